@@ -185,6 +185,11 @@ int main(int argc, char* argv[])
         {
             TEST_RUN(CircularBufferTests);
             TEST_RUN(BasicUtilsTests);
+            TEST_RUN(LRUCacheTests);
+            TEST_RUN(AudioEngineTests);
+            TEST_RUN(AudioDecoderTests);
+            TEST_RUN(JobSystemTests);
+            TEST_RUN(MeshTests);
             TEST_RUN(TreeTests);
             //TEST_RUN(FSM_Tests);
             //TEST_RUN(EventSystemTests);
@@ -193,7 +198,13 @@ int main(int argc, char* argv[])
             TEST_RUN(ClockTests);
             TEST_RUN(SchemaTests);
             TEST_RUN(RandTests);
+            TEST_RUN(CullingTests);
             TEST_RUN(EntitySerialisationTests);
+            TEST_RUN(UndoJournalTests);
+            TEST_RUN(CachedCanvasTests);
+            TEST_RUN(RenderGraphTests);
+            TEST_RUN(RenderCommandListTests);
+            TEST_RUN(DebugDrawTests);
             int testResult = 0;
             if (!TEST_EVALUATE())
             {
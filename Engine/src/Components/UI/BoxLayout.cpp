@@ -83,10 +83,7 @@ namespace Ossium
 
     bool BoxLayout::Contains(Vector2 worldPoint, bool innerDimensions)
     {
-        Vector2 dimensions = innerDimensions ? GetInnerDimensions() : GetDimensions();
-        Vector2 pos = GetTransform()->GetWorldPosition();
-        Rect boxRect = Rect(pos.x - (dimensions.x / 2), pos.y - (dimensions.y / 2), dimensions.x, dimensions.y);
-        return boxRect.Contains(worldPoint);
+        return GetBounds(innerDimensions).Contains(worldPoint);
     }
 
     bool BoxLayout::Contains(Vector2 p)
@@ -94,4 +91,16 @@ namespace Ossium
         return Contains(p, true);
     }
 
+    Rect BoxLayout::GetBounds(bool innerDimensions)
+    {
+        Vector2 dimensions = innerDimensions ? GetInnerDimensions() : GetDimensions();
+        Vector2 pos = GetTransform()->GetWorldPosition();
+        return Rect(pos.x - (dimensions.x / 2), pos.y - (dimensions.y / 2), dimensions.x, dimensions.y);
+    }
+
+    Rect BoxLayout::GetBounds()
+    {
+        return GetBounds(true);
+    }
+
 }
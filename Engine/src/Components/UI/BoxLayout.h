@@ -63,6 +63,12 @@ namespace Ossium
         // IContainsPoint implementation, calls default Contains().
         bool Contains(Vector2 p);
 
+        // Returns the world rect of the layout.
+        Rect GetBounds(bool innerDimensions);
+
+        // IContainsPoint implementation, returns the inner bounds.
+        Rect GetBounds();
+
     private:
         // Cached percent of anchorMin.
         Vector2 anchorMinCached;
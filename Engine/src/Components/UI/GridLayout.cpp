@@ -79,12 +79,16 @@ namespace Ossium
 
     void GridLayout::LayoutRefresh()
     {
+        // Whether any cell entities are created or destroyed.
+        bool changed = false;
+
         // Destroy pre-existing cells that won't be reused.
         for (unsigned int i = cols, counti = cellElements.size(); i < counti; i++)
         {
             for (unsigned int j = rows, countj = cellElements[i].size(); j < countj; j++)
             {
                 Log.Debug("Destroying unused rows and columns!");
+                changed = true;
                 cellElements[i][j]->GetEntity()->Destroy(
 #ifdef OSSIUM_EDITOR
                     true
@@ -107,6 +111,7 @@ namespace Ossium
                 // Destroy unused column entities
                 if (i < totalChildren)
                 {
+                    changed = true;
                     children[i]->GetEntity()->Destroy(
 #ifdef OSSIUM_EDITOR
                         true
@@ -121,6 +126,7 @@ namespace Ossium
             if (i >= totalChildren)
             {
                 // Create missing column entity.
+                changed = true;
                 children.push_back(entity->CreateChild()->AddComponentOnce<Transform>());
                 children.back()->GetEntity()->name = Utilities::Format("Column {0}", i);
             }
@@ -134,6 +140,7 @@ namespace Ossium
                 if (j >= rows && j < cells.size())
                 {
                     // Destroy unused row entities
+                    changed = true;
                     cells[j]->GetEntity()->Destroy(
 #ifdef OSSIUM_EDITOR
                         true
@@ -144,6 +151,7 @@ namespace Ossium
                 else if (j >= cellCount)
                 {
                     // Create missing cell for this row.
+                    changed = true;
                     cells.push_back(children[i]->GetEntity()->CreateChild()->AddComponentOnce<BoxLayout>());
                     cells.back()->GetEntity()->name = Utilities::Format("Row {0}", j);
                 }
@@ -155,6 +163,12 @@ namespace Ossium
                 cellElements[i][j] = cells[j];
             }
         }
+
+        if (changed)
+        {
+            // Cached layouts no longer match the hierarchy.
+            SetLayoutStructureDirty();
+        }
     }
 
 }
@@ -13,7 +13,14 @@ namespace Ossium
     LayoutComponent::LayoutComponent() {}
     LayoutComponent::~LayoutComponent() {}
     void LayoutComponent::OnCreate() { ParentType::OnCreate(); }
-    void LayoutComponent::OnDestroy() { ParentType::OnDestroy(); }
+    void LayoutComponent::OnDestroy()
+    {
+        ParentType::OnDestroy();
+        if (layoutSurface != nullptr)
+        {
+            layoutSurface->RemoveLayout(this);
+        }
+    }
     void LayoutComponent::OnSetEnabled(bool enable) { ParentType::OnSetEnabled(enable); }
     void LayoutComponent::OnLoadStart() { ParentType::OnLoadStart(); }
     void LayoutComponent::OnClone(BaseComponent* src) {}
@@ -33,24 +40,48 @@ namespace Ossium
 
     void LayoutComponent::OnLoadFinish()
     {
-        layoutSurface = entity->GetComponent<LayoutSurface>();
-        if (!layoutSurface)
+        LayoutSurface* surface = entity->GetComponent<LayoutSurface>();
+        if (!surface)
         {
-            layoutSurface = entity->GetAncestor<LayoutSurface>();
-            if (!layoutSurface)
+            surface = entity->GetAncestor<LayoutSurface>();
+            if (!surface)
             {
                 // Automagically add one.
-                layoutSurface = entity->AddComponent<LayoutSurface>();
+                surface = entity->AddComponent<LayoutSurface>();
+            }
+        }
+        if (layoutSurface != surface)
+        {
+            if (layoutSurface != nullptr)
+            {
+                layoutSurface->RemoveLayout(this);
             }
+            surface->AddLayout(this);
         }
         // After loading, make sure the LayoutSurface is marked dirty!
         layoutSurface->SetDirty();
     }
 
+    void LayoutComponent::SetDirty()
+    {
+        if (layoutSurface != nullptr)
+        {
+            layoutSurface->SetDirty(this);
+        }
+    }
+
+    void LayoutComponent::SetLayoutStructureDirty()
+    {
+        if (layoutSurface != nullptr)
+        {
+            layoutSurface->SetDirty();
+        }
+    }
+
     void LayoutComponent::OnEditorPropertyChanged()
     {
         // Mark the layout dirty.
-        layoutSurface->SetDirty();
+        SetDirty();
     }
 
     void LayoutComponent::OnSetActive(bool active)
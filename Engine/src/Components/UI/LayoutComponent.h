@@ -17,14 +17,25 @@ namespace Ossium
 
         // When called, the implementation should refresh the layout.
         virtual void LayoutRefresh() = 0;
+
+        // Marks this layout as needing a refresh, e.g. after changing the anchors of a BoxLayout.
+        // Only this layout and the layouts beneath it are refreshed by the next layout update.
+        void SetDirty();
         
         // Override that forces the layout surface to update.
         virtual void OnEditorPropertyChanged();
 
+    protected:
+        // Marks the entire LayoutSurface dirty. Call this when creating or destroying entities with layout components.
+        void SetLayoutStructureDirty();
+
     private:
         // Reference to the LayoutSurface. Should never be null once the component is loaded.
         LayoutSurface* layoutSurface = nullptr;
 
+        // Whether this layout needs refreshing.
+        bool dirty = false;
+
     };
 
 }
@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "LayoutSurface.h"
 #include "LayoutComponent.h"
 
@@ -8,6 +10,9 @@ namespace Ossium
 
     REGISTER_COMPONENT(LayoutSurface);
 
+    vector<LayoutSurface*> LayoutSurface::dirtySurfaces;
+    Callback<LayoutSurface&> LayoutSurface::OnLayoutRefreshed;
+
     void LayoutSurface::OnLoadFinish()
     {
         SetDirty();
@@ -18,32 +23,141 @@ namespace Ossium
     {
         if (dirty)
         {
-            // Walk layout components breadth-first from this entity
-            entity->GetScene()->WalkEntities([&] (Entity* child) {
-                if (!child->IsActive())
+            RefreshAll();
+        }
+        else if (layoutsDirty)
+        {
+            RefreshDirty();
+        }
+    }
+
+    void LayoutSurface::RefreshAll()
+    {
+        // Unmark dirty first, as layouts may mark the surface dirty again while refreshing (e.g. when a GridLayout creates cells).
+        dirty = false;
+        layoutsDirty = false;
+        layouts.clear();
+        nested.clear();
+
+        // Maps entities to the index of their first cached layout.
+        unordered_map<Entity*, int> groups;
+        auto findParent = [&] (Entity* child) {
+            for (Entity* ancestor = child->GetParent(); ancestor != nullptr && child != entity; ancestor = ancestor->GetParent())
+            {
+                auto itr = groups.find(ancestor);
+                if (itr != groups.end())
                 {
-                    // Skip inactive entities
-                    return false;
+                    return itr->second;
                 }
-                LayoutSurface* group = child->GetComponent<LayoutSurface>();
-                if (group != nullptr && !group->IsDirty())
+                if (ancestor == entity)
                 {
-                    // If another LayoutSurface is encountered which is not dirty, skip it.
-                    return false;
+                    break;
                 }
-                vector<LayoutComponent*> layouts = child->GetComponents<LayoutComponent>();
-                for (auto layout : layouts)
+            }
+            return -1;
+        };
+
+        // Walk layout components breadth-first from this entity
+        entity->GetScene()->WalkEntities([&] (Entity* child) {
+            if (!child->IsActive())
+            {
+                // Skip inactive entities
+                return false;
+            }
+            LayoutSurface* group = child->GetComponent<LayoutSurface>();
+            if (group != nullptr && group != this)
+            {
+                // Other LayoutSurfaces manage their own layouts, but must be refreshed if a layout above them changes.
+                nested.push_back({group, findParent(child)});
+                return false;
+            }
+            vector<LayoutComponent*> found = child->GetComponents<LayoutComponent>();
+            if (!found.empty())
+            {
+                int parent = findParent(child);
+                int first = (int)layouts.size();
+                groups[child] = first;
+                for (auto layout : found)
                 {
+                    if (layout->layoutSurface == nullptr)
+                    {
+                        // Layouts created at runtime don't get OnLoadFinish(), so adopt them here.
+                        AddLayout(layout);
+                    }
+                    layout->dirty = false;
+                    layouts.push_back({layout, parent, first});
                     if (layout->IsEnabled())
                     {
                         // Only refresh enabled layout components
                         layout->LayoutRefresh();
                     }
                 }
-                return true;
-            }, true, entity);
-            // Once layouts are updated, this can be safely unmarked dirty.
-            dirty = false;
+            }
+            return true;
+        }, true, entity);
+
+        OnLayoutRefreshed(*this);
+
+        for (auto& child : nested)
+        {
+            child.surface->SetDirty();
+            child.surface->LayoutUpdate();
+        }
+    }
+
+    void LayoutSurface::RefreshDirty()
+    {
+        layoutsDirty = false;
+        refreshed.assign(layouts.size(), false);
+        bool anyRefreshed = false;
+        // The cache is in breadth-first order, so parent layouts are always refreshed before their children.
+        for (unsigned int i = 0, counti = layouts.size(); i < counti; i++)
+        {
+            CachedLayout& cached = layouts[i];
+            LayoutComponent* layout = cached.layout;
+            bool refresh = layout->dirty || (cached.parent >= 0 && refreshed[cached.parent]);
+            layout->dirty = false;
+            if (refresh && layout->IsEnabled() && layout->GetEntity()->IsActive())
+            {
+                layout->LayoutRefresh();
+                refreshed[cached.group] = true;
+                anyRefreshed = true;
+            }
+        }
+        if (anyRefreshed)
+        {
+            OnLayoutRefreshed(*this);
+        }
+        for (auto& child : nested)
+        {
+            if (child.parent >= 0 && refreshed[child.parent])
+            {
+                child.surface->SetDirty();
+                child.surface->LayoutUpdate();
+            }
+        }
+    }
+
+    void LayoutSurface::UpdateDirtySurfaces()
+    {
+        if (dirtySurfaces.empty())
+        {
+            return;
+        }
+        // Surfaces may be marked dirty again while updating, so they are added to a fresh list for the next update.
+        vector<LayoutSurface*> pending;
+        pending.swap(dirtySurfaces);
+        for (auto surface : pending)
+        {
+            surface->registered = false;
+        }
+        for (auto surface : pending)
+        {
+            // Inactive surfaces stay dirty and are listed again by SetDirty() when their layouts are activated.
+            if (surface->IsEnabled() && surface->GetEntity()->IsActive())
+            {
+                surface->LayoutUpdate();
+            }
         }
     }
 
@@ -55,10 +169,66 @@ namespace Ossium
     void LayoutSurface::SetDirty()
     {
         dirty = true;
+        Register();
+    }
+
+    void LayoutSurface::SetDirty(LayoutComponent* layout)
+    {
+        layout->dirty = true;
+        layoutsDirty = true;
+        Register();
+    }
+
+    void LayoutSurface::Register()
+    {
+        if (!registered)
+        {
+            registered = true;
+            dirtySurfaces.push_back(this);
+        }
+    }
+
+    void LayoutSurface::AddLayout(LayoutComponent* layout)
+    {
+        layout->layoutSurface = this;
+        members.push_back(layout);
+    }
+
+    void LayoutSurface::RemoveLayout(LayoutComponent* layout)
+    {
+        for (unsigned int i = 0, counti = members.size(); i < counti; i++)
+        {
+            if (members[i] == layout)
+            {
+                members[i] = members.back();
+                members.pop_back();
+                break;
+            }
+        }
+        layout->layoutSurface = nullptr;
+        // The cache may reference the layout.
+        SetDirty();
     }
 
     void LayoutSurface::OnDestroy()
     {
+        if (registered)
+        {
+            dirtySurfaces.erase(find(dirtySurfaces.begin(), dirtySurfaces.end(), this));
+            registered = false;
+        }
+        // Layouts must not reference this surface once it's destroyed.
+        for (auto layout : members)
+        {
+            layout->layoutSurface = nullptr;
+        }
+        members.clear();
+        // Cached nested surfaces must not reference this surface either.
+        LayoutSurface* ancestor = entity->GetAncestor<LayoutSurface>();
+        if (ancestor != nullptr)
+        {
+            ancestor->SetDirty();
+        }
 #ifdef OSSIUM_EDITOR
         entity->GetScene()->WalkEntities([&] (Entity* target) {
             if (target->WillBeDestroyed())
@@ -76,13 +246,15 @@ namespace Ossium
             vector<LayoutComponent*> layoutObjs = target->GetComponents<LayoutComponent>();
             for (auto component : layoutObjs)
             {
-                component->layoutSurface = entity->GetAncestor<LayoutSurface>();
-                if (!component->layoutSurface)
+                LayoutSurface* replacement = entity->GetAncestor<LayoutSurface>();
+                if (!replacement)
                 {
                     // Force add it if the target entity is not being destroyed, all layout components must have a LayoutSurface.
                     Log.Warning("LayoutComponent has no ancestor LayoutSurface, attempting to add replacement.");
-                    component->layoutSurface = target->AddComponentOnce<LayoutSurface>();
+                    replacement = target->AddComponentOnce<LayoutSurface>();
                 }
+                replacement->AddLayout(component);
+                replacement->SetDirty();
             }
             return true;
         }, true, entity);
@@ -2,14 +2,17 @@
 #define LAYOUTSURFACE_H
 
 #include "../../Core/component.h"
+#include "../../Core/callback.h"
 
 namespace Ossium
 {
 
+    class LayoutComponent;
+
     struct LayoutSurfaceSchema : public Schema<LayoutSurfaceSchema, 20>
     {
         DECLARE_BASE_SCHEMA(LayoutSurfaceSchema, 20);
-        
+
     };
 
 
@@ -18,12 +21,14 @@ namespace Ossium
     public:
         CONSTRUCT_SCHEMA(Component, LayoutSurfaceSchema);
         DECLARE_COMPONENT(Component, LayoutSurface);
-        
+
+        friend class LayoutComponent;
+
         void OnLoadFinish();
 
-        // Calls LayoutRefresh() for all active and enabled LayoutComponents beneath this LayoutSurface
-        // (breadth-first order). Ignores LayoutComponents on and below entities with LayoutSurfaces which
-        // are not marked dirty.
+        // If the surface is dirty, calls LayoutRefresh() for all active and enabled LayoutComponents beneath this LayoutSurface
+        // (breadth-first order) and caches the order. Otherwise only refreshes the cached LayoutComponents marked dirty and those beneath them.
+        // LayoutSurfaces found beneath this one manage their own LayoutComponents, and are refreshed in full if a LayoutComponent above them is refreshed.
         void LayoutUpdate();
 
         // Is the layout dirty?
@@ -32,13 +37,77 @@ namespace Ossium
         // Mark the layout dirty.
         void SetDirty();
 
-        // Cleans up LayoutComponents on and below this layout's entity, if any. 
+        // Mark a single LayoutComponent managed by this surface dirty.
+        void SetDirty(LayoutComponent* layout);
+
+        // Calls LayoutUpdate() on every LayoutSurface that has been marked dirty, if it is active and enabled.
+        // This does nothing when no layouts have changed.
+        static void UpdateDirtySurfaces();
+
+        // Called after a LayoutSurface refreshes any of its LayoutComponents, e.g. so InputGUI can look up the new bounds of its elements.
+        static Callback<LayoutSurface&> OnLayoutRefreshed;
+
+        // Cleans up LayoutComponents on and below this layout's entity, if any.
         void OnDestroy();
 
     private:
+        // A LayoutComponent in the cached refresh order.
+        struct CachedLayout
+        {
+            LayoutComponent* layout;
+            // Index of the first cached layout on the closest ancestor entity with layouts, or -1 if there is none.
+            int parent;
+            // Index of the first cached layout on the same entity.
+            int group;
+        };
+
+        // A LayoutSurface beneath this one.
+        struct NestedSurface
+        {
+            LayoutSurface* surface;
+            // Index of the first cached layout on the closest ancestor entity with layouts, or -1 if there is none.
+            int parent;
+        };
+
+        // Adds a LayoutComponent managed by this surface.
+        void AddLayout(LayoutComponent* layout);
+
+        // Removes a LayoutComponent managed by this surface.
+        void RemoveLayout(LayoutComponent* layout);
+
+        // Walks the hierarchy beneath this surface, refreshing every layout and rebuilding the cached order.
+        void RefreshAll();
+
+        // Refreshes dirty layouts and the layouts beneath them in the cached order.
+        void RefreshDirty();
+
+        // Adds this surface to the dirty surfaces list if it isn't already listed.
+        void Register();
+
         // Is the layout dirty?
         bool dirty = false;
-        
+
+        // Are any cached layouts dirty?
+        bool layoutsDirty = false;
+
+        // Is this surface in the dirty surfaces list?
+        bool registered = false;
+
+        // All LayoutComponents that use this surface.
+        std::vector<LayoutComponent*> members;
+
+        // Active LayoutComponents beneath this surface in breadth-first order. Only valid while the surface isn't dirty.
+        std::vector<CachedLayout> layouts;
+
+        // LayoutSurfaces beneath this one, found when the cache was built.
+        std::vector<NestedSurface> nested;
+
+        // Scratch flags set on the first cached layout of each entity refreshed by RefreshDirty().
+        std::vector<bool> refreshed;
+
+        // Surfaces waiting for a layout update.
+        static std::vector<LayoutSurface*> dirtySurfaces;
+
     };
 
 }
@@ -14,9 +14,13 @@
  *  3. This notice may not be removed or altered from any source distribution.
  *
 **/
+#include <algorithm>
+
 #include "../Core/transform.h"
 #include "audioextensions.h"
 
+using namespace std;
+
 namespace Ossium
 {
 
@@ -26,6 +30,29 @@ namespace Ossium
 
     REGISTER_COMPONENT(AudioSource);
 
+    vector<AudioSource*> AudioSource::sources;
+
+    vector<pair<float, AudioSource*>> AudioSource::scores;
+
+    void AudioSource::OnCreate()
+    {
+        Component::OnCreate();
+        sourceIndex = sources.size();
+        sources.push_back(this);
+    }
+
+    void AudioSource::OnDestroy()
+    {
+        Component::OnDestroy();
+        if (sourceIndex < sources.size() && sources[sourceIndex] == this)
+        {
+            /// Swap with the last source so removal is constant time
+            sources[sourceIndex] = sources.back();
+            sources[sourceIndex]->sourceIndex = sourceIndex;
+            sources.pop_back();
+        }
+    }
+
     void AudioSource::OnLoadFinish()
     {
         if (looping && !samplePath.empty())
@@ -58,19 +85,103 @@ namespace Ossium
 
     void AudioSource::Update()
     {
-        SetAudioPosition();
+        if (AudioListener::mainListener == nullptr && !sources.empty() && sources[0] == this)
+        {
+            UpdateSources(nullptr);
+        }
+    }
+
+    void AudioSource::UpdateSources(AudioListener* listener)
+    {
+        Vector3 listenerPosition = listener != nullptr ? listener->GetTransform()->GetWorldPosition() : Vector3(0, 0, 0);
+        float cutoffSquared = listener != nullptr ? listener->cutoff * listener->cutoff : 0.0f;
+
+        /// Score all playing sources, updating spatial audio as we go
+        Uint32 realSources = 0;
+        scores.clear();
+        for (AudioSource* source : sources)
+        {
+            if (!source->IsPlaying())
+            {
+                continue;
+            }
+            if (!source->IsVirtual())
+            {
+                realSources++;
+            }
+
+            /// Without a listener, sources play centred
+            Vector2 difference = listener != nullptr ? source->GetTransform()->GetWorldPosition() - listenerPosition : Vector2(0, 0);
+            float squareDistance = difference.LengthSquared();
+            if (listener == nullptr)
+            {
+                source->spatialAttenuation = 0;
+            }
+            else
+            {
+                source->spatialAttenuation = squareDistance > cutoffSquared ? 255 : (Uint8)Utilities::MapRange(squareDistance, 0, cutoffSquared, 0, 255);
+            }
+            source->panningAngle = Wrap(0, (Sint16)difference.Rotation(), 0, 360);
+
+            float audibility = source->IsPaused() ? 0.0f : source->GetFinalVolume() * ((float)(255 - source->spatialAttenuation) / 255.0f);
+            scores.push_back(make_pair(audibility * source->priority, source));
+
+            /// The engine also applies its mix budget by priority, e.g. when other players take up voices
+            source->SetMixPriority(audibility * source->priority);
+        }
+
+        /// Voices mixed for other audio players are not available to audio sources
+        Audio::Internals::AudioEngine& engine = Audio::Internals::AudioEngine::Instance;
+        Uint32 otherVoices = engine.GetRealVoices() - realSources;
+        Uint32 budget = engine.GetMixBudget() > otherVoices ? engine.GetMixBudget() - otherVoices : 0;
+        if (budget < scores.size())
+        {
+            nth_element(scores.begin(), scores.begin() + budget, scores.end(), [] (const pair<float, AudioSource*>& a, const pair<float, AudioSource*>& b) {
+                return a.first > b.first;
+            });
+        }
+
+        /// Only the highest scoring audible sources are mixed
+        for (unsigned int i = 0, counti = scores.empty() ? 0 : scores.size(); i < counti; i++)
+        {
+            AudioSource* source = scores[i].second;
+            if (i < budget && scores[i].first > 0.0f)
+            {
+                if (source->IsVirtual())
+                {
+                    source->SetVirtual(false);
+                }
+                else
+                {
+                    source->OnVolumeChanged();
+                }
+            }
+            else if (!source->IsVirtual())
+            {
+                source->SetVirtual(true);
+            }
+        }
     }
 
     void AudioSource::SetAudioPosition()
     {
         /// Calculate difference as a vector from the listener to this source.
-        Vector2 difference = AudioListener::mainListener != nullptr ? GetTransform()->GetWorldPosition() - AudioListener::mainListener->GetTransform()->GetWorldPosition() : Vector2(0, 0);
-        float cutoffSquared = AudioListener::mainListener != nullptr ? AudioListener::mainListener->cutoff * AudioListener::mainListener->cutoff : 255;
+        /// Without a listener, the source plays centred without attenuation.
+        AudioListener* listener = AudioListener::mainListener;
+        Vector2 difference = listener != nullptr ? GetTransform()->GetWorldPosition() - listener->GetTransform()->GetWorldPosition() : Vector2(0, 0);
 
         /// Set attenuation based on distance
         /// Use maximum attenuation if distance > cutoff, else calculate based on cutoff.
-        float squareDistance = difference.LengthSquared();
-        spatialAttenuation = squareDistance > cutoffSquared ? 255 : (Uint8)Utilities::MapRange(squareDistance, 0, cutoffSquared, 0, 255);
+        if (listener != nullptr)
+        {
+            float cutoffSquared = listener->cutoff * listener->cutoff;
+            float squareDistance = difference.LengthSquared();
+            spatialAttenuation = squareDistance > cutoffSquared ? 255 : (Uint8)Utilities::MapRange(squareDistance, 0, cutoffSquared, 0, 255);
+        }
+        else
+        {
+            spatialAttenuation = 0;
+        }
 
         /// Note: calling this method automatically applies spatial attenuation as it calls OnVolumeChanged().
         SetPanning(difference.Rotation());
@@ -107,6 +218,14 @@ namespace Ossium
         }
     }
 
+    void AudioListener::Update()
+    {
+        if (mainListener == this)
+        {
+            AudioSource::UpdateSources(this);
+        }
+    }
+
     AudioListener* AudioListener::mainListener = nullptr;
 
 }
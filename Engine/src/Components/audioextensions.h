@@ -25,10 +25,10 @@ using namespace Ossium::Audio;
 namespace Ossium
 {
 
-    struct OSSIUM_EDL AudioSourceSchema : public Schema<AudioSourceSchema, 2>
+    struct OSSIUM_EDL AudioSourceSchema : public Schema<AudioSourceSchema, 3>
     {
     public:
-        DECLARE_BASE_SCHEMA(AudioSourceSchema, 2);
+        DECLARE_BASE_SCHEMA(AudioSourceSchema, 3);
 
     protected:
         /// Path to the currently playing audio sample.
@@ -37,8 +37,14 @@ namespace Ossium
         /// Is the source looping forever?
         M(bool, looping) = false;
 
+        /// How important this source is relative to others when there are more playing sources than voices that can be mixed.
+        M(float, priority) = 1.0f;
+
     };
 
+    /// Forward declaration
+    class AudioListener;
+
     namespace Internal
     {
 
@@ -60,18 +66,39 @@ namespace Ossium
         /// Doesn't account for walls and physics objects, purely distance and direction "as the crow flies" from the listener.
         void Play(AudioClip* sample, float vol = -1.0f, int repeats = 0);
 
-        /// Updates the volume and panning of the audio playback for simple spatial effects.
-        void Update();
+        /// Updates the volume and panning of all playing audio sources for simple spatial effects in a single pass.
+        /// Sources are scored by audibility and priority; inaudible sources and those that don't fit in the engine mix budget
+        /// are virtualised, and sources that become audible again are made real.
+        /// If the listener is null, sources are heard from the origin without any distance attenuation.
+        static void UpdateSources(AudioListener* listener);
 
         /// If a sample is specified, play it.
         void OnLoadFinish();
 
+        /// Registers this source for UpdateSources().
+        void OnCreate();
+
+        /// Unregisters this source.
+        void OnDestroy();
+
+        /// When there is no main listener, the first source updates all sources instead.
+        void Update();
+
     private:
         /// Sets the spatial audio attenuation and panning of this source.
         void SetAudioPosition();
 
         using Internal::AudioSourceSchemaCombiner::Play;
 
+        /// Index of this source in the sources array.
+        unsigned int sourceIndex = 0;
+
+        /// All audio sources that currently exist.
+        static std::vector<AudioSource*> sources;
+
+        /// Audibility scores of playing sources, reused by each UpdateSources() pass.
+        static std::vector<std::pair<float, AudioSource*>> scores;
+
     };
 
     struct OSSIUM_EDL AudioListenerSchema : public Schema<AudioListenerSchema, 1>
@@ -98,6 +125,9 @@ namespace Ossium
         /// If this is the main listener, set the main listener pointer to nullptr.
         void OnDestroy();
 
+        /// If this is the main listener, updates all audio sources relative to this listener.
+        void Update();
+
     private:
         static AudioListener* mainListener;
 
@@ -33,6 +33,11 @@ namespace Ossium
         return hitTester->Contains(position);
     }
 
+    Rect Button::GetBounds()
+    {
+        return hitTester != nullptr ? hitTester->GetBounds() : hitbox;
+    }
+
     void Button::OnClick()
     {
         if (stateFollower != nullptr)
@@ -17,6 +17,9 @@ namespace Ossium
         /// Override to use sprite rect.
         bool ContainsPointer(Point position);
 
+        /// Override to use the bounds of the hit tester.
+        Rect GetBounds();
+
         /// Callback registry that is called whenever the button is clicked.
         Callback<Button&> OnClicked;
 
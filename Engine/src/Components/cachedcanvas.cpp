@@ -0,0 +1,341 @@
+#include <algorithm>
+#include <cmath>
+
+#include "cachedcanvas.h"
+#include "canvas.h"
+
+using namespace std;
+
+namespace Ossium
+{
+
+    REGISTER_COMPONENT(CachedCanvas);
+
+    void CachedCanvas::OnCreate()
+    {
+        Renderer* renderer = GetEntity()->GetService<Renderer>();
+        if (renderer != nullptr)
+        {
+            renderer->AddInput(this);
+            cache = new RenderTexture();
+        }
+        watched = GetEntity()->GetScene();
+        addedHandle = watched->onEntityAdded += [this] (Entity* entity) { OnEntityChanged(entity); };
+        removedHandle = watched->onEntityRemoved += [this] (Entity* entity) { OnEntityChanged(entity); };
+        reparentedHandle = watched->onEntityReparented += [this] (Entity* entity) { OnEntityChanged(entity); };
+    }
+
+    void CachedCanvas::OnDestroy()
+    {
+        Renderer* renderer = GetEntity()->GetService<Renderer>();
+        if (renderer != nullptr)
+        {
+            renderer->RemoveInput(this);
+        }
+        if (cache != nullptr)
+        {
+            delete cache;
+            cache = nullptr;
+        }
+        if (watched != nullptr)
+        {
+            watched->onEntityAdded -= addedHandle;
+            watched->onEntityRemoved -= removedHandle;
+            watched->onEntityReparented -= reparentedHandle;
+            watched = nullptr;
+        }
+        entities.clear();
+        hashes.clear();
+    }
+
+    std::string CachedCanvas::GetRenderDebugName()
+    {
+        return "CachedCanvas." + GetEntity()->name;
+    }
+
+    bgfx::ViewMode::Enum CachedCanvas::GetViewMode()
+    {
+        return bgfx::ViewMode::Sequential;
+    }
+
+    SDL_Color CachedCanvas::GetClearColor()
+    {
+        return Colors::Transparent;
+    }
+
+    bool CachedCanvas::IsRenderEnabled()
+    {
+        if (!IsEnabled() || !GetEntity()->IsActive())
+        {
+            return false;
+        }
+        Refresh();
+        return rendering && cache != nullptr && bgfx::isValid(cache->GetFrameBuffer());
+    }
+
+    bool CachedCanvas::IsCached()
+    {
+        Refresh();
+        return !rendering && cache != nullptr && bgfx::isValid(cache->GetFrameBuffer());
+    }
+
+    void CachedCanvas::SetDirty()
+    {
+        dirty = true;
+    }
+
+    void CachedCanvas::DeclareTargets(RenderPassTargets& targets)
+    {
+        // The texture is drawn by the parent canvas in later frames, so it's never read in the frame it is rendered
+        targets.Write(cache);
+    }
+
+    void CachedCanvas::Render()
+    {
+        Canvas::DrawEntities(this, GetEntity());
+
+        // Graphics set the view up for the whole renderer, but only the area covered by the subtree
+        // is rendered, in the top left corner of the texture
+        Matrix<4, 4> view = Matrix<4, 4>::Identity();
+        Matrix<4, 4> proj = Matrix<4, 4>::Orthographic(
+            bounds.x,
+            bounds.x + cache->GetWidth(),
+            bounds.y + cache->GetHeight(),
+            bounds.y,
+            0,
+            100
+        );
+        GetRenderer()->SetViewTransform(this, view, proj);
+    }
+
+    void CachedCanvas::Draw(RenderInput* pass)
+    {
+        if (pass == this || !IsCached() || !bounded)
+        {
+            return;
+        }
+
+        SDL_Rect dest = bounds.SDL();
+        if (dest.w <= 0 || dest.h <= 0)
+        {
+            return;
+        }
+
+        SDL_Rect clip = {0, 0, dest.w, dest.h};
+        SDL_RendererFlip flip = SDL_FLIP_NONE;
+        if (bgfx::getCaps()->originBottomLeft)
+        {
+            // The texture is upside down when the origin is at the bottom left
+            clip.y = cache->GetHeight() - clip.h;
+            flip = SDL_FLIP_VERTICAL;
+        }
+        // Graphics were blended into the transparent texture with separate alpha factors, so the colours are already
+        // multiplied by alpha and must not be multiplied again
+        cache->Render(pass, dest, &clip, nullptr, 0, Colors::White, GetPremultipliedBlendMode(), flip);
+    }
+
+    bool CachedCanvas::GetDrawBounds(Rect& area)
+    {
+        if (bounded)
+        {
+            area = bounds;
+        }
+        return bounded;
+    }
+
+    RenderTexture* CachedCanvas::GetTexture()
+    {
+        return cache;
+    }
+
+    void CachedCanvas::Refresh()
+    {
+        Renderer* renderer = GetRenderer();
+        if (renderer == nullptr || cache == nullptr || (refreshed && refreshFrame == renderer->GetFrame()))
+        {
+            return;
+        }
+        refreshed = true;
+        refreshFrame = renderer->GetFrame();
+
+        bool changed = dirty;
+        if (restructured)
+        {
+            CollectEntities();
+            changed = true;
+        }
+        else
+        {
+            // Only check a few entities each frame, so large subtrees don't have to be hashed every frame
+            for (unsigned int i = 0, counti = min((unsigned int)entities.size(), HashBudget); i < counti; i++)
+            {
+                nextCheck = nextCheck < entities.size() ? nextCheck : 0;
+                Uint64 current = HashEntity(entities[nextCheck]);
+                if (current != hashes[nextCheck])
+                {
+                    hashes[nextCheck] = current;
+                    changed = true;
+                }
+                nextCheck++;
+            }
+        }
+
+        Vector2 current = GetTransform()->GetWorldPosition();
+        if (current.x != position.x || current.y != position.y)
+        {
+            position = current;
+            changed = true;
+        }
+
+        rendering = changed;
+        dirty = false;
+        if (!rendering)
+        {
+            return;
+        }
+
+        UpdateBounds();
+        int width = (int)bounds.w;
+        int height = (int)bounds.h;
+        if (width > 0 && height > 0)
+        {
+            // The texture is reused while it's large enough, so a subtree that changes size doesn't recreate it every frame
+            int cacheWidth = cache->GetWidth();
+            int cacheHeight = cache->GetHeight();
+            if (cacheWidth < width || cacheHeight < height || cacheWidth > width * 2 || cacheHeight > height * 2)
+            {
+                cache->Create(width, height);
+            }
+        }
+        else
+        {
+            // Nothing to render
+            rendering = false;
+        }
+    }
+
+    bool CachedCanvas::Contains(Entity* entity)
+    {
+        Entity* root = GetEntity();
+        for (; entity != nullptr; entity = entity->GetParent())
+        {
+            if (entity == root)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void CachedCanvas::OnEntityChanged(Entity* entity)
+    {
+        if (!restructured && (Contains(entity) || find(entities.begin(), entities.end(), entity) != entities.end()))
+        {
+            restructured = true;
+        }
+    }
+
+    void CachedCanvas::CollectEntities()
+    {
+        Entity* root = GetEntity();
+        entities.clear();
+        hashes.clear();
+        nextCheck = 0;
+        restructured = false;
+
+        // Inactive entities are included so that activating them is detected
+        root->GetScene()->WalkEntities([&] (Entity* child) {
+            bool result = !child->HasComponent<Canvas>() || child == root;
+            if (result)
+            {
+                entities.push_back(child);
+                hashes.push_back(HashEntity(child));
+            }
+            return result;
+        }, true, root);
+    }
+
+    Uint64 CachedCanvas::HashEntity(Entity* entity)
+    {
+        bool active = entity->IsActive();
+        Uint64 current = Utilities::HashBytes(&active, sizeof(active));
+        for (auto& itr : entity->GetAllComponents())
+        {
+            for (BaseComponent* component : itr.second)
+            {
+                bool enabled = component->IsEnabled();
+                current = Utilities::HashBytes(&itr.first, sizeof(itr.first), current);
+                current = Utilities::HashBytes(&enabled, sizeof(enabled), current);
+                memberHashes.clear();
+                component->HashMembers(memberHashes);
+                current = Utilities::HashBytes(memberHashes.data(), memberHashes.size() * sizeof(Uint64), current);
+            }
+        }
+        return current;
+    }
+
+    void CachedCanvas::UpdateBounds()
+    {
+        Entity* root = GetEntity();
+        Renderer* renderer = GetRenderer();
+        bool known = true;
+        bool empty = true;
+        Rect area;
+        root->GetScene()->WalkEntities([&] (Entity* child) {
+            bool result = known && child->IsActive() && (!child->HasComponent<Canvas>() || child == root);
+            if (result)
+            {
+                for (GraphicComponent* graphic : child->GetComponents<GraphicComponent>())
+                {
+                    if (graphic == this || !graphic->IsEnabled())
+                    {
+                        continue;
+                    }
+                    if (!graphic->GetDrawBounds(area))
+                    {
+                        // Unknown area, so the whole viewport must be rendered
+                        known = false;
+                        return false;
+                    }
+                    if (empty)
+                    {
+                        bounds = area;
+                        empty = false;
+                    }
+                    else
+                    {
+                        float xmax = max(bounds.x + bounds.w, area.x + area.w);
+                        float ymax = max(bounds.y + bounds.h, area.y + area.h);
+                        bounds.x = min(bounds.x, area.x);
+                        bounds.y = min(bounds.y, area.y);
+                        bounds.w = xmax - bounds.x;
+                        bounds.h = ymax - bounds.y;
+                    }
+                }
+            }
+            return result;
+        }, true, root);
+
+        if (!known)
+        {
+            bounds = Rect(0, 0, renderer->GetWidth(), renderer->GetHeight());
+        }
+        else if (empty)
+        {
+            bounds = Rect(0, 0, 0, 0);
+        }
+        else
+        {
+            // Nothing outside the viewport is visible. The bounds are rounded out to whole pixels
+            // so the texture maps exactly onto the screen.
+            float xmax = min(ceil(bounds.x + bounds.w), (float)renderer->GetWidth());
+            float ymax = min(ceil(bounds.y + bounds.h), (float)renderer->GetHeight());
+            bounds.x = max(floor(bounds.x), 0.0f);
+            bounds.y = max(floor(bounds.y), 0.0f);
+            bounds.w = max(xmax - bounds.x, 0.0f);
+            bounds.h = max(ymax - bounds.y, 0.0f);
+        }
+        bounded = true;
+    }
+
+}
@@ -0,0 +1,136 @@
+#ifndef CACHEDCANVAS_H
+#define CACHEDCANVAS_H
+
+#include "../Core/component.h"
+#include "../Core/renderinput.h"
+#include "../Core/rendertexture.h"
+
+namespace Ossium
+{
+
+    struct CachedCanvasSchema : public Schema<CachedCanvasSchema, 20>
+    {
+        DECLARE_BASE_SCHEMA(CachedCanvasSchema, 20);
+
+    };
+
+    // Renders the graphics of an entity and its descendants into an offscreen texture,
+    // which the parent canvas then draws as a single quad in place of the whole subtree.
+    // The texture only covers the area of the subtree and is only re-rendered when the subtree changes.
+    // Adding, removing or reparenting entities and moving the root are detected straight away. Other changes are detected by
+    // hashing the schema members, enabled and active states of a few entities in the subtree each frame,
+    // so large subtrees may take a few frames to update; call SetDirty() to re-render immediately,
+    // or after changes that aren't visible through schema members.
+    // While re-rendering, the subtree is also drawn directly by the parent canvas.
+    class CachedCanvas : public RenderInput, public GraphicComponent, public CachedCanvasSchema
+    {
+    public:
+        CONSTRUCT_SCHEMA(GraphicComponent, CachedCanvasSchema);
+        DECLARE_COMPONENT(GraphicComponent, CachedCanvas);
+
+        // Add RenderInput to main renderer
+        void OnCreate();
+
+        // Remove RenderInput from main renderer and free the texture
+        void OnDestroy();
+
+        // Returns a name for graphics debugging purposes
+        std::string GetRenderDebugName();
+
+        // Always returns sequential draw call order mode
+        bgfx::ViewMode::Enum GetViewMode();
+
+        // The subtree is only rendered to the texture when the cache is out of date
+        bool IsRenderEnabled();
+
+        // Returns true if the texture is up to date this frame, i.e. it can be drawn in place of the subtree
+        bool IsCached();
+
+        // Forces the texture to be re-rendered
+        void SetDirty();
+
+        // Draws the texture. Does nothing while the subtree is being re-rendered.
+        void Draw(RenderInput* pass);
+
+        // Returns the area covered by the subtree when it was last rendered to the texture
+        bool GetDrawBounds(Rect& area);
+
+        // Returns the offscreen texture
+        RenderTexture* GetTexture();
+
+        // The maximum number of entities in the subtree that are checked for changes each frame
+        static constexpr unsigned int HashBudget = 32;
+
+    protected:
+        // The texture is cleared to transparent so it can be drawn over other graphics
+        SDL_Color GetClearColor();
+
+        // Renders to the texture rather than the target of the renderer
+        void DeclareTargets(RenderPassTargets& targets);
+
+    private:
+        // Render the subtree to the texture
+        void Render();
+
+        // Checks whether the subtree has changed since it was last rendered. Only checks once per frame.
+        void Refresh();
+
+        // Returns true if an entity is the root or one of its descendants
+        bool Contains(Entity* entity);
+
+        // Marks the subtree as restructured if an entity added, removed or reparented in the scene is or was part of it
+        void OnEntityChanged(Entity* entity);
+
+        // Gathers the entities in the subtree and hashes every one of them
+        void CollectEntities();
+
+        // Returns a hash of everything about an entity that affects how it is drawn
+        Uint64 HashEntity(Entity* entity);
+
+        // Updates the area covered by the subtree
+        void UpdateBounds();
+
+        // The offscreen texture, at least as large as the area covered by the subtree
+        RenderTexture* cache = nullptr;
+
+        // The frame in which the subtree was last checked for changes
+        Uint32 refreshFrame = 0;
+        bool refreshed = false;
+
+        // The scene the callback handles were registered with
+        Scene* watched = nullptr;
+        int addedHandle = 0;
+        int removedHandle = 0;
+        int reparentedHandle = 0;
+
+        // Whether entities were added to, removed from or reparented within the subtree since it was last collected
+        bool restructured = true;
+
+        // The entities in the subtree and their hashes when last checked
+        std::vector<Entity*> entities;
+        std::vector<Uint64> hashes;
+
+        // Index of the next entity to check for changes
+        unsigned int nextCheck = 0;
+
+        // World position of the root when last checked. The texture is in screen space, so moving the whole subtree must re-render it.
+        Vector2 position = Vector2(0, 0);
+
+        // Whether the texture must be re-rendered regardless of the hashes
+        bool dirty = true;
+
+        // Whether the subtree is being re-rendered this frame
+        bool rendering = true;
+
+        // The area covered by the subtree when last rendered, in whole pixels
+        Rect bounds;
+        bool bounded = false;
+
+        // Reused when hashing components
+        std::vector<Uint64> memberHashes;
+
+    };
+
+}
+
+#endif // CACHEDCANVAS_H
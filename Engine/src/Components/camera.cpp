@@ -7,12 +7,21 @@ namespace Ossium
 
     void Camera::OnCreate()
     {
-        GetRenderer()->AddInput(this);
+        // The input isn't added to a renderer yet, so get the renderer from the scene
+        Renderer* renderer = GetEntity()->GetService<Renderer>();
+        if (renderer != nullptr)
+        {
+            renderer->AddInput(this);
+        }
     }
 
     void Camera::OnDestroy()
     {
-        GetRenderer()->RemoveInput(this);
+        Renderer* renderer = GetRenderer();
+        if (renderer != nullptr)
+        {
+            renderer->RemoveInput(this);
+        }
     }
 
     std::string Camera::GetRenderDebugName()
@@ -22,7 +31,7 @@ namespace Ossium
     
     bgfx::ViewMode::Enum Camera::GetViewMode()
     {
-        return bgfx::ViewMode::Default;
+        return bgfx::ViewMode::DepthAscending;
     }
 
     Matrix<4, 4> Camera::GetViewMatrix()
@@ -35,7 +44,7 @@ namespace Ossium
 
     Matrix<4, 4> Camera::GetProjMatrix()
     {
-        return Matrix<4, 4>::Perspective(fov, GetRenderer()->GetAspectRatio(), near, far);
+        return Matrix<4, 4>::Perspective(DegToRad(fov), GetRenderer()->GetAspectRatio(), near, far);
     }
 
     void Camera::Render()
@@ -44,6 +53,10 @@ namespace Ossium
         Renderer* renderer = GetRenderer();
         Matrix<4, 4> view = GetViewMatrix();
         Matrix<4, 4> proj = GetProjMatrix();
+        Frustum frustum = Frustum(proj * view);
+        Vector3 centre;
+        float radius;
+        culled = 0;
         GetEntity()->GetScene()->WalkEntities([&] (Entity* target) {
             if (!target->IsActive())
             {
@@ -52,13 +65,33 @@ namespace Ossium
             auto renderables = target->GetComponents<RenderComponent>();
             for (auto toRender : renderables)
             {
-                if (toRender->IsEnabled())
+                if (!toRender->IsEnabled())
+                {
+                    continue;
+                }
+                bool bounded = toRender->GetRenderBounds(centre, radius);
+                // Skip anything entirely outside the view of the camera
+                if (!bounded || frustum.Intersects(centre, radius))
                 {
+                    // Draw calls are sorted front to back by the centre of what is rendered, or else the position of the entity
+                    Transform* transform = target->GetComponent<Transform>();
+                    Vector3 position = bounded ? centre : (transform != nullptr ? transform->GetWorldPosition() : Vector3(0, 0, 0));
+                    renderer->SetDrawOrder(0, frustum.GetDepth(position));
                     toRender->Render(this, view, proj);
                 }
+                else
+                {
+                    culled++;
+                }
             }
             return true;
         });
+        renderer->SetDrawOrder(0, 0);
+    }
+
+    Uint32 Camera::GetCulledCount()
+    {
+        return culled;
     }
 
 }
@@ -37,7 +37,7 @@ namespace Ossium
         // Returns a name for graphics debugging purposes
         std::string GetRenderDebugName();
         
-        // Camera always sorts primarily by depth
+        // Camera sorts draw calls front to back, so less is drawn over
         bgfx::ViewMode::Enum GetViewMode();
 
         // Returns the camera view "LookAt" matrix
@@ -48,7 +48,13 @@ namespace Ossium
 
         // Render all child graphics
         void Render();
-        
+
+        // Returns the number of RenderComponents the last Render() skipped because they were outside the view
+        Uint32 GetCulledCount();
+
+    private:
+        Uint32 culled = 0;
+
     };
     
 }
@@ -1,4 +1,9 @@
+#include <algorithm>
+
 #include "canvas.h"
+#include "cachedcanvas.h"
+
+using namespace std;
 
 namespace Ossium
 {
@@ -38,23 +43,54 @@ namespace Ossium
     void Canvas::Render()
     {
         //Log.Info("Rendering canvas...");
-        Entity* root = GetEntity();
+        DrawEntities(this, GetEntity());
+    }
+
+    void Canvas::DrawEntities(RenderInput* pass, Entity* root)
+    {
+        Renderer* renderer = pass->GetRenderer();
+        Rect viewport = Rect(0, 0, renderer->GetWidth(), renderer->GetHeight());
+        Rect bounds;
         root->GetScene()->WalkEntities([&] (Entity* child) {
             bool result = child->IsActive() && (!child->HasComponent<Canvas>() || child == root);
             //Log.Info("Walk result = {0}", result);
             if (result)
             {
+                // Graphics are layered by how deep they are in the hierarchy and sorted by z within a layer,
+                // which only matters when drawing in a view that isn't sequential. Graphics are projected with a far plane at z = 100.
+                unsigned int level = 0;
+                for (Entity* parent = child; parent != root && parent != nullptr; parent = parent->GetParent())
+                {
+                    level++;
+                }
+                Transform* transform = child->GetComponent<Transform>();
+                float z = transform != nullptr ? transform->GetWorldPosition().z : 0;
+                renderer->SetDrawOrder((Uint8)min(level, 0xFFu), clamp(z / 100.0f, 0.0f, 1.0f));
+
+                CachedCanvas* cached = child != root ? child->GetComponent<CachedCanvas>() : nullptr;
+                if (cached != nullptr && cached->IsEnabled() && cached->IsCached())
+                {
+                    // The cached texture replaces the entire subtree
+                    if (!cached->GetDrawBounds(bounds) || bounds.Intersects(viewport))
+                    {
+                        cached->Draw(pass);
+                    }
+                    return false;
+                }
+
                 auto graphics = child->GetComponents<GraphicComponent>();
                 for (GraphicComponent* graphic : graphics)
                 {
-                    if (graphic->IsEnabled())
+                    // Skip graphics that are entirely outside the viewport
+                    if (graphic->IsEnabled() && (!graphic->GetDrawBounds(bounds) || bounds.Intersects(viewport)))
                     {
-                        graphic->Draw(this);
+                        graphic->Draw(pass);
                     }
                 }
             }
             return result;
         }, true, root);
+        renderer->SetDrawOrder(0, 0);
     }
 
 }
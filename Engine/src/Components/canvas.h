@@ -37,6 +37,11 @@ namespace Ossium
 
         // Render all child graphics
         void Render();
+
+        // Draws the enabled graphics of an entity and its descendants in hierarchy order, skipping those outside the viewport.
+        // Descendants with their own canvas are left for that canvas to render,
+        // and cached canvases are drawn as a single graphic while their cache is up to date.
+        static void DrawEntities(RenderInput* pass, Entity* root);
         
     };
     
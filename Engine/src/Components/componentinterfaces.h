@@ -25,6 +25,12 @@ namespace Ossium
     {
     public:
         virtual bool Contains(Vector2 p) = 0;
+        /// Returns a rect enclosing every point for which Contains() returns true.
+        /// The default empty rect means the bounds are unknown, so every point must be tested.
+        virtual Rect GetBounds()
+        {
+            return Rect(0, 0, 0, 0);
+        }
     };
 
 }
@@ -14,13 +14,35 @@
  *  3. This notice may not be removed or altered from any source distribution.
  *
 **/
+#include <cmath>
+#include <algorithm>
+#include <iterator>
+
 #include "inputgui.h"
+#include "UI/LayoutSurface.h"
 
 using namespace std;
 
 namespace Ossium
 {
 
+    /// Minimum size of InputGUI grid cells in pixels.
+    const float MinCellSize = 64.0f;
+    /// Maximum number of InputGUI grid cells along each axis.
+    const int MaxGridCells = 128;
+
+    /// Converts a mouse input position into viewport space
+    static Point GetViewportPoint(Renderer* renderer, const MouseInput& data)
+    {
+        if (renderer != nullptr)
+        {
+            /// Offsets to account for the aspect ratio / viewport of the window
+            SDL_Rect vrect = renderer->GetViewportRect();
+            return Point((float)(data.x - vrect.x), (float)(data.y - vrect.y));
+        }
+        return Point((float)data.x, (float)data.y);
+    }
+
     BaseComponent* InteractableGUI::ComponentFactory(void* target_entity)
     {
         return nullptr;
@@ -89,6 +111,14 @@ namespace Ossium
     {
     }
 
+    void InteractableGUI::SetBoundsDirty()
+    {
+        if (input != nullptr)
+        {
+            input->SetBoundsDirty();
+        }
+    }
+
     bool InteractableGUI::IsPressed()
     {
         return pressed;
@@ -104,6 +134,11 @@ namespace Ossium
         return hitbox.Contains(position);
     }
 
+    Rect InteractableGUI::GetBounds()
+    {
+        return hitbox;
+    }
+
     void InteractableGUI::OnPointerEvent(const MouseInput& data)
     {
         if (!IsActiveAndEnabled())
@@ -111,17 +146,7 @@ namespace Ossium
             // Early out.
             return;
         }
-        Point mpos;
-        if (GetService<Renderer>() != nullptr)
-        {
-            /// Offsets to account for the aspect ratio / viewport of the window
-            SDL_Rect vrect = GetService<Renderer>()->GetViewportRect();
-            mpos = Point((float)(data.x - vrect.x), (float)(data.y - vrect.y));
-        }
-        else
-        {
-            mpos = Point((float)data.x, (float)data.y);
-        }
+        Point mpos = GetViewportPoint(GetService<Renderer>(), data);
         lastMousePos = mpos;
         if (ContainsPointer(mpos))
         {
@@ -199,6 +224,14 @@ namespace Ossium
         keyboard->AddAction("select_up", [&] (const KeyboardInput& data) { return this->SelectUp(data); }, SDLK_UP);
         keyboard->AddAction("select_down", [&] (const KeyboardInput& data) { return this->SelectDown(data); }, SDLK_DOWN);
         keyboard->AddAction("go_back", [&] (const KeyboardInput& data) { return this->GoBack(data); }, SDLK_ESCAPE);
+
+        /// Layouts move and resize their elements, so look up the bounds again after layouts in this scene refresh.
+        layoutRefreshHandle = LayoutSurface::OnLayoutRefreshed += [&] (LayoutSurface& surface) {
+            if (surface.GetEntity()->GetScene() == entity->GetScene())
+            {
+                indexDirty = true;
+            }
+        };
     }
     
     void InputGUI::OnSetActive(bool active)
@@ -228,6 +261,11 @@ namespace Ossium
     void InputGUI::OnDestroy()
     {
         Component::OnDestroy();
+        if (layoutRefreshHandle >= 0)
+        {
+            LayoutSurface::OnLayoutRefreshed -= layoutRefreshHandle;
+            layoutRefreshHandle = -1;
+        }
         string context = Utilities::Format("InputGUI:{0}", this);
         if (GetService<InputController>()->GetContext(context) != nullptr)
         {
@@ -247,6 +285,7 @@ namespace Ossium
             }
         }
         interactables.push_back(element);
+        indexDirty = true;
     }
 
     bool InputGUI::RemoveInteractable(InteractableGUI* element)
@@ -257,6 +296,7 @@ namespace Ossium
             if (*itr == element)
             {
                 interactables.erase(itr);
+                indexDirty = true;
                 return true;
             }
         }
@@ -267,18 +307,178 @@ namespace Ossium
     {
         currentIndex = 0;
         interactables.clear();
+        indexDirty = true;
+    }
+
+    void InputGUI::SetBoundsDirty()
+    {
+        indexDirty = true;
+    }
+
+    void InputGUI::RebuildIndex()
+    {
+        indexDirty = false;
+        engaged.clear();
+        unbounded.clear();
+        cellStart.clear();
+        cellItems.clear();
+        gridColumns = 0;
+        gridRows = 0;
+
+        bounds.clear();
+        float minX = 0, minY = 0, maxX = 0, maxY = 0;
+        bool empty = true;
+        for (unsigned int i = 0, counti = interactables.size(); i < counti; i++)
+        {
+            if (interactables[i]->IsHovered() || interactables[i]->IsPressed())
+            {
+                engaged.push_back(i);
+            }
+            Rect rect = interactables[i]->GetBounds();
+            bounds.push_back(rect);
+            if (rect.w <= 0 || rect.h <= 0)
+            {
+                unbounded.push_back(i);
+                continue;
+            }
+            minX = empty ? rect.x : min(minX, rect.x);
+            minY = empty ? rect.y : min(minY, rect.y);
+            maxX = empty ? rect.x + rect.w : max(maxX, rect.x + rect.w);
+            maxY = empty ? rect.y + rect.h : max(maxY, rect.y + rect.h);
+            empty = false;
+        }
+        if (empty)
+        {
+            return;
+        }
+
+        gridOrigin = Vector2(minX, minY);
+        cellSize = max(MinCellSize, max(maxX - minX, maxY - minY) / (float)MaxGridCells);
+        gridColumns = min((int)((maxX - minX) / cellSize) + 1, MaxGridCells);
+        gridRows = min((int)((maxY - minY) / cellSize) + 1, MaxGridCells);
+
+        // Count the interactables overlapping each cell, then fill in the cell lists in order of interactable index.
+        cellStart.assign(gridColumns * gridRows + 1, 0);
+        for (int pass = 0; pass < 2; pass++)
+        {
+            for (unsigned int i = 0, counti = bounds.size(); i < counti; i++)
+            {
+                Rect& rect = bounds[i];
+                if (rect.w <= 0 || rect.h <= 0)
+                {
+                    continue;
+                }
+                int x0 = Clamp((int)floor((rect.x - gridOrigin.x) / cellSize), 0, gridColumns - 1);
+                int y0 = Clamp((int)floor((rect.y - gridOrigin.y) / cellSize), 0, gridRows - 1);
+                int x1 = Clamp((int)floor((rect.x + rect.w - gridOrigin.x) / cellSize), 0, gridColumns - 1);
+                int y1 = Clamp((int)floor((rect.y + rect.h - gridOrigin.y) / cellSize), 0, gridRows - 1);
+                for (int y = y0; y <= y1; y++)
+                {
+                    for (int x = x0; x <= x1; x++)
+                    {
+                        if (pass == 0)
+                        {
+                            cellStart[y * gridColumns + x + 1]++;
+                        }
+                        else
+                        {
+                            cellItems[cellStart[y * gridColumns + x]++] = i;
+                        }
+                    }
+                }
+            }
+            if (pass == 0)
+            {
+                for (unsigned int cell = 1, countcell = cellStart.size(); cell < countcell; cell++)
+                {
+                    cellStart[cell] += cellStart[cell - 1];
+                }
+                cellItems.resize(cellStart.back());
+            }
+        }
+        // The fill pass advanced each cell start to the start of the next cell, so shift them back.
+        for (unsigned int cell = cellStart.size() - 1; cell > 0; cell--)
+        {
+            cellStart[cell] = cellStart[cell - 1];
+        }
+        cellStart[0] = 0;
+    }
+
+    void InputGUI::Engage(unsigned int index)
+    {
+        auto itr = lower_bound(engaged.begin(), engaged.end(), index);
+        if (itr == engaged.end() || *itr != index)
+        {
+            engaged.insert(itr, index);
+        }
+    }
+
+    void InputGUI::AddCandidates(const vector<unsigned int>& indices)
+    {
+        // Both lists are in ascending order, so the union keeps the order the interactables were added in.
+        merged.clear();
+        set_union(candidates.begin(), candidates.end(), indices.begin(), indices.end(), back_inserter(merged));
+        candidates.swap(merged);
     }
 
     ActionOutcome InputGUI::HandlePointer(const MouseInput& data)
     {
         if (IsEnabled() && data.type != MOUSE_UNKNOWN)
         {
-            // Loop doesn't include any interactables added during iteration this way
-            for (unsigned int i = 0, counti = interactables.size(); i < counti; i++)
+            if (indexDirty)
+            {
+                RebuildIndex();
+            }
+
+            candidates.clear();
+            if (data.type == MOUSE_WHEEL)
+            {
+                // OnScroll() is called regardless of whether interactables are hovered.
+                for (unsigned int i = 0, counti = interactables.size(); i < counti; i++)
+                {
+                    candidates.push_back(i);
+                }
+            }
+            else
+            {
+                // Only the interactables in the cell under the pointer, already hovered or pressed, or without bounds can change state.
+                if (gridColumns > 0)
+                {
+                    Point mpos = GetViewportPoint(GetService<Renderer>(), data);
+                    float x = floor((mpos.x - gridOrigin.x) / cellSize);
+                    float y = floor((mpos.y - gridOrigin.y) / cellSize);
+                    if (x >= 0 && y >= 0 && x < gridColumns && y < gridRows)
+                    {
+                        int index = (int)y * gridColumns + (int)x;
+                        candidates.assign(cellItems.begin() + cellStart[index], cellItems.begin() + cellStart[index + 1]);
+                    }
+                }
+                AddCandidates(engaged);
+                AddCandidates(unbounded);
+            }
+
+            // Take pointers first, as the interactables may be added or removed by the event handlers.
+            dispatch.clear();
+            for (unsigned int i : candidates)
+            {
+                dispatch.push_back(interactables[i]);
+            }
+            for (InteractableGUI* interactable : dispatch)
             {
-                auto interactable = interactables[i];
                 interactable->OnPointerEvent(data);
             }
+
+            if (!indexDirty)
+            {
+                engaged.clear();
+                for (unsigned int i : candidates)
+                {
+                    if (interactables[i]->IsHovered() || interactables[i]->IsPressed())
+                    {
+                        engaged.push_back(i);
+                    }
+                }
+            }
         }
         /// Ignored as this is a bindless action.
         return Ignore;
@@ -303,6 +503,7 @@ namespace Ossium
                     /// to indicate which element is selected.
                     interactables[currentIndex]->hovered = true;
                     interactables[currentIndex]->OnHoverBegin();
+                    Engage(currentIndex);
                 }
                 return ClaimContext;
             }
@@ -324,6 +525,7 @@ namespace Ossium
                 }
                 interactables[currentIndex]->OnHoverBegin();
                 interactables[currentIndex]->hovered = true;
+                Engage(currentIndex);
                 return ClaimContext;
             }
         }
@@ -343,6 +545,7 @@ namespace Ossium
                 }
                 interactables[currentIndex]->OnHoverBegin();
                 interactables[currentIndex]->hovered = true;
+                Engage(currentIndex);
                 return ClaimContext;
             }
         }
@@ -44,6 +44,14 @@ namespace Ossium
         /// Whether a pointer is currently hovering over this GUI element.
         bool IsHovered();
 
+        /// Returns a rect enclosing every point for which ContainsPointer() returns true. InputGUI uses this to find the elements under the pointer,
+        /// so override it along with ContainsPointer(). An empty rect means the bounds are unknown, so every pointer event is sent to this element.
+        virtual Rect GetBounds();
+
+        /// Tells the InputGUI that the bounds of this element have changed. InputGUI doesn't poll the bounds, and only picks up
+        /// layout refreshes by itself, so call this after moving or resizing the element any other way.
+        void SetBoundsDirty();
+
     protected:
         DECLARE_ABSTRACT_COMPONENT(Component, InteractableGUI);
 
@@ -57,7 +65,7 @@ namespace Ossium
         virtual void OnPointerDown();
         /// Called once when this GUI element stops being pressed, even if not hovered.
         virtual void OnPointerUp();
-        /// Called whenever the pointer moves.
+        /// Called whenever the pointer moves over this GUI element, or anywhere while it is hovered or pressed.
         virtual void OnPointerMove();
         /// Called when the mouse is scrolled, regardless of whether this element is currently hovered.
         virtual void OnScroll();
@@ -109,6 +117,9 @@ namespace Ossium
         /// Removes all interactables.
         void Clear();
 
+        /// Marks the bounds of the interactables as changed, so they are looked up again on the next pointer event.
+        void SetBoundsDirty();
+
         /// Called when the GoBack() action is called (useful for things like the Android back button).
         Callback<InputGUI&> OnBack;
 
@@ -119,6 +130,12 @@ namespace Ossium
 
         /// Mouse input data distributor (non-bound).
         ActionOutcome HandlePointer(const MouseInput& data);
+        /// Rebuilds the grid of interactable bounds.
+        void RebuildIndex();
+        /// Merges ascending interactable indices into the candidates.
+        void AddCandidates(const std::vector<unsigned int>& indices);
+        /// Adds an interactable to the engaged list, e.g. when it is hovered through keyboard navigation.
+        void Engage(unsigned int index);
         /// Keyboard navigation methods
         ActionOutcome ConfirmSelection(const KeyboardInput& data);
         ActionOutcome SelectRight(const KeyboardInput& data);
@@ -138,6 +155,35 @@ namespace Ossium
         /// TODO: Use a set instead? Can use separate vector for order.
         std::vector<InteractableGUI*> interactables;
 
+        /// Uniform grid over the interactable bounds. The interactables overlapping a cell are listed as ascending indices
+        /// from cellItems[cellStart[cell]] up to cellItems[cellStart[cell + 1]].
+        std::vector<unsigned int> cellStart;
+        std::vector<unsigned int> cellItems;
+        Vector2 gridOrigin;
+        float cellSize = 0;
+        int gridColumns = 0;
+        int gridRows = 0;
+
+        /// Whether the grid needs rebuilding.
+        bool indexDirty = true;
+
+        /// Handle for the layout refresh callback, which marks the grid dirty.
+        int layoutRefreshHandle = -1;
+
+        /// The bounds of each interactable when the grid was built.
+        std::vector<Rect> bounds;
+
+        /// Ascending indices of interactables with unknown bounds. These receive every pointer event.
+        std::vector<unsigned int> unbounded;
+
+        /// Ascending indices of interactables that are hovered or pressed. These receive pointer events wherever the pointer is.
+        std::vector<unsigned int> engaged;
+
+        /// Scratch lists of interactables to send the current pointer event to.
+        std::vector<unsigned int> candidates;
+        std::vector<unsigned int> merged;
+        std::vector<InteractableGUI*> dispatch;
+
     };
 
 }
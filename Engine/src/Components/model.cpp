@@ -1,12 +1,75 @@
+#include <algorithm>
+
 #include "model.h"
+#include "../Core/mesh.h"
+#include "../Core/resourcecontroller.h"
 
 namespace Ossium
 {
+
+    REGISTER_COMPONENT(Model);
     
     void Model::Render(RenderInput* pass, const Matrix<4, 4>& view, const Matrix<4, 4>& proj)
     {
         // TODO
     }
 
-}
+    bool Model::GetRenderBounds(Vector3& centre, float& radius)
+    {
+        ResourceController* resources = GetService<ResourceController>();
+        if (resources == nullptr || meshes.empty())
+        {
+            return false;
+        }
+
+        // Scaling by the model matrix stretches a sphere by at most the length of the longest axis
+        Matrix<4, 4> world = GetTransform()->GetMatrix();
+        float scale = 0;
+        for (unsigned int i = 0; i < 3; i++)
+        {
+            scale = std::max(scale, Vector3(world(i, 0), world(i, 1), world(i, 2)).Length());
+        }
 
+        Vector3 meshCentre;
+        float meshRadius;
+        for (unsigned int i = 0, counti = meshes.size(); i < counti; i++)
+        {
+            Mesh* mesh = resources->Find<Mesh>(meshes[i]);
+            if (mesh == nullptr || !mesh->GetRenderBounds(meshCentre, meshRadius))
+            {
+                return false;
+            }
+            Vector3 worldCentre = Vector3(
+                world(0, 0) * meshCentre.x + world(1, 0) * meshCentre.y + world(2, 0) * meshCentre.z + world(3, 0),
+                world(0, 1) * meshCentre.x + world(1, 1) * meshCentre.y + world(2, 1) * meshCentre.z + world(3, 1),
+                world(0, 2) * meshCentre.x + world(1, 2) * meshCentre.y + world(2, 2) * meshCentre.z + world(3, 2)
+            );
+            float worldRadius = meshRadius * scale;
+            if (i == 0)
+            {
+                centre = worldCentre;
+                radius = worldRadius;
+                continue;
+            }
+
+            // Grow the sphere just enough to enclose the sphere of this mesh
+            Vector3 offset = worldCentre - centre;
+            float distance = offset.Length();
+            if (distance + worldRadius <= radius)
+            {
+                continue;
+            }
+            if (distance + radius <= worldRadius)
+            {
+                centre = worldCentre;
+                radius = worldRadius;
+                continue;
+            }
+            float grown = (distance + radius + worldRadius) / 2.0f;
+            centre = centre + offset * ((grown - radius) / distance);
+            radius = grown;
+        }
+        return true;
+    }
+
+}
@@ -24,6 +24,10 @@ namespace Ossium
         
         // Render the model
         void Render(RenderInput* pass, const Matrix<4, 4>& view, const Matrix<4, 4>& proj);
+
+        // Outputs a world space sphere enclosing the spheres of all the meshes.
+        // Returns false if any of the meshes isn't loaded, as the bounds are unknown.
+        bool GetRenderBounds(Vector3& centre, float& radius);
         
     };
     
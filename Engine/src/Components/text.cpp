@@ -70,11 +70,8 @@ namespace Ossium
             ) * 2.0f);
         }
 
-        // Only bother updating layout if bounds actually change.
-        if (layout.GetBounds() != bounds)
-        {
-            layout.SetBounds(bounds);
-        }
+        /// TODO: figure out why we have to update every frame! Maybe the font atlas glyph cache breaks?
+        UpdateLayout(true);
 
         if (boxed)
         {
@@ -89,12 +86,49 @@ namespace Ossium
 
         if (font != nullptr)
         {
-            /// TODO: figure out why we have to update every frame! Maybe the font atlas glyph cache breaks?
-            layout.SetText(*font, text, applyMarkup);
+            layout.Render(pass, *font, GetTransform()->GetWorldPosition());
+        }
+    }
+
+    void Text::UpdateLayout(bool force)
+    {
+        // Only bother updating layout if bounds actually change.
+        if (layout.GetBounds() != bounds)
+        {
+            layout.SetBounds(bounds);
+        }
+
+        if (font != nullptr)
+        {
+            if (force || font != laidOutFont || applyMarkup != laidOutMarkup || text != laidOutText)
+            {
+                layout.SetText(*font, text, applyMarkup);
+                laidOutFont = font;
+                laidOutMarkup = applyMarkup;
+                laidOutText = text;
+            }
             layout.Update(*font);
+        }
+    }
 
-            layout.Render(pass, *font, GetTransform()->GetWorldPosition());
+    bool Text::GetDrawBounds(Rect& area)
+    {
+        if (entity->GetComponent<BoxLayout>() != nullptr)
+        {
+            // The bounds are only updated from the layout when drawn.
+            return false;
         }
+        // The text may have changed since it was last drawn, e.g. while it was culled
+        UpdateLayout(false);
+        Vector2 position = GetTransform()->GetWorldPosition();
+        Vector2 size = layout.GetSize();
+        area = Rect(
+            position.x - boxPaddingWidth,
+            position.y - boxPaddingHeight,
+            std::max(size.x, bounds.x) + (boxPaddingWidth * 2.0f),
+            std::max(size.y, bounds.y) + (boxPaddingHeight * 2.0f)
+        );
+        return true;
     }
 
 }
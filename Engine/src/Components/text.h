@@ -75,12 +75,23 @@ namespace Ossium
         /// Graphic override
         void Draw(RenderInput* pass);
 
+        /// Returns the area covered by the text and box, unless the bounds are set by a layout.
+        bool GetDrawBounds(Rect& area);
+
         bool dirty = true;
 
     private:
+        /// Lays out the text again if it has changed since it was last laid out, or always if forced.
+        void UpdateLayout(bool force);
+
         /// Pointer to font
         Font* font = nullptr;
 
+        /// The font, markup setting and text that were last laid out.
+        Font* laidOutFont = nullptr;
+        bool laidOutMarkup = true;
+        std::string laidOutText;
+
     };
 
 }
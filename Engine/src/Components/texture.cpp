@@ -423,4 +423,22 @@ namespace Ossium
         return GetRect(GetTransform()->GetWorldPosition()).Contains(p);
     }
 
+    Rect Texture::GetBounds()
+    {
+        return GetRect(GetTransform()->GetWorldPosition());
+    }
+
+    bool Texture::GetDrawBounds(Rect& bounds)
+    {
+        BoxLayout* boxLayout = entity->GetComponent<BoxLayout>();
+        if (boxLayout != nullptr && boxLayout->IsEnabled())
+        {
+            // The width and height are only updated from the layout when drawn.
+            return false;
+        }
+        Transform* trans = GetTransform();
+        bounds = Rect(GetSDL(trans->GetWorldPosition(), trans->GetLocalScale()));
+        return true;
+    }
+
 }
@@ -102,6 +102,9 @@ namespace Ossium
         /// Inherited Graphic::Render() method
         void Draw(RenderInput* pass);
 
+        /// Returns the area the texture is drawn within, unless the dimensions are set by a layout when drawn.
+        bool GetDrawBounds(Rect& bounds);
+
         /// Sets the source image this texture should use. If configureDimensions is true, the width and height are set
         /// to the source image width and height
         void SetSource(Image* src, bool configureDimensions = true);
@@ -136,6 +139,7 @@ namespace Ossium
 
         /// Implementation of IContainsPoint.
         bool Contains(Vector2 p);
+        Rect GetBounds();
 
     protected:
         /// The source image that this texture renders a copy of
@@ -14,6 +14,8 @@
  *  3. This notice may not be removed or altered from any source distribution.
  *
 **/
+#include <cstring>
+
 #include "audio.h"
 #include "logging.h"
 
@@ -33,7 +35,6 @@ namespace Ossium
 
         AudioClip::AudioClip()
         {
-            audioChunk = NULL;
         }
 
         AudioClip::~AudioClip()
@@ -44,29 +45,58 @@ namespace Ossium
         void AudioClip::Free()
         {
             path = "";
-            if (audioChunk != NULL)
+            if (!samples.empty())
             {
-                Mix_FreeChunk(audioChunk);
-                audioChunk = NULL;
+                Internals::AudioEngine::Instance.StopAllUsing(samples.data());
+                samples.clear();
+                samples.shrink_to_fit();
             }
         }
 
         bool AudioClip::Load(string guid_path)
         {
             Free();
-            audioChunk = Mix_LoadWAV(guid_path.c_str());
-            if (audioChunk == NULL)
+            /// SDL_mixer decodes the file and converts it to the device format
+            Mix_Chunk* chunk = Mix_LoadWAV(guid_path.c_str());
+            if (chunk == NULL)
             {
                 Log.Error("Failed to load audio clip '{0}'! Mix_Error: {1}", guid_path, Mix_GetError());
                 return false;
             }
+
+            /// Convert to stereo floats for the mixing engine
+            int frequency = 0;
+            Uint16 format = 0;
+            int channels = 0;
+            SDL_AudioCVT cvt;
+            Mix_QuerySpec(&frequency, &format, &channels);
+            if (SDL_BuildAudioCVT(&cvt, format, (Uint8)channels, frequency, AUDIO_F32SYS, 2, frequency) < 0)
+            {
+                Log.Error("Failed to convert audio clip '{0}'! SDL_Error: {1}", guid_path, SDL_GetError());
+                Mix_FreeChunk(chunk);
+                return false;
+            }
+            cvt.len = (int)chunk->alen;
+            vector<Uint8> converted(cvt.len * cvt.len_mult);
+            memcpy(converted.data(), chunk->abuf, chunk->alen);
+            Mix_FreeChunk(chunk);
+            cvt.buf = converted.data();
+            if (cvt.needed && SDL_ConvertAudio(&cvt) < 0)
+            {
+                Log.Error("Failed to convert audio clip '{0}'! SDL_Error: {1}", guid_path, SDL_GetError());
+                return false;
+            }
+            int length = cvt.needed ? cvt.len_cvt : cvt.len;
+            samples.resize(length / sizeof(float));
+            memcpy(samples.data(), converted.data(), samples.size() * sizeof(float));
+
             path = guid_path;
             return true;
         }
 
         bool AudioClip::Init()
         {
-            return audioChunk != NULL;
+            return !samples.empty();
         }
 
         bool AudioClip::LoadAndInit(string guid_path)
@@ -74,113 +104,19 @@ namespace Ossium
             return Load(guid_path) && Init();
         }
 
-        Mix_Chunk* AudioClip::GetChunk()
+        const float* AudioClip::GetSamples()
         {
-            return audioChunk;
+            return samples.empty() ? nullptr : samples.data();
         }
 
-        string AudioClip::GetPath()
+        Uint32 AudioClip::GetFrames()
         {
-            return path;
+            return (Uint32)(samples.size() / 2);
         }
 
-        ///
-        /// ChannelController
-        ///
-
-        namespace Internals
+        string AudioClip::GetPath()
         {
-
-            void OnAnyChannelFinished(int id)
-            {
-                ChannelController::Instance.ChannelFinished(id);
-            }
-
-            ChannelController::ChannelController()
-            {
-                numChannels = 0;
-                counter = 0;
-            }
-
-            ChannelController::~ChannelController()
-            {
-                /// Don't call Clear() as that calls an SDL_Mixer function, and SDL_Mixer is probably all cleaned up already
-                /// as this is a singleton
-                channels.clear();
-                numChannels = 0;
-                counter = 0;
-            }
-
-            void ChannelController::Clear()
-            {
-                channels.clear();
-                Mix_AllocateChannels(0);
-                numChannels = 0;
-                counter = 0;
-            }
-
-            void ChannelController::Init(int num_channels)
-            {
-                Clear();
-                Mix_AllocateChannels(num_channels);
-                for (int i = 0; i < num_channels; i++)
-                {
-                    /// Initialise all channels
-                    channels.push_back(nullptr);
-                }
-                numChannels = num_channels;
-                Mix_ChannelFinished(*OnAnyChannelFinished);
-            }
-
-            int ChannelController::ReserveChannel(AudioPlayer* callback)
-            {
-                if (callback != nullptr)
-                {
-                    int originalIndex = counter;
-                    do
-                    {
-                        counter = Wrap(counter, 1, 0, numChannels - 1);
-                        if (channels[counter] == nullptr)
-                        {
-                            channels[counter] = callback;
-                            return counter;
-                        }
-                    } while (counter != originalIndex);
-                    return -1;
-                }
-                return -1;
-            }
-
-            void ChannelController::FreeChannel(int id)
-            {
-                if (id < 0)
-                {
-                    Init(numChannels);
-                }
-                else if (id >= numChannels)
-                {
-                    Log.Error("ChannelController: Channel id is out of range.");
-                    return;
-                }
-                else
-                {
-                    /// Frees the channel, but does not halt any playback on the channel
-                    channels[id] = nullptr;
-                }
-            }
-
-            void ChannelController::ChannelFinished(int id)
-            {
-                if (id < numChannels && !channels.empty())
-                {
-                    if (channels[id] != nullptr)
-                    {
-                        /// Call the associated callback
-                        (channels[id])->OnPlayFinished();
-                    }
-                }
-            }
-
+            return path;
         }
 
         ///
@@ -193,6 +129,25 @@ namespace Ossium
             bypass = false;
             muted = false;
             input_stream = nullptr;
+            engineBus = Internals::AudioEngine::Instance.CreateBus();
+        }
+
+        AudioBus::~AudioBus()
+        {
+            Unlink();
+            while (!input_buses.empty())
+            {
+                (*input_buses.begin())->Unlink();
+            }
+            while (!input_signals.empty())
+            {
+                (*input_signals.begin())->Unlink();
+            }
+            if (input_stream != nullptr)
+            {
+                input_stream->Unlink();
+            }
+            Internals::AudioEngine::Instance.DestroyBus(engineBus);
         }
 
         void AudioBus::SetName(string setName)
@@ -211,6 +166,7 @@ namespace Ossium
             bus->input_buses.insert(this);
             linkedBus = bus;
             linkedName = linkedBus->GetName();
+            Internals::AudioEngine::Instance.SetBusOutput(engineBus, bus->engineBus);
         }
 
         void AudioBus::Unlink()
@@ -220,6 +176,7 @@ namespace Ossium
                 linkedBus->input_buses.erase(this);
                 linkedBus = nullptr;
                 linkedName = "";
+                Internals::AudioEngine::Instance.SetBusOutput(engineBus, -1);
             }
         }
 
@@ -308,14 +265,34 @@ namespace Ossium
             }
         }
 
+        void AudioBus::SetInsert(unsigned int index, const AudioInsert& insert)
+        {
+            Internals::AudioEngine::Instance.SetBusInsert(engineBus, index, insert);
+        }
+
+        void AudioBus::ClearInsert(unsigned int index)
+        {
+            Internals::AudioEngine::Instance.SetBusInsert(engineBus, index, AudioInsert());
+        }
+
+        AudioInsert AudioBus::GetInsert(unsigned int index)
+        {
+            return Internals::AudioEngine::Instance.GetBusInsert(engineBus, index);
+        }
+
         void AudioBus::OnVolumeChanged()
         {
-            /// Iterate over all input buses and signals and change their volumes accordingly
-            for (auto i = input_buses.begin(); i != input_buses.end(); i++)
+            /// The mixing engine applies this bus to everything routed through it
+            float left = 1.0f;
+            float right = 1.0f;
+            if (!bypass)
             {
-                (*i)->OnVolumeChanged();
+                Internals::MixKernels::PanGains(muted ? 0.0f : GetVolume(), GetPanning(), left, right);
             }
-            for (auto i = input_signals.begin(); i != input_signals.end(); i++)
+            Internals::AudioEngine::Instance.SetBusGain(engineBus, left, right);
+
+            /// Input signals are mixed through this bus, but the music stream is not so it must be updated directly
+            for (auto i = input_buses.begin(); i != input_buses.end(); i++)
             {
                 (*i)->OnVolumeChanged();
             }
@@ -329,21 +306,14 @@ namespace Ossium
         /// AudioPlayer
         ///
 
-        int AudioPlayer::total_channels = 0;
-
-        Internals::ChannelController& AudioPlayer::_channelController = Internals::ChannelController::Instance;
-
         AudioPlayer::~AudioPlayer()
         {
-            if (channel_id >= 0)
+            if (voice >= 0)
             {
-                _channelController.FreeChannel(channel_id);
-                /// Halt the channel now we've freed it because something is probably playing
-                Mix_HaltChannel(channel_id);
-                Mix_SetPosition(channel_id, 0, 0);
-                Mix_Volume(channel_id, 128);
-                channel_id = -1;
+                Internals::AudioEngine::Instance.StopVoice(voice);
+                voice = -1;
             }
+            Unlink();
         }
 
         void AudioPlayer::Link(AudioBus* bus)
@@ -351,6 +321,7 @@ namespace Ossium
             Unlink();
             bus->input_signals.insert(this);
             linkedBus = bus;
+            Internals::AudioEngine::Instance.SetVoiceBus(voice, bus->engineBus);
         }
 
         void AudioPlayer::Unlink()
@@ -359,17 +330,18 @@ namespace Ossium
             {
                 linkedBus->input_signals.erase(this);
                 linkedBus = nullptr;
+                Internals::AudioEngine::Instance.SetVoiceBus(voice, -1);
             }
         }
 
         void AudioPlayer::Play(AudioClip* sample, Sint16 panning, float vol, int repeats)
         {
-            if (channel_id >= 0)
+            if (voice >= 0)
             {
-                /// Something is playing. Stop it and use that channel
-                Mix_HaltChannel(channel_id);
+                /// Something is playing. Fade it out and play on a new voice
+                Internals::AudioEngine::Instance.StopVoice(voice);
+                voice = -1;
             }
-            channel_id = _channelController.ReserveChannel(this);
             if (vol < 0.0f)
             {
                 SetStereoVolume(GetVolume(), panning);
@@ -378,10 +350,14 @@ namespace Ossium
             {
                 SetStereoVolume(vol, panning);
             }
-            Mix_PlayChannel(channel_id, sample->GetChunk(), repeats);
-            if (Mix_Paused(channel_id))
+            float left, right;
+            GetVoiceGains(left, right);
+            voice = Internals::AudioEngine::Instance.PlayVoice(
+                this, sample->GetSamples(), sample->GetFrames(), IsLinked() ? linkedBus->engineBus : -1, left, right, repeats
+            );
+            if (voice < 0 && sample->GetSamples() != nullptr)
             {
-                Mix_Resume(channel_id);
+                Log.Warning("Failed to play audio clip '{0}', no free voices available.", sample->GetPath());
             }
             paused = false;
         }
@@ -391,16 +367,61 @@ namespace Ossium
             Play(sample, GetPanning(), vol, repeats);
         }
 
+        void AudioPlayer::PlayStream(string path, float vol, int repeats)
+        {
+            if (voice >= 0)
+            {
+                Internals::AudioEngine::Instance.StopVoice(voice);
+                voice = -1;
+            }
+            SetStereoVolume(vol < 0.0f ? GetVolume() : vol, GetPanning());
+            float left, right;
+            GetVoiceGains(left, right);
+            voice = Internals::AudioEngine::Instance.StreamVoice(this, path, IsLinked() ? linkedBus->engineBus : -1, left, right, repeats);
+            if (voice < 0)
+            {
+                Log.Warning("Failed to stream audio file '{0}'.", path);
+            }
+            paused = false;
+        }
+
         bool AudioPlayer::IsPlaying()
         {
-            return channel_id >= 0;
+            return voice >= 0;
+        }
+
+        bool AudioPlayer::IsVirtual()
+        {
+            return Internals::AudioEngine::Instance.IsVoiceVirtual(voice);
+        }
+
+        void AudioPlayer::SetVirtual(bool virtualise)
+        {
+            if (IsPlaying())
+            {
+                if (!virtualise)
+                {
+                    float left, right;
+                    GetVoiceGains(left, right);
+                    Internals::AudioEngine::Instance.SetVoiceGain(voice, left, right);
+                }
+                Internals::AudioEngine::Instance.SetVoiceVirtual(voice, virtualise);
+            }
+        }
+
+        void AudioPlayer::SetMixPriority(float priority)
+        {
+            if (IsPlaying())
+            {
+                Internals::AudioEngine::Instance.SetVoicePriority(voice, priority);
+            }
         }
 
         void AudioPlayer::Pause()
         {
             if (IsPlaying())
             {
-                Mix_Pause(channel_id);
+                Internals::AudioEngine::Instance.SetVoicePaused(voice, true);
                 paused = true;
             }
         }
@@ -409,7 +430,7 @@ namespace Ossium
         {
             if (IsPaused() && IsPlaying())
             {
-                Mix_Resume(channel_id);
+                Internals::AudioEngine::Instance.SetVoicePaused(voice, false);
                 paused = false;
             }
         }
@@ -418,7 +439,8 @@ namespace Ossium
         {
             if (IsPlaying())
             {
-                Mix_HaltChannel(channel_id);
+                Internals::AudioEngine::Instance.StopVoice(voice);
+                OnPlayFinished();
             }
             paused = false;
         }
@@ -451,25 +473,26 @@ namespace Ossium
             return this->GetPanning();
         }
 
+        void AudioPlayer::GetVoiceGains(float& left, float& right)
+        {
+            /// Linked bus volume and panning are applied by the mixing engine
+            Internals::MixKernels::PanGains(GetVolume() * ((float)(255 - spatialAttenuation) / 255.0f), GetPanning(), left, right);
+        }
+
         void AudioPlayer::OnVolumeChanged()
         {
-            if (channel_id >= 0)
+            if (voice >= 0 && !IsVirtual())
             {
-                /// This is okay because it's not set as an SDL_Mixer callback
-                Mix_Volume(channel_id, (int)MapRange(GetFinalVolume(), 0.0f, 1.0f, 0.0f, 128.0f));
-                Mix_SetPosition(channel_id, Wrap(0, GetFinalPanning(), 0, 360), spatialAttenuation);
+                float left, right;
+                GetVoiceGains(left, right);
+                Internals::AudioEngine::Instance.SetVoiceGain(voice, left, right);
             }
         }
 
         void AudioPlayer::OnPlayFinished()
         {
-            /// AudioPlayer is responsible for freeing the channel as it reserved it in the first place
-            _channelController.FreeChannel(channel_id);
-            /// Unregister panning effect
-            Mix_SetPosition(channel_id, 0, 0);
-            /// Reset volume to default
-            Mix_Volume(channel_id, 128);
-            channel_id = -1;
+            voice = -1;
+            paused = false;
         }
 
         ///
@@ -26,6 +26,7 @@ extern "C"
 #include <vector>
 
 #include "funcutils.h"
+#include "audioengine.h"
 #include "delta.h"
 #include "resourcecontroller.h"
 #include "schemamodel.h"
@@ -164,43 +165,6 @@ namespace Ossium
         namespace Internals
         {
 
-            void OnAnyChannelFinished(int id);
-
-            /// Controls the channels allocated by SDL_Mixer
-            class OSSIUM_EDL ChannelController : public Singleton<ChannelController>
-            {
-            public:
-                /// Allocates the specified number of audio channels for use with SDL_Mixer
-                ChannelController();
-                /// Cleans up all channels
-                ~ChannelController();
-
-                /// Allocates the specified number of SDL_Mixer channels
-                void Init(int num_channels = 50);
-
-                /// Deallocates all channels
-                void Clear();
-
-                /// Returns the first available channel and prevents it being reserved again. Returns -1 if it fails to find a free channel or the callback argument is null
-                int ReserveChannel(AudioPlayer* src);
-                /// Frees the specified channel; pass in a value < 0 to free all channels. Does not halt the freed channel(s), use HaltChannel() for that
-                void FreeChannel(int id);
-
-                /// Calls the callback associated with the id
-                void ChannelFinished(int id);
-
-            private:
-                /// All reserved channels have a callback object which is called when the channel finishes playback; if unreserved, callback is null
-                std::vector<AudioPlayer*> channels;
-
-                /// Total channels allocated
-                int numChannels = 0;
-
-                /// Used for stepping through the array of channels
-                int counter = 0;
-
-            };
-
             /// Forward declaration
             class AudioStream;
 
@@ -238,7 +202,8 @@ namespace Ossium
 
             /// Initialise stuff
             AudioBus();
-            virtual ~AudioBus() = default;
+            /// Unlinks all inputs and outputs and frees the mixing engine bus
+            virtual ~AudioBus();
 
             /// Sets the name of this audio channel
             void SetName(std::string setName);
@@ -280,6 +245,15 @@ namespace Ossium
             void Mute();
             void Unmute();
 
+            /// Sets a DSP insert on this bus. Up to Internals::AudioEngine::MaxInserts inserts are processed in index order.
+            void SetInsert(unsigned int index, const AudioInsert& insert);
+
+            /// Removes a DSP insert from this bus.
+            void ClearInsert(unsigned int index);
+
+            /// Returns the settings of a DSP insert on this bus.
+            AudioInsert GetInsert(unsigned int index);
+
         private:
             /// When the volume changes, iterate over all the input signals and call their OnVolumeChanged() methods
             void OnVolumeChanged();
@@ -295,9 +269,12 @@ namespace Ossium
             /// The audio stream coming into this bus; usually null unless the AudioStream has been linked
             Internals::AudioStream* input_stream;
 
+            /// The corresponding bus in the mixing engine
+            int engineBus = -1;
+
         };
 
-        /// Wrapper class for Mix_Chunk, representing an audio sample resource
+        /// Audio sample resource. Decoded samples are kept in memory as interleaved stereo floats at the device sample rate, ready for mixing.
         class OSSIUM_EDL AudioClip : public Resource
         {
         public:
@@ -313,8 +290,11 @@ namespace Ossium
 
             bool LoadAndInit(std::string guid_path);
 
-            /// Returns the audio chunk
-            Mix_Chunk* GetChunk();
+            /// Returns the decoded interleaved stereo samples, or nullptr if nothing is loaded
+            const float* GetSamples();
+
+            /// Returns the number of stereo frames
+            Uint32 GetFrames();
 
             /// Returns the file path to the original audio sample
             std::string GetPath();
@@ -322,8 +302,8 @@ namespace Ossium
         private:
             NOCOPY(AudioClip);
 
-            /// The actual audio file in memory
-            Mix_Chunk* audioChunk;
+            /// The decoded audio in memory
+            std::vector<float> samples;
 
             /// File path to the sample
             std::string path;
@@ -337,7 +317,7 @@ namespace Ossium
             DECLARE_BASE_SCHEMA(AudioPlayerSchema, 1);
 
         protected:
-            /// How much the volume should be attenuated with Mix_SetPosition().
+            /// How much the volume should be attenuated by distance, from 0 (none) to 255 (silent).
             M(Uint8, spatialAttenuation) = 0;
 
         };
@@ -350,7 +330,7 @@ namespace Ossium
             CONSTRUCT_SCHEMA(AudioChannel<AudioPlayer>, AudioPlayerSchema);
 
             friend class AudioBus;
-            friend class Internals::ChannelController;
+            friend class Internals::AudioEngine;
 
             AudioPlayer() = default;
             virtual ~AudioPlayer();
@@ -368,6 +348,10 @@ namespace Ossium
             /// Simplified overload
             void Play(AudioClip* sample, float vol = -1.0f, int repeats = 0);
 
+            /// Streams an audio file (WAV, OGG or FLAC) from disk rather than loading it all into memory first, which suits music and long ambience.
+            /// The file is decoded on a background thread, so any number of streams can play at once. Streams cannot be pitch shifted.
+            void PlayStream(std::string path, float vol = -1.0f, int repeats = 0);
+
             /// Pauses this audio source if it is currently playing
             void Pause();
 
@@ -380,9 +364,12 @@ namespace Ossium
             /// Stops playing, if anything is playing.
             void Stop();
 
-            /// Whether or not this audio source is currently playing anything
+            /// Whether or not this audio source is currently playing anything, including when virtualised
             bool IsPlaying();
 
+            /// Whether or not this audio source is playing on a virtual voice, i.e. it's playing but not being mixed
+            bool IsVirtual();
+
             /// Whether or not this audio source is linked to an output bus
             bool IsLinked();
 
@@ -404,15 +391,18 @@ namespace Ossium
             /// Whether or not the audio source is currently paused
             bool paused = false;
 
-        private:
-            /// The SDL_Mixer channel currently reserved for this audio source. If < 0, the audio source is not playing anything
-            int channel_id = -1;
+            /// Calculates the stereo gains of the voice from the volume, panning and spatial attenuation of this audio source
+            void GetVoiceGains(float& left, float& right);
+
+            /// Virtualises the voice, or makes it real again. When made real, the voice gains are updated
+            void SetVirtual(bool virtualise);
 
-            /// The total number of available channels
-            static int total_channels;
+            /// Sets how important the voice is when more voices are playing than the engine mix budget allows
+            void SetMixPriority(float priority);
 
-            /// Convenient reference
-            static Internals::ChannelController& _channelController;
+        private:
+            /// The mixing engine voice currently playing for this audio source. If < 0, the audio source is not playing anything
+            int voice = -1;
 
         };
 
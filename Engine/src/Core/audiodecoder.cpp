@@ -0,0 +1,311 @@
+/** COPYRIGHT NOTICE
+ *
+ *  Ossium Engine
+ *  Copyright (c) 2018-2020 Tim Lane
+ *
+ *  This software is provided 'as-is', without any express or implied warranty. In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+ *
+ *  2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+ *
+ *  3. This notice may not be removed or altered from any source distribution.
+ *
+**/
+#include <algorithm>
+#include <cstring>
+
+#include "audiodecoder.h"
+#include "logging.h"
+
+/// OGG and FLAC streaming use the single file stb_vorbis and dr_flac libraries
+#include "stb_vorbis.c"
+#define DR_FLAC_IMPLEMENTATION
+#include "dr_flac.h"
+
+using namespace std;
+
+namespace Ossium
+{
+
+    inline namespace Audio
+    {
+
+        namespace Internals
+        {
+
+            ///
+            /// WavDecoder
+            ///
+
+            WavDecoder::~WavDecoder()
+            {
+                if (file != NULL)
+                {
+                    SDL_RWclose(file);
+                    file = NULL;
+                }
+            }
+
+            bool WavDecoder::Open(const string& path)
+            {
+                file = SDL_RWFromFile(path.c_str(), "rb");
+                if (file == NULL)
+                {
+                    Log.Error("Failed to open WAV file '{0}'! SDL_Error: {1}", path, SDL_GetError());
+                    return false;
+                }
+
+                char id[4];
+                if (SDL_RWread(file, id, 1, 4) != 4 || memcmp(id, "RIFF", 4) != 0)
+                {
+                    Log.Error("Failed to decode WAV file '{0}', not a RIFF file.", path);
+                    return false;
+                }
+                SDL_ReadLE32(file);
+                if (SDL_RWread(file, id, 1, 4) != 4 || memcmp(id, "WAVE", 4) != 0)
+                {
+                    Log.Error("Failed to decode WAV file '{0}', not a WAVE file.", path);
+                    return false;
+                }
+
+                /// Find the format and sample data chunks
+                Uint16 formatTag = 0;
+                Uint16 bitsPerSample = 0;
+                bool foundFormat = false;
+                while (SDL_RWread(file, id, 1, 4) == 4)
+                {
+                    Uint32 size = SDL_ReadLE32(file);
+                    Sint64 next = SDL_RWtell(file) + size + (size & 1);
+                    if (memcmp(id, "fmt ", 4) == 0 && size >= 16)
+                    {
+                        formatTag = SDL_ReadLE16(file);
+                        channels = SDL_ReadLE16(file);
+                        sampleRate = (int)SDL_ReadLE32(file);
+                        SDL_ReadLE32(file);
+                        SDL_ReadLE16(file);
+                        bitsPerSample = SDL_ReadLE16(file);
+                        if (formatTag == 0xFFFE && size >= 26)
+                        {
+                            /// WAVE_FORMAT_EXTENSIBLE; the actual format is at the start of the sub-format GUID
+                            SDL_ReadLE16(file);
+                            SDL_ReadLE16(file);
+                            SDL_ReadLE32(file);
+                            formatTag = SDL_ReadLE16(file);
+                        }
+                        foundFormat = true;
+                    }
+                    else if (memcmp(id, "data", 4) == 0 && foundFormat)
+                    {
+                        dataStart = SDL_RWtell(file);
+                        dataSize = size;
+                        break;
+                    }
+                    SDL_RWseek(file, next, RW_SEEK_SET);
+                }
+
+                floatingPoint = formatTag == 3;
+                sampleBytes = bitsPerSample / 8;
+                bool supported = (formatTag == 1 && sampleBytes >= 1 && sampleBytes <= 4) || (floatingPoint && sampleBytes == 4);
+                if (dataStart == 0 || !supported || channels <= 0 || sampleRate <= 0)
+                {
+                    Log.Error("Failed to decode WAV file '{0}', unsupported format {1} ({2} bit).", path, formatTag, bitsPerSample);
+                    return false;
+                }
+                dataRead = 0;
+                return true;
+            }
+
+            Uint32 WavDecoder::Decode(float* output, Uint32 frames)
+            {
+                const Uint32 frameBytes = sampleBytes * channels;
+                const Uint32 maxFrames = sizeof(readBuffer) / frameBytes;
+                Uint32 decoded = 0;
+                while (decoded < frames && dataRead + frameBytes <= dataSize)
+                {
+                    Uint32 count = min(min(frames - decoded, maxFrames), (dataSize - dataRead) / frameBytes);
+                    count = (Uint32)SDL_RWread(file, readBuffer, frameBytes, count);
+                    if (count == 0)
+                    {
+                        /// Truncated file
+                        dataRead = dataSize;
+                        break;
+                    }
+                    dataRead += count * frameBytes;
+
+                    float* out = output + decoded * channels;
+                    const Uint8* in = readBuffer;
+                    for (Uint32 i = 0, counti = count * channels; i < counti; i++, in += sampleBytes)
+                    {
+                        switch (sampleBytes)
+                        {
+                        case 1:
+                            out[i] = ((float)in[0] - 128.0f) / 128.0f;
+                            break;
+                        case 2:
+                            out[i] = (float)(Sint16)(in[0] | (in[1] << 8)) / 32768.0f;
+                            break;
+                        case 3:
+                            out[i] = (float)((Sint32)((Uint32)in[0] << 8 | (Uint32)in[1] << 16 | (Uint32)in[2] << 24) >> 8) / 8388608.0f;
+                            break;
+                        default:
+                        {
+                            Uint32 value = (Uint32)in[0] | (Uint32)in[1] << 8 | (Uint32)in[2] << 16 | (Uint32)in[3] << 24;
+                            if (floatingPoint)
+                            {
+                                memcpy(&out[i], &value, sizeof(float));
+                            }
+                            else
+                            {
+                                out[i] = (float)(Sint32)value / 2147483648.0f;
+                            }
+                            break;
+                        }
+                        }
+                    }
+                    decoded += count;
+                }
+                return decoded;
+            }
+
+            bool WavDecoder::Rewind()
+            {
+                dataRead = 0;
+                return SDL_RWseek(file, dataStart, RW_SEEK_SET) >= 0;
+            }
+
+            /// Decodes Ogg Vorbis files
+            class VorbisDecoder : public AudioDecoder
+            {
+            public:
+                ~VorbisDecoder()
+                {
+                    if (vorbis != nullptr)
+                    {
+                        stb_vorbis_close(vorbis);
+                    }
+                }
+
+                bool Open(const string& path)
+                {
+                    int error = 0;
+                    vorbis = stb_vorbis_open_filename(path.c_str(), &error, NULL);
+                    if (vorbis == nullptr)
+                    {
+                        Log.Error("Failed to decode Ogg Vorbis file '{0}', error {1}.", path, error);
+                        return false;
+                    }
+                    stb_vorbis_info info = stb_vorbis_get_info(vorbis);
+                    sampleRate = (int)info.sample_rate;
+                    channels = info.channels;
+                    return true;
+                }
+
+                Uint32 Decode(float* output, Uint32 frames)
+                {
+                    return (Uint32)stb_vorbis_get_samples_float_interleaved(vorbis, channels, output, (int)(frames * channels));
+                }
+
+                bool Rewind()
+                {
+                    return stb_vorbis_seek_start(vorbis) != 0;
+                }
+
+            private:
+                stb_vorbis* vorbis = nullptr;
+
+            };
+
+            /// Decodes FLAC files
+            class FlacDecoder : public AudioDecoder
+            {
+            public:
+                ~FlacDecoder()
+                {
+                    if (flac != nullptr)
+                    {
+                        drflac_close(flac);
+                    }
+                }
+
+                bool Open(const string& path)
+                {
+                    flac = drflac_open_file(path.c_str(), NULL);
+                    if (flac == nullptr)
+                    {
+                        Log.Error("Failed to decode FLAC file '{0}'.", path);
+                        return false;
+                    }
+                    sampleRate = (int)flac->sampleRate;
+                    channels = flac->channels;
+                    return true;
+                }
+
+                Uint32 Decode(float* output, Uint32 frames)
+                {
+                    return (Uint32)drflac_read_pcm_frames_f32(flac, frames, output);
+                }
+
+                bool Rewind()
+                {
+                    return drflac_seek_to_pcm_frame(flac, 0) != 0;
+                }
+
+            private:
+                drflac* flac = nullptr;
+
+            };
+
+            ///
+            /// AudioDecoder
+            ///
+
+            int AudioDecoder::GetSampleRate()
+            {
+                return sampleRate;
+            }
+
+            int AudioDecoder::GetChannels()
+            {
+                return channels;
+            }
+
+            AudioDecoder* AudioDecoder::Create(const string& path)
+            {
+                string extension = path.find_last_of('.') != string::npos ? path.substr(path.find_last_of('.') + 1) : "";
+                transform(extension.begin(), extension.end(), extension.begin(), [] (unsigned char c) { return tolower(c); });
+
+                AudioDecoder* decoder = nullptr;
+                if (extension == "wav")
+                {
+                    decoder = new WavDecoder();
+                }
+                else if (extension == "ogg")
+                {
+                    decoder = new VorbisDecoder();
+                }
+                else if (extension == "flac")
+                {
+                    decoder = new FlacDecoder();
+                }
+                else
+                {
+                    Log.Error("Cannot stream '{0}', unsupported audio file type.", path);
+                    return nullptr;
+                }
+
+                if (!decoder->Open(path))
+                {
+                    delete decoder;
+                    return nullptr;
+                }
+                return decoder;
+            }
+
+        }
+
+    }
+
+}
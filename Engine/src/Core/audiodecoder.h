@@ -0,0 +1,104 @@
+/** COPYRIGHT NOTICE
+ *
+ *  Ossium Engine
+ *  Copyright (c) 2018-2020 Tim Lane
+ *
+ *  This software is provided 'as-is', without any express or implied warranty. In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+ *
+ *  2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+ *
+ *  3. This notice may not be removed or altered from any source distribution.
+ *
+**/
+#ifndef AUDIODECODER_H
+#define AUDIODECODER_H
+extern "C"
+{
+    #include <SDL.h>
+}
+
+#include <string>
+
+#include "helpermacros.h"
+
+namespace Ossium
+{
+
+    inline namespace Audio
+    {
+
+        namespace Internals
+        {
+
+            /// Incrementally decodes an audio file into interleaved float samples.
+            class OSSIUM_EDL AudioDecoder
+            {
+            public:
+                virtual ~AudioDecoder() = default;
+
+                /// Opens a file for decoding. Returns false on error.
+                virtual bool Open(const std::string& path) = 0;
+
+                /// Decodes up to the specified number of frames into output, which must have room for frames * GetChannels() samples.
+                /// Returns the number of frames decoded, which is 0 once the end of the file is reached.
+                virtual Uint32 Decode(float* output, Uint32 frames) = 0;
+
+                /// Seeks back to the start of the audio. Returns false on error.
+                virtual bool Rewind() = 0;
+
+                /// Returns the sample rate of the decoded audio.
+                int GetSampleRate();
+
+                /// Returns the number of interleaved channels in the decoded audio.
+                int GetChannels();
+
+                /// Creates a decoder for the file type (WAV, OGG or FLAC, by file extension) and opens the file.
+                /// Returns nullptr if the file cannot be opened or the type is not supported.
+                static AudioDecoder* Create(const std::string& path);
+
+            protected:
+                int sampleRate = 0;
+                int channels = 0;
+
+            };
+
+            /// Decodes uncompressed PCM or floating point WAV files.
+            class OSSIUM_EDL WavDecoder : public AudioDecoder
+            {
+            public:
+                ~WavDecoder();
+
+                bool Open(const std::string& path);
+                Uint32 Decode(float* output, Uint32 frames);
+                bool Rewind();
+
+            private:
+                SDL_RWops* file = NULL;
+
+                /// Byte offset and size of the sample data in the file.
+                Sint64 dataStart = 0;
+                Uint32 dataSize = 0;
+
+                /// Number of sample data bytes read so far.
+                Uint32 dataRead = 0;
+
+                /// Bytes per sample and whether samples are floating point.
+                Uint16 sampleBytes = 0;
+                bool floatingPoint = false;
+
+                /// Raw data read from the file before conversion.
+                Uint8 readBuffer[4096];
+
+            };
+
+        }
+
+    }
+
+}
+
+#endif // AUDIODECODER_H
@@ -0,0 +1,1189 @@
+/** COPYRIGHT NOTICE
+ *
+ *  Ossium Engine
+ *  Copyright (c) 2018-2020 Tim Lane
+ *
+ *  This software is provided 'as-is', without any express or implied warranty. In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+ *
+ *  2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+ *
+ *  3. This notice may not be removed or altered from any source distribution.
+ *
+**/
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+extern "C"
+{
+    #include <SDL_mixer.h>
+}
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define OSSIUM_AUDIO_SSE
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define OSSIUM_AUDIO_NEON
+#include <arm_neon.h>
+#endif
+
+#include "audioengine.h"
+#include "audio.h"
+#include "mathconsts.h"
+#include "logging.h"
+
+using namespace std;
+
+namespace Ossium
+{
+
+    inline namespace Audio
+    {
+
+        ///
+        /// AudioInsert
+        ///
+
+        AudioInsert AudioInsert::Gain(float gain)
+        {
+            AudioInsert insert;
+            insert.type = AudioInsertType::Gain;
+            insert.gain = gain;
+            return insert;
+        }
+
+        AudioInsert AudioInsert::LowPass(float cutoff)
+        {
+            AudioInsert insert;
+            insert.type = AudioInsertType::LowPass;
+            insert.cutoff = cutoff;
+            return insert;
+        }
+
+        AudioInsert AudioInsert::Compressor(float threshold, float ratio, float attack, float release, float makeupGain)
+        {
+            AudioInsert insert;
+            insert.type = AudioInsertType::Compressor;
+            insert.threshold = threshold;
+            insert.ratio = ratio;
+            insert.attack = attack;
+            insert.release = release;
+            insert.gain = makeupGain;
+            return insert;
+        }
+
+        namespace Internals
+        {
+
+            ///
+            /// MixKernels
+            ///
+
+            namespace MixKernels
+            {
+
+                void MixStereo(float* dst, const float* src, Uint32 frames, float startLeft, float startRight, float endLeft, float endRight)
+                {
+                    if (frames == 0)
+                    {
+                        return;
+                    }
+                    float stepLeft = (endLeft - startLeft) / (float)frames;
+                    float stepRight = (endRight - startRight) / (float)frames;
+                    Uint32 i = 0;
+#if defined(OSSIUM_AUDIO_SSE)
+                    // Two stereo frames per iteration.
+                    __m128 gain = _mm_setr_ps(startLeft, startRight, startLeft + stepLeft, startRight + stepRight);
+                    __m128 increment = _mm_setr_ps(stepLeft * 2.0f, stepRight * 2.0f, stepLeft * 2.0f, stepRight * 2.0f);
+                    for (; i + 2 <= frames; i += 2)
+                    {
+                        __m128 mixed = _mm_add_ps(_mm_loadu_ps(dst + i * 2), _mm_mul_ps(_mm_loadu_ps(src + i * 2), gain));
+                        _mm_storeu_ps(dst + i * 2, mixed);
+                        gain = _mm_add_ps(gain, increment);
+                    }
+#elif defined(OSSIUM_AUDIO_NEON)
+                    float gainValues[4] = {startLeft, startRight, startLeft + stepLeft, startRight + stepRight};
+                    float32x4_t gain = vld1q_f32(gainValues);
+                    float32x4_t increment = vdupq_n_f32(0.0f);
+                    increment = vsetq_lane_f32(stepLeft * 2.0f, increment, 0);
+                    increment = vsetq_lane_f32(stepRight * 2.0f, increment, 1);
+                    increment = vsetq_lane_f32(stepLeft * 2.0f, increment, 2);
+                    increment = vsetq_lane_f32(stepRight * 2.0f, increment, 3);
+                    for (; i + 2 <= frames; i += 2)
+                    {
+                        vst1q_f32(dst + i * 2, vmlaq_f32(vld1q_f32(dst + i * 2), vld1q_f32(src + i * 2), gain));
+                        gain = vaddq_f32(gain, increment);
+                    }
+#endif
+                    for (; i < frames; i++)
+                    {
+                        dst[i * 2] += src[i * 2] * (startLeft + stepLeft * (float)i);
+                        dst[i * 2 + 1] += src[i * 2 + 1] * (startRight + stepRight * (float)i);
+                    }
+                }
+
+                void ScaleStereo(float* buffer, Uint32 frames, float startLeft, float startRight, float endLeft, float endRight)
+                {
+                    if (frames == 0)
+                    {
+                        return;
+                    }
+                    float stepLeft = (endLeft - startLeft) / (float)frames;
+                    float stepRight = (endRight - startRight) / (float)frames;
+                    Uint32 i = 0;
+#if defined(OSSIUM_AUDIO_SSE)
+                    __m128 gain = _mm_setr_ps(startLeft, startRight, startLeft + stepLeft, startRight + stepRight);
+                    __m128 increment = _mm_setr_ps(stepLeft * 2.0f, stepRight * 2.0f, stepLeft * 2.0f, stepRight * 2.0f);
+                    for (; i + 2 <= frames; i += 2)
+                    {
+                        _mm_storeu_ps(buffer + i * 2, _mm_mul_ps(_mm_loadu_ps(buffer + i * 2), gain));
+                        gain = _mm_add_ps(gain, increment);
+                    }
+#elif defined(OSSIUM_AUDIO_NEON)
+                    float gainValues[4] = {startLeft, startRight, startLeft + stepLeft, startRight + stepRight};
+                    float32x4_t gain = vld1q_f32(gainValues);
+                    float32x4_t increment = vdupq_n_f32(0.0f);
+                    increment = vsetq_lane_f32(stepLeft * 2.0f, increment, 0);
+                    increment = vsetq_lane_f32(stepRight * 2.0f, increment, 1);
+                    increment = vsetq_lane_f32(stepLeft * 2.0f, increment, 2);
+                    increment = vsetq_lane_f32(stepRight * 2.0f, increment, 3);
+                    for (; i + 2 <= frames; i += 2)
+                    {
+                        vst1q_f32(buffer + i * 2, vmulq_f32(vld1q_f32(buffer + i * 2), gain));
+                        gain = vaddq_f32(gain, increment);
+                    }
+#endif
+                    for (; i < frames; i++)
+                    {
+                        buffer[i * 2] *= startLeft + stepLeft * (float)i;
+                        buffer[i * 2 + 1] *= startRight + stepRight * (float)i;
+                    }
+                }
+
+                Uint32 Resample(float* dst, Uint32 frames, const float* src, Uint32 srcFrames, Uint64& position, Uint64 step)
+                {
+                    const Uint64 end = (Uint64)srcFrames << 32;
+                    const float fractionScale = 1.0f / 4294967296.0f;
+                    Uint32 i = 0;
+
+                    if (step == ((Uint64)1 << 32) && (position & 0xFFFFFFFF) == 0)
+                    {
+                        // Original pitch and aligned to a frame, so no interpolation is needed.
+                        Uint32 available = position < end ? srcFrames - (Uint32)(position >> 32) : 0;
+                        Uint32 count = available < frames ? available : frames;
+                        memcpy(dst, src + (position >> 32) * 2, count * 2 * sizeof(float));
+                        position += (Uint64)count << 32;
+                        return count;
+                    }
+
+#if defined(OSSIUM_AUDIO_SSE)
+                    // Two output frames per iteration; each stereo frame is loaded as a single 64-bit pair.
+                    while (i + 2 <= frames && ((position + step) >> 32) + 1 < srcFrames)
+                    {
+                        Uint64 second = position + step;
+                        const float* a = src + (position >> 32) * 2;
+                        const float* b = src + (second >> 32) * 2;
+                        __m128 current = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), (const __m64*)a), (const __m64*)b);
+                        __m128 next = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), (const __m64*)(a + 2)), (const __m64*)(b + 2));
+                        float t0 = (float)(Uint32)position * fractionScale;
+                        float t1 = (float)(Uint32)second * fractionScale;
+                        __m128 t = _mm_setr_ps(t0, t0, t1, t1);
+                        _mm_storeu_ps(dst + i * 2, _mm_add_ps(current, _mm_mul_ps(_mm_sub_ps(next, current), t)));
+                        position = second + step;
+                        i += 2;
+                    }
+#elif defined(OSSIUM_AUDIO_NEON)
+                    while (i + 2 <= frames && ((position + step) >> 32) + 1 < srcFrames)
+                    {
+                        Uint64 second = position + step;
+                        const float* a = src + (position >> 32) * 2;
+                        const float* b = src + (second >> 32) * 2;
+                        float32x4_t current = vcombine_f32(vld1_f32(a), vld1_f32(b));
+                        float32x4_t next = vcombine_f32(vld1_f32(a + 2), vld1_f32(b + 2));
+                        float t0 = (float)(Uint32)position * fractionScale;
+                        float t1 = (float)(Uint32)second * fractionScale;
+                        float32x4_t t = vcombine_f32(vdup_n_f32(t0), vdup_n_f32(t1));
+                        vst1q_f32(dst + i * 2, vmlaq_f32(current, vsubq_f32(next, current), t));
+                        position = second + step;
+                        i += 2;
+                    }
+#endif
+                    for (; i < frames && position < end; i++)
+                    {
+                        Uint32 index = (Uint32)(position >> 32);
+                        Uint32 next = index + 1 < srcFrames ? index + 1 : index;
+                        float t = (float)(Uint32)position * fractionScale;
+                        dst[i * 2] = src[index * 2] + (src[next * 2] - src[index * 2]) * t;
+                        dst[i * 2 + 1] = src[index * 2 + 1] + (src[next * 2 + 1] - src[index * 2 + 1]) * t;
+                        position += step;
+                    }
+                    return i;
+                }
+
+                void PanGains(float volume, Sint16 angle, float& left, float& right)
+                {
+                    float pan = sinf((float)angle * (Constants::pi / 180.0f));
+                    left = volume * (pan > 0.0f ? 1.0f - pan : 1.0f);
+                    right = volume * (pan < 0.0f ? 1.0f + pan : 1.0f);
+                }
+
+            }
+
+            ///
+            /// AudioEngine::Stream
+            ///
+
+            AudioEngine::Stream::~Stream()
+            {
+                if (converter != NULL)
+                {
+                    SDL_FreeAudioStream(converter);
+                    converter = NULL;
+                }
+                delete decoder;
+                decoder = nullptr;
+            }
+
+            bool AudioEngine::Stream::Fill(Uint32 chunks)
+            {
+                bool decodedAny = false;
+                const Uint32 chunkSize = converted.size();
+                while (!complete.load(memory_order_relaxed) && ring.GetCapacity() - ring.Size() >= chunkSize)
+                {
+                    // Move converted samples into the ring buffer before decoding more so the converter never grows.
+                    int available = SDL_AudioStreamAvailable(converter);
+                    if (available > 0)
+                    {
+                        int bytes = SDL_AudioStreamGet(converter, &converted[0], min((Uint32)available, chunkSize * (Uint32)sizeof(float)));
+                        if (bytes > 0)
+                        {
+                            ring.PushRange(&converted[0], (Uint32)bytes / sizeof(float));
+                            decodedAny = true;
+                            continue;
+                        }
+                    }
+                    if (flushed)
+                    {
+                        complete.store(true, memory_order_release);
+                        break;
+                    }
+                    if (chunks == 0)
+                    {
+                        break;
+                    }
+
+                    Uint32 frames = decoder->Decode(&decoded[0], StreamChunkFrames);
+                    chunks--;
+                    if (frames == 0)
+                    {
+                        if (repeats != 0 && decoder->Rewind())
+                        {
+                            if (repeats > 0)
+                            {
+                                repeats--;
+                            }
+                            continue;
+                        }
+                        SDL_AudioStreamFlush(converter);
+                        flushed = true;
+                        continue;
+                    }
+                    if (SDL_AudioStreamPut(converter, &decoded[0], frames * decoder->GetChannels() * sizeof(float)) < 0)
+                    {
+                        Log.Warning("Failed to convert streamed audio! SDL_Error: {0}", SDL_GetError());
+                        SDL_AudioStreamFlush(converter);
+                        flushed = true;
+                    }
+                    decodedAny = true;
+                }
+                return decodedAny;
+            }
+
+            ///
+            /// AudioEngine
+            ///
+
+            AudioEngine::~AudioEngine()
+            {
+                /// Don't call Clear() as it calls SDL_mixer functions and this is usually a singleton
+                delete[] voices;
+                voices = nullptr;
+            }
+
+            bool AudioEngine::Init(Uint32 numVoices, Uint32 budget)
+            {
+                int frequency = 0;
+                Uint16 format = 0;
+                int channels = 0;
+                if (Mix_QuerySpec(&frequency, &format, &channels) == 0)
+                {
+                    Log.Error("Failed to initialise audio engine, the audio device is not open! Mix_Error: {0}", Mix_GetError());
+                    return false;
+                }
+                if (format != AUDIO_S16SYS && format != AUDIO_F32SYS)
+                {
+                    Log.Error("Failed to initialise audio engine, unsupported audio device format {0}.", format);
+                    return false;
+                }
+
+                Setup(numVoices, frequency);
+                SetMixBudget(budget);
+                deviceFormat = format;
+                deviceChannels = channels;
+
+                Mix_SetPostMix(PostMix, this);
+                hooked = true;
+
+                Log.Verbose("Initialised audio engine with {0} voices ({1} mixed) at {2} Hz.", numVoices, budget, frequency);
+                return true;
+            }
+
+            void AudioEngine::Clear()
+            {
+                if (hooked)
+                {
+                    /// Once this returns the audio thread is no longer mixing
+                    Mix_SetPostMix(NULL, NULL);
+                    hooked = false;
+                }
+
+                for (Uint32 i = 0; i < maxVoices; i++)
+                {
+                    int state = voices[i].state.load(memory_order_acquire);
+                    if (state != VOICE_FREE)
+                    {
+                        ReleaseVoice(i);
+                    }
+                }
+                StopDecoder();
+
+                delete[] voices;
+                voices = nullptr;
+                maxVoices = 0;
+                realVoices = 0;
+                freeVoices.clear();
+                finishedVoices.SetCapacity(0);
+                busBuffers.clear();
+                voiceBuffer.clear();
+                mixBuffer.clear();
+            }
+
+            void AudioEngine::Setup(Uint32 numVoices, int rate)
+            {
+                Clear();
+
+                maxVoices = numVoices;
+                voices = new Voice[maxVoices];
+                freeVoices.reserve(maxVoices);
+                for (Uint32 i = maxVoices; i > 0; i--)
+                {
+                    freeVoices.push_back(i - 1);
+                }
+                finishedVoices.SetCapacity(maxVoices);
+
+                busBuffers.assign(MaxBuses * BlockFrames * 2, 0.0f);
+                voiceBuffer.assign(BlockFrames * 2, 0.0f);
+                budgetCandidates.assign(maxVoices, 0);
+                budgetPriorities.assign(maxVoices, 0.0f);
+                mixBuffer.assign(BlockFrames * 2, 0.0f);
+
+                sampleRate = rate;
+                deviceFormat = AUDIO_F32SYS;
+                deviceChannels = 2;
+            }
+
+            void AudioEngine::Render(float* output, Uint32 frames)
+            {
+                if (voices == nullptr)
+                {
+                    memset(output, 0, frames * 2 * sizeof(float));
+                    return;
+                }
+
+                // Snapshot the bus graph so it stays consistent for the whole render.
+                // Inactive buses are marked with -2, buses feeding the device output with -1.
+                int routing[MaxBuses];
+                for (Uint32 i = 0; i < MaxBuses; i++)
+                {
+                    routing[i] = buses[i].active.load(memory_order_acquire) ? buses[i].output.load(memory_order_relaxed) : -2;
+                }
+                for (Uint32 i = 0; i < MaxBuses; i++)
+                {
+                    if (routing[i] >= (int)MaxBuses || (routing[i] >= 0 && routing[routing[i]] == -2))
+                    {
+                        routing[i] = -1;
+                    }
+                }
+
+                // Order buses by depth in the graph, deepest first, so every bus is processed before the bus it feeds.
+                Uint32 depth[MaxBuses];
+                Uint32 order[MaxBuses];
+                Uint32 numOrdered = 0;
+                for (Uint32 i = 0; i < MaxBuses; i++)
+                {
+                    if (routing[i] == -2)
+                    {
+                        continue;
+                    }
+                    depth[i] = 0;
+                    for (int next = routing[i]; next >= 0 && depth[i] < MaxBuses; next = routing[next])
+                    {
+                        depth[i]++;
+                    }
+                    Uint32 insertAt = numOrdered;
+                    while (insertAt > 0 && depth[order[insertAt - 1]] < depth[i])
+                    {
+                        order[insertAt] = order[insertAt - 1];
+                        insertAt--;
+                    }
+                    order[insertAt] = i;
+                    numOrdered++;
+                }
+
+                ApplyMixBudget();
+
+                for (Uint32 offset = 0; offset < frames; offset += BlockFrames)
+                {
+                    Uint32 count = frames - offset < BlockFrames ? frames - offset : BlockFrames;
+                    RenderBlock(output + offset * 2, count, routing, order, numOrdered);
+                }
+            }
+
+            void AudioEngine::RenderBlock(float* output, Uint32 frames, const int* routing, const Uint32* order, Uint32 numOrdered)
+            {
+                memset(output, 0, frames * 2 * sizeof(float));
+                for (Uint32 i = 0; i < numOrdered; i++)
+                {
+                    memset(&busBuffers[order[i] * BlockFrames * 2], 0, frames * 2 * sizeof(float));
+                }
+
+                for (Uint32 i = 0; i < maxVoices; i++)
+                {
+                    Voice& voice = voices[i];
+                    int state = voice.state.load(memory_order_acquire);
+                    if (state != VOICE_PLAYING && state != VOICE_STOPPING)
+                    {
+                        continue;
+                    }
+                    if (state == VOICE_PLAYING && voice.paused.load(memory_order_relaxed))
+                    {
+                        continue;
+                    }
+
+                    // Voices over the budget are treated as virtual until enough voices are virtualised or stop.
+                    bool silence = state == VOICE_PLAYING && (voice.virtualised.load(memory_order_relaxed) || voice.overBudget);
+                    bool playing = true;
+                    if (silence && voice.lastLeft == 0.0f && voice.lastRight == 0.0f)
+                    {
+                        playing = AdvanceVoice(voice, frames);
+                    }
+                    else
+                    {
+                        int bus = voice.bus.load(memory_order_relaxed);
+                        float* target = bus >= 0 && bus < (int)MaxBuses && routing[bus] != -2 ? &busBuffers[bus * BlockFrames * 2] : output;
+                        playing = RenderVoice(voice, target, frames, silence);
+                    }
+                    if (!playing)
+                    {
+                        FinishVoice(i);
+                    }
+                }
+
+                for (Uint32 i = 0; i < numOrdered; i++)
+                {
+                    Bus& bus = buses[order[i]];
+                    float* buffer = &busBuffers[order[i] * BlockFrames * 2];
+                    ProcessInserts(bus, buffer, frames);
+
+                    float left = bus.gainLeft.load(memory_order_relaxed);
+                    float right = bus.gainRight.load(memory_order_relaxed);
+                    int output_bus = routing[order[i]];
+                    MixKernels::MixStereo(output_bus >= 0 ? &busBuffers[output_bus * BlockFrames * 2] : output, buffer, frames, bus.lastLeft, bus.lastRight, left, right);
+                    bus.lastLeft = left;
+                    bus.lastRight = right;
+                }
+            }
+
+            void AudioEngine::ApplyMixBudget()
+            {
+                Uint32 budget = mixBudget.load(memory_order_relaxed);
+                Uint32 numCandidates = 0;
+                for (Uint32 i = 0; i < maxVoices; i++)
+                {
+                    Voice& voice = voices[i];
+                    if (voice.state.load(memory_order_acquire) != VOICE_PLAYING)
+                    {
+                        // Free voices belong to the main thread
+                        continue;
+                    }
+                    voice.overBudget = false;
+                    if (!voice.paused.load(memory_order_relaxed) && !voice.virtualised.load(memory_order_relaxed))
+                    {
+                        // Snapshot the priority so it can't change while sorting
+                        budgetPriorities[i] = voice.priority.load(memory_order_relaxed);
+                        budgetCandidates[numCandidates] = i;
+                        numCandidates++;
+                    }
+                }
+                if (numCandidates <= budget)
+                {
+                    return;
+                }
+
+                // Keep the highest priority voices, preferring lower voice indices when priorities are equal
+                const float* priorities = &budgetPriorities[0];
+                Uint32* candidates = &budgetCandidates[0];
+                nth_element(candidates, candidates + budget, candidates + numCandidates, [priorities] (Uint32 a, Uint32 b) {
+                    return priorities[a] > priorities[b] || (priorities[a] == priorities[b] && a < b);
+                });
+                for (Uint32 i = budget; i < numCandidates; i++)
+                {
+                    voices[candidates[i]].overBudget = true;
+                }
+            }
+
+            bool AudioEngine::RenderVoice(Voice& voice, float* target, Uint32 frames, bool silence)
+            {
+                bool stopping = voice.state.load(memory_order_acquire) == VOICE_STOPPING;
+
+                // Stopping and virtualised voices fade out over one block rather than cutting off with a click.
+                silence = silence || stopping;
+                float left = silence ? 0.0f : voice.gainLeft.load(memory_order_relaxed);
+                float right = silence ? 0.0f : voice.gainRight.load(memory_order_relaxed);
+                Uint64 step = (Uint64)((double)voice.pitch.load(memory_order_relaxed) * 4294967296.0);
+                const Uint64 end = (Uint64)voice.frames << 32;
+
+                float* scratch = &voiceBuffer[0];
+                Uint32 written = 0;
+                bool finished = false;
+                if (voice.stream != nullptr)
+                {
+                    // Streams are already at the output rate. If the decoder thread falls behind, the rest of the block is silent.
+                    written = voice.stream->ring.PopRange(scratch, frames * 2) / 2;
+                    finished = written < frames && voice.stream->complete.load(memory_order_acquire) && voice.stream->ring.Size() == 0;
+                }
+                while (voice.stream == nullptr && written < frames)
+                {
+                    if (voice.position >= end)
+                    {
+                        if (voice.repeats == 0)
+                        {
+                            finished = true;
+                            break;
+                        }
+                        if (voice.repeats > 0)
+                        {
+                            voice.repeats--;
+                        }
+                        voice.position -= end;
+                    }
+                    written += MixKernels::Resample(scratch + written * 2, frames - written, voice.samples, voice.frames, voice.position, step);
+                }
+                if (written < frames)
+                {
+                    memset(scratch + written * 2, 0, (frames - written) * 2 * sizeof(float));
+                }
+
+                MixKernels::MixStereo(target, scratch, frames, voice.lastLeft, voice.lastRight, left, right);
+                voice.lastLeft = left;
+                voice.lastRight = right;
+
+                return !finished && !stopping;
+            }
+
+            bool AudioEngine::AdvanceVoice(Voice& voice, Uint32 frames)
+            {
+                if (voice.stream != nullptr)
+                {
+                    Uint32 skipped = voice.stream->ring.PopRange(nullptr, frames * 2) / 2;
+                    return skipped == frames || !voice.stream->complete.load(memory_order_acquire) || voice.stream->ring.Size() != 0;
+                }
+                Uint64 step = (Uint64)((double)voice.pitch.load(memory_order_relaxed) * 4294967296.0);
+                const Uint64 end = (Uint64)voice.frames << 32;
+                voice.position += step * frames;
+                while (voice.position >= end)
+                {
+                    if (voice.repeats == 0)
+                    {
+                        return false;
+                    }
+                    if (voice.repeats > 0)
+                    {
+                        voice.repeats--;
+                    }
+                    voice.position -= end;
+                }
+                return true;
+            }
+
+            void AudioEngine::ProcessInserts(Bus& bus, float* buffer, Uint32 frames)
+            {
+                for (Uint32 i = 0; i < MaxInserts; i++)
+                {
+                    Insert& insert = bus.inserts[i];
+                    int type = insert.type.load(memory_order_acquire);
+                    if (type != insert.activeType)
+                    {
+                        // Reset the processing state when the effect changes.
+                        insert.activeType = type;
+                        insert.activeCutoff = 0.0f;
+                        insert.z[0][0] = insert.z[0][1] = insert.z[1][0] = insert.z[1][1] = 0.0f;
+                        insert.envelope = 0.0f;
+                    }
+
+                    float gain = insert.gain.load(memory_order_relaxed);
+                    switch ((AudioInsertType)type)
+                    {
+                    case AudioInsertType::Gain:
+                    {
+                        MixKernels::ScaleStereo(buffer, frames, gain, gain, gain, gain);
+                        break;
+                    }
+                    case AudioInsertType::LowPass:
+                    {
+                        float cutoff = Clamp(insert.cutoff.load(memory_order_relaxed), 10.0f, (float)sampleRate * 0.49f);
+                        if (cutoff != insert.activeCutoff)
+                        {
+                            // Second order Butterworth low-pass coefficients.
+                            float w0 = 2.0f * Constants::pi * cutoff / (float)sampleRate;
+                            float cosw0 = cosf(w0);
+                            float alpha = sinf(w0) / (2.0f * 0.70710678f);
+                            float a0 = 1.0f + alpha;
+                            insert.b0 = ((1.0f - cosw0) * 0.5f) / a0;
+                            insert.b1 = (1.0f - cosw0) / a0;
+                            insert.b2 = insert.b0;
+                            insert.a1 = (-2.0f * cosw0) / a0;
+                            insert.a2 = (1.0f - alpha) / a0;
+                            insert.activeCutoff = cutoff;
+                        }
+                        for (Uint32 f = 0; f < frames; f++)
+                        {
+                            for (Uint32 c = 0; c < 2; c++)
+                            {
+                                float x = buffer[f * 2 + c];
+                                float y = insert.b0 * x + insert.z[c][0];
+                                insert.z[c][0] = insert.b1 * x - insert.a1 * y + insert.z[c][1];
+                                insert.z[c][1] = insert.b2 * x - insert.a2 * y;
+                                buffer[f * 2 + c] = y * gain;
+                            }
+                        }
+                        break;
+                    }
+                    case AudioInsertType::Compressor:
+                    {
+                        float threshold = insert.threshold.load(memory_order_relaxed);
+                        float ratio = insert.ratio.load(memory_order_relaxed);
+                        float attack = expf(-1.0f / (max(insert.attack.load(memory_order_relaxed), 0.0001f) * (float)sampleRate));
+                        float release = expf(-1.0f / (max(insert.release.load(memory_order_relaxed), 0.0001f) * (float)sampleRate));
+                        ratio = ratio < 1.0f ? 1.0f : ratio;
+                        float envelope = insert.envelope;
+                        for (Uint32 f = 0; f < frames; f++)
+                        {
+                            float peak = max(fabsf(buffer[f * 2]), fabsf(buffer[f * 2 + 1]));
+                            envelope = peak + (peak > envelope ? attack : release) * (envelope - peak);
+                            float reduction = envelope > threshold ? (threshold + (envelope - threshold) / ratio) / envelope : 1.0f;
+                            buffer[f * 2] *= reduction * gain;
+                            buffer[f * 2 + 1] *= reduction * gain;
+                        }
+                        insert.envelope = envelope;
+                        break;
+                    }
+                    default:
+                        break;
+                    }
+                }
+            }
+
+            void AudioEngine::FinishVoice(Uint32 index)
+            {
+                // Don't carry the budget over to whatever plays in this voice next
+                voices[index].overBudget = false;
+                // The main thread may have already finished the voice in StopAllUsing(), in which case it releases the voice itself.
+                if (voices[index].state.exchange(VOICE_FINISHED, memory_order_acq_rel) != VOICE_FINISHED)
+                {
+                    finishedVoices.Push(index);
+                }
+            }
+
+            void AudioEngine::ReleaseVoice(Uint32 index)
+            {
+                Voice& voice = voices[index];
+                AudioPlayer* owner = voice.owner;
+                if (voice.real)
+                {
+                    realVoices--;
+                    voice.real = false;
+                }
+                voice.owner = nullptr;
+                voice.samples = nullptr;
+                voice.frames = 0;
+                if (voice.stream != nullptr)
+                {
+                    /// The audio thread is done with the stream, so the decoder thread can delete it
+                    voice.stream->released.store(true, memory_order_release);
+                    voice.stream = nullptr;
+                    SDL_CondSignal(streamSignal);
+                }
+                voice.state.store(VOICE_FREE, memory_order_release);
+                freeVoices.push_back(index);
+                if (owner != nullptr)
+                {
+                    /// The owner may start playing again from the callback, so notify it last
+                    owner->OnPlayFinished();
+                }
+            }
+
+            void AudioEngine::Update()
+            {
+                Uint32 index;
+                while (finishedVoices.Pop(index))
+                {
+                    ReleaseVoice(index);
+                }
+            }
+
+            int AudioEngine::PlayVoice(AudioPlayer* owner, const float* samples, Uint32 frames, int bus, float left, float right, int repeats, float pitch)
+            {
+                if (freeVoices.empty() || samples == nullptr || frames == 0)
+                {
+                    return -1;
+                }
+                return StartVoice(owner, samples, frames, nullptr, bus, left, right, repeats, pitch);
+            }
+
+            int AudioEngine::StreamVoice(AudioPlayer* owner, const string& path, int bus, float left, float right, int repeats)
+            {
+                if (freeVoices.empty() || sampleRate <= 0)
+                {
+                    return -1;
+                }
+                AudioDecoder* decoder = AudioDecoder::Create(path);
+                if (decoder == nullptr)
+                {
+                    return -1;
+                }
+
+                Stream* stream = new Stream();
+                stream->decoder = decoder;
+                stream->repeats = repeats;
+                stream->converter = SDL_NewAudioStream(AUDIO_F32SYS, (Uint8)decoder->GetChannels(), decoder->GetSampleRate(), AUDIO_F32SYS, 2, sampleRate);
+                if (stream->converter == NULL)
+                {
+                    Log.Error("Failed to stream '{0}', cannot convert from {1} channels at {2} Hz! SDL_Error: {3}", path, decoder->GetChannels(), decoder->GetSampleRate(), SDL_GetError());
+                    delete stream;
+                    return -1;
+                }
+                stream->ring.SetCapacity(StreamBufferFrames * 2);
+                stream->decoded.resize(StreamChunkFrames * decoder->GetChannels());
+                stream->converted.resize(StreamChunkFrames * 2);
+
+                /// Decode the first chunk here so the voice doesn't start with an underrun
+                stream->Fill(1);
+
+                if (decoderThread == NULL)
+                {
+                    streamLock = SDL_CreateMutex();
+                    streamSignal = SDL_CreateCond();
+                    decoderQuit = false;
+                    decoderThread = SDL_CreateThread(DecoderThread, "AudioDecoder", (void*)this);
+                    if (decoderThread == NULL)
+                    {
+                        Log.Error("Failed to create audio decoder thread! SDL_Error: {0}", SDL_GetError());
+                        StopDecoder();
+                        delete stream;
+                        return -1;
+                    }
+                }
+                SDL_LockMutex(streamLock);
+                streams.push_back(stream);
+                SDL_CondSignal(streamSignal);
+                SDL_UnlockMutex(streamLock);
+
+                return StartVoice(owner, nullptr, 0, stream, bus, left, right, 0, 1.0f);
+            }
+
+            int AudioEngine::StartVoice(AudioPlayer* owner, const float* samples, Uint32 frames, Stream* stream, int bus, float left, float right, int repeats, float pitch)
+            {
+                Uint32 index = freeVoices.back();
+                freeVoices.pop_back();
+
+                Voice& voice = voices[index];
+                voice.samples = samples;
+                voice.frames = frames;
+                voice.stream = stream;
+                voice.owner = owner;
+                voice.position = 0;
+                voice.repeats = repeats;
+                voice.lastLeft = left;
+                voice.lastRight = right;
+                voice.paused.store(false, memory_order_relaxed);
+                voice.virtualised.store(false, memory_order_relaxed);
+                voice.priority.store(0.0f, memory_order_relaxed);
+                voice.real = true;
+                realVoices++;
+                voice.bus.store(bus, memory_order_relaxed);
+                voice.gainLeft.store(left, memory_order_relaxed);
+                voice.gainRight.store(right, memory_order_relaxed);
+                voice.pitch.store(pitch > 0.001f ? pitch : 0.001f, memory_order_relaxed);
+
+                /// Publish everything above to the audio thread
+                voice.state.store(VOICE_PLAYING, memory_order_release);
+                return (int)index;
+            }
+
+            void AudioEngine::StopDecoder()
+            {
+                if (decoderThread != NULL)
+                {
+                    SDL_LockMutex(streamLock);
+                    decoderQuit = true;
+                    SDL_CondSignal(streamSignal);
+                    SDL_UnlockMutex(streamLock);
+                    SDL_WaitThread(decoderThread, NULL);
+                    decoderThread = NULL;
+                }
+                for (Stream* stream : streams)
+                {
+                    delete stream;
+                }
+                streams.clear();
+                if (streamSignal != NULL)
+                {
+                    SDL_DestroyCond(streamSignal);
+                    streamSignal = NULL;
+                }
+                if (streamLock != NULL)
+                {
+                    SDL_DestroyMutex(streamLock);
+                    streamLock = NULL;
+                }
+            }
+
+            int AudioEngine::DecoderThread(void* data)
+            {
+                AudioEngine* engine = (AudioEngine*)data;
+                vector<Stream*> active;
+
+                SDL_LockMutex(engine->streamLock);
+                while (!engine->decoderQuit)
+                {
+                    for (unsigned int i = 0; i < engine->streams.size();)
+                    {
+                        if (engine->streams[i]->released.load(memory_order_acquire))
+                        {
+                            delete engine->streams[i];
+                            engine->streams[i] = engine->streams.back();
+                            engine->streams.pop_back();
+                            continue;
+                        }
+                        i++;
+                    }
+                    active.assign(engine->streams.begin(), engine->streams.end());
+                    SDL_UnlockMutex(engine->streamLock);
+
+                    /// Decode without holding the lock so the main thread can start streams meanwhile
+                    bool decoded = false;
+                    for (Stream* stream : active)
+                    {
+                        decoded = stream->Fill(StreamBufferFrames / StreamChunkFrames) || decoded;
+                    }
+
+                    SDL_LockMutex(engine->streamLock);
+                    if (!decoded && !engine->decoderQuit)
+                    {
+                        /// All buffers are full; the audio thread drains a chunk in tens of milliseconds
+                        SDL_CondWaitTimeout(engine->streamSignal, engine->streamLock, 10);
+                    }
+                }
+                SDL_UnlockMutex(engine->streamLock);
+                return 0;
+            }
+
+            void AudioEngine::StopVoice(int voice)
+            {
+                if (voice >= 0 && (Uint32)voice < maxVoices)
+                {
+                    voices[voice].owner = nullptr;
+                    int expected = VOICE_PLAYING;
+                    voices[voice].state.compare_exchange_strong(expected, VOICE_STOPPING, memory_order_acq_rel);
+                }
+            }
+
+            void AudioEngine::SetVoicePaused(int voice, bool paused)
+            {
+                if (voice >= 0 && (Uint32)voice < maxVoices)
+                {
+                    voices[voice].paused.store(paused, memory_order_relaxed);
+                }
+            }
+
+            void AudioEngine::SetVoiceGain(int voice, float left, float right)
+            {
+                if (voice >= 0 && (Uint32)voice < maxVoices)
+                {
+                    voices[voice].gainLeft.store(left, memory_order_relaxed);
+                    voices[voice].gainRight.store(right, memory_order_relaxed);
+                }
+            }
+
+            void AudioEngine::SetVoicePitch(int voice, float pitch)
+            {
+                if (voice >= 0 && (Uint32)voice < maxVoices)
+                {
+                    voices[voice].pitch.store(pitch > 0.001f ? pitch : 0.001f, memory_order_relaxed);
+                }
+            }
+
+            void AudioEngine::SetVoiceBus(int voice, int bus)
+            {
+                if (voice >= 0 && (Uint32)voice < maxVoices)
+                {
+                    voices[voice].bus.store(bus, memory_order_relaxed);
+                }
+            }
+
+            void AudioEngine::SetVoiceVirtual(int voice, bool virtualise)
+            {
+                if (voice >= 0 && (Uint32)voice < maxVoices && voices[voice].state.load(memory_order_relaxed) != VOICE_FREE)
+                {
+                    if (voices[voice].real == virtualise)
+                    {
+                        voices[voice].real = !virtualise;
+                        realVoices = virtualise ? realVoices - 1 : realVoices + 1;
+                        voices[voice].virtualised.store(virtualise, memory_order_relaxed);
+                    }
+                }
+            }
+
+            void AudioEngine::SetVoicePriority(int voice, float priority)
+            {
+                if (voice >= 0 && (Uint32)voice < maxVoices)
+                {
+                    voices[voice].priority.store(priority, memory_order_relaxed);
+                }
+            }
+
+            bool AudioEngine::IsVoiceVirtual(int voice)
+            {
+                return voice >= 0 && (Uint32)voice < maxVoices && voices[voice].state.load(memory_order_relaxed) != VOICE_FREE && !voices[voice].real;
+            }
+
+            void AudioEngine::StopAllUsing(const float* samples)
+            {
+                if (samples == nullptr)
+                {
+                    return;
+                }
+                vector<Uint32> stopped;
+                for (Uint32 i = 0; i < maxVoices; i++)
+                {
+                    if (voices[i].samples == samples)
+                    {
+                        int previous = voices[i].state.exchange(VOICE_FINISHED, memory_order_acq_rel);
+                        if (previous == VOICE_PLAYING || previous == VOICE_STOPPING)
+                        {
+                            stopped.push_back(i);
+                        }
+                    }
+                }
+                if (stopped.empty())
+                {
+                    return;
+                }
+                if (hooked)
+                {
+                    /// SDL_mixer holds the audio device lock while setting the hook,
+                    /// so this waits for any mix still reading the samples to finish
+                    Mix_SetPostMix(PostMix, this);
+                }
+                for (Uint32 index : stopped)
+                {
+                    ReleaseVoice(index);
+                }
+            }
+
+            Uint32 AudioEngine::GetActiveVoices()
+            {
+                return maxVoices - (Uint32)freeVoices.size();
+            }
+
+            Uint32 AudioEngine::GetMaxVoices()
+            {
+                return maxVoices;
+            }
+
+            Uint32 AudioEngine::GetRealVoices()
+            {
+                return realVoices;
+            }
+
+            void AudioEngine::SetMixBudget(Uint32 budget)
+            {
+                mixBudget.store(budget, memory_order_relaxed);
+            }
+
+            Uint32 AudioEngine::GetMixBudget()
+            {
+                Uint32 budget = mixBudget.load(memory_order_relaxed);
+                return budget < maxVoices ? budget : maxVoices;
+            }
+
+            int AudioEngine::GetSampleRate()
+            {
+                return sampleRate;
+            }
+
+            int AudioEngine::CreateBus()
+            {
+                for (Uint32 i = 0; i < MaxBuses; i++)
+                {
+                    if (!buses[i].active.load(memory_order_relaxed))
+                    {
+                        buses[i].output.store(-1, memory_order_relaxed);
+                        buses[i].gainLeft.store(1.0f, memory_order_relaxed);
+                        buses[i].gainRight.store(1.0f, memory_order_relaxed);
+                        for (Uint32 j = 0; j < MaxInserts; j++)
+                        {
+                            buses[i].inserts[j].type.store((int)AudioInsertType::None, memory_order_relaxed);
+                        }
+                        buses[i].active.store(true, memory_order_release);
+                        return (int)i;
+                    }
+                }
+                Log.Error("Failed to create audio bus, all {0} buses are in use!", MaxBuses);
+                return -1;
+            }
+
+            void AudioEngine::DestroyBus(int bus)
+            {
+                if (bus < 0 || bus >= (int)MaxBuses)
+                {
+                    return;
+                }
+                buses[bus].active.store(false, memory_order_release);
+                for (Uint32 i = 0; i < MaxBuses; i++)
+                {
+                    if (buses[i].output.load(memory_order_relaxed) == bus)
+                    {
+                        buses[i].output.store(-1, memory_order_relaxed);
+                    }
+                }
+                for (Uint32 i = 0; i < maxVoices; i++)
+                {
+                    if (voices[i].bus.load(memory_order_relaxed) == bus)
+                    {
+                        voices[i].bus.store(-1, memory_order_relaxed);
+                    }
+                }
+            }
+
+            void AudioEngine::SetBusOutput(int bus, int output)
+            {
+                if (bus >= 0 && bus < (int)MaxBuses)
+                {
+                    buses[bus].output.store(output != bus ? output : -1, memory_order_relaxed);
+                }
+            }
+
+            void AudioEngine::SetBusGain(int bus, float left, float right)
+            {
+                if (bus >= 0 && bus < (int)MaxBuses)
+                {
+                    buses[bus].gainLeft.store(left, memory_order_relaxed);
+                    buses[bus].gainRight.store(right, memory_order_relaxed);
+                }
+            }
+
+            void AudioEngine::SetBusInsert(int bus, Uint32 index, const AudioInsert& insert)
+            {
+                if (bus < 0 || bus >= (int)MaxBuses || index >= MaxInserts)
+                {
+                    Log.Warning("Invalid audio bus insert [{0}] on bus {1}.", index, bus);
+                    return;
+                }
+                Insert& target = buses[bus].inserts[index];
+                target.gain.store(insert.gain, memory_order_relaxed);
+                target.cutoff.store(insert.cutoff, memory_order_relaxed);
+                target.threshold.store(insert.threshold, memory_order_relaxed);
+                target.ratio.store(insert.ratio, memory_order_relaxed);
+                target.attack.store(insert.attack, memory_order_relaxed);
+                target.release.store(insert.release, memory_order_relaxed);
+                target.type.store((int)insert.type, memory_order_release);
+            }
+
+            AudioInsert AudioEngine::GetBusInsert(int bus, Uint32 index)
+            {
+                AudioInsert insert;
+                if (bus >= 0 && bus < (int)MaxBuses && index < MaxInserts)
+                {
+                    Insert& source = buses[bus].inserts[index];
+                    insert.type = (AudioInsertType)source.type.load(memory_order_relaxed);
+                    insert.gain = source.gain.load(memory_order_relaxed);
+                    insert.cutoff = source.cutoff.load(memory_order_relaxed);
+                    insert.threshold = source.threshold.load(memory_order_relaxed);
+                    insert.ratio = source.ratio.load(memory_order_relaxed);
+                    insert.attack = source.attack.load(memory_order_relaxed);
+                    insert.release = source.release.load(memory_order_relaxed);
+                }
+                return insert;
+            }
+
+            void AudioEngine::PostMix(void* data, Uint8* stream, int length)
+            {
+                AudioEngine* engine = (AudioEngine*)data;
+#if defined(OSSIUM_AUDIO_SSE)
+                // Filter tails decay into denormals, which are very slow on x86.
+                _mm_setcsr(_mm_getcsr() | 0x8040);
+#endif
+                int channels = engine->deviceChannels;
+                Uint32 frameBytes = (SDL_AUDIO_BITSIZE(engine->deviceFormat) / 8) * channels;
+                Uint32 frames = frameBytes > 0 ? (Uint32)length / frameBytes : 0;
+                float* mixed = &engine->mixBuffer[0];
+
+                for (Uint32 offset = 0; offset < frames; offset += BlockFrames)
+                {
+                    Uint32 count = frames - offset < BlockFrames ? frames - offset : BlockFrames;
+                    engine->Render(mixed, count);
+
+                    // Add to whatever SDL_mixer has already mixed (music), converting to the device format.
+                    if (engine->deviceFormat == AUDIO_F32SYS)
+                    {
+                        float* out = (float*)stream + offset * channels;
+                        for (Uint32 i = 0; i < count; i++)
+                        {
+                            if (channels == 1)
+                            {
+                                out[i] += (mixed[i * 2] + mixed[i * 2 + 1]) * 0.5f;
+                            }
+                            else
+                            {
+                                out[i * channels] += mixed[i * 2];
+                                out[i * channels + 1] += mixed[i * 2 + 1];
+                            }
+                        }
+                    }
+                    else
+                    {
+                        Sint16* out = (Sint16*)stream + offset * channels;
+                        for (Uint32 i = 0; i < count; i++)
+                        {
+                            for (int c = 0, countc = channels < 2 ? channels : 2; c < countc; c++)
+                            {
+                                float sample = channels == 1 ? (mixed[i * 2] + mixed[i * 2 + 1]) * 0.5f : mixed[i * 2 + c];
+                                int value = (int)out[i * channels + c] + (int)(sample * 32767.0f);
+                                out[i * channels + c] = (Sint16)(value > 32767 ? 32767 : (value < -32768 ? -32768 : value));
+                            }
+                        }
+                    }
+                }
+            }
+
+        }
+
+    }
+
+}
@@ -0,0 +1,429 @@
+/** COPYRIGHT NOTICE
+ *
+ *  Ossium Engine
+ *  Copyright (c) 2018-2020 Tim Lane
+ *
+ *  This software is provided 'as-is', without any express or implied warranty. In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+ *
+ *  2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+ *
+ *  3. This notice may not be removed or altered from any source distribution.
+ *
+**/
+#ifndef AUDIOENGINE_H
+#define AUDIOENGINE_H
+extern "C"
+{
+    #include <SDL.h>
+}
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "funcutils.h"
+#include "spscqueue.h"
+#include "audiodecoder.h"
+
+namespace Ossium
+{
+
+    inline namespace Audio
+    {
+
+        /// Forward declaration
+        class OSSIUM_EDL AudioPlayer;
+
+        /// Types of DSP effect that can be inserted on an audio bus.
+        enum class AudioInsertType : Uint8
+        {
+            None = 0,
+            Gain,
+            LowPass,
+            Compressor
+        };
+
+        /// Settings for a single DSP insert on an audio bus. Only the settings relevant to the insert type are used.
+        struct OSSIUM_EDL AudioInsert
+        {
+            AudioInsertType type = AudioInsertType::None;
+
+            /// Linear gain applied to the output of the insert. For the compressor, this is the makeup gain.
+            float gain = 1.0f;
+
+            /// Low-pass cutoff frequency in hertz.
+            float cutoff = 20000.0f;
+
+            /// Compressor threshold as a linear amplitude.
+            float threshold = 1.0f;
+
+            /// Compressor ratio, e.g. 4 for 4:1 compression above the threshold.
+            float ratio = 1.0f;
+
+            /// Compressor attack time in seconds.
+            float attack = 0.01f;
+
+            /// Compressor release time in seconds.
+            float release = 0.1f;
+
+            static AudioInsert Gain(float gain);
+            static AudioInsert LowPass(float cutoff);
+            static AudioInsert Compressor(float threshold, float ratio, float attack = 0.01f, float release = 0.1f, float makeupGain = 1.0f);
+
+        };
+
+        namespace Internals
+        {
+
+            /// Mixing kernels used by the audio engine. All buffers are interleaved stereo floats.
+            namespace MixKernels
+            {
+
+                /// Adds frames from src to dst, ramping the left and right gains linearly from the start values to the end values.
+                OSSIUM_EDL void MixStereo(float* dst, const float* src, Uint32 frames, float startLeft, float startRight, float endLeft, float endRight);
+
+                /// Scales frames in place, ramping the left and right gains linearly from the start values to the end values.
+                OSSIUM_EDL void ScaleStereo(float* buffer, Uint32 frames, float startLeft, float startRight, float endLeft, float endRight);
+
+                /// Resamples src into dst with linear interpolation, starting at a 32.32 fixed point frame position and advancing by step per frame.
+                /// Stops when dst is full or the position passes the end of src; returns the number of frames written.
+                OSSIUM_EDL Uint32 Resample(float* dst, Uint32 frames, const float* src, Uint32 srcFrames, Uint64& position, Uint64 step);
+
+                /// Calculates stereo gains for a volume and panning angle (0 = centre, 90 = right, 270 = left).
+                OSSIUM_EDL void PanGains(float volume, Sint16 angle, float& left, float& right);
+
+            }
+
+            /// Software mixing engine. Voices play sample data into a graph of buses, each of which sums its inputs,
+            /// runs its DSP inserts and feeds its output bus (or the device output if it has none).
+            /// Voices can be virtualised, in which case they keep advancing their play cursor but are not mixed;
+            /// at most GetMixBudget() voices are mixed at once, chosen by priority, and any others are treated as virtual.
+            /** Voices and buses are controlled from the main thread and mixed on the audio thread, which never blocks or allocates;
+             *  all communication between the two is through atomics and lock-free queues.
+             *  Output is mixed into the SDL_mixer stream via a post-mix hook, so it works with any SDL audio driver,
+             *  e.g. set SDL_AUDIODRIVER to "disk" to write the output to a file. Render() can also be called directly for offline mixing. */
+            class OSSIUM_EDL AudioEngine : public Singleton<AudioEngine>
+            {
+            public:
+                /// Maximum number of buses that can exist at once.
+                static constexpr Uint32 MaxBuses = 64;
+
+                /// Maximum number of DSP inserts on each bus.
+                static constexpr Uint32 MaxInserts = 4;
+
+                /// Maximum number of frames mixed in one pass; larger requests are split into blocks of this size.
+                static constexpr Uint32 BlockFrames = 512;
+
+                /// Number of frames decoded at a time for streaming voices.
+                static constexpr Uint32 StreamChunkFrames = 4096;
+
+                /// Number of decoded frames buffered ahead for each streaming voice. This bounds the memory used by a stream.
+                static constexpr Uint32 StreamBufferFrames = 32768;
+
+                AudioEngine() = default;
+                ~AudioEngine();
+
+                /// Allocates voices and hooks into the output of the audio device opened by SDL_mixer. Returns false on error.
+                bool Init(Uint32 maxVoices = 1024, Uint32 mixBudget = 256);
+
+                /// Unhooks from the audio device and frees all voices.
+                void Clear();
+
+                /// Allocates voices and mixing buffers without hooking into an audio device. Not thread safe.
+                void Setup(Uint32 maxVoices, int sampleRate);
+
+                /// Mixes the next frames of all voices into output as interleaved stereo floats, overwriting the contents.
+                /// Must only be called by the audio thread, or by the main thread when the engine is not hooked into a device.
+                void Render(float* output, Uint32 frames);
+
+                /// Handles voices that have finished playing since the last call. Call once per frame from the main thread.
+                void Update();
+
+                /// Starts playing interleaved stereo float samples on a free voice, returning the voice index or -1 if there are no free voices.
+                /// The owner is notified via OnPlayFinished() when the voice finishes. repeats < 0 loops forever.
+                int PlayVoice(AudioPlayer* owner, const float* samples, Uint32 frames, int bus, float left, float right, int repeats = 0, float pitch = 1.0f);
+
+                /// Starts streaming an audio file (see AudioDecoder::Create() for supported types) on a free voice,
+                /// returning the voice index or -1 on failure. The file is decoded in chunks on a background thread, so memory use
+                /// doesn't depend on the length of the file. Streaming voices always play at the original pitch.
+                int StreamVoice(AudioPlayer* owner, const std::string& path, int bus, float left, float right, int repeats = 0);
+
+                /// Fades out and stops a voice. The owner is detached and won't be notified.
+                void StopVoice(int voice);
+
+                /// Pauses or resumes a voice.
+                void SetVoicePaused(int voice, bool paused);
+
+                /// Sets the gain of each stereo channel of a voice. Changes are ramped over the next block.
+                void SetVoiceGain(int voice, float left, float right);
+
+                /// Sets the playback rate of a voice, where 1 is the original pitch.
+                void SetVoicePitch(int voice, float pitch);
+
+                /// Routes a voice to a bus, or to the device output if bus < 0.
+                void SetVoiceBus(int voice, int bus);
+
+                /// Virtualises a voice or makes it real again. Virtual voices are faded out and are no longer mixed,
+                /// but their play cursor keeps advancing so they resume in the right place.
+                void SetVoiceVirtual(int voice, bool virtualise);
+
+                /// Returns true if the voice is virtual.
+                bool IsVoiceVirtual(int voice);
+
+                /// Sets the priority of a voice. When more voices are playing than the mix budget allows,
+                /// those with the highest priority are mixed and the rest are treated as virtual. Voices start with priority 0.
+                void SetVoicePriority(int voice, float priority);
+
+                /// Immediately stops all voices playing the sample data, waiting for the audio thread to stop reading it.
+                /// Owners of the stopped voices are notified immediately.
+                void StopAllUsing(const float* samples);
+
+                /// Returns the number of voices currently allocated to playback.
+                Uint32 GetActiveVoices();
+
+                /// Returns the total number of voices.
+                Uint32 GetMaxVoices();
+
+                /// Returns the number of voices allocated to playback that are not virtual.
+                Uint32 GetRealVoices();
+
+                /// Sets the maximum number of voices that are mixed at once.
+                void SetMixBudget(Uint32 budget);
+
+                /// Returns the maximum number of voices that are mixed at once.
+                Uint32 GetMixBudget();
+
+                /// Returns the output sample rate.
+                int GetSampleRate();
+
+                /// Allocates a bus, returning the bus index or -1 if there are no free buses.
+                int CreateBus();
+
+                /// Frees a bus. Anything routed to it is routed to the device output instead.
+                void DestroyBus(int bus);
+
+                /// Routes the output of a bus into another bus, or to the device output if output < 0.
+                void SetBusOutput(int bus, int output);
+
+                /// Sets the gain of each stereo channel of a bus. Changes are ramped over the next block.
+                void SetBusGain(int bus, float left, float right);
+
+                /// Sets a DSP insert on a bus. Inserts are processed in index order.
+                void SetBusInsert(int bus, Uint32 index, const AudioInsert& insert);
+
+                /// Returns the settings of a DSP insert on a bus.
+                AudioInsert GetBusInsert(int bus, Uint32 index);
+
+            private:
+                NOCOPY(AudioEngine);
+
+                /// Voice playback states.
+                enum VoiceState
+                {
+                    VOICE_FREE = 0,
+                    VOICE_PLAYING,
+                    VOICE_STOPPING,
+                    VOICE_FINISHED
+                };
+
+                /// A file being streamed, decoded ahead on the decoder thread and read by the audio thread.
+                struct Stream
+                {
+                    ~Stream();
+
+                    /// Decodes up to the specified number of chunks while there is space in the ring buffer.
+                    /// Returns true if any data was decoded. Only called by the decoder thread, or before the stream is playing.
+                    bool Fill(Uint32 chunks);
+
+                    /// Converts decoded audio to stereo floats at the output sample rate.
+                    AudioDecoder* decoder = nullptr;
+                    SDL_AudioStream* converter = NULL;
+
+                    /// Converted samples waiting to be mixed.
+                    SPSCQueue<float> ring;
+
+                    /// Scratch buffers for decoding and conversion.
+                    std::vector<float> decoded;
+                    std::vector<float> converted;
+
+                    /// Remaining repeats of the file; < 0 loops forever.
+                    int repeats = 0;
+
+                    /// Whether the converter has been flushed after the final repeat.
+                    bool flushed = false;
+
+                    /// Set once all the audio has been pushed to the ring buffer.
+                    std::atomic<bool> complete = {false};
+
+                    /// Set by the main thread once no voice uses the stream, so the decoder thread can delete it.
+                    std::atomic<bool> released = {false};
+                };
+
+                struct Voice
+                {
+                    /// Playback state, shared by both threads.
+                    std::atomic<int> state = {VOICE_FREE};
+                    std::atomic<bool> paused = {false};
+                    std::atomic<bool> virtualised = {false};
+                    std::atomic<int> bus = {-1};
+                    std::atomic<float> gainLeft = {0.0f};
+                    std::atomic<float> gainRight = {0.0f};
+                    std::atomic<float> pitch = {1.0f};
+                    std::atomic<float> priority = {0.0f};
+
+                    /// Set by the main thread before the voice starts playing; read-only while playing.
+                    const float* samples = nullptr;
+                    Uint32 frames = 0;
+                    Stream* stream = nullptr;
+
+                    /// Only used by the main thread.
+                    AudioPlayer* owner = nullptr;
+                    bool real = false;
+
+                    /// Only used by the audio thread while playing.
+                    Uint64 position = 0;
+                    int repeats = 0;
+                    float lastLeft = 0.0f;
+                    float lastRight = 0.0f;
+
+                    /// Whether the voice missed out on the mix budget this render. Only used by the audio thread,
+                    /// and only after it has seen the voice playing, so the main thread never touches it.
+                    bool overBudget = false;
+                };
+
+                struct Insert
+                {
+                    /// Settings, written by the main thread.
+                    std::atomic<int> type = {(int)AudioInsertType::None};
+                    std::atomic<float> gain = {1.0f};
+                    std::atomic<float> cutoff = {20000.0f};
+                    std::atomic<float> threshold = {1.0f};
+                    std::atomic<float> ratio = {1.0f};
+                    std::atomic<float> attack = {0.01f};
+                    std::atomic<float> release = {0.1f};
+
+                    /// Processing state, only used by the audio thread.
+                    int activeType = (int)AudioInsertType::None;
+                    float activeCutoff = 0.0f;
+                    float b0 = 0.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+                    float z[2][2] = {{0.0f, 0.0f}, {0.0f, 0.0f}};
+                    float envelope = 0.0f;
+                };
+
+                struct Bus
+                {
+                    /// Settings, written by the main thread.
+                    std::atomic<bool> active = {false};
+                    std::atomic<int> output = {-1};
+                    std::atomic<float> gainLeft = {1.0f};
+                    std::atomic<float> gainRight = {1.0f};
+                    Insert inserts[MaxInserts];
+
+                    /// Only used by the audio thread.
+                    float lastLeft = 1.0f;
+                    float lastRight = 1.0f;
+                };
+
+                /// Marks the lowest priority voices over the mix budget so they aren't mixed this render.
+                void ApplyMixBudget();
+
+                /// Mixes a single block of up to BlockFrames frames.
+                void RenderBlock(float* output, Uint32 frames, const int* routing, const Uint32* order, Uint32 numOrdered);
+
+                /// Mixes a single voice into the target buffer, fading it out if silence is true. Returns false when the voice has finished.
+                bool RenderVoice(Voice& voice, float* target, Uint32 frames, bool silence);
+
+                /// Advances the play cursor of a voice without mixing it. Returns false when the voice has finished.
+                bool AdvanceVoice(Voice& voice, Uint32 frames);
+
+                /// Runs the DSP inserts of a bus over a block.
+                void ProcessInserts(Bus& bus, float* buffer, Uint32 frames);
+
+                /// Marks a voice as finished from the audio thread.
+                void FinishVoice(Uint32 index);
+
+                /// Returns a finished voice to the free list. Main thread only.
+                void ReleaseVoice(Uint32 index);
+
+                /// Starts playing either sample data or a stream on a free voice.
+                int StartVoice(AudioPlayer* owner, const float* samples, Uint32 frames, Stream* stream, int bus, float left, float right, int repeats, float pitch);
+
+                /// Stops the decoder thread and deletes all streams.
+                void StopDecoder();
+
+                /// Tops up the ring buffers of all streams.
+                static int DecoderThread(void* engine);
+
+                /// SDL_mixer post-mix callback.
+                static void PostMix(void* engine, Uint8* stream, int length);
+
+                /// All voices.
+                Voice* voices = nullptr;
+
+                /// Total number of voices.
+                Uint32 maxVoices = 0;
+
+                /// Number of allocated voices that are not virtual. Main thread only.
+                Uint32 realVoices = 0;
+
+                /// Maximum number of voices mixed at once.
+                std::atomic<Uint32> mixBudget = {0xFFFFFFFF};
+
+                /// Indices of free voices. Main thread only.
+                std::vector<Uint32> freeVoices;
+
+                /// Voices that finished playing on the audio thread, waiting to be released on the main thread.
+                SPSCQueue<Uint32> finishedVoices;
+
+                /// All buses.
+                Bus buses[MaxBuses];
+
+                /// Mixing buffers for each bus.
+                std::vector<float> busBuffers;
+
+                /// Voices competing for the mix budget and a snapshot of their priorities, used by ApplyMixBudget().
+                std::vector<Uint32> budgetCandidates;
+                std::vector<float> budgetPriorities;
+
+                /// Scratch buffer for rendering voices before they are mixed.
+                std::vector<float> voiceBuffer;
+
+                /// Intermediate buffer when converting to the device format.
+                std::vector<float> mixBuffer;
+
+                /// Output sample rate, format and channel count.
+                int sampleRate = 44100;
+                Uint16 deviceFormat = AUDIO_F32SYS;
+                int deviceChannels = 2;
+
+                /// Whether the engine is hooked into the SDL_mixer output.
+                bool hooked = false;
+
+                /// All streams, including released streams waiting to be deleted. Guarded by streamLock.
+                std::vector<Stream*> streams;
+
+                /// Background thread that decodes streams.
+                SDL_Thread* decoderThread = NULL;
+
+                /// Guards the streams array and decoderQuit.
+                SDL_mutex* streamLock = NULL;
+
+                /// Wakes the decoder thread.
+                SDL_cond* streamSignal = NULL;
+
+                /// Tells the decoder thread to exit.
+                bool decoderQuit = false;
+
+            };
+
+        }
+
+    }
+
+}
+
+#endif // AUDIOENGINE_H
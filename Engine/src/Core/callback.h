@@ -34,7 +34,7 @@ namespace Ossium
         /// Calls all listeners, passing in a reference to the caller.
         void operator()(Args...args)
         {
-            for (auto func : callees)
+            for (auto& func : callees)
             {
                 func.second(args...);
             }
@@ -15,6 +15,7 @@
  *
 **/
 #include <cmath>
+#include "bgfx/bgfx.h"
 
 #include "colors.h"
 #include "funcutils.h"
@@ -34,6 +35,30 @@ namespace Ossium
         return output;
     }
 
+    SDL_BlendMode GetPremultipliedBlendMode()
+    {
+        static const SDL_BlendMode premultiplied = SDL_ComposeCustomBlendMode(
+            SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+            SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD
+        );
+        return premultiplied;
+    }
+
+    Uint64 GetBlendState(SDL_BlendMode blending)
+    {
+        switch (blending)
+        {
+        case SDL_BLENDMODE_NONE:
+            return 0;
+        case SDL_BLENDMODE_ADD:
+            return BGFX_STATE_BLEND_ADD;
+        case SDL_BLENDMODE_MOD:
+            return BGFX_STATE_BLEND_MULTIPLY;
+        default:
+            return blending == GetPremultipliedBlendMode() ? OSSIUM_BLEND_PREMULTIPLIED : OSSIUM_BLEND_STANDARD;
+        }
+    }
+
     SDL_Color operator-(SDL_Color c, int brightness)
     {
         c.r = (Uint8)max((int)c.r - brightness, 0);
@@ -28,6 +28,9 @@ extern "C"
 
 #define OSSIUM_BLEND_STANDARD BGFX_STATE_BLEND_FUNC_SEPARATE(BGFX_STATE_BLEND_SRC_ALPHA, BGFX_STATE_BLEND_INV_SRC_ALPHA, BGFX_STATE_BLEND_ONE, BGFX_STATE_BLEND_INV_SRC_ALPHA)
 
+/// Blending for colours that are already multiplied by their alpha, such as render textures drawn to with OSSIUM_BLEND_STANDARD
+#define OSSIUM_BLEND_PREMULTIPLIED BGFX_STATE_BLEND_FUNC(BGFX_STATE_BLEND_ONE, BGFX_STATE_BLEND_INV_SRC_ALPHA)
+
 namespace Ossium
 {
 
@@ -56,6 +59,12 @@ namespace Ossium
     /// Converts raw pixel data into an SDL_Colour. Effectively the opposite of the SDL_MapRGBA() function
     OSSIUM_EDL SDL_Color ConvertToColor(Uint32 pixel, SDL_PixelFormat* pixelFormat);
 
+    /// Returns the blend mode for textures whose colours are already multiplied by their alpha.
+    OSSIUM_EDL SDL_BlendMode GetPremultipliedBlendMode();
+
+    /// Returns the bgfx blend state equivalent to an SDL blend mode. Unknown custom blend modes use standard alpha blending.
+    OSSIUM_EDL Uint64 GetBlendState(SDL_BlendMode blending);
+
     SDL_Color operator-(SDL_Color color, int brightness);
     SDL_Color operator+(SDL_Color color, int brightness);
 
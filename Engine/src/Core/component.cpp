@@ -36,10 +36,20 @@ namespace Ossium
 
     REGISTER_ABSTRACT_COMPONENT(GraphicComponent);
 
+    bool GraphicComponent::GetDrawBounds(Rect& bounds)
+    {
+        return false;
+    }
+
     ///
     /// RenderComponent
     ///
 
     REGISTER_ABSTRACT_COMPONENT(RenderComponent);
 
+    bool RenderComponent::GetRenderBounds(Vector3& centre, float& radius)
+    {
+        return false;
+    }
+
 }
@@ -35,6 +35,11 @@ namespace Ossium
     // General purpose component that a Canvas can render.
     class OSSIUM_EDL GraphicComponent : public Graphic, public Component
     {
+    public:
+        // Outputs the screen space area this graphic draws within, so it can be culled when outside the viewport.
+        // Returns false if the area is unknown, in which case the graphic is always drawn.
+        virtual bool GetDrawBounds(Rect& bounds);
+
     protected:
         DECLARE_ABSTRACT_COMPONENT(Component, GraphicComponent);
 
@@ -45,6 +50,11 @@ namespace Ossium
     // General purpose component that a Camera can render.
     class OSSIUM_EDL RenderComponent : public Renderable, public Component
     {
+    public:
+        // Outputs a world space bounding sphere enclosing everything this component renders, so it can be culled
+        // when outside the camera frustum. Returns false if the bounds are unknown, in which case it is always rendered.
+        virtual bool GetRenderBounds(Vector3& centre, float& radius);
+
     protected:
         DECLARE_ABSTRACT_COMPONENT(Component, RenderComponent);
 
@@ -37,6 +37,9 @@ namespace Ossium
         M(bool, hardwareAcceleration) = true;
         M(int, totalRenderLayers) = 100;
         M(float, fpscap) = 0;
+        M(float, tickrate) = 120.0f;
+        M(bool, renderThread) = false;
+        M(int, workerThreads) = -1;
         M(char, filtering) = '1';
         M(unsigned int, mastervolume) = 100;
         M(std::vector<std::string>, startScenes) = {};
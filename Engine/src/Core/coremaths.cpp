@@ -15,11 +15,11 @@
  *
 **/
 #include <cmath>
+#include <algorithm>
 
 #include "funcutils.h"
 #include "stringconvert.h"
 #include "coremaths.h"
-#include "shader.h"
 
 using namespace std;
 
@@ -337,6 +337,32 @@ namespace Ossium
         return Utilities::ToString(GetDegrees());
     }
 */
+    // Records a draw call of 2D shapes with the default shaders, in screen space of the renderer
+    static void DrawShape(RenderInput* pass, const Vertex2D* vertices, Uint32 vertexCount, const uint16_t* indices, Uint32 indexCount)
+    {
+        Renderer* renderer = pass->GetRenderer();
+
+        // Setup transform and projection matrix
+        Matrix<4, 4> view = Matrix<4, 4>::Identity();
+        Matrix<4, 4> proj = Matrix<4, 4>::Orthographic(
+            0, renderer->GetWidth(), renderer->GetHeight(), 0, 0, 100
+        );
+        renderer->SetViewTransform(pass, view, proj);
+
+        DrawCall call;
+        call.layout = &Vertex2D::Layout();
+        call.vertices = vertices;
+        call.vertexCount = vertexCount;
+        call.indices = indices;
+        call.indexCount = indexCount;
+        call.program = renderer->GetProgram("default.vert", "default.frag");
+        call.state = renderer->GetState();
+        call.rgba = renderer->GetDrawColorUint32();
+        call.layer = renderer->GetDrawLayer();
+        call.depth = renderer->GetDrawDepth();
+        renderer->Draw(pass, call);
+    }
+
     ///
     /// Point
     ///
@@ -357,54 +383,15 @@ namespace Ossium
     {
         Renderer* renderer = pass->GetRenderer();
 
-        // First, specify the layout of the data to pass to the GPU
-        bgfx::VertexLayout layout;
-        layout.begin()
-            .add(bgfx::Attrib::Position, 3, bgfx::AttribType::Float)
-            .add(bgfx::Attrib::Color0, 4, bgfx::AttribType::Uint8, true)
-        .end();
-        
         // Create the vertices
-        float vertices[1][4] = {
-            { round(x), round(y), 0.0f, (float)ColorToUint32(renderer->GetDrawColor(), SDL_PIXELFORMAT_ABGR8888) }
+        Vertex2D vertices[] = {
+            { round(x), round(y), renderer->GetDrawColorUint32() }
         };
-        // Create index array
-        uint16_t indices[] = { 0 };
 
         // Set primitive type to points
         renderer->SetState((renderer->GetState() & (~BGFX_STATE_PT_MASK)) | BGFX_STATE_PT_POINTS);
-        bgfx::setState(renderer->GetState(), renderer->GetDrawColorUint32());
-
-        // Create a VBO
-        bgfx::VertexBufferHandle vbo = bgfx::createVertexBuffer(
-            bgfx::copy(vertices, sizeof(vertices)),
-            layout
-        );
 
-        // Create an IBO
-        // TODO: check if this is necessary for points?
-        bgfx::IndexBufferHandle ibo = bgfx::createIndexBuffer(bgfx::copy(indices, sizeof(indices)));
-
-        // Load the vertex and fragment shaders
-        // TODO load shaders elsewhere
-        Shader vshader;
-        vshader.LoadAndInit(Shader::GetPath("default.vert"));
-        Shader fshader;
-        fshader.LoadAndInit(Shader::GetPath("default.frag"));
-        bgfx::ProgramHandle program = bgfx::createProgram(vshader.GetHandle(), fshader.GetHandle());
-
-        // Setup transform and projection matrix
-        Matrix<4, 4> view = Matrix<4, 4>::Identity();
-        Matrix<4, 4> proj = Matrix<4, 4>::Identity();
-
-        bgfx::setViewTransform(pass->GetID(), &view, &proj);
-        bgfx::setVertexBuffer(0, vbo);
-        bgfx::setIndexBuffer(ibo);
-
-        // Submit the draw call
-        bgfx::submit(pass->GetID(), program);
-
-        bgfx::destroy(program);
+        DrawShape(pass, vertices, 1, nullptr, 0);
     }
 
     void Point::Draw(RenderInput* pass, SDL_Color color)
@@ -464,17 +451,35 @@ namespace Ossium
     /// Circle
     ///
 
-    /// TODO: use a more efficient drawing algorithm
     void Circle::Draw(RenderInput* pass, float smoothness)
     {
-        int segments = r * r * Utilities::Clamp(smoothness);
+        Renderer* renderer = pass->GetRenderer();
+
+        // All segments are drawn as a single line list, sharing vertices between neighbouring segments
+        int segments = Utilities::Clamp((int)(r * r * Utilities::Clamp(smoothness)), 0, (int)UINT16_MAX);
+        if (segments < 2)
+        {
+            return;
+        }
+        Uint32 color0 = renderer->GetDrawColorUint32();
+        vector<Vertex2D> vertices(segments);
+        vector<uint16_t> indices(segments * 2);
         for (int i = 0; i < segments; i++)
         {
-            Line(
-                Point(x + r * sin(((Constants::pi * 2) / segments) * i), y + r * cos(((Constants::pi * 2) / segments) * i)),
-                Point(x + r * sin(((Constants::pi * 2) / segments) * (i + 1)), y + r * cos(((Constants::pi * 2) / segments) * (i + 1)))
-            ).Draw(pass);
+            float angle = ((Constants::pi * 2) / segments) * i;
+            vertices[i] = { x + r * (float)sin(angle), y + r * (float)cos(angle), color0 };
+            indices[i * 2] = (uint16_t)i;
+            indices[i * 2 + 1] = (uint16_t)((i + 1) % segments);
         }
+
+        renderer->SetState(0
+            | BGFX_STATE_PT_LINES
+            | BGFX_STATE_WRITE_RGB
+            | BGFX_STATE_WRITE_A
+            | OSSIUM_BLEND_STANDARD
+        );
+
+        DrawShape(pass, vertices.data(), segments, indices.data(), segments * 2);
     }
 
     void Circle::Draw(RenderInput* pass, SDL_Color color, float smoothness)
@@ -547,24 +552,6 @@ namespace Ossium
         b = end;
     }
 
-    // TODO sort this out...
-    struct Vertex2D
-    {
-        float x;
-        float y;
-        Uint32 color0;
-
-        static bgfx::VertexLayout Layout()
-        {
-            bgfx::VertexLayout layout;
-            layout.begin()
-                .add(bgfx::Attrib::Position, 2, bgfx::AttribType::Float)
-                .add(bgfx::Attrib::Color0, 4, bgfx::AttribType::Uint8, true)
-            .end();
-            return layout;
-        }
-    };
-
     void Line::Draw(RenderInput* pass)
     {
         Renderer* renderer = pass->GetRenderer();
@@ -589,39 +576,8 @@ namespace Ossium
             // Alpha opacity blending
             | OSSIUM_BLEND_STANDARD
         );
-        renderer->UpdateStateAndColor();
-
-        // Create buffers
-        bgfx::VertexBufferHandle vbo = bgfx::createVertexBuffer(
-            bgfx::copy(vertices, sizeof(vertices)),
-            Vertex2D::Layout()
-        );
-
-        // Load the vertex and fragment shaders
-        // TODO load shaders elsewhere
-        Shader vshader;
-        vshader.LoadAndInit(Shader::GetPath("default.vert"));
-        Shader fshader;
-        fshader.LoadAndInit(Shader::GetPath("default.frag"));
-        bgfx::ProgramHandle program = bgfx::createProgram(vshader.GetHandle(), fshader.GetHandle());
-
-        // Setup transform and projection matrix
-        Matrix<4, 4> view = Matrix<4, 4>::Identity();
-        Matrix<4, 4> proj = Matrix<4, 4>::Orthographic(
-            0, renderer->GetWidth(), renderer->GetHeight(), 0, 0, 100
-        );
-
-        bgfx::setViewTransform(pass->GetID(), &view, &proj);
-        bgfx::setVertexBuffer(0, vbo);
 
-        // Submit the draw call
-        bgfx::submit(pass->GetID(), program);
-
-        // TODO be less memory unfriendly
-        // Destroy everything - bgfx only frees them after the next frame() call
-        bgfx::destroy(vbo);
-
-        bgfx::destroy(program);
+        DrawShape(pass, vertices, 2, nullptr, 0);
     }
 
     void Line::Draw(RenderInput* pass, SDL_Color color)
@@ -691,39 +647,8 @@ namespace Ossium
             // Cull backfaces
             | BGFX_STATE_CULL_CW
         );
-        renderer->UpdateStateAndColor();
-
-        // Create a VBO
-        bgfx::VertexBufferHandle vbo = bgfx::createVertexBuffer(
-            bgfx::copy(vertices, sizeof(vertices)), Vertex2D::Layout()
-        );
-        // Create an IBO
-        bgfx::IndexBufferHandle ibo = bgfx::createIndexBuffer(bgfx::copy(indices, sizeof(indices)));
-
-        // Load the vertex and fragment shaders
-        // TODO load shaders elsewhere
-        Shader vshader;
-        vshader.LoadAndInit(Shader::GetPath("default.vert"));
-        Shader fshader;
-        fshader.LoadAndInit(Shader::GetPath("default.frag"));
-        bgfx::ProgramHandle program = bgfx::createProgram(vshader.GetHandle(), fshader.GetHandle());
-
-        // Setup transform and projection matrix
-        Matrix<4, 4> view = Matrix<4, 4>::Identity();
-        Matrix<4, 4> proj = Matrix<4, 4>::Orthographic(
-            0, renderer->GetWidth(), renderer->GetHeight(), 0, 0, 100
-        );
 
-        bgfx::setViewTransform(pass->GetID(), &view, &proj);
-        bgfx::setVertexBuffer(0, vbo);
-        bgfx::setIndexBuffer(ibo);
-        
-        // Submit the draw call
-        bgfx::submit(pass->GetID(), program);
-
-        bgfx::destroy(program);
-        bgfx::destroy(ibo);
-        bgfx::destroy(vbo);
+        DrawShape(pass, vertices, 4, indices, 6);
     }
 
     void Rect::DrawFilled(RenderInput* pass, SDL_Color color)
@@ -773,7 +698,8 @@ namespace Ossium
     }
     bool Rect::Intersects(Rect rect)
     {
-        return !((x > rect.xmax() || xmax() < rect.x) && (y > rect.ymax() || ymax() < rect.y));
+        // Compare as floats; xmax() and ymax() truncate to integers
+        return !(x > rect.x + rect.w || x + w < rect.x || y > rect.y + rect.h || y + h < rect.y);
     }
     bool Rect::Contains(Point point)
     {
@@ -820,7 +746,36 @@ namespace Ossium
 
     void Polygon::DrawFilled(RenderInput* pass)
     {
-        /// TODO: this
+        if (vertices.size() < 3 || vertices.size() > UINT16_MAX)
+        {
+            return;
+        }
+        Renderer* renderer = pass->GetRenderer();
+
+        // Draw as a triangle fan, so this only works for convex polygons
+        Uint32 color0 = renderer->GetDrawColorUint32();
+        vector<Vertex2D> points(vertices.size());
+        vector<uint16_t> indices;
+        indices.reserve((vertices.size() - 2) * 3);
+        for (unsigned int i = 0, counti = vertices.size(); i < counti; i++)
+        {
+            points[i] = { vertices[i].x, vertices[i].y, color0 };
+            if (i > 1)
+            {
+                indices.push_back(0);
+                indices.push_back((uint16_t)(i - 1));
+                indices.push_back((uint16_t)i);
+            }
+        }
+
+        // The vertices may wind either way, so don't cull
+        renderer->SetState(0
+            | BGFX_STATE_WRITE_RGB
+            | BGFX_STATE_WRITE_A
+            | OSSIUM_BLEND_STANDARD
+        );
+
+        DrawShape(pass, points.data(), points.size(), indices.data(), indices.size());
     }
 
     void Polygon::DrawFilled(RenderInput* pass, SDL_Color color)
@@ -837,19 +792,105 @@ namespace Ossium
 
     void Polygon::Draw(RenderInput* pass)
     {
-        if (!vertices.empty())
+        if (vertices.size() < 2 || vertices.size() > UINT16_MAX)
+        {
+            return;
+        }
+        Renderer* renderer = pass->GetRenderer();
+
+        // Draw all edges as a single line list
+        Uint32 color0 = renderer->GetDrawColorUint32();
+        vector<Vertex2D> points(vertices.size());
+        vector<uint16_t> indices(vertices.size() * 2);
+        for (unsigned int i = 0, counti = vertices.size(); i < counti; i++)
+        {
+            points[i] = { vertices[i].x, vertices[i].y, color0 };
+            indices[i * 2] = (uint16_t)i;
+            indices[i * 2 + 1] = (uint16_t)((i + 1) % counti);
+        }
+
+        renderer->SetState(0
+            | BGFX_STATE_PT_LINES
+            | BGFX_STATE_WRITE_RGB
+            | BGFX_STATE_WRITE_A
+            | OSSIUM_BLEND_STANDARD
+        );
+
+        DrawShape(pass, points.data(), points.size(), indices.data(), indices.size());
+    }
+
+    ///
+    /// Frustum
+    ///
+
+    Frustum::Frustum(const Matrix<4, 4>& viewProj)
+    {
+        // Each plane is a sum or difference of the rows of the matrix (Gribb & Hartmann)
+        for (unsigned int i = 0; i < 4; i++)
+        {
+            float x = viewProj.data[i][0];
+            float y = viewProj.data[i][1];
+            float z = viewProj.data[i][2];
+            float w = viewProj.data[i][3];
+            planes[0][i] = w + x;
+            planes[1][i] = w - x;
+            planes[2][i] = w + y;
+            planes[3][i] = w - y;
+            planes[4][i] = z;
+            planes[5][i] = w - z;
+        }
+
+        // Normalise so distances to the planes are in world units
+        for (unsigned int i = 0; i < 6; i++)
+        {
+            float length = sqrt(planes[i][0] * planes[i][0] + planes[i][1] * planes[i][1] + planes[i][2] * planes[i][2]);
+            if (length > 0)
+            {
+                for (unsigned int j = 0; j < 4; j++)
+                {
+                    planes[i][j] /= length;
+                }
+            }
+        }
+    }
+
+    bool Frustum::Intersects(Vector3 centre, float radius)
+    {
+        for (unsigned int i = 0; i < 6; i++)
+        {
+            if (planes[i][0] * centre.x + planes[i][1] * centre.y + planes[i][2] * centre.z + planes[i][3] < -radius)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    float Frustum::GetDepth(Vector3 point)
+    {
+        float nearDistance = planes[4][0] * point.x + planes[4][1] * point.y + planes[4][2] * point.z + planes[4][3];
+        float farDistance = planes[5][0] * point.x + planes[5][1] * point.y + planes[5][2] * point.z + planes[5][3];
+        if (nearDistance + farDistance <= 0)
+        {
+            return 0;
+        }
+        return clamp(nearDistance / (nearDistance + farDistance), 0.0f, 1.0f);
+    }
+
+    bool Frustum::Intersects(Vector3 min, Vector3 max)
+    {
+        for (unsigned int i = 0; i < 6; i++)
         {
-            Point previousPoint = vertices[0];
-            Line renderLine = Line(previousPoint, Vector2::Zero);
-            for (unsigned int i = 1, counti = vertices.size(); i < counti; i++)
+            // Test the corner furthest along the plane normal
+            float x = planes[i][0] >= 0 ? max.x : min.x;
+            float y = planes[i][1] >= 0 ? max.y : min.y;
+            float z = planes[i][2] >= 0 ? max.z : min.z;
+            if (planes[i][0] * x + planes[i][1] * y + planes[i][2] * z + planes[i][3] < 0)
             {
-                renderLine.b = Point(vertices[i].x, vertices[i].y);
-                renderLine.Draw(pass);
-                previousPoint = vertices[i];
+                return false;
             }
-            renderLine.b = Point(vertices[0].x, vertices[0].y);
-            renderLine.Draw(pass);
         }
+        return true;
     }
 
 }
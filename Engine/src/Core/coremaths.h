@@ -383,6 +383,29 @@ namespace Ossium
 
     };
 
+    /// The volume visible to a camera, bounded by 6 planes.
+    struct OSSIUM_EDL Frustum
+    {
+        Frustum() = default;
+        /// Extracts the planes from a combined projection and view matrix, i.e. proj * view.
+        /// Assumes the clip space depth range is 0 to 1, as used by Matrix<4, 4>::Perspective().
+        Frustum(const Matrix<4, 4>& viewProj);
+
+        /// Whether or not a sphere is at least partially inside the frustum.
+        bool Intersects(Vector3 centre, float radius);
+        /// Whether or not an axis-aligned box is at least partially inside the frustum.
+        /// This is conservative; boxes near the corners of the frustum may be reported as intersecting when they are not.
+        bool Intersects(Vector3 min, Vector3 max);
+
+        /// Returns how far a point is from the near plane (0) to the far plane (1), clamped to that range.
+        float GetDepth(Vector3 point);
+
+        /// The planes in the order left, right, bottom, top, near, far.
+        /// Each plane normal points into the frustum and is stored as xyz, with the plane distance in w.
+        float planes[6][4];
+
+    };
+
 }
 
 #endif // VECTOR_H
@@ -0,0 +1,200 @@
+#include <cmath>
+
+#include "debugdraw.h"
+
+using namespace std;
+
+namespace Ossium
+{
+
+    DebugDraw::DebugDraw(Renderer* renderer)
+    {
+        this->renderer = renderer;
+        submitHandle = renderer->OnSubmit += [this] (Renderer& caller) { Flush(); };
+        removedHandle = renderer->OnInputRemoved += [this] (RenderInput* pass) { Forget(pass); };
+    }
+
+    DebugDraw::~DebugDraw()
+    {
+        renderer->OnSubmit -= submitHandle;
+        renderer->OnInputRemoved -= removedHandle;
+    }
+
+    void DebugDraw::AddLine(RenderInput* pass, Vector2 a, Vector2 b, SDL_Color color)
+    {
+        Uint32 color0 = ColorToUint32(color, SDL_PIXELFORMAT_RGBA32);
+        vector<Vertex2D>& lines = GetBatch(pass).lines;
+        lines.push_back({ a.x, a.y, color0 });
+        lines.push_back({ b.x, b.y, color0 });
+    }
+
+    void DebugDraw::AddTriangle(RenderInput* pass, Vector2 a, Vector2 b, Vector2 c, SDL_Color color)
+    {
+        Uint32 color0 = ColorToUint32(color, SDL_PIXELFORMAT_RGBA32);
+        vector<Vertex2D>& triangles = GetBatch(pass).triangles;
+        triangles.push_back({ a.x, a.y, color0 });
+        triangles.push_back({ b.x, b.y, color0 });
+        triangles.push_back({ c.x, c.y, color0 });
+    }
+
+    void DebugDraw::AddRect(RenderInput* pass, const Rect& rect, SDL_Color color, bool filled)
+    {
+        Vector2 corners[4] = {
+            Vector2(rect.x, rect.y),
+            Vector2(rect.x + rect.w, rect.y),
+            Vector2(rect.x + rect.w, rect.y + rect.h),
+            Vector2(rect.x, rect.y + rect.h)
+        };
+        if (filled)
+        {
+            AddTriangle(pass, corners[0], corners[1], corners[2], color);
+            AddTriangle(pass, corners[0], corners[2], corners[3], color);
+            return;
+        }
+        for (unsigned int i = 0; i < 4; i++)
+        {
+            AddLine(pass, corners[i], corners[(i + 1) % 4], color);
+        }
+    }
+
+    void DebugDraw::AddCircle(RenderInput* pass, Vector2 centre, float radius, SDL_Color color, unsigned int segments)
+    {
+        if (segments < 3)
+        {
+            return;
+        }
+        Vector2 previous = Vector2(centre.x, centre.y + radius);
+        for (unsigned int i = 1; i <= segments; i++)
+        {
+            float angle = ((Constants::pi * 2) / segments) * i;
+            Vector2 next = Vector2(centre.x + radius * (float)sin(angle), centre.y + radius * (float)cos(angle));
+            AddLine(pass, previous, next, color);
+            previous = next;
+        }
+    }
+
+    void DebugDraw::AddPolygon(RenderInput* pass, const Polygon& polygon, SDL_Color color, bool filled)
+    {
+        unsigned int count = polygon.vertices.size();
+        if (filled)
+        {
+            // Triangle fan, so only convex polygons are drawn correctly
+            for (unsigned int i = 2; i < count; i++)
+            {
+                AddTriangle(pass, polygon.vertices[0], polygon.vertices[i - 1], polygon.vertices[i], color);
+            }
+            return;
+        }
+        for (unsigned int i = 0; count > 1 && i < count; i++)
+        {
+            AddLine(pass, polygon.vertices[i], polygon.vertices[(i + 1) % count], color);
+        }
+    }
+
+    unsigned int DebugDraw::GetLineCount()
+    {
+        return lineCount;
+    }
+
+    unsigned int DebugDraw::GetTriangleCount()
+    {
+        return triangleCount;
+    }
+
+    DebugDraw::Batch& DebugDraw::GetBatch(RenderInput* pass)
+    {
+        // There are only ever a few views, so a linear search is fine
+        for (Batch& batch : batches)
+        {
+            if (batch.pass == pass)
+            {
+                return batch;
+            }
+        }
+        for (Batch& batch : batches)
+        {
+            if (batch.pass == nullptr)
+            {
+                batch.pass = pass;
+                return batch;
+            }
+        }
+        batches.push_back(Batch());
+        batches.back().pass = pass;
+        return batches.back();
+    }
+
+    void DebugDraw::Flush()
+    {
+        lineCount = 0;
+        triangleCount = 0;
+        for (Batch& batch : batches)
+        {
+            if (batch.pass != nullptr && batch.pass->GetRenderer() == renderer && batch.pass->GetViewMode() != bgfx::ViewMode::Sequential)
+            {
+                Log.Warning("Dropped debug shapes added to input '{0}', as they can only be drawn in inputs with a sequential view mode.", batch.pass->GetRenderDebugName());
+            }
+            else if (batch.pass != nullptr && batch.pass->GetRenderer() == renderer)
+            {
+                // Same transform as other shapes, see Line::Draw()
+                Matrix<4, 4> view = Matrix<4, 4>::Identity();
+                Matrix<4, 4> proj = Matrix<4, 4>::Orthographic(
+                    0, renderer->GetWidth(), renderer->GetHeight(), 0, 0, 100
+                );
+                renderer->SetViewTransform(batch.pass, view, proj);
+
+                Record(batch.pass, batch.triangles, 3, 0
+                    | BGFX_STATE_WRITE_RGB
+                    | BGFX_STATE_WRITE_A
+                    | OSSIUM_BLEND_STANDARD
+                );
+                Record(batch.pass, batch.lines, 2, 0
+                    | BGFX_STATE_PT_LINES
+                    | BGFX_STATE_WRITE_RGB
+                    | BGFX_STATE_WRITE_A
+                    | OSSIUM_BLEND_STANDARD
+                );
+                lineCount += batch.lines.size() / 2;
+                triangleCount += batch.triangles.size() / 3;
+            }
+
+            // Inputs may be destroyed before the next frame, so only keep the memory
+            batch.pass = nullptr;
+            batch.lines.clear();
+            batch.triangles.clear();
+        }
+    }
+
+    void DebugDraw::Forget(RenderInput* pass)
+    {
+        for (Batch& batch : batches)
+        {
+            if (batch.pass == pass)
+            {
+                batch.pass = nullptr;
+                batch.lines.clear();
+                batch.triangles.clear();
+            }
+        }
+    }
+
+    void DebugDraw::Record(RenderInput* pass, const vector<Vertex2D>& vertices, unsigned int verticesPerPrimitive, Uint64 state)
+    {
+        // Draw calls are limited to what 16 bit indices can address, without splitting primitives
+        unsigned int limit = (UINT16_MAX / verticesPerPrimitive) * verticesPerPrimitive;
+        for (unsigned int offset = 0, total = vertices.size(); offset < total; offset += limit)
+        {
+            DrawCall call;
+            call.layout = &Vertex2D::Layout();
+            call.vertices = &vertices[offset];
+            call.vertexCount = min(limit, total - offset);
+            call.program = renderer->GetProgram("default.vert", "default.frag");
+            call.state = state;
+            call.rgba = 0xFFFFFFFF;
+            // Debug shapes go on top of everything else drawn in the view
+            call.layer = 0xFF;
+            renderer->Draw(pass, call);
+        }
+    }
+
+}
@@ -0,0 +1,82 @@
+#ifndef DEBUGDRAW_H
+#define DEBUGDRAW_H
+
+#include <vector>
+
+#include "helpermacros.h"
+#include "services.h"
+#include "coremaths.h"
+
+namespace Ossium
+{
+
+    // Accumulates debug lines and triangles over a frame and draws them when the renderer submits,
+    // so any number of debug shapes drawn in a view costs a single draw call per primitive type.
+    // Shapes are in the screen space of the renderer and only last for the frame they are added in.
+    // The view transform is set to screen space, so shapes can only be drawn in inputs with a sequential view mode such as a Canvas.
+    // Shapes added to other inputs, e.g. a Camera, are dropped rather than overriding the perspective of the view.
+    class OSSIUM_EDL DebugDraw : public Service<DebugDraw>
+    {
+    public:
+        DebugDraw(Renderer* renderer);
+        ~DebugDraw();
+
+        // Adds a line to draw in the view of an input.
+        void AddLine(RenderInput* pass, Vector2 a, Vector2 b, SDL_Color color);
+
+        // Adds a filled triangle to draw in the view of an input.
+        void AddTriangle(RenderInput* pass, Vector2 a, Vector2 b, Vector2 c, SDL_Color color);
+
+        // Adds the outline of a rect, or a filled rect.
+        void AddRect(RenderInput* pass, const Rect& rect, SDL_Color color, bool filled = false);
+
+        // Adds the outline of a circle with the given number of segments.
+        void AddCircle(RenderInput* pass, Vector2 centre, float radius, SDL_Color color, unsigned int segments = 32);
+
+        // Adds the outline of a polygon, or a filled convex polygon.
+        void AddPolygon(RenderInput* pass, const Polygon& polygon, SDL_Color color, bool filled = false);
+
+        // Returns the number of lines and triangles drawn in the last frame.
+        unsigned int GetLineCount();
+        unsigned int GetTriangleCount();
+
+    private:
+        NOCOPY(DebugDraw);
+
+        // The shapes added to the view of an input this frame
+        struct Batch
+        {
+            RenderInput* pass;
+            std::vector<Vertex2D> lines;
+            std::vector<Vertex2D> triangles;
+        };
+
+        // Returns the batch for an input, adding one if necessary
+        Batch& GetBatch(RenderInput* pass);
+
+        // Records draw calls for each batch with the renderer
+        void Flush();
+
+        // Forgets the shapes added for an input, so a removed input is never drawn
+        void Forget(RenderInput* pass);
+
+        // Records vertices in draw calls small enough for 16 bit indices
+        void Record(RenderInput* pass, const std::vector<Vertex2D>& vertices, unsigned int verticesPerPrimitive, Uint64 state);
+
+        Renderer* renderer;
+
+        // Handles to the registered OnSubmit and OnInputRemoved callbacks
+        int submitHandle;
+        int removedHandle;
+
+        // Batches are kept between frames so their memory is reused
+        std::vector<Batch> batches;
+
+        unsigned int lineCount = 0;
+        unsigned int triangleCount = 0;
+
+    };
+
+}
+
+#endif // DEBUGDRAW_H
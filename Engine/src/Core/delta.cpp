@@ -19,6 +19,8 @@ extern "C"
     #include <SDL.h>
 }
 
+#include <algorithm>
+
 #include "delta.h"
 #include "funcutils.h"
 
@@ -29,7 +31,7 @@ namespace Ossium
 
     Delta::Delta()
     {
-        previousTicks = 0;
+        previousCounter = 0;
         deltaTime = 0;
         fpscap = 0;
     }
@@ -41,27 +43,80 @@ namespace Ossium
 
     void Delta::Update()
     {
-        deltaTime = ((float)SDL_GetTicks() - (float)previousTicks) / 1000.0f;
+        Uint64 now = SDL_GetPerformanceCounter();
         if (fpscap > 0)
         {
-            float maxDelta = 1.0f / fpscap;
-            if (deltaTime < maxDelta)
+            Uint64 period = (Uint64)(frequency / (double)fpscap);
+            if (now < nextFrame)
             {
-                SDL_Delay((Uint32)((maxDelta - deltaTime) * 1000.0f));
+                /// Sleep for most of the remaining time, then spin until the frame is due
+                double remaining = (double)(nextFrame - now) / frequency;
+                if (remaining > SpinTime)
+                {
+                    SDL_Delay((Uint32)((remaining - SpinTime) * 1000.0));
+                }
+                while ((now = SDL_GetPerformanceCounter()) < nextFrame)
+                {
+                }
             }
+            /// Schedule frames at a fixed period so timing errors don't accumulate, unless a frame is late
+            nextFrame = now - nextFrame >= period ? now + period : nextFrame + period;
+        }
+        deltaTime = (float)((double)(now - previousCounter) / frequency);
+        previousCounter = now;
+
+        if (fixedTime > 0)
+        {
+            accumulator += min((double)deltaTime, MaxFixedFrameTime);
         }
-        previousTicks = SDL_GetTicks();
     }
 
-    void Delta::Init(float fpsCap)
+    void Delta::Init(float fpsCap, float tickRate)
     {
         fpscap = fpsCap;
-        previousTicks = SDL_GetTicks();
+        frequency = (double)SDL_GetPerformanceFrequency();
+        startCounter = SDL_GetPerformanceCounter();
+        previousCounter = startCounter;
+        nextFrame = startCounter;
+        SetTickRate(tickRate);
     }
 
     void Delta::Reset()
     {
-        previousTicks = SDL_GetTicks();
+        previousCounter = SDL_GetPerformanceCounter();
+        nextFrame = previousCounter;
+        accumulator = 0;
+    }
+
+    void Delta::SetTickRate(float tickRate)
+    {
+        fixedTime = tickRate > 0 ? 1.0 / (double)tickRate : 0.0;
+        accumulator = 0;
+    }
+
+    float Delta::FixedTime()
+    {
+        return (float)fixedTime;
+    }
+
+    bool Delta::StepFixed()
+    {
+        if (fixedTime > 0 && accumulator >= fixedTime)
+        {
+            accumulator -= fixedTime;
+            return true;
+        }
+        return false;
+    }
+
+    float Delta::Alpha()
+    {
+        return fixedTime > 0 ? (float)(accumulator / fixedTime) : 1.0f;
+    }
+
+    double Delta::Elapsed()
+    {
+        return (double)(SDL_GetPerformanceCounter() - startCounter) / frequency;
     }
 
 }
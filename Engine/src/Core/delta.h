@@ -20,34 +20,78 @@
 #define DELTA_H
 
 #include "helpermacros.h"
+#include "services.h"
 
 namespace Ossium
 {
 
-    class OSSIUM_EDL Delta
+    /// Keeps track of frame time using the high resolution performance counter, paces frames to an optional FPS cap
+    /// and schedules fixed timestep updates.
+    class OSSIUM_EDL Delta : public Service<Delta>
     {
     public:
         Delta();
 
-        /// Get the change in time between calls to Update()
+        /// Get the change in time between calls to Update(), in seconds
         float Time();
 
-        /// Updates values in the class each time it is called
+        /// Updates values in the class each time it is called. If there is an FPS cap, this waits until the next frame is due.
         void Update();
 
-        /// Applies FPS cap and initialises previousTicks to current ticks. An FPS cap <= 0.0f means no cap is applied.
-        void Init(float fpsCap = 0.0f);
+        /// Applies FPS cap and fixed update rate, and initialises the previous frame time to the current time.
+        /// An FPS cap <= 0.0f means no cap is applied, and a tick rate <= 0.0f means there are no fixed updates.
+        void Init(float fpsCap = 0.0f, float tickRate = 0.0f);
 
-        /// Resets previousTicks to current ticks
+        /// Resets the previous frame time to the current time
         void Reset();
 
+        /// Sets the number of fixed updates per second. Values <= 0.0f disable fixed updates.
+        void SetTickRate(float tickRate);
+
+        /// Returns the time between fixed updates in seconds, or 0.0f if fixed updates are disabled.
+        float FixedTime();
+
+        /// Returns true if a fixed update is due, and consumes the time of one fixed update.
+        /// Call this in a loop after Update() and do a fixed update each time it returns true.
+        bool StepFixed();
+
+        /// Returns how far the current time is between the last fixed update and the next, from 0.0f to 1.0f.
+        /// Use this to interpolate between fixed update states when rendering.
+        float Alpha();
+
+        /// Returns the time in seconds since Init() was called.
+        double Elapsed();
+
     private:
-        Uint32 previousTicks = 0;
+        /// Longest frame time that is simulated in fixed updates. Limits the number of fixed updates after a stall
+        /// so a slow frame can't cause ever slower frames.
+        static constexpr double MaxFixedFrameTime = 0.25;
+
+        /// Time before a paced frame is due at which to stop sleeping and start spinning, as sleeps can overshoot.
+        static constexpr double SpinTime = 0.002;
+
+        /// Performance counter frequency in ticks per second.
+        double frequency = 1.0;
+
+        /// Performance counter value when Init() was called.
+        Uint64 startCounter = 0;
+
+        /// Performance counter value at the last call to Update().
+        Uint64 previousCounter = 0;
+
+        /// Performance counter value when the next frame is due, if there is an FPS cap.
+        Uint64 nextFrame = 0;
 
         float deltaTime = 0.0f;
 
         float fpscap = 0.0f;
 
+        /// Time between fixed updates in seconds.
+        double fixedTime = 0.0;
+
+        /// Time that has passed but has not been simulated by fixed updates yet.
+        double accumulator = 0.0;
+
     };
 
 }
@@ -266,7 +266,22 @@ namespace Ossium
 
     void Entity::SetParent(Entity* parent)
     {
+        if (parent == GetParent())
+        {
+            return;
+        }
         controller->entityTree.SetParent(self, parent != nullptr ? parent->self : nullptr);
+        controller->onEntityReparented(this);
+    }
+
+    unsigned int Entity::GetChildCount()
+    {
+        return self->children.size();
+    }
+
+    Entity* Entity::GetChild(unsigned int index)
+    {
+        return self->children[index]->data;
     }
 
     void Entity::OnSceneLoaded()
@@ -399,6 +414,7 @@ namespace Ossium
         {
             auto oldSelf = self;
             Scene* oldScene = controller;
+            oldScene->onEntityRemoved(this);
 
             // Insert nodes into the destination scene.
             oldScene->entityTree.WalkBreadth([scene, parent, oldScene, this] (Node<Entity*>* node) {
@@ -467,6 +483,8 @@ namespace Ossium
             // Remove root references from the source scene.
             oldScene->entityTree.Remove(oldSelf);
 
+            scene->onEntityAdded(this);
+
             // TODO: OnSceneChanged() callback for components perhaps?
         }
     }
@@ -515,6 +533,10 @@ namespace Ossium
     {
     }
 
+    void BaseComponent::FixedUpdate()
+    {
+    }
+
     string BaseComponent::GetBaseTypeNames()
     {
         return string();
@@ -623,6 +645,84 @@ namespace Ossium
         return false;
     }
 
+    void Scene::SaveAsync(string path)
+    {
+        SaveAsync(path, Snapshot());
+    }
+
+    void Scene::SaveAsync(string path, shared_ptr<const SceneSnapshot> snapshot)
+    {
+        JobSystem* jobs = servicesProvider != nullptr ? servicesProvider->GetService<JobSystem>() : nullptr;
+        if (jobs == nullptr)
+        {
+            snapshot->Save(path);
+            return;
+        }
+        if (IsSaving())
+        {
+            jobs->Wait(saving);
+        }
+        // The job only refers to the snapshot, so the scene may change or be destroyed while it is saved
+        jobs->Run([snapshot, path] () { snapshot->Save(path); }, &saving);
+    }
+
+    bool Scene::IsSaving()
+    {
+        return !saving.IsDone();
+    }
+
+    shared_ptr<const SceneSnapshot> Scene::Snapshot()
+    {
+        shared_ptr<SceneSnapshot> snapshot = make_shared<SceneSnapshot>();
+        snapshot->entities.reserve(entities.size());
+        unordered_map<int, SnapshotEntity> captured;
+        captured.reserve(entities.size());
+
+        WalkEntities(
+            [&] (Entity* entity) {
+                if (entity == nullptr)
+                {
+                    return true;
+                }
+                // Hash everything that Entity::ToString() serialises
+                int parent = entity->self->parent != nullptr && entity->self->parent->data != nullptr ? entity->self->parent->id : -1;
+                Uint64 hash = Utilities::HashBytes(entity->name.data(), entity->name.length());
+                hash = Utilities::HashBytes(&entity->active, sizeof(entity->active), hash);
+                hash = Utilities::HashBytes(&parent, sizeof(parent), hash);
+                for (auto& itr : entity->components)
+                {
+                    hash = Utilities::HashBytes(&itr.first, sizeof(itr.first), hash);
+                    for (BaseComponent* component : itr.second)
+                    {
+                        snapshotHashes.clear();
+                        component->HashMembers(snapshotHashes);
+                        hash = Utilities::HashBytes(snapshotHashes.data(), snapshotHashes.size() * sizeof(Uint64), hash);
+                    }
+                }
+
+                int id = entity->self->id;
+                auto itr = snapshotEntities.find(id);
+                if (itr != snapshotEntities.end() && itr->second.hash == hash)
+                {
+                    // Unchanged, so share the data serialised for an earlier snapshot
+                    captured[id] = itr->second;
+                }
+                else
+                {
+                    captured[id] = SnapshotEntity{ hash, make_shared<const string>(entity->ToString()) };
+                }
+                snapshot->entities.push_back(make_pair(id, captured[id].data));
+                snapshot->hash = Utilities::HashBytes(&id, sizeof(id), snapshot->hash);
+                snapshot->hash = Utilities::HashBytes(&hash, sizeof(hash), snapshot->hash);
+                return true;
+            }
+        );
+
+        // Entities that no longer exist are dropped
+        snapshotEntities.swap(captured);
+        return snapshot;
+    }
+
     void Scene::SetName(string name)
     {
         name = Utilities::SanitiseFilename(name);
@@ -668,6 +768,7 @@ namespace Ossium
                 }
             }
         }
+        UpdateStreaming();
         // Should be safe to clean up components now. Assuming they clean up after themselves!
         if (!toLoad.empty())
         {
@@ -681,6 +782,134 @@ namespace Ossium
         }
     }
 
+    Uint32 Scene::StreamIn(string guid_path)
+    {
+        Uint32 id = nextChunk++;
+        shared_ptr<StreamedChunk> chunk = make_shared<StreamedChunk>();
+        chunk->state.remap = true;
+        streamed[id] = chunk;
+
+        auto parse = [chunk, guid_path] () {
+            string data = Utilities::FileToString(guid_path);
+            if (data.empty())
+            {
+                Log.Error("Failed to stream scene file '{0}'.", guid_path);
+            }
+            else
+            {
+                ParseEntities(data, chunk->state);
+            }
+            chunk->parsed.store(true, memory_order_release);
+        };
+
+        JobSystem* jobs = servicesProvider != nullptr ? servicesProvider->GetService<JobSystem>() : nullptr;
+        if (jobs != nullptr)
+        {
+            // The job only refers to the chunk, so the scene may be destroyed before it finishes
+            jobs->Run(parse);
+        }
+        else
+        {
+            parse();
+        }
+        return id;
+    }
+
+    void Scene::StreamOut(Uint32 chunk)
+    {
+        auto itr = streamed.find(chunk);
+        if (itr == streamed.end())
+        {
+            Log.Warning("Cannot stream out chunk [{0}] as it is not streamed in.", chunk);
+            return;
+        }
+        itr->second->unloading = true;
+    }
+
+    bool Scene::IsStreamedIn(Uint32 chunk)
+    {
+        auto itr = streamed.find(chunk);
+        return itr != streamed.end() && itr->second->loaded && !itr->second->unloading;
+    }
+
+    void Scene::SetStreamingBudget(float milliseconds)
+    {
+        streamingBudget = milliseconds;
+    }
+
+    void Scene::UpdateStreaming()
+    {
+        if (streamed.empty())
+        {
+            return;
+        }
+        Uint64 start = SDL_GetPerformanceCounter();
+        Uint64 budget = (Uint64)((double)streamingBudget * 0.001 * (double)SDL_GetPerformanceFrequency());
+
+        for (auto itr = streamed.begin(); itr != streamed.end() && SDL_GetPerformanceCounter() - start < budget;)
+        {
+            StreamedChunk& chunk = *itr->second;
+            if (!chunk.parsed.load(memory_order_acquire))
+            {
+                if (chunk.unloading)
+                {
+                    // Nothing has been created yet; the worker just finishes parsing into the chunk it shares.
+                    itr = streamed.erase(itr);
+                    continue;
+                }
+            }
+            else if (chunk.unloading)
+            {
+                // The references of entities that were never finished would otherwise be left dangling
+                chunk.state.pointers.clear();
+                while (!chunk.state.created.empty() && SDL_GetPerformanceCounter() - start < budget)
+                {
+                    // Children are skipped if their parent has already been destroyed
+                    Entity* entity = GetEntity(chunk.state.created.back());
+                    chunk.state.created.pop_back();
+                    if (entity != nullptr)
+                    {
+                        DestroyEntity(entity, true);
+                    }
+                }
+                if (chunk.state.created.empty())
+                {
+                    itr = streamed.erase(itr);
+                    continue;
+                }
+            }
+            else if (!chunk.loaded)
+            {
+                while (SDL_GetPerformanceCounter() - start < budget && LoadNextEntity(chunk.state));
+                if (chunk.state.next >= chunk.state.serialised.size())
+                {
+                    FinishLoading(chunk.state);
+                    chunk.loaded = true;
+                    // Only the ids of the created entities are needed to stream the chunk out
+                    vector<pair<string, string>>().swap(chunk.state.serialised);
+                    chunk.state.ids.clear();
+                    chunk.state.parents.clear();
+                    onStreamedIn(itr->first);
+                }
+            }
+            itr++;
+        }
+    }
+
+    void Scene::FixedUpdateComponents()
+    {
+        for (unsigned int i = 0, counti = TypeSystem::TypeRegistry<BaseComponent>::GetTotalTypes(); i < counti; i++)
+        {
+            for (auto j = components[i].begin(); j != components[i].end(); j++)
+            {
+                if ((*j)->IsActiveAndEnabled())
+                {
+                    (*j)->FixedUpdate();
+                }
+            }
+        }
+    }
+
     Entity* Scene::CreateEntity(Entity* parent)
     {
         Node<Entity*>* node = nullptr;
@@ -695,9 +924,37 @@ namespace Ossium
         Entity* created = new Entity(this, node);
         node->data = created;
         entities[node->id] = node;
+        onEntityAdded(created);
+        return created;
+    }
+
+    Entity* Scene::CreateEntity(Entity* parent, int id)
+    {
+        if (entities.find(id) != entities.end())
+        {
+            return nullptr;
+        }
+        if (id >= entityTree.GetGeneration())
+        {
+            /// TODO: make this more robust?
+            /// Make sure the tree always generates unique ids
+            entityTree.SetGeneration(id + 1);
+        }
+        Entity* created = CreateEntity(parent);
+
+        /// Replace generated id with the specified id
+        entities.erase(created->self->id);
+        created->self->id = id;
+        entities[id] = created->self;
         return created;
     }
 
+    Entity* Scene::GetEntity(int id)
+    {
+        auto itr = entities.find(id);
+        return itr != entities.end() ? itr->second->data : nullptr;
+    }
+
     void Scene::DestroyEntity(Entity* entity, bool immediate)
     {
         if (entity == nullptr)
@@ -710,6 +967,7 @@ namespace Ossium
         }
         else if (immediate)
         {
+            onEntityRemoved(entity);
             auto rootNode = entity->self;
             // Clean up all children first; only delete entities on way back up the tree
             // so the parent hierarchy is not broken during destruction.
@@ -816,6 +1074,9 @@ namespace Ossium
 
     void Scene::Clear()
     {
+        onClear(this);
+        /// Streamed entities are destroyed with everything else
+        streamed.clear();
         /// Delete all entities
         WalkEntities([&] (Entity* entity) {
             DestroyEntity(entity, true);
@@ -857,6 +1118,11 @@ namespace Ossium
     }
 
     string Scene::ToString()
+    {
+        return ToString(nullptr);
+    }
+
+    string Scene::ToString(Entity* root)
     {
         JSON serialised;
         // Walk through the entity tree
@@ -867,7 +1133,9 @@ namespace Ossium
                     serialised[Utilities::ToString(entity->self->id)] = entity->ToString();
                 }
                 return true;
-            }
+            },
+            true,
+            root
         );
         return serialised.ToString();
     }
@@ -875,54 +1143,130 @@ namespace Ossium
     void Scene::FromString(const string& str)
     {
         Clear();
+        LoadEntities(str);
+    }
+
+    vector<Entity*> Scene::LoadEntities(const string& str)
+    {
+        LoadState state;
+        ParseEntities(str, state);
+        while (LoadNextEntity(state));
+        vector<Entity*> created = FinishLoading(state);
+
+#ifdef OSSIUM_DEBUG
+        if (created.size() != state.serialised.size())
+        {
+            Log.Warning("Serialised entities ({0}) != created entities ({1})!", created.size(), state.serialised.size());
+        }
+#endif
+        return created;
+    }
+
+    void Scene::ParseEntities(const string& str, LoadState& state)
+    {
         JSON serialised(str);
-        /// Map of entities that need to be nested under a parent entity
-        vector<pair<Entity*, int>> parentMap;
-        for (auto itr : serialised)
+        state.serialised.reserve(serialised.size());
+        for (auto itr = serialised.begin(); itr != serialised.end(); itr++)
         {
-            if (!IsInt(itr.first))
+            state.serialised.push_back(make_pair(itr->first, std::move((string&)itr.value())));
+        }
+    }
+
+    bool Scene::LoadNextEntity(LoadState& state)
+    {
+        if (state.next >= state.serialised.size())
+        {
+            return false;
+        }
+        auto& itr = state.serialised[state.next++];
+        if (!IsInt(itr.first))
+        {
+            Log.Error("Failed to load entity due to invalid ID '{0}'!", itr.first);
+            return true;
+        }
+        int id = ToInt(itr.first);
+        Entity* entity = CreateEntity(nullptr, id);
+        if (entity == nullptr)
+        {
+            if (!state.remap)
             {
-                Log.Error("Failed to load entity due to invalid ID '{0}'!", itr.first);
-                continue;
+                Log.Error("Failed to load entity as ID '{0}' is already in use!", itr.first);
+                return true;
             }
-            int id = ToInt(itr.first);
-            if (id >= entityTree.GetGeneration())
+            entity = CreateEntity();
+            state.ids[id] = entity->GetID();
+        }
+        state.created.push_back(entity->GetID());
+        /// The entity isn't in its place in the hierarchy or hooked up to other entities until FinishLoading(),
+        /// which may be several frames later when streaming, so keep it out of updates and rendering until then.
+        /// This only affects whether it is active in the scene, not the active flag it is loaded with.
+        SetInactive(entity);
+
+        // Collect references separately, as other entities may be loaded before this entity has finished loading
+        unordered_map<string, set<void**>> references;
+        serialised_pointers.swap(references);
+        entity->FromString(itr.second);
+        serialised_pointers.swap(references);
+        for (auto& reference : references)
+        {
+            vector<pair<int, void**>>& slots = state.pointers[reference.first];
+            for (void** slot : reference.second)
             {
-                /// TODO: make this more robust?
-                /// Make sure the tree always generates unique ids
-                entityTree.SetGeneration(id + 1);
+                slots.push_back(make_pair(entity->GetID(), slot));
             }
-            Entity* entity = CreateEntity();
-
-            /// Replace generated id with serialised id
-            entities.erase(entity->self->id);
-            entity->self->id = id;
-            entities[id] = entity->self;
+        }
 
-            entity->FromString(itr.second);
-            JSON serialisedEntity(itr.second);
-            auto parentItr = serialisedEntity.find("Parent");
-            if (parentItr != serialisedEntity.end())
+        JSON serialisedEntity(itr.second);
+        auto parentItr = serialisedEntity.find("Parent");
+        if (parentItr != serialisedEntity.end())
+        {
+            int ident = IsInt(parentItr->second) ? ToInt(parentItr->second) : -1;
+            if (ident >= 0)
             {
-                int ident = IsInt(parentItr->second) ? ToInt(parentItr->second) : -1;
-                if (ident >= 0)
-                {
-                    pair<Entity*, int> parentPair(entity, ToInt(parentItr->second));
-                    parentMap.push_back(parentPair);
-                }
+                state.parents.push_back(make_pair(entity->GetID(), ident));
             }
-            else
+        }
+        else
+        {
+            Log.Warning("Failed to get entity parent!");
+        }
+        return true;
+    }
+
+    int Scene::GetLoadedID(LoadState& state, int id)
+    {
+        auto itr = state.ids.find(id);
+        return itr != state.ids.end() ? itr->second : id;
+    }
+
+    vector<Entity*> Scene::FinishLoading(LoadState& state)
+    {
+        /// Entities may have been destroyed since they were created
+        vector<Entity*> created;
+        unordered_set<int> createdIds;
+        created.reserve(state.created.size());
+        for (int id : state.created)
+        {
+            Entity* entity = GetEntity(id);
+            if (entity != nullptr)
             {
-                Log.Warning("Failed to get entity parent!");
+                created.push_back(entity);
+                createdIds.insert(id);
             }
         }
+
         /// Now setup the entity hierarchy
-        for (auto itr : parentMap)
+        for (auto itr : state.parents)
         {
-            auto entityItr = entities.find(itr.second);
+            Entity* entity = GetEntity(itr.first);
+            if (entity == nullptr)
+            {
+                continue;
+            }
+            auto entityItr = entities.find(GetLoadedID(state, itr.second));
             if (entityItr != entities.end())
             {
-                itr.first->SetParent(entityItr->second->data);
+                entity->SetParent(entityItr->second->data);
             }
             else
             {
@@ -930,16 +1274,20 @@ namespace Ossium
             }
         }
         /// Finally, hook up the serialised pointers
-        for (auto itr : serialised_pointers)
+        for (auto& itr : state.pointers)
         {
             if (IsInt(itr.first))
             {
-                auto entityItr = entities.find(ToInt(itr.first));
+                auto entityItr = entities.find(GetLoadedID(state, ToInt(itr.first)));
                 if (entityItr != entities.end())
                 {
-                    for (void** i : itr.second)
+                    for (auto& slot : itr.second)
                     {
-                        *i = ((void*)entityItr->second->data);
+                        /// The references of destroyed entities were destroyed with them
+                        if (createdIds.find(slot.first) != createdIds.end())
+                        {
+                            *slot.second = ((void*)entityItr->second->data);
+                        }
                     }
                 }
                 else
@@ -953,7 +1301,7 @@ namespace Ossium
                 if (IsInt(ent_id))
                 {
                     /// Must be a component pointer
-                    auto entityItr = entities.find(ToInt(ent_id));
+                    auto entityItr = entities.find(GetLoadedID(state, ToInt(ent_id)));
                     if (entityItr != entities.end())
                     {
                         string comp_type = SplitLeft(SplitRight(itr.first, ':', "error"), ':', "error");
@@ -967,9 +1315,12 @@ namespace Ossium
                                 unsigned int id = ToInt(compid);
                                 if (comps.size() >= id)
                                 {
-                                    for (void** i : itr.second)
+                                    for (auto& slot : itr.second)
                                     {
-                                        *i = ((void*)comps[id]);
+                                        if (createdIds.find(slot.first) != createdIds.end())
+                                        {
+                                            *slot.second = ((void*)comps[id]);
+                                        }
                                     }
                                 }
                                 else
@@ -998,20 +1349,35 @@ namespace Ossium
                 }
             }
         }
-        serialised_pointers.clear();
+        state.pointers.clear();
 
-        /// Notify all entities that the scene has finished loading
+        /// Activate the loaded entities in the scene and notify them that the scene has finished loading.
+        /// Parents come before their children in the flat tree, so an entity is left inactive when its parent is.
+        unordered_set<Entity*> loaded(created.begin(), created.end());
         for (auto entityNode : entityTree.GetFlatTree())
         {
-            entityNode->data->OnSceneLoaded();
+            Entity* entity = entityNode->data;
+            if (loaded.find(entity) != loaded.end())
+            {
+                Entity* parent = entity->GetParent();
+                if (parent == nullptr || parent->IsActive())
+                {
+                    SetActive(entity);
+                }
+                entity->OnSceneLoaded();
+            }
         }
-        /// Notify all components that the scene has finished loading
+        /// Notify the components of the loaded entities that the scene has finished loading
         for (unsigned int i = 0, counti = TypeSystem::TypeRegistry<BaseComponent>::GetTotalTypes(); i < counti; i++)
         {
             //Log.Info("Loading components of type {0}", GetComponentName(i));
             int total = 0;
             for (auto component : components[i])
             {
+                if (loaded.find(component->entity) == loaded.end())
+                {
+                    continue;
+                }
                 Log.Debug("Finished loading \"{0}\" component on entity \"{1}\"", GetComponentName(component->GetType()), component->entity->name);
                 component->OnLoadFinish();
                 total++;
@@ -1019,12 +1385,7 @@ namespace Ossium
             //Log.Info("Loaded {0} component(s) of type {1}", total, GetComponentName(i));
         }
 
-#ifdef OSSIUM_DEBUG
-        if (entities.size() != serialised.size())
-        {
-            Log.Warning("Serialised entities ({0}) != created entities ({1})!", entities.size(), serialised.size());
-        }
-#endif
+        return created;
     }
 
     vector<Entity*> Scene::GetRootEntities()
@@ -1079,6 +1440,12 @@ namespace Ossium
 
     Scene::~Scene()
     {
+        if (IsSaving())
+        {
+            // Finish saving before the counter is destroyed
+            servicesProvider->GetService<JobSystem>()->Wait(saving);
+        }
+        onDestroy(this);
         Clear();
         delete[] components;
         components = nullptr;
@@ -24,6 +24,8 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <set>
+#include <map>
+#include <memory>
 #include <algorithm>
 
 #include "tree.h"
@@ -31,6 +33,8 @@
 #include "schemamodel.h"
 #include "services.h"
 #include "callback.h"
+#include "jobsystem.h"
+#include "scenesnapshot.h"
 
 namespace Ossium
 {
@@ -166,9 +170,44 @@ namespace Ossium
         /// Save the scene at a specified directory.
         bool Save(std::string directoryPath);
 
+        /// Saves a snapshot of the scene on a worker thread, so the caller isn't blocked while the file is written.
+        /// Saves immediately if there is no JobSystem service. If the last call to SaveAsync() has not finished,
+        /// this waits for it first so that saves are written in order.
+        void SaveAsync(std::string path);
+
+        /// Saves a snapshot of this scene taken earlier with Snapshot(), in the same way as SaveAsync().
+        void SaveAsync(std::string path, std::shared_ptr<const SceneSnapshot> snapshot);
+
+        /// Returns true while a SaveAsync() call has not finished.
+        bool IsSaving();
+
+        /// Captures the serialised state of the scene. Only entities that have changed since the last snapshot are serialised,
+        /// which is detected by hashing their schema members, so this is much cheaper than ToString() when few entities change.
+        std::shared_ptr<const SceneSnapshot> Snapshot();
+
         /// Attempts to clear this scene safely after updating.
         void ClearSafe();
 
+        /// Starts streaming a scene file into this scene, without removing the entities already in the scene.
+        /// The file is read and parsed on a worker thread if there is a JobSystem service, then UpdateComponents() creates its entities
+        /// over as many frames as it takes to stay within the streaming budget. Entities whose serialised id is already in use are given a new id.
+        /// Components are only notified that they have loaded once every entity in the file has been created.
+        /// Returns an id for the streamed chunk, for use with StreamOut().
+        Uint32 StreamIn(std::string guid_path);
+
+        /// Destroys the entities of a streamed chunk over several frames, staying within the streaming budget.
+        /// If the chunk is still streaming in, no more of its entities are created.
+        void StreamOut(Uint32 chunk);
+
+        /// Returns true once every entity of a streamed chunk has been created and loaded.
+        bool IsStreamedIn(Uint32 chunk);
+
+        /// Sets the time in milliseconds that may be spent creating and destroying streamed entities each frame.
+        void SetStreamingBudget(float milliseconds);
+
+        /// Creates and destroys streamed entities until the streaming budget is used up. This is called at the end of UpdateComponents().
+        void UpdateStreaming();
+
         /// Sets the name of this scene.
         void SetName(std::string name);
 
@@ -186,6 +225,9 @@ namespace Ossium
         /// and replace with an override that only calls Update() on component types that use it.
         void UpdateComponents();
 
+        /// Calls FixedUpdate() for all active and enabled components.
+        void FixedUpdateComponents();
+
         /// Renders the scene.
         void Render();
 
@@ -229,6 +271,13 @@ namespace Ossium
         /// the new entity will be added as a child of the parent.
         Entity* CreateEntity(Entity* parent = nullptr);
 
+        /// Creates an entity with a specific id, e.g. to restore an entity that was destroyed.
+        /// Returns nullptr if an entity with that id already exists in this scene.
+        Entity* CreateEntity(Entity* parent, int id);
+
+        /// Returns the entity with the specified id, or nullptr if there is no such entity in this scene.
+        Entity* GetEntity(int id);
+
         /// Destroys a single entity and all it's components. Logs a warning if the entity does not exist within this system.
         /// Note that the entity is destroyed at the end of a frame, prior to a RenderPresent call if 'immediate' is left false.
         /// Also note that you should only ever call this once on an entity, or you'll end up crashing (as you would with multiple `delete` calls).
@@ -261,9 +310,36 @@ namespace Ossium
         std::string ToString();
         void FromString(const std::string& str);
 
+        /// Serialises an entity and all of its children, in the same format as ToString().
+        std::string ToString(Entity* root);
+
+        /// Creates the entities serialised by ToString() without clearing the scene, keeping their serialised ids.
+        /// Entities whose id is already in use are skipped. Returns the entities that were created.
+        std::vector<Entity*> LoadEntities(const std::string& str);
+
         // Callback for when the scene has finished loading
         Callback<Scene*> onLoadComplete;
 
+        /// Called when an entity is created in this scene or moved into it from another scene.
+        /// When an entity is moved, this is only called for that entity and not for each of its children.
+        Callback<Entity*> onEntityAdded;
+
+        /// Called just before an entity is destroyed or moved to another scene, while it is still in the scene hierarchy.
+        /// This is only called for that entity and not for each of its children.
+        Callback<Entity*> onEntityRemoved;
+
+        /// Called after the parent of an entity in this scene changes.
+        Callback<Entity*> onEntityReparented;
+
+        /// Called when all entities are about to be destroyed, when the scene is cleared, loaded or destroyed.
+        Callback<Scene*> onClear;
+
+        /// Called when the scene is destroyed, before any of its entities are destroyed.
+        Callback<Scene*> onDestroy;
+
+        /// Called with the id of a streamed chunk once all of its entities have been created and loaded.
+        Callback<Uint32> onStreamedIn;
+
     private:
         /// Destroys ALL entities and their components
         void Clear();
@@ -311,6 +387,81 @@ namespace Ossium
         /// Hash table of entity nodes by id
         std::unordered_map<int, Node<Entity*>*> entities;
 
+        /// State for creating serialised entities, which may be spread over several frames.
+        struct LoadState
+        {
+            /// Serialised entities by id, in the order they are created.
+            std::vector<std::pair<std::string, std::string>> serialised;
+
+            /// Index of the next serialised entity to create.
+            unsigned int next = 0;
+
+            /// When true, entities whose serialised id is in use are given a new id rather than skipped.
+            bool remap = false;
+
+            /// New ids by serialised id, for entities that could not keep their serialised id.
+            std::unordered_map<int, int> ids;
+
+            /// Ids of the created entities, and the serialised ids of the parents they are to be nested under.
+            std::vector<int> created;
+            std::vector<std::pair<int, int>> parents;
+
+            /// References to entities and components that are hooked up once all the entities have been created,
+            /// along with the id of the entity each reference belongs to, as it may be destroyed in the meantime.
+            std::unordered_map<std::string, std::vector<std::pair<int, void**>>> pointers;
+        };
+
+        /// Splits serialised scene data into the serialised entities. Doesn't use the scene, so can be called from any thread.
+        static void ParseEntities(const std::string& str, LoadState& state);
+
+        /// Creates the next serialised entity, which is inactive in the scene until FinishLoading() is called.
+        /// Returns false once there are no more entities to create.
+        bool LoadNextEntity(LoadState& state);
+
+        /// Returns the id of a loaded entity given its serialised id.
+        int GetLoadedID(LoadState& state, int id);
+
+        /// Sets up the hierarchy and references of the created entities, then notifies them that they have loaded.
+        std::vector<Entity*> FinishLoading(LoadState& state);
+
+        /// A scene file streamed into this scene.
+        struct StreamedChunk
+        {
+            /// Set once the file has been parsed, which may happen on a worker thread.
+            std::atomic<bool> parsed = {false};
+
+            LoadState state;
+
+            /// Have all the entities been created and loaded?
+            bool loaded = false;
+
+            /// Are the entities being destroyed?
+            bool unloading = false;
+        };
+
+        /// Streamed chunks by id. Chunks are shared with the worker thread that parses them.
+        std::map<Uint32, std::shared_ptr<StreamedChunk>> streamed;
+
+        /// Id of the next streamed chunk.
+        Uint32 nextChunk = 1;
+
+        /// Time in milliseconds that may be spent on streaming each frame.
+        float streamingBudget = 2.0f;
+
+        /// The serialised data of each entity in the last snapshot, along with the hash of the state it was serialised from.
+        struct SnapshotEntity
+        {
+            Uint64 hash;
+            std::shared_ptr<const std::string> data;
+        };
+        std::unordered_map<int, SnapshotEntity> snapshotEntities;
+
+        /// Reused when hashing entities for a snapshot.
+        std::vector<Uint64> snapshotHashes;
+
+        /// Counts unfinished SaveAsync() calls.
+        JobCounter saving;
+
         /// Direct map of ids to reference type members that point to entities or components
         std::unordered_map<std::string, std::set<void**>> serialised_pointers;
 
@@ -517,7 +668,14 @@ namespace Ossium
         /// Returns the parent entity, if any.
         Entity* GetParent();
 
+        /// Returns the number of direct children of this entity.
+        unsigned int GetChildCount();
+
+        /// Returns a direct child of this entity, in the order the children were added.
+        Entity* GetChild(unsigned int index);
+
         /// Sets the parent entity. Disallows moving this entity to another scene, use SetScene() instead.
+        /// Does nothing if the parent is unchanged, so onEntityReparented is only invoked when the entity actually moves.
         void SetParent(Entity* parent);
 
         /// Returns this entity's ID
@@ -630,7 +788,7 @@ namespace Ossium
     };
 
 #ifdef OSSIUM_EDITOR
-    namespace Editor { class EntityProperties; }
+    namespace Editor { class EntityProperties; class UndoJournal; }
 #endif // OSSIUM_EDITOR
 
     /// Base class for all components
@@ -644,6 +802,7 @@ namespace Ossium
         friend class Scene;
 #ifdef OSSIUM_EDITOR
         friend class Editor::EntityProperties;
+        friend class Editor::UndoJournal;
 #endif // OSSIUM_EDITOR
 
         /// Returns a pointer to the entity this component is attached to.
@@ -690,6 +849,9 @@ namespace Ossium
         /// Each frame this method is called.
         virtual void Update();
 
+        /// Called at a fixed rate (see Config::tickrate), independent of the frame rate. Use GetService<Delta>()->FixedTime() for the time step.
+        virtual void FixedUpdate();
+
         /// Attempt to get an instance of a specific service type.
         template<typename T>
         T* GetService()
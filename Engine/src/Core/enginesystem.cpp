@@ -14,9 +14,20 @@
  *  3. This notice may not be removed or altered from any source distribution.
  *
 **/
+#include <atomic>
+
+extern "C"
+{
+    #include <SDL_thread.h>
+}
+#include "bgfx/platform.h"
+
 #include "window.h"
 #include "enginesystem.h"
 #include "ecs.h"
+#include "font.h"
+#include "audio.h"
+#include "transform.h"
 #include "../Components/UI/LayoutSurface.h"
 
 namespace Ossium
@@ -28,14 +39,17 @@ namespace Ossium
         renderViewPool = new RenderViewPool();
         renderer = new Renderer(window, renderViewPool);
         input = new InputController();
-        services = new ServicesProvider(renderer, &resources, input);
+        debugDraw = new DebugDraw(renderer);
+        services = new ServicesProvider(renderer, &resources, input, &delta, &jobs, debugDraw);
         Init(config);
     }
 
     EngineSystem::~EngineSystem()
     {
+        jobs.Quit();
         delete services;
         delete input;
+        delete debugDraw;
         delete renderer;
         delete renderViewPool;
         delete window;
@@ -43,7 +57,8 @@ namespace Ossium
 
     void EngineSystem::Init(const Config& config)
     {
-        delta.Init(config.fpscap);
+        delta.Init(config.fpscap, config.tickrate);
+        jobs.Init(config.workerThreads);
         for (std::string scenePath : config.startScenes)
         {
             if (!resources.LoadAndInit<Scene>(scenePath, services))
@@ -73,9 +88,29 @@ namespace Ossium
             input->HandleEvent(currentEvent);
         }
 
+        // Notify audio players whose voices finished since the last frame.
+        Audio::Internals::AudioEngine::Instance.Update();
+
+        // Pack glyphs that finished rasterising in the background since the last frame.
+        for (auto itr : resources.GetAll<Font>())
+        {
+            ((Font*)itr.second)->PackRasterised();
+        }
+
         // Update services before main logic update.
         services->PreUpdate();
 
+        // Run fixed updates for the time that has passed since the last frame.
+        while (delta.StepFixed())
+        {
+            Transform::SaveInterpolationState();
+            services->FixedUpdate();
+            for (auto itr : resources.GetAll<Scene>())
+            {
+                ((Scene*)itr.second)->FixedUpdateComponents();
+            }
+        }
+
         // Update game logic in loaded scenes
         for (auto itr : resources.GetAll<Scene>())
         {
@@ -85,26 +120,13 @@ namespace Ossium
         // Update services after the main logic update.
         services->PostUpdate();
 
-        for (auto itr : resources.GetAll<Scene>())
-        {
-            Scene* scene = (Scene*)itr.second;
-            // Update all layouts now everything has moved.
-            scene->WalkEntities([=] (Entity* entity) {
-                if (entity->IsActive())
-                {
-                    LayoutSurface* layoutSurface = entity->GetComponent<LayoutSurface>();
-                    if (layoutSurface && layoutSurface->IsEnabled())
-                    {
-                        layoutSurface->LayoutUpdate();
-                    }
-                    return true;
-                }
-                return false;
-            });
-        }
+        // Update all dirty layouts now everything has moved.
+        LayoutSurface::UpdateDirtySurfaces();
 
-        // Render everything
+        // Render everything, with interpolated transforms placed between the last two fixed updates.
+        Transform::BeginInterpolation(delta.Alpha());
         renderer->RenderPresent();
+        Transform::EndInterpolation();
 
         // Destroy entities and components pending destruction.
         for (auto itr : resources.GetAll<Scene>())
@@ -126,4 +148,64 @@ namespace Ossium
         doExit = true;
     }
 
+    /// Arguments for running the engine on a separate thread
+    struct EngineRunData
+    {
+        const Config* config;
+        std::function<void(EngineSystem&)> onStart;
+        std::atomic<bool> finished = {false};
+    };
+
+    static int RunEngine(void* data)
+    {
+        EngineRunData* run = (EngineRunData*)data;
+        {
+            EngineSystem engine(*run->config);
+            if (run->onStart)
+            {
+                run->onStart(engine);
+            }
+            while (engine.Update())
+            {
+            }
+        }
+        run->finished.store(true);
+        return 0;
+    }
+
+    int EngineSystem::Run(const Config& config, std::function<void(EngineSystem&)> onStart)
+    {
+        EngineRunData data;
+        data.config = &config;
+        data.onStart = onStart;
+        if (!config.renderThread)
+        {
+            return RunEngine(&data);
+        }
+
+        // Calling renderFrame() before bgfx is initialised makes this thread the render thread.
+        // bgfx::init() and all other bgfx calls then happen on the engine thread.
+        bgfx::renderFrame();
+        SDL_Thread* thread = SDL_CreateThread(RunEngine, "Engine", (void*)&data);
+        if (thread == NULL)
+        {
+            Log.Error("Failed to create engine thread! SDL_Error: {0}", SDL_GetError());
+            return -1;
+        }
+
+        // Render frames until the engine shuts down bgfx, or stops without initialising it.
+        while (true)
+        {
+            bgfx::RenderFrame::Enum result = bgfx::renderFrame(100);
+            if (result == bgfx::RenderFrame::Exiting || (result == bgfx::RenderFrame::NoContext && data.finished.load()))
+            {
+                break;
+            }
+        }
+
+        int status = 0;
+        SDL_WaitThread(thread, &status);
+        return status;
+    }
+
 }
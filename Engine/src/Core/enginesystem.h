@@ -17,12 +17,16 @@
 #ifndef ENGINESYSTEM_H
 #define ENGINESYSTEM_H
 
+#include <functional>
+
 #include "input.h"
 #include "delta.h"
 #include "component.h"
 #include "config.h"
 #include "resourcecontroller.h"
+#include "jobsystem.h"
 #include "physics.h"
+#include "debugdraw.h"
 
 namespace Ossium
 {
@@ -45,6 +49,13 @@ namespace Ossium
         /// Indicates that the engine should return false on the next Update() call.
         void Exit();
 
+        /// Creates an engine and calls Update() until it exits. onStart is called once the engine is created, e.g. to load scenes.
+        /// If config.renderThread is true, the calling thread becomes the bgfx render thread and the engine runs on a new thread,
+        /// so simulating and submitting the next frame overlaps with rendering the current one. bgfx buffers the draw calls submitted
+        /// each frame, so the render thread never reads engine state. The window is created on the engine thread,
+        /// which not all platforms allow (e.g. macOS). Returns 0 on success.
+        static int Run(const Config& config, std::function<void(EngineSystem&)> onStart = nullptr);
+
     private:
         NOCOPY(EngineSystem);
 
@@ -66,6 +77,9 @@ namespace Ossium
         /// Input system.
         InputController* input = nullptr;
 
+        /// Batches debug shapes drawn with the main renderer.
+        DebugDraw* debugDraw = nullptr;
+
         /// Services available to this engine system instance. Always provides a renderer at the very least.
         ServicesProvider* services = nullptr;
 
@@ -75,6 +89,9 @@ namespace Ossium
         /// Time keeping for this system.
         Delta delta;
 
+        /// Worker threads that components and engine subsystems can schedule jobs on.
+        JobSystem jobs;
+
     };
 
 }
@@ -1,10 +1,31 @@
+#include <cstring>
+
 #include "file.h"
 
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#define OSSIUM_FILE_MAPPING
+#elif !defined(__ANDROID__) && (defined(__unix__) || defined(__APPLE__))
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define OSSIUM_FILE_MAPPING
+#endif
+
 namespace Ossium
 {
-    
+
     File::File(std::string path, std::string mode)
     {
+        // Only files that are just being read can be mapped
+        bool readOnly = mode.find_first_of("wa+") == std::string::npos;
+        if (readOnly && Map(path))
+        {
+            return;
+        }
+
         file = SDL_RWFromFile(path.c_str(), mode.c_str());
         if (file != NULL)
         {
@@ -22,76 +43,232 @@ namespace Ossium
         {
             SDL_RWclose(file);
         }
+        if (mapping != nullptr)
+        {
+#if defined(_WIN32)
+            UnmapViewOfFile(data);
+            CloseHandle((HANDLE)mapping);
+#elif defined(OSSIUM_FILE_MAPPING)
+            munmap((void*)data, (size_t)size);
+#endif
+        }
     }
 
-    std::string File::ReadLine()
+    bool File::Map(const std::string& path)
     {
-        if (file != NULL)
+#if defined(_WIN32)
+        HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (handle == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+        LARGE_INTEGER fileSize;
+        HANDLE map = NULL;
+        // Empty files can't be mapped
+        if (GetFileSizeEx(handle, &fileSize) && fileSize.QuadPart > 0)
+        {
+            map = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+        }
+        // The mapping keeps the file open
+        CloseHandle(handle);
+        if (map == NULL)
+        {
+            return false;
+        }
+        const char* view = (const char*)MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+        if (view == NULL)
+        {
+            CloseHandle(map);
+            return false;
+        }
+        mapping = (void*)map;
+        data = view;
+        size = (Sint64)fileSize.QuadPart;
+        available = size;
+        return true;
+#elif defined(OSSIUM_FILE_MAPPING)
+        int descriptor = open(path.c_str(), O_RDONLY);
+        if (descriptor < 0)
+        {
+            return false;
+        }
+        struct stat info;
+        void* view = MAP_FAILED;
+        // Empty files can't be mapped
+        if (fstat(descriptor, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0)
+        {
+            view = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        }
+        // The mapping keeps the file open
+        close(descriptor);
+        if (view == MAP_FAILED)
+        {
+            return false;
+        }
+        madvise(view, (size_t)info.st_size, MADV_SEQUENTIAL);
+        mapping = view;
+        data = (const char*)view;
+        size = (Sint64)info.st_size;
+        available = size;
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    bool File::Refill()
+    {
+        if (file == NULL)
+        {
+            // Mapped files are always fully available
+            return false;
+        }
+
+        // Discard data that has been read
+        if (cursor > 0)
+        {
+            memmove(&buffer[0], &buffer[cursor], (size_t)(available - cursor));
+            offset += cursor;
+            available -= cursor;
+            cursor = 0;
+        }
+        if (buffer.empty() || available == (Sint64)buffer.size())
         {
-            std::string line;
-            char buffer;
-            // Read the data from the current index
-            while (SDL_RWread(file, &buffer, sizeof(char), 1))
+            buffer.resize(buffer.empty() ? BufferSize : buffer.size() * 2);
+        }
+        data = &buffer[0];
+
+        size_t count = SDL_RWread(file, &buffer[available], sizeof(char), buffer.size() - available);
+        if (count == 0)
+        {
+            if (offset + available < size)
             {
-                if (buffer == '\n')
-                {
-                    return line;
-                }
-                line.append(1, buffer);
+                error = SDL_GetError();
             }
+            return false;
+        }
+        available += count;
+        return true;
+    }
+
+    std::string File::ReadLine()
+    {
+        return std::string(ReadLineView());
+    }
 
-            if (SDL_RWtell(file) < size)
+    std::string File::ReadElement(char separator, bool ignoreNewlines)
+    {
+        return std::string(ReadElementView(separator, ignoreNewlines));
+    }
+
+    std::string_view File::ReadLineView()
+    {
+        Sint64 length = 0;
+        while (true)
+        {
+            if (cursor + length >= available && !Refill())
             {
-                error = SDL_GetError();
+                break;
             }
-            else
+            if (data[cursor + length] == '\n')
             {
-                return line;
+                break;
             }
+            length++;
         }
-        return "";
+        if (length == 0 && cursor >= available)
+        {
+            return std::string_view();
+        }
+
+        std::string_view line(data + cursor, (size_t)length);
+        cursor += length < available - cursor ? length + 1 : length;
+        // Exclude the carriage return of Windows line endings
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.remove_suffix(1);
+        }
+        return line;
     }
 
-    std::string File::ReadElement(char separator, bool ignoreNewlines)
+    std::string_view File::ReadElementView(char separator, bool ignoreNewlines)
     {
-        std::string element = "";
-        if (file != NULL && GetIndex() < size)
+        // Skip over consecutive separator characters
+        while (true)
         {
-            char buffer;
-            while (SDL_RWread(file, &buffer, sizeof(char), 1))
+            if (cursor >= available && !Refill())
+            {
+                return std::string_view();
+            }
+            char c = data[cursor];
+            if (c != separator && (ignoreNewlines || (c != '\n' && c != '\r')))
             {
-                if (buffer == separator || (buffer == '\n' && !ignoreNewlines))
-                {
-                    if (element.empty())
-                    {
-                        // Skip consecutive separator characters
-                        continue;
-                    }
-                    return element;
-                }
-                element.append(1, buffer);
+                break;
             }
+            cursor++;
+        }
 
-            if (SDL_RWtell(file) < size)
+        Sint64 length = 0;
+        while (true)
+        {
+            if (cursor + length >= available && !Refill())
             {
-                error = SDL_GetError();
+                break;
             }
-            else
+            char c = data[cursor + length];
+            if (c == separator || (!ignoreNewlines && (c == '\n' || c == '\r')))
             {
-                return element;
+                break;
             }
+            length++;
         }
-        return "";
+
+        std::string_view element(data + cursor, (size_t)length);
+        // Also skip the separator after the element
+        cursor += length < available - cursor ? length + 1 : length;
+        return element;
     }
 
     bool File::GoTo(Sint64 index)
     {
-        return index < size && file != NULL && SDL_RWseek(file, index, RW_SEEK_SET) >= 0;
+        if (index < 0 || index >= size)
+        {
+            return false;
+        }
+        if (index >= offset && index <= offset + available)
+        {
+            cursor = index - offset;
+            return true;
+        }
+        if (file != NULL && SDL_RWseek(file, index, RW_SEEK_SET) >= 0)
+        {
+            offset = index;
+            available = 0;
+            cursor = 0;
+            return true;
+        }
+        return false;
     }
 
     Sint64 File::GetIndex()
     {
-        return file != NULL ? SDL_RWtell(file) : 0;
+        return offset + cursor;
+    }
+
+    bool File::IsEnd()
+    {
+        return GetIndex() >= size;
+    }
+
+    bool File::IsMapped()
+    {
+        return mapping != nullptr;
+    }
+
+    const char* File::GetMappedData()
+    {
+        // Mapped files are never refilled, so data always points at the start of the file
+        return mapping != nullptr ? data : nullptr;
     }
 
     std::string File::GetError()
@@ -111,28 +288,34 @@ namespace Ossium
 
     std::string File::ToString()
     {
-        if (file != NULL)
+        if (mapping != nullptr)
+        {
+            cursor = size;
+            return std::string(data, (size_t)size);
+        }
+        if (file != NULL && size > 0)
         {
-            char* buffer = new char[size + 1];
-            std::string data;
+            std::string contents;
+            contents.resize((size_t)size);
             // Read the data
             SDL_RWseek(file, 0, RW_SEEK_SET);
-            Sint64 num_bytes = SDL_RWread(file, buffer, sizeof(char), size);
+            Sint64 num_bytes = SDL_RWread(file, &contents[0], sizeof(char), size);
             if (num_bytes > 0)
             {
-                // Null terminate and copy
-                buffer[num_bytes] = '\0';
-                data = std::string(buffer);
+                contents.resize((size_t)num_bytes);
             }
             else
             {
                 error = SDL_GetError();
+                contents.clear();
             }
 
-            // Clean up
-            delete[] buffer;
+            // The buffer is now out of date
+            offset = num_bytes > 0 ? num_bytes : 0;
+            available = 0;
+            cursor = 0;
 
-            return data;
+            return contents;
         }
         return "";
     }
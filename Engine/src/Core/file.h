@@ -2,6 +2,8 @@
 #define FILE_H
 
 #include <SDL.h>
+#include <string_view>
+#include <vector>
 
 #include "funcutils.h"
 
@@ -9,6 +11,8 @@ namespace Ossium
 {
     
     // Represents an open file stream.
+    // Files opened for reading are memory mapped where the platform supports it, so reading is just a matter of scanning memory.
+    // Otherwise (e.g. Android assets, or files opened for writing) the file is read through SDL_RWops in large blocks.
     class File
     {
     public:
@@ -28,12 +32,29 @@ namespace Ossium
         // Optionally ignore newlines, i.e. elements are distinguished solely by the separator and not newlines.
         std::string ReadElement(char separator = ' ', bool ignoreNewlines = false);
 
+        // Same as ReadLine(), but returns a view of the line in the file data rather than copying it.
+        // The view is only valid until the next Read, GoTo() or ToString() call.
+        std::string_view ReadLineView();
+
+        // Same as ReadElement(), but returns a view of the element in the file data rather than copying it.
+        // The view is only valid until the next Read, GoTo() or ToString() call.
+        std::string_view ReadElementView(char separator = ' ', bool ignoreNewlines = false);
+
         // Navigate to a particular index in the file.
         bool GoTo(Sint64 index);
 
         // Return the current index in the file.
         Sint64 GetIndex();
 
+        // Returns true once the end of the file has been reached, or if the file isn't open.
+        bool IsEnd();
+
+        // Returns true if the file is memory mapped.
+        bool IsMapped();
+
+        // Returns the contents of a memory mapped file, which is Size() bytes long, or nullptr if the file isn't memory mapped.
+        const char* GetMappedData();
+
         // Returns the last error message, if any.
         std::string GetError();
 
@@ -49,15 +70,43 @@ namespace Ossium
     private:
         NOCOPY(File);
 
+        // Size of the buffer used when the file isn't memory mapped. The buffer grows if a single line or element is larger.
+        static constexpr Sint64 BufferSize = 65536;
+
+        // Attempts to memory map the file. Returns false if the file can't be mapped.
+        bool Map(const std::string& path);
+
+        // Discards buffered data before the cursor and reads more of the file into the buffer.
+        // Returns false if there is no more data to read.
+        bool Refill();
+
         // The last error message.
         std::string error = "";
 
-        // Pointer to the file stream.
-        SDL_RWops* file;
+        // Pointer to the file stream, if the file isn't memory mapped.
+        SDL_RWops* file = NULL;
 
         // File size.
         Sint64 size = -1;
 
+        // Start of the file data that can be read, either the mapped file or the buffer.
+        const char* data = nullptr;
+
+        // Number of bytes available from data.
+        Sint64 available = 0;
+
+        // Position in the file of the first byte of data.
+        Sint64 offset = 0;
+
+        // Position of the next byte to read, relative to data.
+        Sint64 cursor = 0;
+
+        // Buffer for files that aren't memory mapped.
+        std::vector<char> buffer;
+
+        // Platform specific handle to the file mapping, if any.
+        void* mapping = nullptr;
+
     };
     
 }
@@ -168,6 +168,7 @@ namespace Ossium
 
     void Font::Free()
     {
+        StopRasteriser();
         FreeGlyphs();
         FreeAtlas();
         Renderer* renderer = texturePass.GetRenderer();
@@ -175,6 +176,7 @@ namespace Ossium
         {
             //texturePass.GetRenderer()->RemoveInput(&texturePass);
         }
+        CloseMipmapFonts(mipmapFonts);
         if (font != NULL)
         {
             TTF_CloseFont(font);
@@ -215,6 +217,9 @@ namespace Ossium
 
     bool Font::Init(string guid_path, Renderer* renderer, Uint32 glyphCacheLimit, int mipDepth, Uint32 targetTextureSize)
     {
+        // Rasteriser workers depend on the metrics computed here.
+        StopRasteriser();
+
         // TODO enable this but with a different renderer/render target
         // DO NOT ENABLE THIS WITH A WINDOW RENDERER
         //renderer->AddInput(&texturePass);
@@ -263,26 +268,8 @@ namespace Ossium
         }
 
         // Open up the font at different mipmap levels
-        for (auto f : mipmapFonts)
-        {
-            if (f != NULL)
-            {
-                TTF_CloseFont(f);
-            }
-            f = NULL;
-        }
-        mipmapFonts.clear();
-        float pointSize = (float)loadedPointSize;
-        for (int level = 0; level < mipmapDepth; level++)
-        {
-            pointSize = pointSize * 0.5f;
-            //Log.Info("Loading font '{0}' at point size {1}", guid_path, pointSize);
-            mipmapFonts.push_back(TTF_OpenFont(guid_path.c_str(), (int)pointSize));
-            if (mipmapFonts.back() == NULL)
-            {
-                Log.Error("TTF_Error opening font '{0}': {1}", guid_path, TTF_GetError());
-            }
-        }
+        CloseMipmapFonts(mipmapFonts);
+        OpenMipmapFonts(mipmapFonts);
 
         if (targetTextureSize == 0)
         {
@@ -303,6 +290,9 @@ namespace Ossium
         {
             cacheLimit = glyphCacheLimit;
         }
+        textureCache.SetCapacity(maxAtlasGlyphs);
+        glyphCache.SetCapacity(cacheLimit);
+        atlasGlyphMap.clear();
         Log.Verbose("Font {0} has atlas size: {1}, max glyphs: {2}, cache limit: {3}, mipmap depth: {4}", guid_path, actualTextureSize.x, maxAtlasGlyphs, cacheLimit, mipmapDepth);
 
         // Create the empty atlas surface in transparent white so color modulation works.
@@ -376,6 +366,28 @@ namespace Ossium
     }
 
     Font::Glyph* Font::GetGlyph(GlyphID id)
+    {
+        auto itr = glyphs.find(id);
+        if (itr != glyphs.end())
+        {
+            // Already cached, return the glyph
+            glyphCache.Access(id);
+            return itr->second;
+        }
+
+        if (IsRasteriserRunning())
+        {
+            // Render a placeholder until the glyph has been rasterised in the background.
+            RequestRasterise(id);
+            return nullptr;
+        }
+
+        float inverseScale = 1.0f;
+        SDL_Surface* created = RasteriseGlyph(id, font, mipmapFonts, inverseScale);
+        return InsertGlyph(id, created, inverseScale);
+    }
+
+    SDL_Surface* Font::RasteriseGlyph(GlyphID id, TTF_Font* mainFont, vector<TTF_Font*>& mipFonts, float& inverseScale)
     {
         int outline = (id & GLYPH_OUTLINE_MASK) >> GLYPH_OUTLINE_SHIFT;
         int hinting = (id & GLYPH_HINTING_MASK) >> GLYPH_HINTING_SHIFT;
@@ -383,164 +395,175 @@ namespace Ossium
 
         Uint32 codepoint = id & GLYPH_UNICODE_MASK;
 
-        Glyph* glyph = nullptr;
+        inverseScale = 1.0f;
 
-        auto itr = glyphs.find(id);
-        if (itr != glyphs.end())
+        // Check if the glyph exists in the font.
+        // TODO: upgrade encoding from UCS-2 to UCS-4 on next SDL_TTF update.
+        // Currently the glyphs are limited due to lack of proper character encoding support in SDL_TTF.
+        if (!TTF_GlyphIsProvided(mainFont, (Uint16)codepoint))
         {
-            // Already cached, return the glyph
-            glyphCache.Access(id);
-            glyph = itr->second;
+            Log.Verbose("Glyph is not provided for UTF-8 character [Codepoint {0}].", codepoint);
+            return NULL;
         }
-        else
+
+        // Configure font
+        if (hinting != TTF_GetFontHinting(mainFont))
+        {
+            TTF_SetFontHinting(mainFont, hinting);
+        }
+        if (outline != TTF_GetFontOutline(mainFont))
+        {
+            TTF_SetFontOutline(mainFont, outline);
+        }
+        if (style != TTF_GetFontStyle(mainFont))
         {
-            // Check if the glyph exists in the font.
-            // TODO: upgrade encoding from UCS-2 to UCS-4 on next SDL_TTF update.
-            // Currently the glyphs are limited due to lack of proper character encoding support in SDL_TTF.
-            if (TTF_GlyphIsProvided(font, (Uint16)codepoint))
+            TTF_SetFontStyle(mainFont, style);
+        }
+
+        SDL_Surface* result = NULL;
+
+        // Render the glyph
+        // TODO: ditto regarding converting encoding from UCS-2 to UCS-4 when SDL_TTF gets updated
+        SDL_Surface* renderedGlyph = TTF_RenderGlyph_Blended(mainFont, (Uint16)codepoint, Colors::White);
+        SDL_Surface* created = Image::CreateEmptySurface(cellSize.x, cellSize.y, Alpha(Colors::White, 0));
+        if (created != NULL && renderedGlyph != NULL)
+        {
+            // First, get the scaling correct
+            int maxSize = GetAtlasMipSize(0);
+            if (renderedGlyph->w > maxSize)
             {
-                // Configure font
-                if (hinting != TTF_GetFontHinting(font))
-                {
-                    TTF_SetFontHinting(font, hinting);
-                }
-                if (outline != TTF_GetFontOutline(font))
-                {
-                    TTF_SetFontOutline(font, outline);
-                }
-                if (style != TTF_GetFontStyle(font))
+                inverseScale = (float)renderedGlyph->w / (float)maxSize;
+            }
+            if (renderedGlyph->h > maxSize)
+            {
+                float rescaled = (float)renderedGlyph->h / (float)maxSize;
+                if (rescaled < inverseScale)
                 {
-                    TTF_SetFontStyle(font, style);
+                    inverseScale = rescaled;
                 }
-                // Render the glyph
-                // TODO: ditto regarding converting encoding from UCS-2 to UCS-4 when SDL_TTF gets updated
-                SDL_Surface* renderedGlyph = TTF_RenderGlyph_Blended(font, (Uint16)codepoint, Colors::White);
-                SDL_Surface* created = Image::CreateEmptySurface(GetAtlasCellSize().x, GetAtlasCellSize().y, Alpha(Colors::White, 0));
-                if (created != NULL && renderedGlyph != NULL)
+            }
+
+            bool blitSuccess = false;
+            if (inverseScale != 1.0f)
+            {
+                Log.Verbose("Glyph [Codepoint: {0}] is too large for atlas cell, downscaling. Scaling artifacts may be present. Upscale factor is {1}.", codepoint, inverseScale);
+                // Scale the glyph when blitting it
+                float scale = (1.0f / inverseScale);
+                SDL_Rect dest = {0, 0, (int)((float)renderedGlyph->w * scale), (int)((float)renderedGlyph->h * scale)};
+                blitSuccess = SDL_BlitScaled(renderedGlyph, NULL, created, &dest) == 0;
+            }
+            else
+            {
+                blitSuccess = SDL_BlitSurface(renderedGlyph, NULL, created, NULL) == 0;
+            }
+
+            if (blitSuccess)
+            {
+                // Render mipmaps
+                for (int level = 0, counti = min(mipmapDepth, (int)mipFonts.size()); level < counti; level++)
                 {
-                    // First, get the scaling correct
-                    float inverseScale = 1.0f;
-                    int maxSize = GetAtlasMipSize(0);
-                    if (renderedGlyph->w > maxSize)
+                    SDL_Rect dest = mipOffsets[level + 1];
+                    TTF_Font* mipFont = mipFonts[level];
+                    if (mipFont == NULL)
                     {
-                        inverseScale = (float)renderedGlyph->w / (float)maxSize;
+                        // TODO?: resort to manual scaling down? At this point we shouldn't be using mipmaps if they can't be generated.
+                        continue;
                     }
-                    if (renderedGlyph->h > GetAtlasMipSize(0))
+                    if (hinting != TTF_GetFontHinting(mipFont))
                     {
-                        float rescaled = (float)renderedGlyph->h / (float)maxSize;
-                        if (rescaled < inverseScale)
-                        {
-                            inverseScale = rescaled;
-                        }
+                        TTF_SetFontHinting(mipFont, hinting);
                     }
-
-                    bool blitSuccess = false;
-                    if (inverseScale != 1.0f)
+                    if (outline != TTF_GetFontOutline(mipFont))
                     {
-                        Log.Verbose("Glyph [Codepoint: {0}] is too large for atlas cell, downscaling. Scaling artifacts may be present. Upscale factor is {1}.", codepoint, inverseScale);
-                        // Scale the glyph when blitting it
-                        float scale = (1.0f / inverseScale);
-                        SDL_Rect dest = {0, 0, (int)((float)renderedGlyph->w * scale), (int)((float)renderedGlyph->h * scale)};
-                        blitSuccess = SDL_BlitScaled(renderedGlyph, NULL, created, &dest) == 0;
+                        TTF_SetFontOutline(mipFont, outline);
                     }
-                    else
+                    if (style != TTF_GetFontStyle(mipFont))
                     {
-                        blitSuccess = SDL_BlitSurface(renderedGlyph, NULL, created, NULL) == 0;
+                        TTF_SetFontStyle(mipFont, style);
                     }
-
-                    if (blitSuccess)
+                    // TODO: downscale mips that are too large
+                    SDL_Surface* mipped = TTF_RenderGlyph_Blended(mipFont, codepoint, Colors::White);
+                    if (mipped != NULL)
                     {
-                        // Update the cache
-                        if (glyphCache.Size() >= cacheLimit)
-                        {
-                            // Replace a glyph in the glyph cache
-                            Uint32 toReplace = glyphCache.GetLRU();
-                            // Remove from the cache
-                            glyphCache.PopLRU();
-                            auto replaceItr = glyphs.find(toReplace);
-                            if (replaceItr != glyphs.end())
-                            {
-                                // Remove the current map entry
-                                glyph = replaceItr->second;
-                                glyphs.erase(replaceItr);
-                            }
-                            else
-                            {
-                                // This should never happen. If it does there's a problem in code.
-                                Log.Error("Font system failure! LRU decimal code point {0} not found in glyphs map :(", toReplace);
-                            }
-                        }
-                        else
-                        {
-                            // Create a new glyph
-                            glyph = new Glyph();
-                        }
-
-                        // Render mipmaps
-                        for (int level = 0; level < mipmapDepth; level++)
-                        {
-                            SDL_Rect dest = mipOffsets[level + 1];
-                            TTF_Font* mipFont = mipmapFonts[level];
-                            if (hinting != TTF_GetFontHinting(mipFont))
-                            {
-                                TTF_SetFontHinting(mipFont, hinting);
-                            }
-                            if (outline != TTF_GetFontOutline(mipFont))
-                            {
-                                TTF_SetFontOutline(mipFont, outline);
-                            }
-                            if (style != TTF_GetFontStyle(mipFont))
-                            {
-                                TTF_SetFontStyle(mipFont, style);
-                            }
-                            if (mipFont == NULL)
-                            {
-                                // TODO?: resort to manual scaling down? At this point we shouldn't be using mipmaps if they can't be generated.
-                            }
-                            else
-                            {
-                                // TODO: downscale mips that are too large
-                                SDL_Surface* mipped = TTF_RenderGlyph_Blended(mipFont, codepoint, Colors::White);
-                                if (mipped != NULL)
-                                {
-                                    //Log.Info("Blitting from {0} onto {1} (surface = {2})", Vector2(mipped->w, mipped->h), dest, Vector2(renderedGlyph->w, renderedGlyph->h));
-                                    SDL_BlitSurface(mipped, NULL, created, &dest);
-                                    SDL_FreeSurface(mipped);
-                                    mipped = NULL;
-                                }
-                                else
-                                {
-                                    Log.Error("Failed to blit mipmap level {0} for glyph [Codepoint {1}]!", level, codepoint);
-                                }
-                            }
-                        }
-
-                        // Glyph manages surface memory now
-                        glyph->cached.SetSurface(created);
-                        glyph->inverseScale = inverseScale;
-                        glyph->id = id;
+                        SDL_BlitSurface(mipped, NULL, created, &dest);
+                        SDL_FreeSurface(mipped);
+                        mipped = NULL;
                     }
                     else
                     {
-                        Log.Error("Failed to blit glyph. SDL_Error: {0}", SDL_GetError());
+                        Log.Error("Failed to blit mipmap level {0} for glyph [Codepoint {1}]!", level, codepoint);
                     }
-
-                }
-                else
-                {
-                    Log.Error("Failed to render glyph to surface. TTF_Error: {0}", TTF_GetError());
-                }
-                if (renderedGlyph != NULL)
-                {
-                    SDL_FreeSurface(renderedGlyph);
-                    renderedGlyph = NULL;
                 }
+                result = created;
             }
             else
             {
-                Log.Verbose("Glyph is not provided for UTF-8 character [Codepoint {0}].", codepoint);
+                Log.Error("Failed to blit glyph. SDL_Error: {0}", SDL_GetError());
             }
+        }
+        else
+        {
+            Log.Error("Failed to render glyph to surface. TTF_Error: {0}", TTF_GetError());
+        }
 
+        if (result == NULL && created != NULL)
+        {
+            SDL_FreeSurface(created);
+            created = NULL;
+        }
+        if (renderedGlyph != NULL)
+        {
+            SDL_FreeSurface(renderedGlyph);
+            renderedGlyph = NULL;
+        }
+
+        return result;
+    }
+
+    Font::Glyph* Font::InsertGlyph(GlyphID id, SDL_Surface* rasterised, float inverseScale)
+    {
+        Glyph* glyph = nullptr;
+
+        // Update the cache. Invalid glyphs count towards the limit too, as the cache has a fixed capacity.
+        if (glyphCache.Size() >= cacheLimit)
+        {
+            // Replace a glyph in the glyph cache
+            Uint32 toReplace = glyphCache.GetLRU();
+            // Remove from the cache
+            glyphCache.PopLRU();
+            auto replaceItr = glyphs.find(toReplace);
+            if (replaceItr != glyphs.end())
+            {
+                // Remove the current map entry
+                glyph = replaceItr->second;
+                glyphs.erase(replaceItr);
+            }
+            else
+            {
+                // This should never happen. If it does there's a problem in code.
+                Log.Error("Font system failure! LRU decimal code point {0} not found in glyphs map :(", toReplace);
+            }
+        }
+
+        if (rasterised != NULL)
+        {
+            if (glyph == nullptr)
+            {
+                // Create a new glyph
+                glyph = new Glyph();
+            }
+
+            // Glyph manages surface memory now
+            glyph->cached.SetSurface(rasterised);
+            glyph->inverseScale = inverseScale;
+            glyph->id = id;
+            // The replaced glyph's atlas cell now belongs to a glyph that is no longer cached.
+            glyph->atlasIndex = 0;
+        }
+        else if (glyph != nullptr)
+        {
+            delete glyph;
+            glyph = nullptr;
         }
 
         // Add the glyph to the map and update the LRU cache
@@ -718,6 +741,241 @@ namespace Ossium
         textureCache.Clear();
     }
 
+    void Font::OpenMipmapFonts(vector<TTF_Font*>& mipFonts)
+    {
+        float pointSize = (float)loadedPointSize;
+        for (int level = 0; level < mipmapDepth; level++)
+        {
+            pointSize = pointSize * 0.5f;
+            mipFonts.push_back(TTF_OpenFont(path.c_str(), (int)pointSize));
+            if (mipFonts.back() == NULL)
+            {
+                Log.Error("TTF_Error opening font '{0}': {1}", path, TTF_GetError());
+            }
+        }
+    }
+
+    void Font::CloseMipmapFonts(vector<TTF_Font*>& mipFonts)
+    {
+        for (auto f : mipFonts)
+        {
+            if (f != NULL)
+            {
+                TTF_CloseFont(f);
+            }
+        }
+        mipFonts.clear();
+    }
+
+    bool Font::StartRasteriser(Uint32 workers)
+    {
+        if (IsRasteriserRunning())
+        {
+            return true;
+        }
+        if (font == NULL || atlas.GetSurface() == NULL)
+        {
+            Log.Error("Cannot start glyph rasteriser, font '{0}' is not initialised!", path);
+            return false;
+        }
+
+        rasteriserLock = SDL_CreateMutex();
+        rasteriserSignal = SDL_CreateCond();
+        if (rasteriserLock == NULL || rasteriserSignal == NULL)
+        {
+            Log.Error("Failed to create glyph rasteriser sync objects! SDL_Error: {0}", SDL_GetError());
+            StopRasteriser();
+            return false;
+        }
+        rasteriserQuit = false;
+
+        for (Uint32 i = 0; i < max(workers, (Uint32)1); i++)
+        {
+            // SDL_ttf shares a single FreeType library instance, so fonts are opened on this thread
+            // and each worker only ever touches it's own faces.
+            RasteriserWorker* worker = new RasteriserWorker();
+            worker->owner = this;
+            worker->font = TTF_OpenFont(path.c_str(), loadedPointSize);
+            if (worker->font == NULL)
+            {
+                Log.Error("Failed to open font '{0}' for glyph rasteriser! TTF_Error: {1}", path, TTF_GetError());
+                delete worker;
+                break;
+            }
+            OpenMipmapFonts(worker->mipmapFonts);
+            worker->thread = SDL_CreateThread(RasteriserThread, "GlyphRasteriser", (void*)worker);
+            if (worker->thread == NULL)
+            {
+                Log.Error("Failed to create glyph rasteriser thread! SDL_Error: {0}", SDL_GetError());
+                CloseMipmapFonts(worker->mipmapFonts);
+                TTF_CloseFont(worker->font);
+                delete worker;
+                break;
+            }
+            rasteriserWorkers.push_back(worker);
+        }
+
+        if (rasteriserWorkers.empty())
+        {
+            StopRasteriser();
+            return false;
+        }
+        return true;
+    }
+
+    void Font::StopRasteriser()
+    {
+        if (rasteriserLock != NULL)
+        {
+            SDL_LockMutex(rasteriserLock);
+            rasteriserQuit = true;
+            rasteriseRequests.clear();
+            if (rasteriserSignal != NULL)
+            {
+                SDL_CondBroadcast(rasteriserSignal);
+            }
+            SDL_UnlockMutex(rasteriserLock);
+        }
+
+        for (RasteriserWorker* worker : rasteriserWorkers)
+        {
+            SDL_WaitThread(worker->thread, NULL);
+            CloseMipmapFonts(worker->mipmapFonts);
+            TTF_CloseFont(worker->font);
+            delete worker;
+        }
+        rasteriserWorkers.clear();
+
+        // Workers have exited, so the queues are no longer shared.
+        for (RasterisedGlyph& finished : rasterised)
+        {
+            if (finished.surface != NULL)
+            {
+                SDL_FreeSurface(finished.surface);
+            }
+        }
+        rasterised.clear();
+        pendingGlyphs.clear();
+
+        if (rasteriserSignal != NULL)
+        {
+            SDL_DestroyCond(rasteriserSignal);
+            rasteriserSignal = NULL;
+        }
+        if (rasteriserLock != NULL)
+        {
+            SDL_DestroyMutex(rasteriserLock);
+            rasteriserLock = NULL;
+        }
+    }
+
+    bool Font::IsRasteriserRunning()
+    {
+        return !rasteriserWorkers.empty();
+    }
+
+    void Font::RequestRasterise(GlyphID id)
+    {
+        if (pendingGlyphs.insert(id).second)
+        {
+            SDL_LockMutex(rasteriserLock);
+            rasteriseRequests.push_back(id);
+            SDL_CondSignal(rasteriserSignal);
+            SDL_UnlockMutex(rasteriserLock);
+        }
+    }
+
+    int Font::RasteriserThread(void* data)
+    {
+        RasteriserWorker* worker = (RasteriserWorker*)data;
+        Font* owner = worker->owner;
+
+        SDL_LockMutex(owner->rasteriserLock);
+        while (true)
+        {
+            while (!owner->rasteriserQuit && owner->rasteriseRequests.empty())
+            {
+                SDL_CondWait(owner->rasteriserSignal, owner->rasteriserLock);
+            }
+            if (owner->rasteriserQuit)
+            {
+                break;
+            }
+
+            RasterisedGlyph finished;
+            finished.id = owner->rasteriseRequests.front();
+            owner->rasteriseRequests.pop_front();
+
+            // Rasterise without holding the lock so other workers and the main thread aren't blocked.
+            SDL_UnlockMutex(owner->rasteriserLock);
+            finished.surface = owner->RasteriseGlyph(finished.id, worker->font, worker->mipmapFonts, finished.inverseScale);
+            SDL_LockMutex(owner->rasteriserLock);
+
+            owner->rasterised.push_back(finished);
+        }
+        SDL_UnlockMutex(owner->rasteriserLock);
+
+        return 0;
+    }
+
+    Uint32 Font::Prefetch(const u32string& codepoints, Uint8 style, Uint8 hinting, Uint8 outline)
+    {
+        Uint32 queued = 0;
+        for (char32_t codepoint : codepoints)
+        {
+            GlyphID id = CreateGlyphID((Uint32)codepoint & GLYPH_UNICODE_MASK, style, hinting, outline);
+            if (glyphs.find(id) == glyphs.end() && pendingGlyphs.find(id) == pendingGlyphs.end())
+            {
+                // When the rasteriser isn't running this renders the glyph immediately.
+                GetGlyph(id);
+                queued++;
+            }
+        }
+        return queued;
+    }
+
+    Uint32 Font::Prefetch(Uint32 firstCodepoint, Uint32 lastCodepoint, Uint8 style, Uint8 hinting, Uint8 outline)
+    {
+        Uint32 queued = 0;
+        lastCodepoint = min(lastCodepoint, GLYPH_UNICODE_MASK);
+        for (Uint32 codepoint = firstCodepoint; codepoint <= lastCodepoint; codepoint++)
+        {
+            GlyphID id = CreateGlyphID(codepoint, style, hinting, outline);
+            if (glyphs.find(id) == glyphs.end() && pendingGlyphs.find(id) == pendingGlyphs.end())
+            {
+                GetGlyph(id);
+                queued++;
+            }
+        }
+        return queued;
+    }
+
+    Uint32 Font::PackRasterised()
+    {
+        if (!IsRasteriserRunning())
+        {
+            return 0;
+        }
+
+        vector<RasterisedGlyph> finished;
+        SDL_LockMutex(rasteriserLock);
+        finished.swap(rasterised);
+        SDL_UnlockMutex(rasteriserLock);
+
+        for (RasterisedGlyph& received : finished)
+        {
+            pendingGlyphs.erase(received.id);
+            Glyph* glyph = InsertGlyph(received.id, received.surface, received.inverseScale);
+            // Only pack while this batch has space in the font atlas, the rest are packed on demand.
+            if (glyph != nullptr && GetBatchPackTotal() < GetAtlasMaxGlyphs())
+            {
+                BatchPackGlyph(received.id, glyph);
+            }
+        }
+
+        return finished.size();
+    }
+
     TTF_Font* Font::GetFont()
     {
         return font;
@@ -20,9 +20,12 @@
 #include <string>
 #include <map>
 #include <unordered_map>
+#include <unordered_set>
+#include <deque>
 extern "C"
 {
     #include <SDL_ttf.h>
+    #include <SDL_thread.h>
 }
 
 #include "resourcecontroller.h"
@@ -246,6 +249,28 @@ namespace Ossium
         /// Frees all glyphs in the map and clears the LRU caches. Does not destroy the atlas texture.
         void FreeGlyphs();
 
+        /// Starts rasterising glyphs on background worker threads. Returns false if the font is not initialised or the threads could not be created.
+        /** While the rasteriser is running, glyphs that are not yet cached are queued for rasterisation rather than rendered on the spot;
+         *  they render as invalid glyph boxes until they have been packed by PackRasterised(). Each worker opens its own copies of the font. */
+        bool StartRasteriser(Uint32 workers = 1);
+
+        /// Stops the background rasteriser, discarding any outstanding requests and unpacked glyphs.
+        void StopRasteriser();
+
+        /// Is the background rasteriser running?
+        bool IsRasteriserRunning();
+
+        /// Queues the glyphs for a string of codepoints for rasterisation ahead of use. Returns the number of glyphs queued.
+        /// If the background rasteriser is not running, the glyphs are rasterised immediately instead.
+        Uint32 Prefetch(const std::u32string& codepoints, Uint8 style = TTF_STYLE_NORMAL, Uint8 hinting = TTF_HINTING_NORMAL, Uint8 outline = 0);
+
+        /// Ditto, but for an inclusive range of codepoints, e.g. 0x4E00 to 0x9FFF for the common CJK ideographs.
+        Uint32 Prefetch(Uint32 firstCodepoint, Uint32 lastCodepoint, Uint8 style = TTF_STYLE_NORMAL, Uint8 hinting = TTF_HINTING_NORMAL, Uint8 outline = 0);
+
+        /// Moves glyphs finished by the background rasteriser into the glyph cache and packs them into the atlas. Returns the number of glyphs received.
+        /// This should be called once per frame; EngineSystem does this for all fonts in its ResourceController.
+        Uint32 PackRasterised();
+
         /// Returns pointer to a font. Useful if you want to use SDL_ttf functions directly.
         TTF_Font* GetFont();
 
@@ -336,6 +361,43 @@ namespace Ossium
         /// Internal method for batching a glyph.
         Uint32 BatchPackGlyph(GlyphID id, Glyph* glyph);
 
+        /// Renders a glyph and all of it's mipmaps to a new atlas cell surface using the given fonts. Returns NULL if the glyph could not be rendered.
+        /** This only reads font metrics that are set up by Init(), so it is safe to call from rasteriser threads with their own TTF_Font instances. */
+        SDL_Surface* RasteriseGlyph(GlyphID id, TTF_Font* mainFont, std::vector<TTF_Font*>& mipFonts, float& inverseScale);
+
+        /// Adds a rasterised glyph surface to the glyphs map, replacing the least recently used glyph if the cache is full.
+        /// Passing a NULL surface caches the glyph as invalid. Returns the cached glyph, or nullptr if invalid.
+        Glyph* InsertGlyph(GlyphID id, SDL_Surface* rasterised, float inverseScale);
+
+        /// Opens the font at each mipmap point size.
+        void OpenMipmapFonts(std::vector<TTF_Font*>& mipFonts);
+
+        /// Closes fonts opened by OpenMipmapFonts().
+        void CloseMipmapFonts(std::vector<TTF_Font*>& mipFonts);
+
+        /// Queues a glyph for background rasterisation, unless it is already queued.
+        void RequestRasterise(GlyphID id);
+
+        /// Entry point for rasteriser worker threads.
+        static int RasteriserThread(void* data);
+
+        /// State owned by a single rasteriser worker thread.
+        struct RasteriserWorker
+        {
+            Font* owner = nullptr;
+            SDL_Thread* thread = NULL;
+            TTF_Font* font = NULL;
+            std::vector<TTF_Font*> mipmapFonts;
+        };
+
+        /// A glyph surface produced by a rasteriser worker, waiting to be packed on the main thread.
+        struct RasterisedGlyph
+        {
+            GlyphID id;
+            SDL_Surface* surface;
+            float inverseScale;
+        };
+
         /// Copying is not permitted.
         NOCOPY(Font);
 
@@ -417,6 +479,27 @@ namespace Ossium
         // RenderInput instance for creating the atlas
         FontRenderInput texturePass;
 
+        /// Background rasteriser worker threads.
+        std::vector<RasteriserWorker*> rasteriserWorkers;
+
+        /// Glyphs waiting to be rasterised. Guarded by rasteriserLock.
+        std::deque<GlyphID> rasteriseRequests;
+
+        /// Glyphs that have been rasterised but not yet packed. Guarded by rasteriserLock.
+        std::vector<RasterisedGlyph> rasterised;
+
+        /// Glyphs that have been requested but not yet packed. Only accessed on the main thread.
+        std::unordered_set<GlyphID> pendingGlyphs;
+
+        /// Guards the rasteriser queues.
+        SDL_mutex* rasteriserLock = NULL;
+
+        /// Wakes up rasteriser workers when requests are queued or the rasteriser is stopped.
+        SDL_cond* rasteriserSignal = NULL;
+
+        /// Set when the rasteriser workers should exit. Guarded by rasteriserLock.
+        bool rasteriserQuit = false;
+
     };
 
 }
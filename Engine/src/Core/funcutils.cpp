@@ -14,6 +14,7 @@
  *  3. This notice may not be removed or altered from any source distribution.
  *
 **/
+#include <charconv>
 #include <cstdarg>
 #include <cstdio>
 #include <string>
@@ -247,6 +248,27 @@ namespace Ossium
             return out;
         }
 
+        const char* SkipSpaces(const char* pos, const char* end)
+        {
+            while (pos < end && (*pos == ' ' || *pos == '\t'))
+            {
+                pos++;
+            }
+            return pos;
+        }
+
+        const char* ParseFloat(const char* pos, const char* end, float& value)
+        {
+            pos = SkipSpaces(pos, end);
+            // from_chars doesn't accept a leading plus sign
+            if (pos < end && *pos == '+')
+            {
+                pos++;
+            }
+            from_chars_result result = from_chars(pos, end, value);
+            return result.ec == errc() ? result.ptr : nullptr;
+        }
+
         bool IsInt(const string& data)
         {
             bool isi = false;
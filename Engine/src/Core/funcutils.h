@@ -71,6 +71,13 @@ namespace Ossium
         /// Splits a string up into smaller strings depending on the delimiter.
         OSSIUM_EDL std::vector<std::string> Split(std::string data, char delimited = ' ');
 
+        /// Returns the first character from pos that isn't a space or tab, or end if there are none.
+        OSSIUM_EDL const char* SkipSpaces(const char* pos, const char* end);
+
+        /// Parses a float after any spaces or tabs from pos, without allocating.
+        /// Returns a pointer to the character after the float, or nullptr if there isn't a float.
+        OSSIUM_EDL const char* ParseFloat(const char* pos, const char* end, float& value);
+
         ///
         /// Type query functions (for converting strings to specific data types).
         ///
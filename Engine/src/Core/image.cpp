@@ -30,20 +30,10 @@ namespace Ossium
 
     REGISTER_RESOURCE(Image);
 
-    Image::Image()
-    {
-        // Load shaders
-        shaderVertex.LoadAndInit(Shader::GetPath("image.vert"));
-        shaderFragment.LoadAndInit(Shader::GetPath("image.frag"));
-        shaderProgram = bgfx::createProgram(shaderVertex.GetHandle(), shaderFragment.GetHandle(), false);
-    }
-
     Image::~Image()
     {
         PopGPU();
         FreeSurface();
-
-        bgfx::destroy(shaderProgram);
     }
 
     void Image::FreeSurface()
@@ -182,14 +172,17 @@ namespace Ossium
         float v;
         Uint32 color;
 
-        static bgfx::VertexLayout Layout()
+        static const bgfx::VertexLayout& Layout()
         {
-            bgfx::VertexLayout layout;
-            layout.begin()
-                .add(bgfx::Attrib::Position, 2, bgfx::AttribType::Float)
-                .add(bgfx::Attrib::TexCoord0, 2, bgfx::AttribType::Float)
-                .add(bgfx::Attrib::Color0, 4, bgfx::AttribType::Uint8, true)
-            .end();
+            static bgfx::VertexLayout layout = [] () {
+                bgfx::VertexLayout layout;
+                layout.begin()
+                    .add(bgfx::Attrib::Position, 2, bgfx::AttribType::Float)
+                    .add(bgfx::Attrib::TexCoord0, 2, bgfx::AttribType::Float)
+                    .add(bgfx::Attrib::Color0, 4, bgfx::AttribType::Uint8, true)
+                .end();
+                return layout;
+            }();
             return layout;
         }
 
@@ -242,12 +235,11 @@ namespace Ossium
             | BGFX_STATE_WRITE_RGB
             // Write alpha
             | BGFX_STATE_WRITE_A
-            // Alpha opacity blending
-            | OSSIUM_BLEND_STANDARD
+            // Alpha opacity blending by default
+            | GetBlendState(blending)
             // Cull backfaces
             | BGFX_STATE_CULL_CW
         );
-        renderer->UpdateStateAndColor();
 
         if (clip && clip->w > 0 && clip->h > 0)
         {
@@ -259,13 +251,6 @@ namespace Ossium
             }
         }
 
-        // Vertex buffer object
-        bgfx::VertexBufferHandle vbo = bgfx::createVertexBuffer(
-            bgfx::copy(vertices, sizeof(vertices)), ImageVertex::Layout()
-        );
-        // Index buffer object
-        bgfx::IndexBufferHandle ibo = bgfx::createIndexBuffer(bgfx::copy(indices, sizeof(indices)));
-
         Matrix<4, 4> view = Matrix<4, 4>::Identity();
         Matrix<4, 4> proj = Matrix<4, 4>::Orthographic(
             0,
@@ -275,19 +260,24 @@ namespace Ossium
             0,
             100
         );
-
-        bgfx::setViewTransform(pass->GetID(), &view, &proj);
-        
-        bgfx::setVertexBuffer(0, vbo);
-        bgfx::setIndexBuffer(ibo);
+        renderer->SetViewTransform(pass, view, proj);
+
+        // Record the draw call, consecutive images using the same texture are submitted together
+        DrawCall call;
+        call.layout = &ImageVertex::Layout();
+        call.vertices = vertices;
+        call.vertexCount = 4;
+        call.indices = indices;
+        call.indexCount = 6;
+        call.program = renderer->GetProgram("image.vert", "image.frag");
+        call.state = renderer->GetState();
+        call.rgba = renderer->GetDrawColorUint32();
+        call.layer = renderer->GetDrawLayer();
+        call.depth = renderer->GetDrawDepth();
         // Set the first (and only) uniform - stage 0 - to the created sampler
-        bgfx::setTexture(0, uniform, texture);
-
-        // Submit the draw call
-        bgfx::submit(pass->GetID(), shaderProgram);
-
-        bgfx::destroy(vbo);
-        bgfx::destroy(ibo);
+        call.texture = texture;
+        call.sampler = uniform;
+        renderer->Draw(pass, call);
     }
 
     int Image::GetWidth()
@@ -37,7 +37,7 @@ namespace Ossium
     public:
         DECLARE_RESOURCE(Image);
 
-        Image();
+        Image() = default;
         ~Image();
 
         /// Destroys the image, freeing it from memory. Does not modify the temporary SDL_Surface
@@ -122,9 +122,10 @@ namespace Ossium
         // Returns the texture flags.
         Uint64 GetTextureFlags();
 
-    protected:
+    private:
         NOCOPY(Image);
 
+    protected:
         /// The path used to load the current image.
         std::string pathname = "";
 
@@ -137,11 +138,6 @@ namespace Ossium
         // Handle to uniform associated with the GPU texture
         bgfx::UniformHandle uniform = BGFX_INVALID_HANDLE;
 
-        // TODO move shader program somewhere shared
-        Shader shaderVertex;
-        Shader shaderFragment;
-        bgfx::ProgramHandle shaderProgram = BGFX_INVALID_HANDLE;
-
         /// Dimensions of the GPU texture.
         int widthGPU = 0;
         int heightGPU = 0;
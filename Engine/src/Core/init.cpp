@@ -77,8 +77,12 @@ namespace Ossium
                 }
                 else
                 {
-                    /// Initialise the Audio channel subsystem
-                    Audio::Internals::ChannelController::Instance.Init(50);
+                    /// Audio clips are mixed by the audio engine, so SDL_mixer only needs to play music
+                    Mix_AllocateChannels(0);
+                    if (!Audio::Internals::AudioEngine::Instance.Init(1024, 256))
+                    {
+                        Log.Warning("Audio engine failed to initialise, audio clips will not play.");
+                    }
 
                     if (TTF_Init() == -1)
                     {
@@ -97,10 +101,12 @@ namespace Ossium
 
     void TerminateOssium()
     {
+        Audio::Internals::AudioEngine::Instance.Clear();
         Mix_CloseAudio();
         TTF_Quit();
         IMG_Quit();
         SDL_Quit();
+        Log.Flush();
         printf("INFO: Successfully terminated Ossium.\n");
     }
 
@@ -0,0 +1,452 @@
+/** COPYRIGHT NOTICE
+ *
+ *  Ossium Engine
+ *  Copyright (c) 2018-2020 Tim Lane
+ *
+ *  This software is provided 'as-is', without any express or implied warranty. In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+ *
+ *  2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+ *
+ *  3. This notice may not be removed or altered from any source distribution.
+ *
+**/
+#include "jobsystem.h"
+#include "logging.h"
+
+using namespace std;
+
+namespace Ossium
+{
+
+    ///
+    /// JobCounter
+    ///
+
+    bool JobCounter::IsDone()
+    {
+        return pending.load(memory_order_acquire) <= 0;
+    }
+
+    namespace Internals
+    {
+
+        ///
+        /// JobDeque
+        ///
+
+        JobDeque::JobDeque(unsigned int capacity) : buffer(capacity), mask((Sint64)capacity - 1)
+        {
+        }
+
+        bool JobDeque::Push(Job* job)
+        {
+            Sint64 b = bottom.load(memory_order_relaxed);
+            Sint64 t = top.load(memory_order_acquire);
+            if (b - t > mask)
+            {
+                return false;
+            }
+            buffer[b & mask].store(job, memory_order_relaxed);
+            bottom.store(b + 1, memory_order_release);
+            return true;
+        }
+
+        Job* JobDeque::Pop()
+        {
+            Sint64 b = bottom.load(memory_order_relaxed) - 1;
+            bottom.store(b, memory_order_relaxed);
+            atomic_thread_fence(memory_order_seq_cst);
+            Sint64 t = top.load(memory_order_relaxed);
+            if (t > b)
+            {
+                /// Empty
+                bottom.store(b + 1, memory_order_relaxed);
+                return nullptr;
+            }
+            Job* job = buffer[b & mask].load(memory_order_relaxed);
+            if (t == b)
+            {
+                /// Last job, so race any thieves for it
+                if (!top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed))
+                {
+                    job = nullptr;
+                }
+                bottom.store(b + 1, memory_order_relaxed);
+            }
+            return job;
+        }
+
+        Job* JobDeque::Steal()
+        {
+            Sint64 t = top.load(memory_order_acquire);
+            atomic_thread_fence(memory_order_seq_cst);
+            Sint64 b = bottom.load(memory_order_acquire);
+            if (t >= b)
+            {
+                return nullptr;
+            }
+            Job* job = buffer[t & mask].load(memory_order_relaxed);
+            if (!top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed))
+            {
+                return nullptr;
+            }
+            return job;
+        }
+
+    }
+
+    ///
+    /// JobSystem
+    ///
+
+    JobSystem::Worker::Worker() : jobs(MaxWorkerJobs), pool(MaxWorkerJobs)
+    {
+    }
+
+    JobSystem::~JobSystem()
+    {
+        Quit();
+    }
+
+    void JobSystem::Init(int workerCount)
+    {
+        Quit();
+        if (workerCount < 0)
+        {
+            workerCount = SDL_GetCPUCount() - 1;
+        }
+
+        quit.store(false);
+        sharedLock = SDL_CreateMutex();
+        wake = SDL_CreateSemaphore(0);
+        if (sharedLock == NULL || wake == NULL)
+        {
+            Log.Error("Failed to create job system synchronisation primitives! SDL_Error: {0}", SDL_GetError());
+            workerCount = 0;
+        }
+
+        for (int i = 0; i <= workerCount; i++)
+        {
+            Worker* worker = new Worker();
+            worker->system = this;
+            worker->index = (unsigned int)i;
+            worker->random = 0x9E3779B9u * (Uint32)(i + 1);
+            workers.push_back(worker);
+        }
+        workers[0]->threadId.store(SDL_ThreadID(), memory_order_release);
+
+        for (unsigned int i = 1, counti = workers.size(); i < counti; i++)
+        {
+            workers[i]->thread = SDL_CreateThread(WorkerThread, "JobWorker", (void*)workers[i]);
+            if (workers[i]->thread == NULL)
+            {
+                Log.Error("Failed to create job worker thread! SDL_Error: {0}", SDL_GetError());
+            }
+        }
+    }
+
+    void JobSystem::Quit()
+    {
+        if (workers.empty())
+        {
+            return;
+        }
+
+        /// Finish outstanding work so no counters are left waiting
+        while (RunJob(workers[0]))
+        {
+        }
+
+        quit.store(true);
+        for (unsigned int i = 1, counti = workers.size(); i < counti; i++)
+        {
+            SDL_SemPost(wake);
+        }
+        for (unsigned int i = 1, counti = workers.size(); i < counti; i++)
+        {
+            if (workers[i]->thread != NULL)
+            {
+                SDL_WaitThread(workers[i]->thread, NULL);
+            }
+        }
+        for (Internals::Job* job : shared)
+        {
+            if (job->heap)
+            {
+                delete job;
+            }
+        }
+        shared.clear();
+        for (Worker* worker : workers)
+        {
+            delete worker;
+        }
+        workers.clear();
+        sharedCount.store(0);
+        SDL_DestroyMutex(sharedLock);
+        sharedLock = NULL;
+        SDL_DestroySemaphore(wake);
+        wake = NULL;
+    }
+
+    void JobSystem::Run(function<void()> work, JobCounter* counter, JobCounter* dependency)
+    {
+        if (counter != nullptr)
+        {
+            counter->pending.fetch_add(1, memory_order_relaxed);
+        }
+        if (workers.empty())
+        {
+            /// Not initialised, so just do the work now
+            work();
+            if (counter != nullptr)
+            {
+                counter->pending.fetch_sub(1, memory_order_release);
+            }
+            return;
+        }
+
+        Worker* worker = GetCurrentWorker();
+        Internals::Job* job = nullptr;
+        if (worker != nullptr)
+        {
+            /// Take the next job slot, helping out until it's free if it's still in use
+            job = &worker->pool[worker->nextJob];
+            while (job->busy.load(memory_order_acquire))
+            {
+                if (!RunJob(worker))
+                {
+                    SDL_Delay(0);
+                }
+            }
+            worker->nextJob = (worker->nextJob + 1) % MaxWorkerJobs;
+        }
+        else
+        {
+            job = new Internals::Job();
+            job->heap = true;
+        }
+        job->work = move(work);
+        job->counter = counter;
+        job->next = nullptr;
+        job->busy.store(true, memory_order_relaxed);
+
+        if (dependency != nullptr)
+        {
+            /// Park the job on the dependency until it is done, rather than queueing it to be picked up and put back repeatedly
+            SDL_AtomicLock(&dependency->lock);
+            bool blocked = !dependency->IsDone();
+            if (blocked)
+            {
+                job->next = dependency->waiting;
+                dependency->waiting = job;
+            }
+            SDL_AtomicUnlock(&dependency->lock);
+            if (blocked)
+            {
+                return;
+            }
+        }
+        Schedule(job, worker);
+    }
+
+    void JobSystem::Schedule(Internals::Job* job, Worker* worker)
+    {
+        if (worker == nullptr || !worker->jobs.Push(job))
+        {
+            SDL_LockMutex(sharedLock);
+            shared.push_back(job);
+            sharedCount.fetch_add(1, memory_order_release);
+            SDL_UnlockMutex(sharedLock);
+        }
+
+        /// Pairs with the fence in WorkerThread(), so either a sleeping worker is seen here or the worker sees the job
+        atomic_thread_fence(memory_order_seq_cst);
+        if (sleeping.load(memory_order_relaxed) > 0)
+        {
+            SDL_SemPost(wake);
+        }
+    }
+
+    void JobSystem::Wait(JobCounter& counter)
+    {
+        Worker* worker = GetCurrentWorker();
+        while (!counter.IsDone())
+        {
+            if (worker == nullptr || !RunJob(worker))
+            {
+                SDL_Delay(0);
+            }
+        }
+        /// The thread that finished the last job may still be releasing the counter, so let it finish before the counter can be destroyed
+        SDL_AtomicLock(&counter.lock);
+        SDL_AtomicUnlock(&counter.lock);
+    }
+
+    void JobSystem::ParallelFor(unsigned int count, unsigned int batchSize, const function<void(unsigned int, unsigned int)>& work)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+        batchSize = batchSize > 0 ? batchSize : 1;
+        if (count <= batchSize || workers.size() <= 1)
+        {
+            work(0, count);
+            return;
+        }
+
+        JobCounter counter;
+        for (unsigned int begin = batchSize; begin < count; begin += batchSize)
+        {
+            unsigned int end = count - begin > batchSize ? begin + batchSize : count;
+            Run([&work, begin, end] () { work(begin, end); }, &counter);
+        }
+        /// The first batch is done here rather than waiting idle
+        work(0, batchSize);
+        Wait(counter);
+    }
+
+    unsigned int JobSystem::GetWorkerCount()
+    {
+        return workers.size();
+    }
+
+    int JobSystem::WorkerThread(void* data)
+    {
+        Worker* worker = (Worker*)data;
+        JobSystem* system = worker->system;
+        worker->threadId.store(SDL_ThreadID(), memory_order_release);
+        while (!system->quit.load(memory_order_acquire))
+        {
+            if (!system->RunJob(worker))
+            {
+                /// Nothing to do, so sleep until a job is scheduled. Count this worker as sleeping before looking for jobs
+                /// one last time, so a job scheduled in between is either found here or wakes the worker.
+                system->sleeping.fetch_add(1, memory_order_relaxed);
+                atomic_thread_fence(memory_order_seq_cst);
+                if (!system->RunJob(worker) && !system->quit.load(memory_order_acquire))
+                {
+                    SDL_SemWait(system->wake);
+                }
+                system->sleeping.fetch_sub(1, memory_order_relaxed);
+            }
+        }
+        return 0;
+    }
+
+    bool JobSystem::RunJob(Worker* worker)
+    {
+        Internals::Job* job = FindJob(worker);
+        if (job == nullptr)
+        {
+            return false;
+        }
+        Execute(job, worker);
+        return true;
+    }
+
+    Internals::Job* JobSystem::FindJob(Worker* worker)
+    {
+        Internals::Job* job = worker->jobs.Pop();
+        if (job != nullptr)
+        {
+            return job;
+        }
+
+        if (sharedCount.load(memory_order_acquire) > 0)
+        {
+            SDL_LockMutex(sharedLock);
+            if (!shared.empty())
+            {
+                job = shared.front();
+                shared.pop_front();
+                sharedCount.fetch_sub(1, memory_order_release);
+            }
+            SDL_UnlockMutex(sharedLock);
+            if (job != nullptr)
+            {
+                return job;
+            }
+        }
+
+        /// Try to steal from every other worker, starting from a random one
+        unsigned int total = workers.size();
+        worker->random ^= worker->random << 13;
+        worker->random ^= worker->random >> 17;
+        worker->random ^= worker->random << 5;
+        for (unsigned int i = 0, start = worker->random % total; i < total; i++)
+        {
+            Worker* victim = workers[(start + i) % total];
+            if (victim != worker)
+            {
+                job = victim->jobs.Steal();
+                if (job != nullptr)
+                {
+                    return job;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    void JobSystem::Execute(Internals::Job* job, Worker* worker)
+    {
+        job->work();
+        job->work = nullptr;
+        JobCounter* counter = job->counter;
+        if (job->heap)
+        {
+            delete job;
+        }
+        else
+        {
+            job->busy.store(false, memory_order_release);
+        }
+        if (counter != nullptr)
+        {
+            Release(counter, worker);
+        }
+    }
+
+    void JobSystem::Release(JobCounter* counter, Worker* worker)
+    {
+        Internals::Job* ready = nullptr;
+        SDL_AtomicLock(&counter->lock);
+        if (counter->pending.fetch_sub(1, memory_order_acq_rel) == 1)
+        {
+            ready = counter->waiting;
+            counter->waiting = nullptr;
+        }
+        SDL_AtomicUnlock(&counter->lock);
+
+        /// The counter may be destroyed from here on
+        while (ready != nullptr)
+        {
+            Internals::Job* next = ready->next;
+            ready->next = nullptr;
+            Schedule(ready, worker);
+            ready = next;
+        }
+    }
+
+    JobSystem::Worker* JobSystem::GetCurrentWorker()
+    {
+        /// Each job system has its own workers, so look the thread up among them rather than in a thread_local
+        /// that would be shared by every job system
+        SDL_threadID id = SDL_ThreadID();
+        for (Worker* worker : workers)
+        {
+            if (worker->threadId.load(memory_order_acquire) == id)
+            {
+                return worker;
+            }
+        }
+        return nullptr;
+    }
+
+}
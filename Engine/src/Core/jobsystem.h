@@ -0,0 +1,212 @@
+/** COPYRIGHT NOTICE
+ *
+ *  Ossium Engine
+ *  Copyright (c) 2018-2020 Tim Lane
+ *
+ *  This software is provided 'as-is', without any express or implied warranty. In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+ *
+ *  2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+ *
+ *  3. This notice may not be removed or altered from any source distribution.
+ *
+**/
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+extern "C"
+{
+    #include <SDL.h>
+}
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <vector>
+
+#include "helpermacros.h"
+#include "services.h"
+
+namespace Ossium
+{
+
+    namespace Internals
+    {
+        struct Job;
+    }
+
+    /// Counts the jobs that have been scheduled with it and not yet finished.
+    /** Pass a counter to JobSystem::Run() and then to JobSystem::Wait() to wait for a group of jobs,
+     *  or pass it as the dependency of other jobs so they only start once the group has finished.
+     *  A counter must outlive the jobs scheduled with it and any call to JobSystem::Wait() with it. */
+    class OSSIUM_EDL JobCounter
+    {
+    public:
+        /// Returns true when every job scheduled with this counter has finished.
+        bool IsDone();
+
+    private:
+        friend class JobSystem;
+
+        std::atomic<int> pending = {0};
+
+        /// Jobs that depend on this counter and are scheduled once it is done, linked through Job::next.
+        Internals::Job* waiting = nullptr;
+
+        /// Guards the waiting list against the counter becoming done while a job is added to it.
+        SDL_SpinLock lock = 0;
+
+    };
+
+    namespace Internals
+    {
+
+        /// A unit of work scheduled with the job system.
+        struct Job
+        {
+            std::function<void()> work;
+
+            /// Decremented when the job finishes, if not null.
+            JobCounter* counter = nullptr;
+
+            /// The next job waiting on the same dependency.
+            Job* next = nullptr;
+
+            /// Is this job slot waiting to run or running?
+            std::atomic<bool> busy = {false};
+
+            /// Was this job allocated on the heap rather than from a worker's job pool?
+            bool heap = false;
+        };
+
+        /// Bounded lock-free work-stealing deque (Chase-Lev).
+        /** Only the owning worker may call Push() and Pop(), which work at the bottom of the deque.
+         *  Any thread may call Steal(), which takes from the top. */
+        class OSSIUM_EDL JobDeque
+        {
+        public:
+            JobDeque(unsigned int capacity);
+
+            /// Adds a job to the bottom of the deque. Returns false if the deque is full.
+            bool Push(Job* job);
+
+            /// Takes the most recently pushed job, or returns nullptr if the deque is empty.
+            Job* Pop();
+
+            /// Takes the oldest job, or returns nullptr if the deque is empty or another thread took the job first.
+            Job* Steal();
+
+        private:
+            NOCOPY(JobDeque);
+
+            std::vector<std::atomic<Job*>> buffer;
+            Sint64 mask;
+            std::atomic<Sint64> top = {0};
+            std::atomic<Sint64> bottom = {0};
+
+        };
+
+    }
+
+    /// Runs jobs on a worker thread per CPU core, so engine subsystems can split work across cores without creating their own threads.
+    /** Each worker, including the thread that called Init(), has its own deque of jobs and steals from the other workers when it runs out.
+     *  Jobs may be scheduled from any thread; jobs scheduled from threads that aren't workers go into a shared queue.
+     *  Jobs must not block waiting on other jobs except through Wait(), which runs other jobs while it waits. */
+    class OSSIUM_EDL JobSystem : public Service<JobSystem>
+    {
+    public:
+        JobSystem() = default;
+        ~JobSystem();
+
+        /// Starts the worker threads. The calling thread becomes worker 0 and only runs jobs when it calls Wait() or ParallelFor().
+        /// A negative number of workers uses one worker per CPU core. With 0 workers, every job runs on the thread that waits for it.
+        void Init(int workers = -1);
+
+        /// Runs any remaining jobs and stops the worker threads. Must be called from the thread that called Init().
+        void Quit();
+
+        /// Schedules a job. If counter is not null, it is incremented now and decremented when the job finishes.
+        /// If dependency is not null, the job won't start until the dependency counter is done.
+        void Run(std::function<void()> work, JobCounter* counter = nullptr, JobCounter* dependency = nullptr);
+
+        /// Waits until the counter is done, running other jobs in the meantime.
+        void Wait(JobCounter& counter);
+
+        /// Calls work(begin, end) for consecutive ranges of at most batchSize indices covering [0, count) across the workers,
+        /// and waits for every range to finish.
+        void ParallelFor(unsigned int count, unsigned int batchSize, const std::function<void(unsigned int, unsigned int)>& work);
+
+        /// Returns the number of threads that run jobs, including the thread that called Init().
+        unsigned int GetWorkerCount();
+
+    private:
+        NOCOPY(JobSystem);
+
+        /// Maximum number of jobs that may be queued by a single worker.
+        static constexpr unsigned int MaxWorkerJobs = 4096;
+
+        /// Data owned by each worker.
+        struct Worker
+        {
+            Worker();
+
+            JobSystem* system = nullptr;
+            unsigned int index = 0;
+            SDL_Thread* thread = NULL;
+
+            /// The thread running this worker, set by the thread itself once it starts.
+            std::atomic<SDL_threadID> threadId = {0};
+
+            /// Jobs scheduled by this worker.
+            Internals::JobDeque jobs;
+
+            /// Ring of job slots used by this worker, so scheduling a job doesn't allocate.
+            std::vector<Internals::Job> pool;
+            unsigned int nextJob = 0;
+
+            /// State for choosing which worker to steal from.
+            Uint32 random = 0;
+        };
+
+        /// Entry point for worker threads.
+        static int WorkerThread(void* data);
+
+        /// Runs one job if there is one available. Returns false if there was nothing to run.
+        bool RunJob(Worker* worker);
+
+        /// Finds a job for the worker, from its own deque, the shared queue or another worker.
+        Internals::Job* FindJob(Worker* worker);
+
+        /// Adds a job that is ready to run to the worker's deque, or to the shared queue if worker is null or its deque is full.
+        void Schedule(Internals::Job* job, Worker* worker);
+
+        /// Runs a job and releases it.
+        void Execute(Internals::Job* job, Worker* worker);
+
+        /// Decrements a counter, scheduling the jobs that depend on it once it is done.
+        void Release(JobCounter* counter, Worker* worker);
+
+        /// Returns the worker of this job system that owns the calling thread, or nullptr if the calling thread isn't one of its workers.
+        Worker* GetCurrentWorker();
+
+        /// Every worker, including worker 0 which belongs to the thread that called Init().
+        std::vector<Worker*> workers;
+
+        /// Jobs scheduled by threads that aren't workers, or by workers whose deque is full.
+        std::deque<Internals::Job*> shared;
+        std::atomic<unsigned int> sharedCount = {0};
+        SDL_mutex* sharedLock = NULL;
+
+        /// Wakes sleeping workers when jobs are scheduled.
+        SDL_sem* wake = NULL;
+        std::atomic<int> sleeping = {0};
+
+        std::atomic<bool> quit = {false};
+
+    };
+
+}
+
+#endif // JOBSYSTEM_H
@@ -14,11 +14,377 @@
  *  3. This notice may not be removed or altered from any source distribution.
  *
 **/
+#include <functional>
+#include <string_view>
+
 #include "logging.h"
 
+using namespace std;
+
 namespace Ossium
 {
 
-    Logger Log;
+    /// Names of each LogLevel for output.
+    static const char* LogLevelNames[] = {"VERBOSE", "DEBUG", "INFO", "WARNING", "ERROR", "CRITICAL"};
+
+    ///
+    /// LogSink
+    ///
+
+    void LogSink::Flush()
+    {
+    }
+
+    ///
+    /// ConsoleLogSink
+    ///
+
+    void ConsoleLogSink::Write(LogLevel level, Uint32 time, const string& message)
+    {
+        /// LogLevel values are one less than the matching SDL priorities
+        SDL_LogMessage(SDL_LOG_CATEGORY_CUSTOM, (SDL_LogPriority)((int)level + 1), "%s", message.c_str());
+    }
+
+    ///
+    /// RotatingFileLogSink
+    ///
+
+    RotatingFileLogSink::RotatingFileLogSink(string path, Uint32 maxBytes, unsigned int maxFiles)
+    {
+        this->path = path;
+        this->maxBytes = maxBytes;
+        this->maxFiles = maxFiles > 0 ? maxFiles : 1;
+        Rotate();
+    }
+
+    RotatingFileLogSink::~RotatingFileLogSink()
+    {
+        if (file != NULL)
+        {
+            fclose(file);
+            file = NULL;
+        }
+    }
+
+    void RotatingFileLogSink::Write(LogLevel level, Uint32 time, const string& message)
+    {
+        char prefix[48];
+        int length = snprintf(
+            prefix,
+            sizeof(prefix),
+            "[%02u:%02u:%02u.%03u] %s: ",
+            (unsigned int)(time / 3600000),
+            (unsigned int)(time / 60000 % 60),
+            (unsigned int)(time / 1000 % 60),
+            (unsigned int)(time % 1000),
+            LogLevelNames[(int)level]
+        );
+        Uint32 size = (Uint32)(length + message.length() + 1);
+        if (written > 0 && written + size > maxBytes)
+        {
+            Rotate();
+        }
+        if (file != NULL)
+        {
+            fwrite(prefix, 1, length, file);
+            fwrite(message.c_str(), 1, message.length(), file);
+            fputc('\n', file);
+            written += size;
+        }
+    }
+
+    void RotatingFileLogSink::Flush()
+    {
+        if (file != NULL)
+        {
+            fflush(file);
+        }
+    }
+
+    void RotatingFileLogSink::Rotate()
+    {
+        if (file != NULL)
+        {
+            fclose(file);
+            file = NULL;
+        }
+
+        /// Shift older files along by one, discarding the oldest
+        for (unsigned int i = maxFiles - 1; i > 0; i--)
+        {
+            string from = i > 1 ? path + "." + Utilities::ToString((int)(i - 1)) : path;
+            string to = path + "." + Utilities::ToString((int)i);
+            remove(to.c_str());
+            rename(from.c_str(), to.c_str());
+        }
+
+        written = 0;
+        file = fopen(path.c_str(), "wb");
+        if (file == NULL)
+        {
+            /// Can't use the logger here as this is called on the logging thread
+            SDL_LogError(SDL_LOG_CATEGORY_CUSTOM, "Failed to open log file '%s'!", path.c_str());
+        }
+    }
+
+    ///
+    /// Logger
+    ///
+
+    Logger::Logger() : queue(QueueCapacity)
+    {
+        sinkLock = SDL_CreateMutex();
+        sinks.push_back(new ConsoleLogSink());
+    }
+
+    Logger::~Logger()
+    {
+        Shutdown();
+        ClearSinks();
+        if (wake != NULL)
+        {
+            SDL_DestroySemaphore(wake);
+            wake = NULL;
+        }
+        SDL_DestroyMutex(sinkLock);
+        sinkLock = NULL;
+    }
+
+    void Logger::AddSink(LogSink* sink)
+    {
+        SDL_LockMutex(sinkLock);
+        sinks.push_back(sink);
+        SDL_UnlockMutex(sinkLock);
+    }
+
+    void Logger::ClearSinks()
+    {
+        SDL_LockMutex(sinkLock);
+        for (LogSink* sink : sinks)
+        {
+            delete sink;
+        }
+        sinks.clear();
+        SDL_UnlockMutex(sinkLock);
+    }
+
+    void Logger::SetLevel(LogLevel level)
+    {
+        minLevel.store((int)level, memory_order_relaxed);
+    }
+
+    void Logger::SetRateLimit(Uint32 messagesPerSecond)
+    {
+        rateLimit.store(messagesPerSecond, memory_order_relaxed);
+    }
+
+    void Logger::Flush()
+    {
+        while (state.load(memory_order_acquire) == 1)
+        {
+            SDL_Delay(0);
+        }
+        if (state.load(memory_order_acquire) == 2)
+        {
+            Uint32 target = queued.load(memory_order_acquire);
+            while ((int)(target - written.load(memory_order_acquire)) > 0 && state.load(memory_order_acquire) == 2)
+            {
+                SDL_SemPost(wake);
+                SDL_Delay(1);
+            }
+        }
+        else
+        {
+            SDL_LockMutex(sinkLock);
+            WriteQueued();
+            SDL_UnlockMutex(sinkLock);
+        }
+    }
+
+    void Logger::Shutdown()
+    {
+        int current = state.exchange(3);
+        if (current == 2)
+        {
+            quit.store(true, memory_order_release);
+            SDL_SemPost(wake);
+            SDL_WaitThread(thread, NULL);
+            thread = NULL;
+        }
+        SDL_LockMutex(sinkLock);
+        WriteQueued();
+        SDL_UnlockMutex(sinkLock);
+    }
+
+    bool Logger::Accept(LogLevel level, const FormatString& message)
+    {
+        if ((int)level < minLevel.load(memory_order_relaxed))
+        {
+            return false;
+        }
+        Uint32 limit = rateLimit.load(memory_order_relaxed);
+        if (limit == 0 || level == LogLevel::Critical)
+        {
+            return true;
+        }
+
+        RateLimitCounter& counter = rateLimits[hash<string_view>()(string_view(message.GetText(), message.GetLength())) % RateLimitSlots];
+        Uint32 now = SDL_GetTicks();
+        Uint32 start = counter.windowStart.load(memory_order_relaxed);
+        if (now - start >= 1000 && counter.windowStart.compare_exchange_strong(start, now, memory_order_relaxed))
+        {
+            /// Start a new window, reporting what was suppressed in the last one
+            counter.count.store(0, memory_order_relaxed);
+            Uint32 suppressed = counter.suppressed.exchange(0, memory_order_relaxed);
+            if (suppressed > 0)
+            {
+                Submit(LogLevel::Warning, Format("Suppressed {0} repeats of log message \"{1}\".", suppressed, string(message.GetText(), message.GetLength())));
+            }
+        }
+        if (counter.count.fetch_add(1, memory_order_relaxed) < limit)
+        {
+            return true;
+        }
+        counter.suppressed.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+
+    void Logger::Submit(LogLevel level, const string& text)
+    {
+        if (!Start())
+        {
+            /// No logging thread, so write on this thread
+            SDL_LockMutex(sinkLock);
+            WriteQueued();
+            WriteToSinks(level, SDL_GetTicks(), text);
+            for (LogSink* sink : sinks)
+            {
+                sink->Flush();
+            }
+            SDL_UnlockMutex(sinkLock);
+            return;
+        }
+
+        Message message;
+        message.level = level;
+        message.time = SDL_GetTicks();
+        message.length = (unsigned int)text.length();
+        if (message.length <= InlineMessageLength)
+        {
+            text.copy(message.inlineText, message.length);
+        }
+        else
+        {
+            message.text = text;
+        }
+
+        if (queue.Push(message))
+        {
+            queued.fetch_add(1, memory_order_release);
+        }
+        else
+        {
+            dropped.fetch_add(1, memory_order_relaxed);
+        }
+
+        if (level == LogLevel::Critical)
+        {
+            Flush();
+        }
+        else if (queue.Size() >= QueueCapacity / 2)
+        {
+            /// Don't wait for the flush interval when the queue is filling up
+            SDL_SemPost(wake);
+        }
+    }
+
+    void Logger::WriteToSinks(const Message& message)
+    {
+        if (message.length <= InlineMessageLength)
+        {
+            line.assign(message.inlineText, message.length);
+            WriteToSinks(message.level, message.time, line);
+        }
+        else
+        {
+            WriteToSinks(message.level, message.time, message.text);
+        }
+    }
+
+    void Logger::WriteToSinks(LogLevel level, Uint32 time, const string& text)
+    {
+        for (LogSink* sink : sinks)
+        {
+            sink->Write(level, time, text);
+        }
+    }
+
+    bool Logger::Start()
+    {
+        int current = state.load(memory_order_acquire);
+        if (current == 0 && state.compare_exchange_strong(current, 1))
+        {
+            wake = SDL_CreateSemaphore(0);
+            thread = wake != NULL ? SDL_CreateThread(LoggingThread, "Logger", (void*)this) : NULL;
+            if (thread == NULL)
+            {
+                SDL_LogError(SDL_LOG_CATEGORY_CUSTOM, "Failed to start logging thread, logging synchronously instead. SDL_Error: %s", SDL_GetError());
+                state.store(3, memory_order_release);
+                return false;
+            }
+            state.store(2, memory_order_release);
+            return true;
+        }
+        /// If the thread is being started by another thread, it will write this message once it's running
+        return current != 3;
+    }
+
+    void Logger::WriteQueued()
+    {
+        bool wrote = false;
+        while (queue.Pop(popped))
+        {
+            WriteToSinks(popped);
+            written.fetch_add(1, memory_order_release);
+            wrote = true;
+        }
+
+        Uint32 lost = dropped.exchange(0, memory_order_relaxed);
+        if (lost > 0)
+        {
+            WriteToSinks(LogLevel::Warning, SDL_GetTicks(), Format("Dropped {0} log messages as too many were logged at once.", lost));
+            wrote = true;
+        }
+
+        if (wrote)
+        {
+            for (LogSink* sink : sinks)
+            {
+                sink->Flush();
+            }
+        }
+    }
+
+    int Logger::LoggingThread(void* data)
+    {
+        Logger* logger = (Logger*)data;
+        while (!logger->quit.load(memory_order_acquire))
+        {
+            /// Messages are written in batches, either every flush interval or when woken early
+            SDL_SemWaitTimeout(logger->wake, FlushInterval);
+            SDL_LockMutex(logger->sinkLock);
+            logger->WriteQueued();
+            SDL_UnlockMutex(logger->sinkLock);
+        }
+        return 0;
+    }
+
+    Logger& Logger::EngineLog()
+    {
+        static Logger engineLog;
+        return engineLog;
+    }
+
+    Logger& Log = Logger::EngineLog();
 
 }
@@ -17,61 +17,259 @@
 #ifndef LOGGING_H
 #define LOGGING_H
 
+#include <atomic>
+#include <cstdio>
+#include <vector>
+
 #include "stringconvert.h"
+#include "mpscqueue.h"
+
+/// Messages below this level (see LogLevel) are removed at compile time.
+/// Debug messages are also removed unless OSSIUM_DEBUG is defined.
+#ifndef OSSIUM_LOG_LEVEL
+#define OSSIUM_LOG_LEVEL 0
+#endif
 
 namespace Ossium
 {
 
+    /// Severity of a log message, from least to most severe.
+    enum class LogLevel
+    {
+        Verbose = 0,
+        Debug,
+        Info,
+        Warning,
+        Error,
+        Critical
+    };
+
+    /// Destination for log messages, such as the console or a file.
+    class OSSIUM_EDL LogSink
+    {
+    public:
+        virtual ~LogSink() = default;
+
+        /// Outputs a message. Called on the logging thread; time is in milliseconds since SDL was initialised.
+        virtual void Write(LogLevel level, Uint32 time, const std::string& message) = 0;
+
+        /// Called on the logging thread after each batch of messages has been written.
+        virtual void Flush();
+
+    };
+
+    /// Writes log messages using SDL_Log, which outputs to the console or the platform's log.
+    class OSSIUM_EDL ConsoleLogSink : public LogSink
+    {
+    public:
+        void Write(LogLevel level, Uint32 time, const std::string& message);
+
+    };
+
+    /// Writes log messages to a file. When the file exceeds the maximum size it is renamed with a numbered extension
+    /// (e.g. "log.txt" becomes "log.txt.1") and a new file is started. Only the most recent files are kept.
+    class OSSIUM_EDL RotatingFileLogSink : public LogSink
+    {
+    public:
+        /// Rotates any existing log file at the path and starts a new one.
+        RotatingFileLogSink(std::string path, Uint32 maxBytes = 1048576, unsigned int maxFiles = 3);
+        ~RotatingFileLogSink();
+
+        void Write(LogLevel level, Uint32 time, const std::string& message);
+        void Flush();
+
+    private:
+        NOCOPY(RotatingFileLogSink);
+
+        /// Renames the existing files and opens a new file.
+        void Rotate();
+
+        std::string path;
+        Uint32 maxBytes;
+        unsigned int maxFiles;
+
+        FILE* file = NULL;
+        Uint32 written = 0;
+
+    };
+
+    /// Formats log messages on the calling thread and hands them to a background thread which writes them to the sinks in batches,
+    /// so logging doesn't wait on console or file output. Safe to use from any thread.
+    /** Messages are only formatted if they pass the compile-time level (OSSIUM_LOG_LEVEL), the runtime level set by SetLevel()
+     *  and the rate limit set by SetRateLimit(). Critical messages are flushed before returning, in case the program is about to crash. */
     class OSSIUM_EDL Logger
     {
     public:
+        /// Starts with a ConsoleLogSink.
+        Logger();
+        ~Logger();
+
+        /// Returns the engine logger. It is constructed on first use, so it is safe to log during static initialisation.
+        static Logger& EngineLog();
+
         template<typename ...Args>
-        void Info(std::string message, Args&&... args)
+        void Info(const FormatString& message, Args&&... args)
         {
-            message = Format(message, std::forward<Args>(args)...);
-            SDL_LogInfo(SDL_LOG_CATEGORY_CUSTOM, "%s", message.c_str());
+            Write<LogLevel::Info>(message, std::forward<Args>(args)...);
         }
 
         template<typename ...Args>
-        void Warning(std::string message, Args&&... args)
+        void Warning(const FormatString& message, Args&&... args)
         {
-            message = Format(message, std::forward<Args>(args)...);
-            SDL_LogWarn(SDL_LOG_CATEGORY_CUSTOM, "%s", message.c_str());
+            Write<LogLevel::Warning>(message, std::forward<Args>(args)...);
         }
 
         template<typename ...Args>
-        void Error(std::string message, Args&&... args)
+        void Error(const FormatString& message, Args&&... args)
         {
-            message = Format(message, std::forward<Args>(args)...);
-            SDL_LogError(SDL_LOG_CATEGORY_CUSTOM, "%s", message.c_str());
+            Write<LogLevel::Error>(message, std::forward<Args>(args)...);
         }
 
         template<typename ...Args>
-        void Critical(std::string message, Args&&... args)
+        void Critical(const FormatString& message, Args&&... args)
         {
-            message = Format(message, std::forward<Args>(args)...);
-            SDL_LogCritical(SDL_LOG_CATEGORY_CUSTOM, "%s", message.c_str());
+            Write<LogLevel::Critical>(message, std::forward<Args>(args)...);
         }
 
         template<typename ...Args>
-        void Verbose(std::string message, Args&&... args)
+        void Verbose(const FormatString& message, Args&&... args)
         {
-            message = Format(message, std::forward<Args>(args)...);
-            SDL_LogVerbose(SDL_LOG_CATEGORY_CUSTOM, "%s", message.c_str());
+            Write<LogLevel::Verbose>(message, std::forward<Args>(args)...);
         }
 
         template<typename ...Args>
-        void Debug(std::string message, Args&&... args)
+        void Debug(const FormatString& message, Args&&... args)
+        {
+            Write<LogLevel::Debug>(message, std::forward<Args>(args)...);
+        }
+
+        /// Adds a sink that messages are written to. The logger takes ownership of the sink.
+        void AddSink(LogSink* sink);
+
+        /// Removes and deletes all sinks, including the default ConsoleLogSink.
+        void ClearSinks();
+
+        /// Messages below this level are discarded without being formatted.
+        void SetLevel(LogLevel level);
+
+        /// Limits how many times per second each message may be logged before repeats are suppressed, counted by unformatted message.
+        /// A summary of suppressed messages is logged once the second is up. Critical messages are never suppressed. 0 means no limit.
+        void SetRateLimit(Uint32 messagesPerSecond);
+
+        /// Waits until every message logged so far has been written to the sinks.
+        void Flush();
+
+        /// Writes any remaining messages and stops the logging thread. Messages logged afterwards are written on the calling thread.
+        void Shutdown();
+
+        /// Returns true if messages of the given level are compiled in.
+        static constexpr bool IsCompiledIn(LogLevel level)
         {
-            #ifdef OSSIUM_DEBUG
-            message = Format(message, std::forward<Args>(args)...);
-            SDL_LogDebug(SDL_LOG_CATEGORY_CUSTOM, "%s", message.c_str());
+            #ifndef OSSIUM_DEBUG
+            if (level == LogLevel::Debug)
+            {
+                return false;
+            }
             #endif // DEBUG
+            return (int)level >= OSSIUM_LOG_LEVEL;
+        }
+
+    private:
+        NOCOPY(Logger);
+
+        /// Maximum number of messages waiting to be written. Messages logged while the queue is full are dropped.
+        static constexpr unsigned int QueueCapacity = 4096;
+
+        /// Formatted messages up to this length are stored in the queue without allocating.
+        static constexpr unsigned int InlineMessageLength = 232;
+
+        /// Number of rate limit counters. Messages whose hashes share a counter share a rate limit.
+        static constexpr unsigned int RateLimitSlots = 64;
+
+        /// How long the logging thread waits for messages before writing anyway, in milliseconds.
+        static constexpr Uint32 FlushInterval = 50;
+
+        struct Message
+        {
+            LogLevel level = LogLevel::Info;
+            Uint32 time = 0;
+            /// Messages that fit are stored in inlineText, longer messages in text.
+            unsigned int length = 0;
+            char inlineText[InlineMessageLength];
+            std::string text;
+        };
+
+        /// Rate limit counter for messages that hash to the same slot.
+        struct RateLimitCounter
+        {
+            std::atomic<Uint32> windowStart = {0};
+            std::atomic<Uint32> count = {0};
+            std::atomic<Uint32> suppressed = {0};
+        };
+
+        template<LogLevel level, typename ...Args>
+        void Write(const FormatString& message, Args&&... args)
+        {
+            if (IsCompiledIn(level) && Accept(level, message))
+            {
+                /// Each thread formats into its own buffer, which only allocates until it's big enough for the longest message
+                static thread_local std::string formatted;
+                formatted.clear();
+                FormatTo(formatted, message, std::forward<Args>(args)...);
+                Submit(level, formatted);
+            }
         }
 
+        /// Returns true if a message passes the runtime level and rate limit.
+        bool Accept(LogLevel level, const FormatString& message);
+
+        /// Queues a formatted message for the logging thread.
+        void Submit(LogLevel level, const std::string& text);
+
+        /// Writes a message to every sink. Only called with the sink lock held.
+        void WriteToSinks(const Message& message);
+
+        /// Writes text to every sink. Only called with the sink lock held.
+        void WriteToSinks(LogLevel level, Uint32 time, const std::string& text);
+
+        /// Starts the logging thread if it isn't running yet. Returns true if it is running.
+        bool Start();
+
+        /// Writes queued messages until the queue is empty.
+        void WriteQueued();
+
+        /// Entry point for the logging thread.
+        static int LoggingThread(void* data);
+
+        MPSCQueue<Message> queue;
+
+        std::vector<LogSink*> sinks;
+        SDL_mutex* sinkLock = NULL;
+
+        /// Reused for writing messages to the sinks. Only used with the sink lock held.
+        Message popped;
+        std::string line;
+
+        SDL_Thread* thread = NULL;
+        SDL_sem* wake = NULL;
+
+        /// 0 before the logging thread is started, 1 while starting, 2 while running, 3 once stopped or if it failed to start.
+        std::atomic<int> state = {0};
+        std::atomic<bool> quit = {false};
+
+        /// Number of messages queued, written by the logging thread and dropped because the queue was full.
+        std::atomic<Uint32> queued = {0};
+        std::atomic<Uint32> written = {0};
+        std::atomic<Uint32> dropped = {0};
+
+        std::atomic<int> minLevel = {(int)LogLevel::Verbose};
+        std::atomic<Uint32> rateLimit = {0};
+        RateLimitCounter rateLimits[RateLimitSlots];
+
     };
 
-    extern Logger Log;
+    /// Shorthand for Logger::EngineLog(). Only bound once logging.cpp is initialised, so code that runs during static initialisation must use Logger::EngineLog() instead.
+    extern Logger& Log;
 
 }
 
@@ -17,69 +17,274 @@
 #ifndef LRUCACHE_H
 #define LRUCACHE_H
 
-#include <list>
-#include <unordered_map>
+#include <vector>
+#include <functional>
 
 namespace Ossium
 {
 
-    template<typename T>
+    /// Fixed capacity least-recently-used cache.
+    /** Entries live in a flat array and are threaded onto an intrusive doubly-linked list in order of use,
+     *  with an open-addressing hash table (linear probing) of entry indices for lookup.
+     *  Memory is only allocated by the constructor and SetCapacity(); Access(), Erase() and PopLRU() never allocate.
+     *  When the cache is full, accessing a new value evicts the least recently used value. */
+    template<typename T, typename Hash = std::hash<T>>
     class LRUCache
     {
     public:
+        LRUCache(unsigned int capacity = 0)
+        {
+            SetCapacity(capacity);
+        }
+
+        /// Sets the maximum number of values the cache can hold. This clears the cache and is the only method that allocates memory.
+        void SetCapacity(unsigned int capacity)
+        {
+            entries.assign(capacity, Entry());
+
+            // Keep the load factor at or below 50% so probe sequences stay short.
+            unsigned int tableSize = 1;
+            tableBits = 0;
+            while (tableSize < capacity * 2)
+            {
+                tableSize <<= 1;
+                tableBits++;
+            }
+            table.assign(capacity > 0 ? tableSize : 0, NONE);
+            mask = tableSize - 1;
+
+            Clear();
+        }
+
+        /// Returns the maximum number of values the cache can hold.
+        unsigned int GetCapacity()
+        {
+            return entries.empty() ? 0 : entries.size();
+        }
+
         /// Clears the cache
         void Clear()
         {
-            accessLookup.clear();
-            cache.clear();
+            for (unsigned int i = 0, counti = table.empty() ? 0 : table.size(); i < counti; i++)
+            {
+                table[i] = NONE;
+            }
+            // Chain all entries onto the free list.
+            for (unsigned int i = 0, counti = GetCapacity(); i < counti; i++)
+            {
+                entries[i].prev = NONE;
+                entries[i].next = i + 1 < counti ? i + 1 : NONE;
+            }
+            freeList = entries.empty() ? NONE : 0;
+            head = NONE;
+            tail = NONE;
+            count = 0;
         }
 
         /// Removes an element from the cache
         void Erase(const T& data)
         {
-            auto itr = accessLookup.find(data);
-            if (itr != accessLookup.end())
+            unsigned int slot = FindSlot(data);
+            if (slot != NONE)
             {
-                cache.erase(itr->second);
-                accessLookup.erase(itr);
+                Remove(slot);
             }
         }
 
+        /// Removes the least recently used value from the cache.
         void PopLRU()
         {
-            if (!cache.empty())
+            if (tail != NONE)
             {
-                Erase(cache.back());
+                Erase(entries[tail].data);
             }
         }
 
         /// Returns a copy of the least recently used value.
         T GetLRU()
         {
-            return cache.back();
+            return tail != NONE ? entries[tail].data : T();
         }
 
-        /// Moves the data to the top of the cache.
+        /// Moves the data to the top of the cache, inserting it if necessary.
         void Access(const T& data)
         {
-            auto itr = accessLookup.find(data);
-            if (itr != accessLookup.end())
+            if (entries.empty())
+            {
+                return;
+            }
+
+            unsigned int slot = FindSlot(data);
+            if (slot != NONE)
             {
                 // Found, just move to the top
-                cache.erase(itr->second);
+                unsigned int index = table[slot];
+                if (index != head)
+                {
+                    Unlink(index);
+                    LinkFront(index);
+                }
+                return;
+            }
+
+            if (freeList == NONE)
+            {
+                // Full, make room by evicting the least recently used value.
+                PopLRU();
+            }
+
+            unsigned int index = freeList;
+            freeList = entries[index].next;
+            entries[index].data = data;
+            LinkFront(index);
+
+            slot = HomeSlot(data);
+            while (table[slot] != NONE)
+            {
+                slot = (slot + 1) & mask;
             }
-            cache.push_front(data);
-            accessLookup[data] = cache.begin();
+            table[slot] = index;
+            count++;
+        }
+
+        /// Returns true if the value is in the cache. Does not affect the order of use.
+        bool Contains(const T& data)
+        {
+            return FindSlot(data) != NONE;
         }
 
         unsigned int Size()
         {
-            return accessLookup.empty() ? 0 : accessLookup.size();
+            return count;
         }
 
     private:
-        std::list<T> cache;
-        std::unordered_map<T, typename std::list<T>::iterator> accessLookup;
+        /// Null entry index and null slot.
+        static constexpr unsigned int NONE = 0xFFFFFFFF;
+
+        struct Entry
+        {
+            T data = T();
+
+            /// Towards the most recently used entry. Unused on the free list.
+            unsigned int prev = NONE;
+
+            /// Towards the least recently used entry, or the next free entry.
+            unsigned int next = NONE;
+        };
+
+        /// Returns the preferred hash table slot for a value (Fibonacci hashing).
+        unsigned int HomeSlot(const T& data)
+        {
+            unsigned long long hashed = (unsigned long long)Hash()(data) * 11400714819323198485ull;
+            return tableBits == 0 ? 0 : (unsigned int)(hashed >> (64 - tableBits));
+        }
+
+        /// Returns the hash table slot holding the value, or NONE if the value is not cached.
+        unsigned int FindSlot(const T& data)
+        {
+            if (count == 0)
+            {
+                return NONE;
+            }
+            for (unsigned int slot = HomeSlot(data); table[slot] != NONE; slot = (slot + 1) & mask)
+            {
+                if (entries[table[slot]].data == data)
+                {
+                    return slot;
+                }
+            }
+            return NONE;
+        }
+
+        /// Removes the entry in a hash table slot, returning the entry to the free list.
+        void Remove(unsigned int slot)
+        {
+            unsigned int index = table[slot];
+            Unlink(index);
+            entries[index].data = T();
+            entries[index].next = freeList;
+            freeList = index;
+            count--;
+
+            // Backward shift deletion; move later entries in the probe sequence into the hole so no tombstones are needed.
+            unsigned int hole = slot;
+            for (unsigned int i = (slot + 1) & mask; table[i] != NONE; i = (i + 1) & mask)
+            {
+                unsigned int home = HomeSlot(entries[table[i]].data);
+                if (((i - home) & mask) >= ((i - hole) & mask))
+                {
+                    table[hole] = table[i];
+                    hole = i;
+                }
+            }
+            table[hole] = NONE;
+        }
+
+        /// Detaches an entry from the usage list.
+        void Unlink(unsigned int index)
+        {
+            Entry& entry = entries[index];
+            if (entry.prev != NONE)
+            {
+                entries[entry.prev].next = entry.next;
+            }
+            else
+            {
+                head = entry.next;
+            }
+            if (entry.next != NONE)
+            {
+                entries[entry.next].prev = entry.prev;
+            }
+            else
+            {
+                tail = entry.prev;
+            }
+            entry.prev = NONE;
+            entry.next = NONE;
+        }
+
+        /// Attaches an entry to the front of the usage list as the most recently used.
+        void LinkFront(unsigned int index)
+        {
+            Entry& entry = entries[index];
+            entry.prev = NONE;
+            entry.next = head;
+            if (head != NONE)
+            {
+                entries[head].prev = index;
+            }
+            head = index;
+            if (tail == NONE)
+            {
+                tail = index;
+            }
+        }
+
+        /// Fixed array of entries.
+        std::vector<Entry> entries;
+
+        /// Open addressing hash table of entry indices, sized to a power of two.
+        std::vector<unsigned int> table;
+
+        /// Bit mask for wrapping hash table slots.
+        unsigned int mask = 0;
+
+        /// Number of bits used to index the hash table.
+        unsigned int tableBits = 0;
+
+        /// Most recently used entry.
+        unsigned int head = NONE;
+
+        /// Least recently used entry.
+        unsigned int tail = NONE;
+
+        /// First unused entry.
+        unsigned int freeList = NONE;
+
+        /// Number of values in the cache.
+        unsigned int count = 0;
 
     };
 
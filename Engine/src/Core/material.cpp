@@ -7,6 +7,24 @@ namespace Ossium
     
     REGISTER_RESOURCE(Material);
 
+    // Parses a colour of one value for all channels, or separate red, green and blue values. Returns false on failure.
+    static bool ParseColor(const char* pos, const char* end, Vector3& color)
+    {
+        float r = 0;
+        pos = ParseFloat(pos, end, r);
+        if (pos == nullptr)
+        {
+            return false;
+        }
+        color = Vector3(r, r, r);
+        if (SkipSpaces(pos, end) < end)
+        {
+            pos = ParseFloat(pos, end, color.y);
+            return pos != nullptr && ParseFloat(pos, end, color.z) != nullptr;
+        }
+        return true;
+    }
+
     bool Material::Load(std::string guid_path)
     {
         // Open the MTL file
@@ -17,80 +35,78 @@ namespace Ossium
             return false;
         }
 
-        // Read the very first element of the file
-        std::string keyword = mtl.ReadElement(' ');
-        std::string element = "";
-
-        Vector3 ambient;
-        Vector3 diffuse;
-        Vector3 specular;
-        float dissolve;
-        while (!keyword.empty())
+        unsigned int materials = 0;
+        unsigned int lineNumber = 0;
+        while (!mtl.IsEnd())
         {
-            if (keyword == "v")
+            std::string_view line = mtl.ReadLineView();
+            lineNumber++;
+            // Comments can follow data on the same line
+            line = line.substr(0, line.find('#'));
+            const char* end = line.data() + line.length();
+            const char* pos = SkipSpaces(line.data(), end);
+            const char* keywordEnd = pos;
+            while (keywordEnd < end && *keywordEnd != ' ' && *keywordEnd != '\t')
             {
-                for (unsigned int i = 0; i < 3; i++)
-                {
-                    element = obj.ReadElement(' ');
-                    DEBUG_ASSERT(Utilities::IsNumber(element), "OBJ must have exactly 3 elements per v; ReadElement() result = {0}", element);
-                    vert(0, i) = Utilities::ToFloat(element);
-                }
-                vertices.push_back(vert);
+                keywordEnd++;
             }
-            else if (keyword == "vt")
+            std::string_view keyword(pos, keywordEnd - pos);
+            pos = keywordEnd;
+
+            // The rest of the line, for names and paths which may contain spaces
+            std::string_view rest(SkipSpaces(pos, end), end - SkipSpaces(pos, end));
+            while (!rest.empty() && (rest.back() == ' ' || rest.back() == '\t'))
             {
-                for (unsigned int i = 0; i < 2; i++)
-                {
-                    element = obj.ReadElement(' ');
-                    DEBUG_ASSERT(Utilities::IsNumber(element), "OBJ must have exactly 2 elements per vt; ReadElement() result = {0}", element);
-                    uv(0, i) = Utilities::ToFloat(element);
-                }
-                texcoords.push_back(uv);
+                rest.remove_suffix(1);
             }
-            else if (keyword == "vn")
+
+            bool valid = true;
+            if (keyword == "newmtl")
             {
-                for (unsigned int i = 0; i < 3; i++)
+                materials++;
+                if (materials == 1)
                 {
-                    element = obj.ReadElement(' ');
-                    DEBUG_ASSERT(Utilities::IsNumber(element), "OBJ must have exactly 3 elements per vn; ReadElement() result = {0}", element);
-                    norm(0, i) = Utilities::ToFloat(element);
+                    name = std::string(rest);
                 }
-                normals.push_back(norm);
-            }
-            else if (keyword == "f")
-            {
-                std::vector<MeshFaceElement> face;
-                element = obj.ReadElement(' ');
-                while (!element.empty() && Utilities::IsInt(element.substr(0, 1)))
+                else if (materials == 2)
                 {
-                    auto indices = Utilities::Split(element, '/');
-                    Uint16 v = Utilities::ToInt(indices[0]);
-                    Uint16 vt = Utilities::ToInt(indices[1]);
-                    Uint16 vn = indices.size() > 2 ? Utilities::ToInt(indices[2]) : 0;
-                    face.push_back(MeshFaceElement(v, vt, vn));
-                    element = obj.ReadElement(' ');
+                    Log.Warning("MTL file '{0}' contains more than one material, only '{1}' will be used.", guid_path, name);
                 }
-                faces.push_back(face);
-
-                // Skip to next iteration as the next keyword has been read already
-                keyword = element;
-                continue;
             }
-            else if (keyword == "usemtl")
+            else if (materials > 1)
+            {
+                // Statements of materials other than the first are ignored
+            }
+            else if (keyword == "Ka" || keyword == "Kd" || keyword == "Ks")
+            {
+                valid = ParseColor(pos, end, keyword == "Ka" ? ambient : (keyword == "Kd" ? diffuse : specular));
+            }
+            else if (keyword == "Ns")
+            {
+                valid = ParseFloat(pos, end, shininess) != nullptr;
+            }
+            else if (keyword == "d" || keyword == "Tr")
             {
+                float value = 0;
+                valid = ParseFloat(pos, end, value) != nullptr;
+                dissolve = keyword == "d" ? value : 1.0f - value;
             }
-            else if (keyword == "mtllib")
+            else if (keyword == "map_Kd")
             {
-                // Load material(s) used by the mesh
+                diffuseMap = std::string(rest);
             }
             else
             {
-                // Irrelevant data such as comments
+                // Unsupported statements and blank lines
+            }
+
+            if (!valid)
+            {
+                Log.Error("Failed to parse MTL file '{0}', invalid data on line {1}.", guid_path, lineNumber);
+                return false;
             }
-            // Get the next keyword
-            keyword = obj.ReadElement(' ');
         }
-        
+
         return true;
     }
 
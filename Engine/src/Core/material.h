@@ -3,6 +3,7 @@
 
 #include "resourcecontroller.h"
 #include "shader.h"
+#include "coremaths.h"
 #include "bgfx/bgfx.h"
 
 namespace Ossium
@@ -15,7 +16,7 @@ namespace Ossium
     public:
         DECLARE_RESOURCE(Material);
 
-        // Load from a .MTL file.
+        // Load from a .MTL file. Only the first material in the file is used.
         bool Load(std::string guid_path);
 
         // Initialise relevant shader.
@@ -27,6 +28,23 @@ namespace Ossium
         // Get the shader associated with this material.
         Shader* GetShader();
 
+        // Name of the material, from the newmtl statement.
+        std::string name;
+
+        // Ambient, diffuse and specular colours (Ka, Kd and Ks).
+        Vector3 ambient = Vector3(0.2f, 0.2f, 0.2f);
+        Vector3 diffuse = Vector3(0.8f, 0.8f, 0.8f);
+        Vector3 specular = Vector3(1.0f, 1.0f, 1.0f);
+
+        // Specular exponent (Ns).
+        float shininess = 0;
+
+        // Opacity, from 0 for fully transparent to 1 for opaque (d, or 1 - Tr).
+        float dissolve = 1;
+
+        // Path of the diffuse texture (map_Kd), relative to the .MTL file. Empty if there isn't one.
+        std::string diffuseMap;
+
     private:
         // The shaders associated with this material.
         Shader* shaderVertex = nullptr;
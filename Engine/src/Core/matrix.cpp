@@ -5,15 +5,20 @@ namespace Ossium
 {
     Matrix<4, 4> Matrix<4, 4>::LookAt(Vector3 from, Vector3 up, Vector3 at)
     {
+        // Left handed like Perspective(), so the view looks along +z. Each row projects onto an axis of the view.
         Vector3 direction = Vector3(at - from).Normalised();
-        up = up.Normalised();
-        Vector3 crossed = direction.Cross(up);
-        Vector3 invcrossed = crossed.Normalised().Cross(direction);
+        Vector3 right = up.Cross(direction).Normalised();
+        Vector3 viewUp = direction.Cross(right);
         return Matrix<4, 4>({
-            {crossed.x, crossed.y, crossed.z, 0},
-            {invcrossed.x, invcrossed.y, invcrossed.z, 0},
-            {-direction.x, -direction.y, -direction.z, 0},
-            {0, 0, 0, 1}
+            {right.x, viewUp.x, direction.x, 0},
+            {right.y, viewUp.y, direction.y, 0},
+            {right.z, viewUp.z, direction.z, 0},
+            {
+                -(right.x * from.x + right.y * from.y + right.z * from.z),
+                -(viewUp.x * from.x + viewUp.y * from.y + viewUp.z * from.z),
+                -(direction.x * from.x + direction.y * from.y + direction.z * from.z),
+                1
+            }
         });
     }
 }
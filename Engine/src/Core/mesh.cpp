@@ -1,4 +1,11 @@
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <unordered_map>
+
 #include "resourcecontroller.h"
+#include "renderer.h"
 #include "mesh.h"
 #include "file.h"
 
@@ -6,74 +13,212 @@ namespace Ossium
 {
 
     REGISTER_RESOURCE(Mesh);
-    
+
+    // Identifies .omesh files.
+    static const char MeshCacheMagic[4] = {'O', 'M', 'S', 'H'};
+
+    // Incremented whenever the .omesh format or MeshVertex layout changes, so old caches are ignored.
+    static const Uint32 MeshCacheVersion = 1;
+
+    // Start of a .omesh file, followed by the vertices then the indices.
+    struct MeshCacheHeader
+    {
+        char magic[4];
+        Uint32 version;
+        Sint64 sourceSize;
+        Sint64 sourceTime;
+        Uint32 vertexSize;
+        Uint32 vertexCount;
+        Uint32 indexCount;
+        Uint32 padding;
+    };
+
+    // Hash for deduplicating face elements.
+    struct MeshFaceElementHash
+    {
+        size_t operator()(const MeshFaceElement& element) const
+        {
+            size_t hash = element.vert;
+            hash = hash * 31 + element.uv;
+            hash = hash * 31 + element.norm;
+            return hash;
+        }
+    };
+
+    bool MeshFaceElement::operator==(const MeshFaceElement& other) const
+    {
+        return vert == other.vert && uv == other.uv && norm == other.norm;
+    }
+
+    // Parses a face element index, which may be relative to the end of the elements read so far if negative.
+    // Returns nullptr on failure. An empty index is valid and sets the index to 0.
+    static const char* ParseIndex(const char* pos, const char* end, size_t count, Uint32& index)
+    {
+        index = 0;
+        if (pos >= end || *pos == '/' || *pos == ' ' || *pos == '\t')
+        {
+            return pos;
+        }
+        Sint64 value = 0;
+        std::from_chars_result result = std::from_chars(pos, end, value);
+        if (result.ec != std::errc())
+        {
+            return nullptr;
+        }
+        if (value < 0)
+        {
+            value += (Sint64)count + 1;
+        }
+        if (value <= 0 || value > (Sint64)count)
+        {
+            return nullptr;
+        }
+        index = (Uint32)value;
+        return result.ptr;
+    }
+
+    std::string Mesh::GetCachePath(const std::string& path)
+    {
+        return std::filesystem::path(path).replace_extension(".omesh").string();
+    }
+
     bool Mesh::Load(std::string guid_path)
+    {
+        vertices.clear();
+        indices.clear();
+
+        // The cache is keyed by the size and modification time of the source file
+        std::error_code error;
+        Sint64 sourceSize = (Sint64)std::filesystem::file_size(guid_path, error);
+        bool cacheable = !error;
+        Sint64 sourceTime = cacheable ? (Sint64)std::filesystem::last_write_time(guid_path, error).time_since_epoch().count() : 0;
+        cacheable = cacheable && !error;
+
+        std::string cachePath = GetCachePath(guid_path);
+        if (cacheable && LoadCache(cachePath, sourceSize, sourceTime))
+        {
+            return true;
+        }
+        if (!LoadOBJ(guid_path))
+        {
+            return false;
+        }
+        if (cacheable)
+        {
+            SaveCache(cachePath, sourceSize, sourceTime);
+        }
+        return true;
+    }
+
+    bool Mesh::LoadOBJ(const std::string& path)
     {
         // Open the OBJ file
-        File obj(guid_path);
+        File obj(path);
         if (obj.HasError())
         {
             Log.Error(obj.GetError());
             return false;
         }
 
-        // Read the very first element of the file
-        std::string keyword = obj.ReadElement(' ');
-        std::string element = "";
+        std::vector<float> positions;
+        std::vector<float> texcoords;
+        std::vector<float> normals;
+        std::unordered_map<MeshFaceElement, Uint32, MeshFaceElementHash> unique;
+        std::vector<Uint32> face;
 
-        Vector3 vert;
-        Vector2 uv;
-        Vector3 norm;
-        while (!keyword.empty())
+        unsigned int lineNumber = 0;
+        while (!obj.IsEnd())
         {
-            if (keyword == "v")
+            std::string_view line = obj.ReadLineView();
+            lineNumber++;
+            // Comments can follow data on the same line
+            line = line.substr(0, line.find('#'));
+            const char* end = line.data() + line.length();
+            const char* pos = SkipSpaces(line.data(), end);
+            const char* keywordEnd = pos;
+            while (keywordEnd < end && *keywordEnd != ' ' && *keywordEnd != '\t')
             {
-                for (unsigned int i = 0; i < 3; i++)
-                {
-                    element = obj.ReadElement(' ');
-                    DEBUG_ASSERT(Utilities::IsNumber(element), "OBJ must have exactly 3 elements per v; ReadElement() result = {0}", element);
-                    vert(0, i) = Utilities::ToFloat(element);
-                }
-                vertices.push_back(vert);
+                keywordEnd++;
             }
-            else if (keyword == "vt")
+            std::string_view keyword(pos, keywordEnd - pos);
+            pos = keywordEnd;
+
+            bool valid = true;
+            if (keyword == "v" || keyword == "vn")
             {
-                for (unsigned int i = 0; i < 2; i++)
+                std::vector<float>& target = keyword == "v" ? positions : normals;
+                for (unsigned int i = 0; i < 3 && valid; i++)
                 {
-                    element = obj.ReadElement(' ');
-                    DEBUG_ASSERT(Utilities::IsNumber(element), "OBJ must have exactly 2 elements per vt; ReadElement() result = {0}", element);
-                    uv(0, i) = Utilities::ToFloat(element);
+                    float value = 0;
+                    valid = (pos = ParseFloat(pos, end, value)) != nullptr;
+                    target.push_back(value);
                 }
-                texcoords.push_back(uv);
             }
-            else if (keyword == "vn")
+            else if (keyword == "vt")
             {
-                for (unsigned int i = 0; i < 3; i++)
+                // The v coordinate is optional and defaults to 0, any third (w) coordinate is ignored
+                float u = 0;
+                float v = 0;
+                valid = (pos = ParseFloat(pos, end, u)) != nullptr;
+                if (valid && SkipSpaces(pos, end) < end)
                 {
-                    element = obj.ReadElement(' ');
-                    DEBUG_ASSERT(Utilities::IsNumber(element), "OBJ must have exactly 3 elements per vn; ReadElement() result = {0}", element);
-                    norm(0, i) = Utilities::ToFloat(element);
+                    valid = ParseFloat(pos, end, v) != nullptr;
                 }
-                normals.push_back(norm);
+                texcoords.push_back(u);
+                texcoords.push_back(v);
             }
             else if (keyword == "f")
             {
-                std::vector<MeshFaceElement> face;
-                element = obj.ReadElement(' ');
-                while (!element.empty() && Utilities::IsInt(element.substr(0, 1)))
+                face.clear();
+                pos = SkipSpaces(pos, end);
+                while (pos < end && valid)
                 {
-                    auto indices = Utilities::Split(element, '/');
-                    Uint16 v = Utilities::ToInt(indices[0]);
-                    Uint16 vt = Utilities::ToInt(indices[1]);
-                    Uint16 vn = indices.size() > 2 ? Utilities::ToInt(indices[2]) : 0;
-                    face.push_back(MeshFaceElement(v, vt, vn));
-                    element = obj.ReadElement(' ');
+                    // Each element is v, v/vt, v//vn or v/vt/vn
+                    MeshFaceElement element;
+                    pos = ParseIndex(pos, end, positions.size() / 3, element.vert);
+                    valid = pos != nullptr && element.vert != 0;
+                    if (valid && pos < end && *pos == '/')
+                    {
+                        pos = ParseIndex(pos + 1, end, texcoords.size() / 2, element.uv);
+                        valid = pos != nullptr;
+                        if (valid && pos < end && *pos == '/')
+                        {
+                            pos = ParseIndex(pos + 1, end, normals.size() / 3, element.norm);
+                            valid = pos != nullptr;
+                        }
+                    }
+                    if (!valid)
+                    {
+                        break;
+                    }
+
+                    auto itr = unique.find(element);
+                    if (itr == unique.end())
+                    {
+                        MeshVertex vertex = {};
+                        memcpy(vertex.position, &positions[(element.vert - 1) * 3], sizeof(vertex.position));
+                        if (element.norm != 0)
+                        {
+                            memcpy(vertex.normal, &normals[(element.norm - 1) * 3], sizeof(vertex.normal));
+                        }
+                        if (element.uv != 0)
+                        {
+                            memcpy(vertex.uv, &texcoords[(element.uv - 1) * 2], sizeof(vertex.uv));
+                        }
+                        itr = unique.insert({element, (Uint32)vertices.size()}).first;
+                        vertices.push_back(vertex);
+                    }
+                    face.push_back(itr->second);
+                    pos = SkipSpaces(pos, end);
                 }
-                faces.push_back(face);
 
-                // Skip to next iteration as the next keyword has been read already
-                keyword = element;
-                continue;
+                // Split the face into a fan of triangles
+                for (unsigned int i = 2, counti = face.size(); valid && i < counti; i++)
+                {
+                    indices.push_back(face[0]);
+                    indices.push_back(face[i - 1]);
+                    indices.push_back(face[i]);
+                }
             }
             else if (keyword == "usemtl")
             {
@@ -86,16 +231,170 @@ namespace Ossium
             {
                 // Irrelevant data such as comments
             }
-            // Get the next keyword
-            keyword = obj.ReadElement(' ');
+
+            if (!valid)
+            {
+                Log.Error("Failed to parse OBJ file '{0}', invalid data on line {1}.", path, lineNumber);
+                vertices.clear();
+                indices.clear();
+                return false;
+            }
         }
-        
+
         return true;
     }
 
+    bool Mesh::LoadCache(const std::string& path, Sint64 sourceSize, Sint64 sourceTime)
+    {
+        File cache(path);
+        if (cache.HasError() || cache.Size() < (Sint64)sizeof(MeshCacheHeader))
+        {
+            return false;
+        }
+
+        // Mapped files can be copied from directly, otherwise the whole file is read at once
+        std::string contents;
+        const char* data = nullptr;
+        if (cache.IsMapped())
+        {
+            data = cache.GetMappedData();
+        }
+        else
+        {
+            contents = cache.ToString();
+            data = contents.data();
+            if ((Sint64)contents.size() != cache.Size())
+            {
+                return false;
+            }
+        }
+
+        MeshCacheHeader header;
+        memcpy(&header, data, sizeof(MeshCacheHeader));
+        if (
+            memcmp(header.magic, MeshCacheMagic, sizeof(MeshCacheMagic)) != 0 ||
+            header.version != MeshCacheVersion ||
+            header.vertexSize != sizeof(MeshVertex) ||
+            header.sourceSize != sourceSize ||
+            header.sourceTime != sourceTime ||
+            cache.Size() != (Sint64)(sizeof(MeshCacheHeader) + header.vertexCount * sizeof(MeshVertex) + header.indexCount * sizeof(Uint32))
+        )
+        {
+            return false;
+        }
+
+        data += sizeof(MeshCacheHeader);
+        vertices.resize(header.vertexCount);
+        memcpy(vertices.data(), data, header.vertexCount * sizeof(MeshVertex));
+        data += header.vertexCount * sizeof(MeshVertex);
+        indices.resize(header.indexCount);
+        memcpy(indices.data(), data, header.indexCount * sizeof(Uint32));
+        return true;
+    }
+
+    void Mesh::SaveCache(const std::string& path, Sint64 sourceSize, Sint64 sourceTime)
+    {
+        MeshCacheHeader header = {};
+        memcpy(header.magic, MeshCacheMagic, sizeof(MeshCacheMagic));
+        header.version = MeshCacheVersion;
+        header.sourceSize = sourceSize;
+        header.sourceTime = sourceTime;
+        header.vertexSize = sizeof(MeshVertex);
+        header.vertexCount = (Uint32)vertices.size();
+        header.indexCount = (Uint32)indices.size();
+
+        SDL_RWops* cache = SDL_RWFromFile(path.c_str(), "wb");
+        if (cache == NULL)
+        {
+            Log.Warning("Failed to create mesh cache '{0}'. SDL_Error: {1}", path, SDL_GetError());
+            return;
+        }
+        bool success = SDL_RWwrite(cache, &header, sizeof(MeshCacheHeader), 1) == 1;
+        success &= vertices.empty() || SDL_RWwrite(cache, vertices.data(), sizeof(MeshVertex), vertices.size()) == vertices.size();
+        success &= indices.empty() || SDL_RWwrite(cache, indices.data(), sizeof(Uint32), indices.size()) == indices.size();
+        SDL_RWclose(cache);
+        if (!success)
+        {
+            // Don't leave a partial cache behind
+            Log.Warning("Failed to write mesh cache '{0}'.", path);
+            remove(path.c_str());
+        }
+    }
+
+    Mesh::~Mesh()
+    {
+        FreeBuffers();
+    }
+
+    const bgfx::VertexLayout& Mesh::GetVertexLayout()
+    {
+        static bgfx::VertexLayout layout = [] () {
+            bgfx::VertexLayout layout;
+            layout.begin()
+                .add(bgfx::Attrib::Position, 3, bgfx::AttribType::Float)
+                .add(bgfx::Attrib::Normal, 3, bgfx::AttribType::Float)
+                .add(bgfx::Attrib::TexCoord0, 2, bgfx::AttribType::Float)
+            .end();
+            return layout;
+        }();
+        return layout;
+    }
+
     bool Mesh::Init(ResourceController* resources)
     {
-        // TODO
+        FreeBuffers();
+        UpdateBounds();
+
+        if (dynamic)
+        {
+            // Both pairs of buffers start with the same geometry and grow as needed when updated
+            for (unsigned int i = 0; i < 2; i++)
+            {
+                dynamicVertexBuffers[i] = vertices.empty() ?
+                    bgfx::createDynamicVertexBuffer(1, GetVertexLayout(), BGFX_BUFFER_ALLOW_RESIZE) :
+                    bgfx::createDynamicVertexBuffer(
+                        bgfx::copy(vertices.data(), (Uint32)(vertices.size() * sizeof(MeshVertex))),
+                        GetVertexLayout(),
+                        BGFX_BUFFER_ALLOW_RESIZE
+                    );
+                dynamicIndexBuffers[i] = indices.empty() ?
+                    bgfx::createDynamicIndexBuffer(1, BGFX_BUFFER_ALLOW_RESIZE | BGFX_BUFFER_INDEX32) :
+                    bgfx::createDynamicIndexBuffer(
+                        bgfx::copy(indices.data(), (Uint32)(indices.size() * sizeof(Uint32))),
+                        BGFX_BUFFER_ALLOW_RESIZE | BGFX_BUFFER_INDEX32
+                    );
+                dynamicVertexCounts[i] = (Uint32)vertices.size();
+                dynamicIndexCounts[i] = (Uint32)indices.size();
+                if (!bgfx::isValid(dynamicVertexBuffers[i]) || !bgfx::isValid(dynamicIndexBuffers[i]))
+                {
+                    Log.Error("Failed to create dynamic mesh buffers! Unknown BGFX error.");
+                    FreeBuffers();
+                    return false;
+                }
+            }
+            frontBuffer = 0;
+            return true;
+        }
+
+        if (vertices.empty() || indices.empty())
+        {
+            Log.Warning("Mesh has no faces, no GPU buffers will be created.");
+            return false;
+        }
+
+        // The data is only copied to the GPU once, as static buffers can't be changed
+        vertexBuffer = bgfx::createVertexBuffer(
+            bgfx::copy(vertices.data(), (Uint32)(vertices.size() * sizeof(MeshVertex))), GetVertexLayout()
+        );
+        indexBuffer = bgfx::createIndexBuffer(
+            bgfx::copy(indices.data(), (Uint32)(indices.size() * sizeof(Uint32))), BGFX_BUFFER_INDEX32
+        );
+        if (!bgfx::isValid(vertexBuffer) || !bgfx::isValid(indexBuffer))
+        {
+            Log.Error("Failed to create mesh buffers! Unknown BGFX error.");
+            FreeBuffers();
+            return false;
+        }
         return true;
     }
 
@@ -104,15 +403,166 @@ namespace Ossium
         return Load(guid_path) && Init(resources);
     }
 
-    void Mesh::Render(RenderInput* pass, const Matrix<4, 4>& view, const Matrix<4, 4>& proj)
+    void Mesh::SetDynamic(bool dynamic)
     {
-        for (unsigned int face = 0, numfaces = faces.size(); face < numfaces; face++)
+        if (bgfx::isValid(vertexBuffer) || bgfx::isValid(dynamicVertexBuffers[0]))
         {
-            for (unsigned int i = 0, counti = faces[face].size(); i < counti; i++)
-            {
+            Log.Warning("Mesh buffers have already been created, call Init() again for SetDynamic() to take effect.");
+        }
+        this->dynamic = dynamic;
+    }
+
+    bool Mesh::IsDynamic()
+    {
+        return dynamic;
+    }
+
+    bool Mesh::UpdateBuffers()
+    {
+        if (!dynamic || !bgfx::isValid(dynamicVertexBuffers[0]))
+        {
+            Log.Error("Cannot update mesh buffers, the mesh must be made dynamic before Init() is called.");
+            return false;
+        }
+
+        // Write to the back buffers, which aren't in use by the frame that's being rendered
+        unsigned int backBuffer = frontBuffer ^ 1;
+        if (!vertices.empty())
+        {
+            bgfx::update(
+                dynamicVertexBuffers[backBuffer], 0, bgfx::copy(vertices.data(), (Uint32)(vertices.size() * sizeof(MeshVertex)))
+            );
+        }
+        if (!indices.empty())
+        {
+            bgfx::update(
+                dynamicIndexBuffers[backBuffer], 0, bgfx::copy(indices.data(), (Uint32)(indices.size() * sizeof(Uint32)))
+            );
+        }
+        dynamicVertexCounts[backBuffer] = (Uint32)vertices.size();
+        dynamicIndexCounts[backBuffer] = (Uint32)indices.size();
+        frontBuffer = backBuffer;
+        UpdateBounds();
+        return true;
+    }
+
+    void Mesh::SetBuffers()
+    {
+        if (dynamic)
+        {
+            // Only the part of the buffers that was last written is used
+            bgfx::setVertexBuffer(0, dynamicVertexBuffers[frontBuffer], 0, dynamicVertexCounts[frontBuffer]);
+            bgfx::setIndexBuffer(dynamicIndexBuffers[frontBuffer], 0, dynamicIndexCounts[frontBuffer]);
+        }
+        else
+        {
+            bgfx::setVertexBuffer(0, vertexBuffer);
+            bgfx::setIndexBuffer(indexBuffer);
+        }
+    }
 
+    void Mesh::FreeBuffers()
+    {
+        if (bgfx::isValid(vertexBuffer))
+        {
+            bgfx::destroy(vertexBuffer);
+            vertexBuffer = BGFX_INVALID_HANDLE;
+        }
+        if (bgfx::isValid(indexBuffer))
+        {
+            bgfx::destroy(indexBuffer);
+            indexBuffer = BGFX_INVALID_HANDLE;
+        }
+        for (unsigned int i = 0; i < 2; i++)
+        {
+            if (bgfx::isValid(dynamicVertexBuffers[i]))
+            {
+                bgfx::destroy(dynamicVertexBuffers[i]);
+                dynamicVertexBuffers[i] = BGFX_INVALID_HANDLE;
             }
+            if (bgfx::isValid(dynamicIndexBuffers[i]))
+            {
+                bgfx::destroy(dynamicIndexBuffers[i]);
+                dynamicIndexBuffers[i] = BGFX_INVALID_HANDLE;
+            }
+            dynamicVertexCounts[i] = 0;
+            dynamicIndexCounts[i] = 0;
         }
     }
 
+    bool Mesh::HasBuffers()
+    {
+        return dynamic ? bgfx::isValid(dynamicVertexBuffers[frontBuffer]) : bgfx::isValid(vertexBuffer);
+    }
+
+    Uint32 Mesh::GetBufferedIndexCount()
+    {
+        if (!HasBuffers())
+        {
+            return 0;
+        }
+        return dynamic ? dynamicIndexCounts[frontBuffer] : (Uint32)indices.size();
+    }
+
+    bool Mesh::GetRenderBounds(Vector3& centre, float& radius)
+    {
+        if (!HasBuffers())
+        {
+            return false;
+        }
+        centre = boundsCentre;
+        radius = boundsRadius;
+        return true;
+    }
+
+    void Mesh::UpdateBounds()
+    {
+        if (vertices.empty())
+        {
+            boundsCentre = Vector3(0, 0, 0);
+            boundsRadius = 0;
+            return;
+        }
+        Vector3 lower = Vector3(vertices[0].position[0], vertices[0].position[1], vertices[0].position[2]);
+        Vector3 upper = lower;
+        for (const MeshVertex& vertex : vertices)
+        {
+            lower = Vector3(std::min(lower.x, vertex.position[0]), std::min(lower.y, vertex.position[1]), std::min(lower.z, vertex.position[2]));
+            upper = Vector3(std::max(upper.x, vertex.position[0]), std::max(upper.y, vertex.position[1]), std::max(upper.z, vertex.position[2]));
+        }
+        // The sphere through the corners of the extents encloses every vertex
+        boundsCentre = Vector3((lower.x + upper.x) * 0.5f, (lower.y + upper.y) * 0.5f, (lower.z + upper.z) * 0.5f);
+        boundsRadius = Vector3(upper.x - boundsCentre.x, upper.y - boundsCentre.y, upper.z - boundsCentre.z).Length();
+    }
+
+    void Mesh::Render(RenderInput* pass, const Matrix<4, 4>& view, const Matrix<4, 4>& proj, const Matrix<4, 4>& model)
+    {
+        if (pass == nullptr || pass->GetRenderer() == nullptr || GetBufferedIndexCount() == 0)
+        {
+            return;
+        }
+
+        Renderer* renderer = pass->GetRenderer();
+        // The default 2D program has no normals or texture coordinates, so meshes have their own default program
+        bgfx::ProgramHandle program = renderer->GetProgram("mesh.vert", "mesh.frag");
+        if (!bgfx::isValid(program))
+        {
+            return;
+        }
+
+        renderer->SetViewTransform(pass, view, proj);
+        bgfx::setTransform(&model);
+        SetBuffers();
+        bgfx::setState(0
+            | BGFX_STATE_WRITE_RGB
+            | BGFX_STATE_WRITE_A
+            | BGFX_STATE_WRITE_Z
+            | BGFX_STATE_DEPTH_TEST_LESS
+            | BGFX_STATE_CULL_CW
+            | BGFX_STATE_MSAA
+        );
+        // Sorted by the depth set by the input, e.g. a Camera
+        bgfx::submit(pass->GetID(), program, renderer->GetSortDepth(pass));
+    }
+
 }
@@ -1,6 +1,8 @@
 #ifndef MESH_H
 #define MESH_H
 
+#include "bgfx/bgfx.h"
+
 #include "schemamodel.h"
 #include "coremaths.h"
 
@@ -9,26 +11,22 @@ namespace Ossium
     
     // Represents indices to the Mesh vertex, UV and normals for defining a face; same as the standard .OBJ format.
     // See https://en.wikipedia.org/wiki/Wavefront_.obj_file#Face_elements
-    // Yes, this means that these indices count from 1, NOT from 0.
+    // Yes, this means that these indices count from 1, NOT from 0. An index of 0 means the element is not specified.
     struct MeshFaceElement
     {
         MeshFaceElement() = default;
-        MeshFaceElement(Uint16 vert, Uint16 uv = 0, Uint16 norm = 0) : vert(vert), uv(uv), norm(norm) {}
-        
-        // Convert this face element to a .OBJ format string.
-        std::string ToString();
+        MeshFaceElement(Uint32 vert, Uint32 uv = 0, Uint32 norm = 0) : vert(vert), uv(uv), norm(norm) {}
 
-        // Construct this face element from a .OBJ format face element string.
-        void FromString(const std::string& data);
+        bool operator==(const MeshFaceElement& other) const;
 
         // Index to the 3D position vertex.
-        Uint16 vert;
+        Uint32 vert = 0;
 
         // Index to the texture coordinate.
-        Uint16 uv;
+        Uint32 uv = 0;
 
         // Index to the normal vector.
-        Uint16 norm;
+        Uint32 norm = 0;
 
     };
 
@@ -37,40 +35,112 @@ namespace Ossium
         Uint16 face;
     };
 
+    // A single vertex of a mesh, interleaved in the layout used by the GPU vertex buffer.
+    struct MeshVertex
+    {
+        float position[3];
+        float normal[3];
+        float uv[2];
+    };
+
     // A 3D mesh. Can be loaded from a .OBJ file. Does not support line elements, only faces.
+    // Once a .OBJ file has been loaded, the vertex and index data is cached in a binary .omesh file next to it,
+    // which is loaded instead as long as the .OBJ file hasn't changed.
+    // By default the GPU buffers are created once by Init() and never changed, so rendering the mesh doesn't upload anything.
+    // Meshes whose geometry changes at runtime should be made dynamic before Init() is called, and updated with UpdateBuffers().
     class Mesh : public Resource
     {
     public:
         DECLARE_RESOURCE(Mesh);
 
-        // Load from a .OBJ file.
-        bool Load(std::string guid_path, ResourceController* resources);
+        ~Mesh();
+
+        // Load from a .OBJ file, or the .omesh cache of it if that is up to date.
+        bool Load(std::string guid_path);
 
-        // Init materials and prepare buffers for use on the GPU.
-        bool Init();
+        // Init materials and create the GPU buffers from the vertices and indices.
+        bool Init(ResourceController* resources);
 
         // Load Mesh resource from a .OBJ file, then load materials and prepare buffers for use on the GPU.
         bool LoadAndInit(std::string guid_path, ResourceController* resources);
 
-        // Render the mesh.
-        void Render(RenderInput* pass, const Matrix<4, 4>& view, const Matrix<4, 4>& proj);
+        // Render the mesh in the view of an input, with the given model transform.
+        // Meshes are drawn with the default mesh shaders, as materials don't have shaders yet.
+        void Render(RenderInput* pass, const Matrix<4, 4>& view, const Matrix<4, 4>& proj, const Matrix<4, 4>& model = Matrix<4, 4>::Identity());
+
+        // Returns the path of the .omesh cache file for a .OBJ file.
+        static std::string GetCachePath(const std::string& path);
+
+        // Sets whether the geometry can be changed after Init() by calling UpdateBuffers(). Must be set before Init() is called.
+        void SetDynamic(bool dynamic);
+
+        // Can the geometry be changed after Init()?
+        bool IsDynamic();
+
+        // Copies the vertices and indices of a dynamic mesh into the back GPU buffers, then swaps them with the front buffers.
+        // Only the front buffers are used for rendering, so a frame that is still being rendered isn't affected by the update.
+        bool UpdateBuffers();
+
+        // Sets the GPU buffers to use for the next draw call.
+        void SetBuffers();
+
+        // Destroys the GPU buffers.
+        void FreeBuffers();
+
+        // Have the GPU buffers been created?
+        bool HasBuffers();
 
-        // Vertices of the mesh in 3D space.
-        std::vector<Vector3> vertices;
+        // Returns the number of indices drawn from the GPU buffers, which for dynamic meshes is the number in the front buffer.
+        Uint32 GetBufferedIndexCount();
 
-        // UV texture coordinates in the normalised range 0 to 1.
-        std::vector<Vector2> texcoords;
+        // Outputs a model space sphere enclosing the vertices in the GPU buffers, so the mesh can be culled.
+        // Returns false if there are no buffers.
+        bool GetRenderBounds(Vector3& centre, float& radius);
 
-        // Vertex normals.
-        std::vector<Vector3> normals;
+        // Returns the layout of MeshVertex for the GPU.
+        static const bgfx::VertexLayout& GetVertexLayout();
 
-        // Indices to the vertex elements, for building the faces of the 3D mesh on the GPU.
-        // A face may have any number of elements, but will always be split into triangles behind the scenes for the GPU.
-        std::vector<std::vector<MeshFaceElement>> faces;
+        // Unique combinations of position, normal and texture coordinates used by the faces of the mesh.
+        std::vector<MeshVertex> vertices;
+
+        // Indices into the vertices, three per triangle. Faces with more than three elements are split into triangles.
+        std::vector<Uint32> indices;
 
     private:
-        std::string NextElement(const std::string& obj, unsigned int& i);
-        
+        // Parses a .OBJ file into the vertices and indices.
+        bool LoadOBJ(const std::string& path);
+
+        // Loads the vertices and indices from a cache file, if it was made from a source file of the given size and modification time.
+        bool LoadCache(const std::string& path, Sint64 sourceSize, Sint64 sourceTime);
+
+        // Writes the vertices and indices to a cache file.
+        void SaveCache(const std::string& path, Sint64 sourceSize, Sint64 sourceTime);
+
+        // Fits the bounding sphere to the extents of the vertices.
+        void UpdateBounds();
+
+        // Sphere enclosing the vertices last copied to the GPU buffers.
+        Vector3 boundsCentre = Vector3(0, 0, 0);
+        float boundsRadius = 0;
+
+        // Should the GPU buffers be dynamic?
+        bool dynamic = false;
+
+        // Buffers for static meshes.
+        bgfx::VertexBufferHandle vertexBuffer = BGFX_INVALID_HANDLE;
+        bgfx::IndexBufferHandle indexBuffer = BGFX_INVALID_HANDLE;
+
+        // Pairs of buffers for dynamic meshes; one is rendered while the other is updated.
+        bgfx::DynamicVertexBufferHandle dynamicVertexBuffers[2] = {BGFX_INVALID_HANDLE, BGFX_INVALID_HANDLE};
+        bgfx::DynamicIndexBufferHandle dynamicIndexBuffers[2] = {BGFX_INVALID_HANDLE, BGFX_INVALID_HANDLE};
+
+        // Number of vertices and indices in use by each of the dynamic buffers, which may be larger than that.
+        Uint32 dynamicVertexCounts[2] = {0, 0};
+        Uint32 dynamicIndexCounts[2] = {0, 0};
+
+        // Which of the dynamic buffers is rendered.
+        unsigned int frontBuffer = 0;
+
     };
 
 }
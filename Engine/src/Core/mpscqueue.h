@@ -0,0 +1,160 @@
+/** COPYRIGHT NOTICE
+ *
+ *  Ossium Engine
+ *  Copyright (c) 2018-2020 Tim Lane
+ *
+ *  This software is provided 'as-is', without any express or implied warranty. In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+ *
+ *  2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+ *
+ *  3. This notice may not be removed or altered from any source distribution.
+ *
+**/
+#ifndef MPSCQUEUE_H
+#define MPSCQUEUE_H
+
+#include <atomic>
+#include <utility>
+
+namespace Ossium
+{
+
+    /// Bounded lock-free queue for passing values from any number of producer threads to exactly one consumer thread.
+    /** Push() may be called from any thread, but Pop() must only be called by the consumer. Neither method allocates memory,
+     *  though moving values in and out may. Each slot has a sequence number so producers can claim slots without locking. */
+    template<typename T>
+    class MPSCQueue
+    {
+    public:
+        MPSCQueue(unsigned int capacity = 0)
+        {
+            SetCapacity(capacity);
+        }
+
+        ~MPSCQueue()
+        {
+            delete[] buffer;
+        }
+
+        /// Sets the maximum number of values the queue can hold, rounded up to a power of two. This clears the queue.
+        /// Not thread safe; only call this while no other thread is using the queue.
+        void SetCapacity(unsigned int capacity)
+        {
+            unsigned int size = 1;
+            while (size < capacity)
+            {
+                size <<= 1;
+            }
+            delete[] buffer;
+            buffer = capacity > 0 ? new Cell[size] : nullptr;
+            mask = size - 1;
+            for (unsigned int i = 0; capacity > 0 && i < size; i++)
+            {
+                buffer[i].sequence.store(i, std::memory_order_relaxed);
+            }
+            head.store(0, std::memory_order_relaxed);
+            tail.store(0, std::memory_order_relaxed);
+        }
+
+        /// Returns the maximum number of values the queue can hold.
+        unsigned int GetCapacity()
+        {
+            return buffer == nullptr ? 0 : mask + 1;
+        }
+
+        /// Moves a value to the back of the queue. Returns false if the queue is full, in which case the value is left as it was.
+        bool Push(T& value)
+        {
+            if (buffer == nullptr)
+            {
+                return false;
+            }
+            Cell* cell;
+            unsigned int back = tail.load(std::memory_order_relaxed);
+            while (true)
+            {
+                cell = &buffer[back & mask];
+                int diff = (int)(cell->sequence.load(std::memory_order_acquire) - back);
+                if (diff == 0)
+                {
+                    /// The slot is free, try to claim it
+                    if (tail.compare_exchange_weak(back, back + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    /// The consumer hasn't emptied this slot yet
+                    return false;
+                }
+                else
+                {
+                    /// Another producer claimed the slot first
+                    back = tail.load(std::memory_order_relaxed);
+                }
+            }
+            cell->value = std::move(value);
+            cell->sequence.store(back + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// Moves the value at the front of the queue into value. Returns false if the queue is empty,
+        /// or if the producer that claimed the front slot hasn't finished writing to it yet.
+        bool Pop(T& value)
+        {
+            if (buffer == nullptr)
+            {
+                return false;
+            }
+            unsigned int front = head.load(std::memory_order_relaxed);
+            Cell* cell = &buffer[front & mask];
+            if ((int)(cell->sequence.load(std::memory_order_acquire) - (front + 1)) < 0)
+            {
+                return false;
+            }
+            value = std::move(cell->value);
+            cell->sequence.store(front + mask + 1, std::memory_order_release);
+            head.store(front + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+        /// Returns the approximate number of values in the queue.
+        unsigned int Size()
+        {
+            return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+        }
+
+    private:
+        struct Cell
+        {
+            /// Equals the slot's position when it is free for the producer claiming that position,
+            /// and one more than that when it holds a value for the consumer.
+            std::atomic<unsigned int> sequence = {0};
+            T value;
+        };
+
+        MPSCQueue(const MPSCQueue& source) = delete;
+        MPSCQueue& operator=(const MPSCQueue& source) = delete;
+
+        /// Ring buffer of slots, sized to a power of two.
+        Cell* buffer = nullptr;
+
+        /// Bit mask for wrapping indices into the buffer.
+        unsigned int mask = 0;
+
+        /// Total number of values popped; only written by the consumer.
+        std::atomic<unsigned int> head = {0};
+
+        /// Total number of slots claimed by producers.
+        std::atomic<unsigned int> tail = {0};
+
+    };
+
+}
+
+#endif // MPSCQUEUE_H
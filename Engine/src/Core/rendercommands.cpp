@@ -0,0 +1,259 @@
+#include <cstring>
+#include <algorithm>
+
+#include "logging.h"
+#include "rendercommands.h"
+
+using namespace std;
+
+namespace Ossium
+{
+
+    void RenderCommandList::Record(bgfx::ViewId view, bgfx::ViewMode::Enum mode, const DrawCall& call)
+    {
+        if (call.layout == nullptr || call.vertices == nullptr || call.vertexCount == 0 || !bgfx::isValid(call.program))
+        {
+            return;
+        }
+        if (call.vertexCount > UINT16_MAX + 1)
+        {
+            Log.Warning("Draw call has {0} vertices, more than can be indexed by 16 bit indices!", call.vertexCount);
+            return;
+        }
+
+        Command command;
+        command.depth = GetSortDepth(mode, call.layer, call.depth);
+        command.view = view;
+        command.layout = call.layout;
+        command.program = call.program;
+        command.state = call.state;
+        command.rgba = call.rgba;
+        command.texture = call.texture;
+        command.sampler = call.sampler;
+
+        // Copy the vertex data and indices
+        Uint32 stride = call.layout->getStride();
+        command.vertexOffset = vertices.size();
+        command.vertexCount = call.vertexCount;
+        vertices.resize(vertices.size() + call.vertexCount * stride);
+        memcpy(&vertices[command.vertexOffset], call.vertices, call.vertexCount * stride);
+
+        command.indexOffset = indices.size();
+        if (call.indices != nullptr && call.indexCount > 0)
+        {
+            command.indexCount = call.indexCount;
+            indices.insert(indices.end(), call.indices, call.indices + call.indexCount);
+        }
+        else
+        {
+            command.indexCount = call.vertexCount;
+            for (Uint32 i = 0; i < call.vertexCount; i++)
+            {
+                indices.push_back((uint16_t)i);
+            }
+        }
+
+        // The view always comes first so views are submitted one after the other
+        Uint64 key = (Uint64)(view & 0xFF) << 56;
+        Uint64 depth = (Uint64)(clamp(call.depth, 0.0f, 1.0f) * (float)UINT16_MAX);
+        switch (mode)
+        {
+        case bgfx::ViewMode::Sequential:
+            key |= sequence & 0x00FFFFFFFFFFFFFF;
+            break;
+        case bgfx::ViewMode::DepthAscending:
+        case bgfx::ViewMode::DepthDescending:
+            if (mode == bgfx::ViewMode::DepthDescending)
+            {
+                depth = UINT16_MAX - depth;
+            }
+            key |= (Uint64)call.layer << 48 | depth << 32 | (Uint64)call.program.idx << 16 | call.texture.idx;
+            break;
+        default:
+            key |= (Uint64)call.layer << 48 | (Uint64)call.program.idx << 32 | (Uint64)call.texture.idx << 16 | depth;
+            break;
+        }
+        command.key = key;
+        sequence++;
+
+        commands.push_back(command);
+    }
+
+    void RenderCommandList::SetViewTransform(bgfx::ViewId view, const Matrix<4, 4>& viewMatrix, const Matrix<4, 4>& projMatrix)
+    {
+        ViewTransform& transform = transforms[view];
+        transform.view = viewMatrix;
+        transform.proj = projMatrix;
+    }
+
+    void RenderCommandList::Submit()
+    {
+        commandCount = commands.size();
+        submitCount = 0;
+        submitDepths.clear();
+
+        for (auto& itr : transforms)
+        {
+            bgfx::setViewTransform(itr.first, &itr.second.view, &itr.second.proj);
+        }
+
+        Sort();
+
+        for (unsigned int i = 0, counti = sorted.size(); i < counti;)
+        {
+            // Gather consecutive commands that only differ by vertex data
+            const Command& first = commands[sorted[i]];
+            Uint32 vertexCount = first.vertexCount;
+            Uint32 indexCount = first.indexCount;
+            unsigned int end = i + 1;
+            for (; end < counti; end++)
+            {
+                const Command& next = commands[sorted[end]];
+                if (!CanMerge(first, next) || vertexCount + next.vertexCount > UINT16_MAX + 1)
+                {
+                    break;
+                }
+                vertexCount += next.vertexCount;
+                indexCount += next.indexCount;
+            }
+
+            bgfx::TransientVertexBuffer tvb;
+            bgfx::TransientIndexBuffer tib;
+            if (!bgfx::allocTransientBuffers(&tvb, *first.layout, vertexCount, &tib, indexCount))
+            {
+                Log.Warning("Failed to allocate transient buffers for {0} vertices, skipping {1} draw calls.", vertexCount, end - i);
+                i = end;
+                continue;
+            }
+
+            // Copy the vertices and offset the indices of each command in the batch
+            Uint32 stride = first.layout->getStride();
+            Uint8* vertexData = tvb.data;
+            uint16_t* indexData = (uint16_t*)tib.data;
+            Uint32 baseVertex = 0;
+            for (unsigned int j = i; j < end; j++)
+            {
+                const Command& command = commands[sorted[j]];
+                memcpy(vertexData, &vertices[command.vertexOffset], command.vertexCount * stride);
+                vertexData += command.vertexCount * stride;
+                for (Uint32 k = 0; k < command.indexCount; k++)
+                {
+                    *indexData = (uint16_t)(indices[command.indexOffset + k] + baseVertex);
+                    indexData++;
+                }
+                baseVertex += command.vertexCount;
+            }
+
+            bgfx::setState(first.state, first.rgba);
+            bgfx::setVertexBuffer(0, &tvb);
+            bgfx::setIndexBuffer(&tib);
+            if (bgfx::isValid(first.texture))
+            {
+                bgfx::setTexture(0, first.sampler, first.texture);
+            }
+            bgfx::submit(first.view, first.program, first.depth);
+            submitDepths.push_back(first.depth);
+            submitCount++;
+
+            i = end;
+        }
+
+        commands.clear();
+        vertices.clear();
+        indices.clear();
+        transforms.clear();
+        sequence = 0;
+    }
+
+    Uint32 RenderCommandList::GetCommandCount()
+    {
+        return commandCount;
+    }
+
+    Uint32 RenderCommandList::GetSubmitCount()
+    {
+        return submitCount;
+    }
+
+    const vector<Uint32>& RenderCommandList::GetSubmitOrder()
+    {
+        return sorted;
+    }
+
+    const vector<Uint32>& RenderCommandList::GetSubmitDepths()
+    {
+        return submitDepths;
+    }
+
+    Uint32 RenderCommandList::GetSortDepth(bgfx::ViewMode::Enum mode, Uint8 layer, float depth)
+    {
+        // The layer takes the top byte and the depth the rest
+        Uint32 quantised = (Uint32)(clamp(depth, 0.0f, 1.0f) * (float)0xFFFFFF);
+        switch (mode)
+        {
+        case bgfx::ViewMode::DepthAscending:
+            return (Uint32)layer << 24 | quantised;
+        case bgfx::ViewMode::DepthDescending:
+            // bgfx sorts the whole value in descending order, so invert the layer to keep layers ascending
+            return (Uint32)(0xFF - layer) << 24 | quantised;
+        default:
+            return 0;
+        }
+    }
+
+    bool RenderCommandList::CanMerge(const Command& a, const Command& b)
+    {
+        // Merged commands are submitted with the depth of the first, so they must share it
+        return a.view == b.view &&
+            a.depth == b.depth &&
+            a.layout == b.layout &&
+            a.program.idx == b.program.idx &&
+            a.state == b.state &&
+            a.rgba == b.rgba &&
+            a.texture.idx == b.texture.idx &&
+            a.sampler.idx == b.sampler.idx;
+    }
+
+    void RenderCommandList::Sort()
+    {
+        unsigned int count = commands.size();
+        sorted.resize(count);
+        scratch.resize(count);
+        for (unsigned int i = 0; i < count; i++)
+        {
+            sorted[i] = i;
+        }
+
+        // Radix sort a byte at a time, starting with the least significant byte. Each pass is stable,
+        // so commands with equal keys stay in the order they were recorded.
+        for (unsigned int shift = 0; shift < 64; shift += 8)
+        {
+            unsigned int offsets[256] = {0};
+            for (unsigned int i = 0; i < count; i++)
+            {
+                offsets[(commands[i].key >> shift) & 0xFF]++;
+            }
+
+            // Skip bytes that are the same for every command, e.g. when there is only one layer
+            if (count == 0 || offsets[(commands[0].key >> shift) & 0xFF] == count)
+            {
+                continue;
+            }
+
+            unsigned int total = 0;
+            for (unsigned int i = 0; i < 256; i++)
+            {
+                unsigned int bucket = offsets[i];
+                offsets[i] = total;
+                total += bucket;
+            }
+            for (unsigned int i = 0; i < count; i++)
+            {
+                unsigned int index = sorted[i];
+                scratch[offsets[(commands[index].key >> shift) & 0xFF]++] = index;
+            }
+            sorted.swap(scratch);
+        }
+    }
+
+}
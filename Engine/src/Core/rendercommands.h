@@ -0,0 +1,140 @@
+#ifndef RENDERCOMMANDS_H
+#define RENDERCOMMANDS_H
+
+#include <vector>
+#include <unordered_map>
+extern "C"
+{
+    #include <SDL.h>
+}
+#include "bgfx/bgfx.h"
+
+#include "helpermacros.h"
+#include "matrix.h"
+
+namespace Ossium
+{
+
+    // A draw call to record in a RenderCommandList.
+    struct DrawCall
+    {
+        // The layout of the vertices. Must remain valid until the commands are submitted, so use a static layout.
+        const bgfx::VertexLayout* layout = nullptr;
+
+        // The vertices and indices, which are copied when recorded.
+        // If there are no indices, the vertices are drawn in order.
+        const void* vertices = nullptr;
+        Uint32 vertexCount = 0;
+        const uint16_t* indices = nullptr;
+        Uint32 indexCount = 0;
+
+        // The shader program, bgfx state and blend factor colour
+        bgfx::ProgramHandle program = BGFX_INVALID_HANDLE;
+        Uint64 state = BGFX_STATE_DEFAULT;
+        Uint32 rgba = 0;
+
+        // Texture bound to stage 0, if any
+        bgfx::TextureHandle texture = BGFX_INVALID_HANDLE;
+        bgfx::UniformHandle sampler = BGFX_INVALID_HANDLE;
+
+        // Sort order of the draw call in views that aren't sequential, see RenderCommandList::Record(). Depth ranges from 0 to 1.
+        Uint8 layer = 0;
+        float depth = 0;
+    };
+
+    // Records draw calls with sort keys during a frame, then sorts and submits them all at once.
+    // Consecutive draw calls in a view that share the same program, texture, state and vertex layout are merged into a single submission,
+    // as long as they have the same layer and depth in depth sorted views. View transforms are only set once per view.
+    class OSSIUM_EDL RenderCommandList
+    {
+    public:
+        RenderCommandList() = default;
+
+        // Records a draw call in a view. Draw calls in sequential views are submitted in the order they are recorded,
+        // otherwise they are sorted by layer, then by depth when the view mode sorts by depth, or else by program and texture.
+        void Record(bgfx::ViewId view, bgfx::ViewMode::Enum mode, const DrawCall& call);
+
+        // Sets the view and projection matrices of a view. As with bgfx, the last transform set in a frame applies to the whole view.
+        void SetViewTransform(bgfx::ViewId view, const Matrix<4, 4>& viewMatrix, const Matrix<4, 4>& projMatrix);
+
+        // Sorts, merges and submits all recorded draw calls, then clears the list.
+        void Submit();
+
+        // Returns the number of draw calls recorded in the last submitted frame.
+        Uint32 GetCommandCount();
+
+        // Returns the number of bgfx submissions made in the last submitted frame.
+        Uint32 GetSubmitCount();
+
+        // Returns the draw calls of the last submitted frame in the order they were submitted,
+        // as indices into the order they were recorded.
+        const std::vector<Uint32>& GetSubmitOrder();
+
+        // Returns the depth passed to bgfx with each submission of the last submitted frame.
+        const std::vector<Uint32>& GetSubmitDepths();
+
+        // Packs a layer and depth into the depth bgfx sorts draw calls by in a view, so that layers come first in either
+        // depth sorted view mode. Views that don't sort by depth get 0. Use this when submitting to bgfx directly.
+        static Uint32 GetSortDepth(bgfx::ViewMode::Enum mode, Uint8 layer, float depth);
+
+    private:
+        NOCOPY(RenderCommandList);
+
+        struct Command
+        {
+            Uint64 key;
+            // Depth passed to bgfx, see GetSortDepth()
+            Uint32 depth;
+            bgfx::ViewId view;
+            const bgfx::VertexLayout* layout;
+            bgfx::ProgramHandle program;
+            Uint64 state;
+            Uint32 rgba;
+            bgfx::TextureHandle texture;
+            bgfx::UniformHandle sampler;
+
+            // Offset into the vertex data in bytes, and into the indices
+            Uint32 vertexOffset;
+            Uint32 vertexCount;
+            Uint32 indexOffset;
+            Uint32 indexCount;
+        };
+
+        struct ViewTransform
+        {
+            Matrix<4, 4> view;
+            Matrix<4, 4> proj;
+        };
+
+        // Returns true if two commands can be submitted together
+        static bool CanMerge(const Command& a, const Command& b);
+
+        // Sorts the command indices by key, least significant byte first
+        void Sort();
+
+        std::vector<Command> commands;
+
+        // Vertex data of all commands, and indices relative to the first vertex of each command
+        std::vector<Uint8> vertices;
+        std::vector<uint16_t> indices;
+
+        // Command indices in submission order, and scratch space for sorting
+        std::vector<Uint32> sorted;
+        std::vector<Uint32> scratch;
+
+        // Depth of each submission
+        std::vector<Uint32> submitDepths;
+
+        std::unordered_map<bgfx::ViewId, ViewTransform> transforms;
+
+        // Used to keep the order of draw calls in sequential views
+        Uint64 sequence = 0;
+
+        Uint32 commandCount = 0;
+        Uint32 submitCount = 0;
+
+    };
+
+}
+
+#endif // RENDERCOMMANDS_H
@@ -19,6 +19,7 @@
 #include <unordered_set>
 
 #include "renderer.h"
+#include "shader.h"
 #include "window.h"
 #include "coremaths.h"
 #include "colors.h"
@@ -29,7 +30,7 @@ using namespace std;
 namespace Ossium
 {
 
-    Renderer::Renderer(RenderTarget* target, RenderViewPool* renderViewPool)
+    Renderer::Renderer(RenderTarget* target, RenderViewPool* renderViewPool, Uint16 maxInputs)
     {
 #ifdef OSSIUM_DEBUG
         DEBUG_ASSERT(target != NULL, "Render target must not be null.");
@@ -37,6 +38,10 @@ namespace Ossium
 #endif
         this->target = target;
         this->renderViewPool = renderViewPool;
+        if (renderViewPool->Reserve(maxInputs, firstView))
+        {
+            viewCount = maxInputs;
+        }
 
         aspect_width = 0;
         aspect_height = 0;
@@ -50,38 +55,104 @@ namespace Ossium
 
     Renderer::~Renderer()
     {
+        for (RenderInput* input : inputs)
+        {
+            input->renderView = nullptr;
+            input->renderer = nullptr;
+        }
+        inputs.clear();
+        if (viewCount > 0)
+        {
+            renderViewPool->Release(firstView);
+        }
+        for (auto& itr : programs)
+        {
+            bgfx::destroy(itr.second);
+        }
+        programs.clear();
+        for (auto& itr : shaders)
+        {
+            delete itr.second;
+        }
+        shaders.clear();
     }
 
     void Renderer::RenderPresent()
     {
-        // Render pipeline inputs
-        for (unsigned int i = 0, counti = inputs.size(); i < counti; i++)
-        {
-            if (inputs[i]->IsRenderEnabled())
-            {
-                // TODO each input should have it's own clear colour
-                auto bgcolor = ColorToUint32(bufferColour, SDL_PIXELFORMAT_ARGB32);
-                //Log.Info("View = {2}, background colour = {0}, converted = {1}", Utilities::ToString(bufferColour), bgcolor, inputs[i]->renderView->GetDebugName());
-                bgfx::setViewClear(
-                    inputs[i]->renderView->GetID(),
-                    BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH, // Clear flags
-                    bgcolor,
-                    1.0f,
-                    0
-                );
-                bgfx::touch(inputs[i]->renderView->GetID());
-
-                inputs[i]->Render();
-            }
-        }
+        // Render pipeline inputs in the order required by the targets they read and write
+        graph.Execute(inputs, target, viewportRect, firstView, viewCount);
+
+        // Submit everything drawn by the inputs
+        OnSubmit(*this);
+        commands.Submit();
 
         #ifdef OSSIUM_DEBUG
         numRenderedPrevious = numRendered;
         numRendered = 0;
         #endif // DEBUG
 
-        // Actually render everything
-        bgfx::frame();
+        // Actually render everything. When running with a render thread (see EngineSystem::Run()) this only waits for the previous
+        // frame to finish rendering, then hands this frame to the render thread so the next frame can be simulated meanwhile.
+        frame = bgfx::frame();
+    }
+
+    Uint32 Renderer::GetFrame()
+    {
+        return frame;
+    }
+
+    RenderTexture* Renderer::GetTransientTarget(const std::string& name)
+    {
+        return graph.GetTransient(name);
+    }
+
+    RenderGraph* Renderer::GetRenderGraph()
+    {
+        return &graph;
+    }
+
+    void Renderer::Draw(RenderInput* pass, const DrawCall& call)
+    {
+        commands.Record(pass->GetID(), pass->GetViewMode(), call);
+    }
+
+    void Renderer::SetViewTransform(RenderInput* pass, const Matrix<4, 4>& view, const Matrix<4, 4>& proj)
+    {
+        commands.SetViewTransform(pass->GetID(), view, proj);
+    }
+
+    RenderCommandList* Renderer::GetCommandList()
+    {
+        return &commands;
+    }
+
+    bgfx::ProgramHandle Renderer::GetProgram(const string& vertexShader, const string& fragmentShader)
+    {
+        string key = vertexShader + "|" + fragmentShader;
+        auto itr = programs.find(key);
+        if (itr != programs.end())
+        {
+            return itr->second;
+        }
+
+        Shader* shaderPair[2] = { nullptr, nullptr };
+        string ids[2] = { vertexShader, fragmentShader };
+        for (unsigned int i = 0; i < 2; i++)
+        {
+            auto shaderItr = shaders.find(ids[i]);
+            if (shaderItr == shaders.end())
+            {
+                // Failures are logged by the shader, the program is then invalid and draw calls using it are ignored
+                Shader* shader = new Shader();
+                shader->LoadAndInit(Shader::GetPath(ids[i]));
+                shaderItr = shaders.insert({ids[i], shader}).first;
+            }
+            shaderPair[i] = shaderItr->second;
+        }
+
+        bgfx::ProgramHandle program = bgfx::createProgram(shaderPair[0]->GetHandle(), shaderPair[1]->GetHandle());
+        programs[key] = program;
+        return program;
     }
 
     SDL_Color Renderer::GetBackgroundColor()
@@ -96,12 +167,8 @@ namespace Ossium
 
     void Renderer::SetDrawColor(SDL_Color color)
     {
-        bool update = drawColour != color;
+        // Draw calls take the colour when recorded, so bgfx state doesn't need updating here
         drawColour = color;
-        if (update)
-        {
-            UpdateStateAndColor();
-        }
     }
 
     void Renderer::SetDrawColor(Uint8 red, Uint8 green, Uint8 blue, Uint8 alpha)
@@ -129,10 +196,25 @@ namespace Ossium
         return state;
     }
 
-    void Renderer::UpdateStateAndColor()
+    void Renderer::SetDrawOrder(Uint8 layer, float depth)
+    {
+        drawLayer = layer;
+        drawDepth = depth;
+    }
+
+    Uint8 Renderer::GetDrawLayer()
+    {
+        return drawLayer;
+    }
+
+    float Renderer::GetDrawDepth()
     {
-        // TODO check pixel format is correct
-        bgfx::setState(state, GetDrawColorUint32());
+        return drawDepth;
+    }
+
+    Uint32 Renderer::GetSortDepth(RenderInput* pass)
+    {
+        return RenderCommandList::GetSortDepth(pass->GetViewMode(), drawLayer, drawDepth);
     }
 
     int Renderer::GetWidth()
@@ -281,9 +363,25 @@ namespace Ossium
         }
     }
 
+    bgfx::ViewId Renderer::GetFirstView()
+    {
+        return firstView;
+    }
+
+    Uint16 Renderer::GetViewCount()
+    {
+        return viewCount;
+    }
+
     void Renderer::AddInput(RenderInput* input)
     {
-        input->renderView = renderViewPool->Create(viewportRect, target, input->GetRenderDebugName());
+        RenderView* view = viewCount > 0 ? renderViewPool->Create(firstView, viewportRect, target, input->GetRenderDebugName()) : nullptr;
+        if (view == nullptr)
+        {
+            Log.Error("Failed to add RenderInput \"{0}\", the renderer has no free views for more than {1} inputs.", input->GetRenderDebugName(), viewCount);
+            return;
+        }
+        input->renderView = view;
         bgfx::setViewMode(input->renderView->GetID(), input->GetViewMode());
         input->renderer = this;
         inputs.push_back(input);
@@ -303,6 +401,7 @@ namespace Ossium
                     inputs[i] = inputs[i + 1];
                 }
                 inputs.pop_back();
+                OnInputRemoved(input);
                 renderViewPool->Free(input->renderView);
                 input->renderView = nullptr;
                 input->renderer = nullptr;
@@ -324,4 +423,21 @@ namespace Ossium
     }
     #endif // DEBUG
 
+    ///
+    /// Vertex2D
+    ///
+
+    const bgfx::VertexLayout& Vertex2D::Layout()
+    {
+        static bgfx::VertexLayout layout = [] () {
+            bgfx::VertexLayout layout;
+            layout.begin()
+                .add(bgfx::Attrib::Position, 2, bgfx::AttribType::Float)
+                .add(bgfx::Attrib::Color0, 4, bgfx::AttribType::Uint8, true)
+            .end();
+            return layout;
+        }();
+        return layout;
+    }
+
 }
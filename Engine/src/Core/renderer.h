@@ -20,6 +20,8 @@
 #include <vector>
 #include <queue>
 #include <set>
+#include <string>
+#include <unordered_map>
 extern "C"
 {
     #include <SDL.h>
@@ -32,11 +34,15 @@ extern "C"
 #include "renderinput.h"
 #include "renderview.h"
 #include "rendertarget.h"
+#include "rendergraph.h"
+#include "rendercommands.h"
+#include "callback.h"
 
 namespace Ossium
 {
     // Forward declarations
     class Renderer;
+    class Shader;
 
     // UI render elements should inherit from this base class
     class OSSIUM_EDL Graphic
@@ -64,13 +70,44 @@ namespace Ossium
     class OSSIUM_EDL Renderer : public Service<Renderer>
     {
     public:
-        // Create a renderer.
-        Renderer(RenderTarget* renderTarget, RenderViewPool* renderViewPool);
+        // Create a renderer. A contiguous range of views is reserved from the pool, which limits the number of inputs.
+        Renderer(RenderTarget* renderTarget, RenderViewPool* renderViewPool, Uint16 maxInputs = 32);
         virtual ~Renderer();
 
         // Renders all RenderInput instances in the current frame.
         void RenderPresent();
 
+        // Returns the number of the last frame submitted by RenderPresent(), so it changes once per frame.
+        Uint32 GetFrame();
+
+        // Returns the frame buffer assigned to a transient target declared by an input, or null if there isn't one.
+        // Only valid while rendering inputs that read or write the target.
+        RenderTexture* GetTransientTarget(const std::string& name);
+
+        // Returns the graph that orders the inputs.
+        RenderGraph* GetRenderGraph();
+
+        // Records a draw call in the view of an input. Draw calls are sorted and submitted together by RenderPresent(),
+        // so the vertex data is copied and consecutive draw calls with the same state are merged.
+        void Draw(RenderInput* pass, const DrawCall& call);
+
+        // Sets the view and projection matrices used by draw calls in the view of an input this frame.
+        void SetViewTransform(RenderInput* pass, const Matrix<4, 4>& view, const Matrix<4, 4>& proj);
+
+        // Returns the draw calls recorded this frame.
+        RenderCommandList* GetCommandList();
+
+        // Called once all inputs have rendered, just before the draw calls recorded this frame are submitted.
+        // Use this to record draw calls accumulated over the frame, see DebugDraw.
+        Callback<Renderer&> OnSubmit;
+
+        // Called when an input is removed, before it loses its view. Use this to forget anything recorded for the input.
+        Callback<RenderInput*> OnInputRemoved;
+
+        // Returns a shader program made from the vertex and fragment shaders with the given ids, see Shader::GetPath().
+        // Programs are loaded the first time they are requested and destroyed with the renderer.
+        bgfx::ProgramHandle GetProgram(const std::string& vertexShader, const std::string& fragmentShader);
+
         // Sets the default rendering color.
         void SetDrawColor(SDL_Color color);
 
@@ -89,8 +126,19 @@ namespace Ossium
         // Returns the bgfx state for this renderer
         Uint64 GetState();
 
-        // Updates the bgfx state and draw colour.
-        void UpdateStateAndColor();
+        // Sets the layer and depth of subsequent draw calls, which sort them in views that aren't sequential, see DrawCall.
+        // Depth ranges from 0 (nearest) to 1 (furthest).
+        void SetDrawOrder(Uint8 layer, float depth);
+
+        // Returns the layer of subsequent draw calls
+        Uint8 GetDrawLayer();
+
+        // Returns the depth of subsequent draw calls
+        float GetDrawDepth();
+
+        // Returns the layer and depth of subsequent draw calls packed into the depth bgfx sorts by in the view of an input.
+        // Pass this to bgfx::submit() when submitting to bgfx directly, so the draw calls sort with recorded ones.
+        Uint32 GetSortDepth(RenderInput* pass);
 
         // Returns a pointer to the render target.
         RenderTarget* GetTarget();
@@ -146,10 +194,17 @@ namespace Ossium
         // Updates the renderer viewport dimensions according to the current aspect of the render target.
         void ResetViewport();
 
+        // Returns the first view id reserved by this renderer.
+        bgfx::ViewId GetFirstView();
+
+        // Returns the number of view ids reserved by this renderer, i.e. the maximum number of inputs.
+        Uint16 GetViewCount();
+
         // Add an input to render.
         // Each input is rendered one after the other in passes; so for example, adding a geometry buffer
         // and a shadow map texture followed by lighting would first render geometry,
         // then render the shadow map, then render lighting to the target.
+        // Inputs that declare they read a target are moved after the inputs that write to it, see RenderGraph.
         void AddInput(RenderInput* input);
         
         // Remove an input that no longer needs to be rendered.
@@ -164,8 +219,22 @@ namespace Ossium
         // The pool of render views available for use
         RenderViewPool* renderViewPool;
 
+        // The range of view ids reserved for the inputs
+        bgfx::ViewId firstView = 0;
+        Uint16 viewCount = 0;
+
         // Inputs for rendering (render passes)
         std::vector<RenderInput*> inputs;
+
+        // Orders, culls and clears the inputs each frame
+        RenderGraph graph;
+
+        // Draw calls recorded this frame
+        RenderCommandList commands;
+
+        // Loaded shaders and the programs made from them
+        std::unordered_map<std::string, Shader*> shaders;
+        std::unordered_map<std::string, bgfx::ProgramHandle> programs;
         
         // Renderer viewport target width/height or aspect ratio
         int aspect_width = 0;
@@ -186,6 +255,13 @@ namespace Ossium
         // The bgfx state to use for this renderer, defaults to BGFX_STATE_DEFAULT.
         Uint64 state = BGFX_STATE_DEFAULT;
 
+        // The layer and depth of draw calls, set by the input drawing them.
+        Uint8 drawLayer = 0;
+        float drawDepth = 0;
+
+        // The number of the last frame submitted.
+        Uint32 frame = 0;
+
         #ifdef OSSIUM_DEBUG
         /// Number of graphics rendered in the current frame
         int numRendered;
@@ -204,6 +280,17 @@ namespace Ossium
         uint32_t abgr;
     };
 
+    // Defines a 2D position vertex with a colour, as used by the default shaders
+    struct OSSIUM_EDL Vertex2D
+    {
+        float x;
+        float y;
+        Uint32 color0;
+
+        // Returns the vertex layout, which is created once
+        static const bgfx::VertexLayout& Layout();
+    };
+
 }
 
 #endif // RENDERER_H
@@ -0,0 +1,442 @@
+#include <algorithm>
+
+#include "rendergraph.h"
+#include "rendertexture.h"
+#include "renderinput.h"
+#include "renderview.h"
+#include "colors.h"
+#include "logging.h"
+
+using namespace std;
+
+namespace Ossium
+{
+
+    ///
+    /// RenderPassTargets
+    ///
+
+    void RenderPassTargets::Read(RenderTarget* target)
+    {
+        reads.push_back(target);
+    }
+
+    void RenderPassTargets::Read(const string& transient)
+    {
+        transientReads.push_back(transient);
+    }
+
+    void RenderPassTargets::Write(RenderTarget* target)
+    {
+        write = target;
+        transientWrite.clear();
+    }
+
+    void RenderPassTargets::Write(const string& transient, int width, int height)
+    {
+        write = nullptr;
+        transientWrite = transient;
+        transientWidth = width;
+        transientHeight = height;
+    }
+
+    ///
+    /// RenderGraph
+    ///
+
+    RenderGraph::~RenderGraph()
+    {
+        for (TransientBuffer& buffer : buffers)
+        {
+            delete buffer.texture;
+        }
+        buffers.clear();
+    }
+
+    void RenderGraph::Execute(vector<RenderInput*>& inputs, RenderTarget* mainTarget, SDL_Rect mainViewport, bgfx::ViewId firstView, Uint16 viewCount)
+    {
+        passes.clear();
+        resources.clear();
+        persistentIds.clear();
+        transientIds.clear();
+        skipped = 0;
+
+        // Collect the enabled inputs and the targets they use
+        vector<bool> enabled(inputs.size(), false);
+        for (unsigned int i = 0, counti = inputs.size(); i < counti; i++)
+        {
+            if (!inputs[i]->IsRenderEnabled())
+            {
+                continue;
+            }
+            enabled[i] = true;
+
+            RenderPassTargets targets;
+            targets.write = mainTarget;
+            inputs[i]->DeclareTargets(targets);
+
+            unsigned int index = passes.size();
+            Pass pass;
+            pass.input = inputs[i];
+            for (RenderTarget* target : targets.reads)
+            {
+                pass.reads.push_back(GetResource(target));
+            }
+            for (string& transient : targets.transientReads)
+            {
+                pass.reads.push_back(GetResource(transient));
+            }
+            if (targets.write == nullptr && !targets.transientWrite.empty())
+            {
+                pass.write = GetResource(targets.transientWrite);
+                Resource& resource = resources[pass.write];
+                if (resource.writers.empty())
+                {
+                    resource.width = targets.transientWidth;
+                    resource.height = targets.transientHeight;
+                }
+            }
+            else
+            {
+                pass.write = GetResource(targets.write != nullptr ? targets.write : mainTarget);
+            }
+
+            for (unsigned int read : pass.reads)
+            {
+                resources[read].readers.push_back(index);
+            }
+            resources[pass.write].writers.push_back(index);
+            passes.push_back(pass);
+        }
+
+        Sort();
+        Cull();
+
+        // Find when each target is first and last used, so transient frame buffers are only held for as long as necessary
+        for (unsigned int i = 0, counti = order.size(); i < counti; i++)
+        {
+            Pass& pass = passes[order[i]];
+            if (!pass.used)
+            {
+                continue;
+            }
+            for (unsigned int read : pass.reads)
+            {
+                resources[read].first = resources[read].first < 0 ? i : resources[read].first;
+                resources[read].last = i;
+            }
+            resources[pass.write].first = resources[pass.write].first < 0 ? i : resources[pass.write].first;
+            resources[pass.write].last = i;
+        }
+
+        for (TransientBuffer& buffer : buffers)
+        {
+            buffer.usedThisFrame = false;
+        }
+
+        for (unsigned int i = 0, counti = order.size(); i < counti; i++)
+        {
+            Pass& pass = passes[order[i]];
+            if (!pass.used)
+            {
+                skipped++;
+                continue;
+            }
+
+            // Assign frame buffers to transient targets when first used
+            for (Resource& resource : resources)
+            {
+                if (resource.target == nullptr && resource.first == (int)i && !resource.writers.empty())
+                {
+                    resource.buffer = AcquireBuffer(resource.width, resource.height);
+                }
+            }
+
+            Resource& output = resources[pass.write];
+            RenderTarget* target = output.target != nullptr ? output.target : output.buffer;
+            if (target != nullptr)
+            {
+                RenderView* view = pass.input->renderView;
+                view->SetRenderTarget(target);
+                view->SetViewport(target == mainTarget ? mainViewport : (SDL_Rect){0, 0, target->GetWidth(), target->GetHeight()});
+
+                // Later passes draw over the output of earlier passes, so only the first pass clears the colour
+                bgfx::setViewClear(
+                    view->GetID(),
+                    output.cleared ? BGFX_CLEAR_DEPTH : BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH,
+                    ColorToUint32(pass.input->GetClearColor(), SDL_PIXELFORMAT_ARGB32),
+                    1.0f,
+                    0
+                );
+                output.cleared = true;
+                bgfx::touch(view->GetID());
+
+                pass.input->Render();
+            }
+            else
+            {
+                skipped++;
+            }
+
+            // Frame buffers can be reused once transient targets are no longer needed
+            for (Resource& resource : resources)
+            {
+                if (resource.buffer != nullptr && resource.last == (int)i)
+                {
+                    ReleaseBuffer(resource.buffer);
+                    resource.buffer = nullptr;
+                }
+            }
+        }
+
+        // Free frame buffers that weren't needed this frame
+        for (unsigned int i = 0; i < buffers.size();)
+        {
+            if (!buffers[i].usedThisFrame)
+            {
+                delete buffers[i].texture;
+                buffers.erase(buffers.begin() + i);
+            }
+            else
+            {
+                i++;
+            }
+        }
+
+        if (viewCount == 0)
+        {
+            return;
+        }
+
+        // Views are submitted in order of id, so reorder the views reserved by the renderer to match the execution order.
+        // Skipped and disabled inputs go last followed by the unused views; they don't submit anything.
+        vector<bgfx::ViewId> remap;
+        vector<bool> listed(viewCount, false);
+        remap.reserve(viewCount);
+        auto append = [&] (RenderInput* input) {
+            bgfx::ViewId id = input->renderView->GetID();
+            if (id >= firstView && id - firstView < viewCount && !listed[id - firstView])
+            {
+                listed[id - firstView] = true;
+                remap.push_back(id);
+            }
+        };
+        for (unsigned int index : order)
+        {
+            if (passes[index].used)
+            {
+                append(passes[index].input);
+            }
+        }
+        for (unsigned int index : order)
+        {
+            if (!passes[index].used)
+            {
+                append(passes[index].input);
+            }
+        }
+        for (unsigned int i = 0, counti = inputs.size(); i < counti; i++)
+        {
+            if (!enabled[i])
+            {
+                append(inputs[i]);
+            }
+        }
+        for (unsigned int i = 0; i < viewCount; i++)
+        {
+            if (!listed[i])
+            {
+                remap.push_back(firstView + i);
+            }
+        }
+        bgfx::setViewOrder(firstView, viewCount, remap.data());
+    }
+
+    RenderTexture* RenderGraph::GetTransient(const string& name)
+    {
+        auto itr = transientIds.find(name);
+        return itr != transientIds.end() ? resources[itr->second].buffer : nullptr;
+    }
+
+    unsigned int RenderGraph::GetSkippedCount()
+    {
+        return skipped;
+    }
+
+    unsigned int RenderGraph::GetTransientBufferCount()
+    {
+        return buffers.size();
+    }
+
+    unsigned int RenderGraph::GetResource(RenderTarget* target)
+    {
+        auto itr = persistentIds.find(target);
+        if (itr != persistentIds.end())
+        {
+            return itr->second;
+        }
+        Resource resource;
+        resource.target = target;
+        resources.push_back(resource);
+        persistentIds[target] = resources.size() - 1;
+        return resources.size() - 1;
+    }
+
+    unsigned int RenderGraph::GetResource(const string& transient)
+    {
+        auto itr = transientIds.find(transient);
+        if (itr != transientIds.end())
+        {
+            return itr->second;
+        }
+        Resource resource;
+        resource.name = transient;
+        resources.push_back(resource);
+        transientIds[transient] = resources.size() - 1;
+        return resources.size() - 1;
+    }
+
+    void RenderGraph::Sort()
+    {
+        unsigned int count = passes.size();
+        vector<vector<unsigned int>> edges(count);
+        vector<unsigned int> incoming(count, 0);
+        auto link = [&] (unsigned int from, unsigned int to) {
+            if (from != to)
+            {
+                edges[from].push_back(to);
+                incoming[to]++;
+            }
+        };
+
+        for (Resource& resource : resources)
+        {
+            // Writers draw over each other in the order they were added, and all writes happen before any reads
+            for (unsigned int i = 1, counti = resource.writers.size(); i < counti; i++)
+            {
+                link(resource.writers[i - 1], resource.writers[i]);
+            }
+            for (unsigned int writer : resource.writers)
+            {
+                for (unsigned int reader : resource.readers)
+                {
+                    link(writer, reader);
+                }
+            }
+        }
+
+        // Always take the earliest added pass that is ready, so independent passes keep the order they were added in
+        order.clear();
+        vector<bool> done(count, false);
+        bool cycle = false;
+        while (order.size() < count)
+        {
+            unsigned int next = count;
+            for (unsigned int i = 0; i < count && next == count; i++)
+            {
+                if (!done[i] && incoming[i] == 0)
+                {
+                    next = i;
+                }
+            }
+            if (next == count)
+            {
+                // There's a cycle, so fall back to the order the passes were added
+                cycle = true;
+                for (unsigned int i = 0; i < count && next == count; i++)
+                {
+                    if (!done[i])
+                    {
+                        next = i;
+                    }
+                }
+            }
+            done[next] = true;
+            order.push_back(next);
+            for (unsigned int to : edges[next])
+            {
+                if (incoming[to] > 0)
+                {
+                    incoming[to]--;
+                }
+            }
+        }
+
+        // Only warn when a cycle first appears, rather than every frame
+        if (cycle && !cyclic)
+        {
+            Log.Warning("Render inputs have cyclic target dependencies, some may read targets before they are written.");
+        }
+        cyclic = cycle;
+    }
+
+    void RenderGraph::Cull()
+    {
+        // Persistent targets may be presented or read in later frames, so passes writing to them are always used
+        vector<unsigned int> stack;
+        for (unsigned int i = 0, counti = passes.size(); i < counti; i++)
+        {
+            if (resources[passes[i].write].target != nullptr)
+            {
+                passes[i].used = true;
+                stack.push_back(i);
+            }
+        }
+
+        // Any pass writing a target read by a used pass is also used
+        while (!stack.empty())
+        {
+            unsigned int index = stack.back();
+            stack.pop_back();
+            for (unsigned int read : passes[index].reads)
+            {
+                for (unsigned int writer : resources[read].writers)
+                {
+                    if (!passes[writer].used)
+                    {
+                        passes[writer].used = true;
+                        stack.push_back(writer);
+                    }
+                }
+            }
+        }
+    }
+
+    RenderTexture* RenderGraph::AcquireBuffer(int width, int height)
+    {
+        for (TransientBuffer& buffer : buffers)
+        {
+            if (!buffer.inUse && buffer.texture->GetWidth() == width && buffer.texture->GetHeight() == height)
+            {
+                buffer.inUse = true;
+                buffer.usedThisFrame = true;
+                return buffer.texture;
+            }
+        }
+
+        TransientBuffer buffer;
+        buffer.texture = new RenderTexture();
+        if (!buffer.texture->Create(width, height))
+        {
+            delete buffer.texture;
+            return nullptr;
+        }
+        buffer.inUse = true;
+        buffer.usedThisFrame = true;
+        buffers.push_back(buffer);
+        return buffer.texture;
+    }
+
+    void RenderGraph::ReleaseBuffer(RenderTexture* texture)
+    {
+        for (TransientBuffer& buffer : buffers)
+        {
+            if (buffer.texture == texture)
+            {
+                buffer.inUse = false;
+                return;
+            }
+        }
+    }
+
+}
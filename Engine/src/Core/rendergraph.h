@@ -0,0 +1,171 @@
+#ifndef RENDERGRAPH_H
+#define RENDERGRAPH_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+extern "C"
+{
+    #include <SDL.h>
+}
+
+#include "bgfx/bgfx.h"
+#include "helpermacros.h"
+
+namespace Ossium
+{
+
+    class RenderInput;
+    class RenderTarget;
+    class RenderTexture;
+
+    // The render targets that a RenderInput reads and writes in a frame.
+    // Unless declared otherwise, an input writes to the target of the renderer and reads nothing.
+    class OSSIUM_EDL RenderPassTargets
+    {
+    public:
+        friend class RenderGraph;
+
+        // Declare that the input reads a target, so it is rendered after any inputs that write to the target.
+        void Read(RenderTarget* target);
+
+        // Declare that the input reads a transient target written by another input this frame.
+        void Read(const std::string& transient);
+
+        // Declare that the input renders to a target instead of the target of the renderer.
+        // Targets other than transient targets may be read in later frames, so inputs writing to them are never skipped.
+        void Write(RenderTarget* target);
+
+        // Declare that the input renders to a transient target. Transient targets only last for the frame
+        // and share frame buffers with transient targets of the same dimensions that aren't in use at the same time.
+        // The input is skipped if nothing reads the target.
+        void Write(const std::string& transient, int width, int height);
+
+    private:
+        // Persistent targets read
+        std::vector<RenderTarget*> reads;
+
+        // Transient targets read
+        std::vector<std::string> transientReads;
+
+        // The target written, or null when writing a transient target
+        RenderTarget* write = nullptr;
+
+        // The transient target written, if any
+        std::string transientWrite;
+        int transientWidth = 0;
+        int transientHeight = 0;
+
+    };
+
+    // Orders, culls and clears render passes according to the targets each RenderInput declares.
+    // Inputs that read a target are rendered after all inputs that write to it, otherwise inputs are rendered in the order they were added.
+    // Only the first input to write to a target each frame clears its colour; later inputs draw over the result and only clear depth.
+    class OSSIUM_EDL RenderGraph
+    {
+    public:
+        RenderGraph() = default;
+        ~RenderGraph();
+
+        // Renders the enabled inputs for the current frame.
+        // The main target and viewport are those of the renderer, which inputs write to by default.
+        // The views of the inputs must lie in the range of view ids reserved by the renderer,
+        // which is reordered to match the execution order. Views outside the range are left alone.
+        void Execute(std::vector<RenderInput*>& inputs, RenderTarget* mainTarget, SDL_Rect mainViewport, bgfx::ViewId firstView, Uint16 viewCount);
+
+        // Returns the frame buffer assigned to a transient target this frame, or null if there isn't one.
+        // Only valid while the inputs that write or read the target are rendering.
+        RenderTexture* GetTransient(const std::string& name);
+
+        // Returns the number of inputs skipped in the last frame because nothing read their output.
+        unsigned int GetSkippedCount();
+
+        // Returns the number of frame buffers allocated for transient targets.
+        unsigned int GetTransientBufferCount();
+
+    private:
+        NOCOPY(RenderGraph);
+
+        // A target used by at least one pass this frame
+        struct Resource
+        {
+            // The target, or null if transient
+            RenderTarget* target = nullptr;
+
+            // Transient target details
+            std::string name;
+            int width = 0;
+            int height = 0;
+
+            // Indices of the passes that write and read this target, in the order the inputs were added
+            std::vector<unsigned int> writers;
+            std::vector<unsigned int> readers;
+
+            // Execution positions of the first and last passes to use the target
+            int first = -1;
+            int last = -1;
+
+            // The frame buffer assigned to a transient target
+            RenderTexture* buffer = nullptr;
+
+            // Whether the colour has been cleared this frame
+            bool cleared = false;
+        };
+
+        // An enabled input
+        struct Pass
+        {
+            RenderInput* input;
+
+            // Resources read and the resource written
+            std::vector<unsigned int> reads;
+            unsigned int write;
+
+            // Whether anything uses the output of this pass
+            bool used = false;
+        };
+
+        // A frame buffer for transient targets
+        struct TransientBuffer
+        {
+            RenderTexture* texture;
+            bool inUse = false;
+            bool usedThisFrame = false;
+        };
+
+        // Returns the index of the resource for a target, adding it if necessary
+        unsigned int GetResource(RenderTarget* target);
+        unsigned int GetResource(const std::string& transient);
+
+        // Sorts passes so that readers follow writers, otherwise keeping the order inputs were added
+        void Sort();
+
+        // Marks passes whose output is used, starting from those writing persistent targets
+        void Cull();
+
+        // Assigns and frees transient frame buffers
+        RenderTexture* AcquireBuffer(int width, int height);
+        void ReleaseBuffer(RenderTexture* texture);
+
+        // Passes and resources for the current frame
+        std::vector<Pass> passes;
+        std::vector<Resource> resources;
+        std::unordered_map<RenderTarget*, unsigned int> persistentIds;
+        std::unordered_map<std::string, unsigned int> transientIds;
+
+        // Pass indices in execution order
+        std::vector<unsigned int> order;
+
+        // Frame buffers available for transient targets
+        std::vector<TransientBuffer> buffers;
+
+        unsigned int skipped = 0;
+
+        // Whether the passes had cyclic dependencies last frame
+        bool cyclic = false;
+
+    };
+
+}
+
+#endif // RENDERGRAPH_H
@@ -1,5 +1,6 @@
 #include "renderinput.h"
 #include "renderview.h"
+#include "renderer.h"
 
 namespace Ossium
 {
@@ -29,4 +30,13 @@ namespace Ossium
         return bgfx::ViewMode::Default;
     }
 
+    SDL_Color RenderInput::GetClearColor()
+    {
+        return renderer->GetBackgroundColor();
+    }
+
+    void RenderInput::DeclareTargets(RenderPassTargets& targets)
+    {
+    }
+
 }
@@ -2,6 +2,10 @@
 #define RENDERINPUT_H
 
 #include <string>
+extern "C"
+{
+    #include <SDL.h>
+}
 #include "bgfx/bgfx.h"
 #include "matrix.h"
 
@@ -11,6 +15,7 @@ namespace Ossium
     class RenderTarget;
     class Renderer;
     class RenderView;
+    class RenderPassTargets;
     
     // An abstract class that takes represents a render input such as a camera, GUI canvas,
     // or even a RenderTarget instance (e.g. for doing things like shadow mapping or deferred rendering)
@@ -18,6 +23,8 @@ namespace Ossium
     {
     public:
         friend class Renderer;
+        friend class RenderGraph;
+        friend class DebugDraw;
 
         // Should this input be rendered?
         virtual bool IsRenderEnabled();
@@ -35,6 +42,12 @@ namespace Ossium
         // Return the mode that determines draw call order, e.g. z-buffer depth or sequential rendering
         virtual bgfx::ViewMode::Enum GetViewMode();
 
+        // Return the colour the view is cleared to before rendering, defaults to the renderer background colour
+        virtual SDL_Color GetClearColor();
+
+        // Declare the render targets this input reads and writes, by default it writes to the target of the renderer
+        virtual void DeclareTargets(RenderPassTargets& targets);
+
         // Return the associated render view
         RenderView* GetRenderView();
 
@@ -0,0 +1,62 @@
+#include "rendertexture.h"
+#include "logging.h"
+
+namespace Ossium
+{
+
+    RenderTexture::~RenderTexture()
+    {
+        Destroy();
+    }
+
+    bool RenderTexture::Create(int width, int height)
+    {
+        Destroy();
+
+        widthGPU = width;
+        heightGPU = height;
+        frameBuffer = CreateFrameBuffer();
+        if (!bgfx::isValid(frameBuffer))
+        {
+            Log.Error("Failed to create {0}x{1} frame buffer for render texture.", width, height);
+            widthGPU = 0;
+            heightGPU = 0;
+            return false;
+        }
+
+        // The texture is owned by the frame buffer
+        texture = bgfx::getTexture(frameBuffer);
+        uniform = bgfx::createUniform("tex0", bgfx::UniformType::Sampler);
+        OnRenderTargetReset(*this);
+        return true;
+    }
+
+    void RenderTexture::Destroy()
+    {
+        // Don't let the image destroy the texture, as it's destroyed with the frame buffer
+        texture = BGFX_INVALID_HANDLE;
+        PopGPU();
+        if (bgfx::isValid(frameBuffer))
+        {
+            bgfx::destroy(frameBuffer);
+            frameBuffer = BGFX_INVALID_HANDLE;
+        }
+    }
+
+    int RenderTexture::GetWidth()
+    {
+        return widthGPU;
+    }
+
+    int RenderTexture::GetHeight()
+    {
+        return heightGPU;
+    }
+
+    bgfx::FrameBufferHandle RenderTexture::CreateFrameBuffer()
+    {
+        flags = BGFX_TEXTURE_RT | BGFX_SAMPLER_U_CLAMP | BGFX_SAMPLER_V_CLAMP;
+        return bgfx::createFrameBuffer((uint16_t)widthGPU, (uint16_t)heightGPU, bgfx::TextureFormat::RGBA8, flags);
+    }
+
+}
@@ -0,0 +1,39 @@
+#ifndef RENDERTEXTURE_H
+#define RENDERTEXTURE_H
+
+#include "image.h"
+#include "rendertarget.h"
+
+namespace Ossium
+{
+
+    // An offscreen render target whose colour buffer can be rendered like any other image.
+    class OSSIUM_EDL RenderTexture : public Image, public RenderTarget
+    {
+    public:
+        RenderTexture() = default;
+        ~RenderTexture();
+
+        // (Re)creates the frame buffer with the given dimensions in pixels. Returns false on failure.
+        bool Create(int width, int height);
+
+        // Destroys the frame buffer and texture.
+        void Destroy();
+
+        /// Returns the width of the texture.
+        int GetWidth();
+
+        /// Returns the height of the texture.
+        int GetHeight();
+
+    protected:
+        NOCOPY(RenderTexture);
+
+        // Creates a frame buffer with a single colour texture, using the current dimensions.
+        bgfx::FrameBufferHandle CreateFrameBuffer();
+
+    };
+
+}
+
+#endif // RENDERTEXTURE_H
@@ -53,29 +53,74 @@ namespace Ossium
         return name;
     }
 
-    RenderView* RenderViewPool::Create(SDL_Rect viewport, RenderTarget* target, std::string name) {
-        RenderView* created = new RenderView(this, views.size(), viewport, target, name);
-        views.push_back(created);
-        return created;
+    bool RenderViewPool::Reserve(Uint16 count, bgfx::ViewId& first)
+    {
+        // Take the first gap between reserved ranges that is large enough
+        Uint32 start = 0;
+        for (auto& itr : ranges)
+        {
+            if (itr.first >= start + count)
+            {
+                break;
+            }
+            start = itr.first + itr.second;
+        }
+        if (start + count > bgfx::getCaps()->limits.maxViews)
+        {
+            Log.Error("Failed to reserve {0} render views, only {1} views are available.", count, bgfx::getCaps()->limits.maxViews);
+            return false;
+        }
+        first = (bgfx::ViewId)start;
+        ranges[first] = count;
+        if (views.size() < start + count)
+        {
+            views.resize(start + count, nullptr);
+        }
+        return true;
+    }
+
+    void RenderViewPool::Release(bgfx::ViewId first)
+    {
+        auto itr = ranges.find(first);
+        if (itr == ranges.end())
+        {
+            return;
+        }
+        for (unsigned int i = first, counti = first + itr->second; i < counti; i++)
+        {
+            if (views[i] != nullptr)
+            {
+                Free(i);
+            }
+        }
+        ranges.erase(itr);
+    }
+
+    RenderView* RenderViewPool::Create(bgfx::ViewId first, SDL_Rect viewport, RenderTarget* target, std::string name)
+    {
+        auto itr = ranges.find(first);
+        DEBUG_ASSERT(itr != ranges.end(), "RenderView range " + Utilities::ToString((int)first) + " was not reserved");
+        for (unsigned int i = first, counti = first + itr->second; i < counti; i++)
+        {
+            if (views[i] == nullptr)
+            {
+                views[i] = new RenderView(this, i, viewport, target, name);
+                return views[i];
+            }
+        }
+        return nullptr;
     }
 
     void RenderViewPool::Free(bgfx::ViewId id)
     {
-        DEBUG_ASSERT(id < views.size() && id >= 0, "RenderView id " + Utilities::ToString((int)id) + " out of range");
+        DEBUG_ASSERT(id < views.size() && views[id] != nullptr, "RenderView id " + Utilities::ToString((int)id) + " is not in use");
         
-        // Destroy the view
+        // Destroy the view. Ids don't change, so the views of other renderers stay in their ranges.
         delete views[id];
-        
-        // Shift pointers and ids down to maintain contiguous view order
-        for (unsigned int i = id, counti = views.size() - 1; i < counti; i++)
-        {
-            views[i] = views[i + 1];
-            // TODO refresh view?
-            views[i]->id = i;
-        }
+        views[id] = nullptr;
 
-        // Remove the (now unused) last element
-        views.pop_back();
+        // Reset the view so the id can be reused by another input
+        bgfx::resetView(id);
     }
 
     void RenderViewPool::Free(RenderView* view)
@@ -5,6 +5,7 @@
 #include <string>
 #include <stack>
 #include <vector>
+#include <map>
 #include "bgfx/bgfx.h"
 
 #include "helpermacros.h"
@@ -73,14 +74,23 @@ namespace Ossium
 
     };
 
-    // Used to create RenderView instances
+    // Used to create RenderView instances.
+    // Each renderer reserves a contiguous range of view ids, so it can reorder its own views without affecting other renderers.
     class RenderViewPool
     {
     private:
         friend class Renderer;
 
-        // Create a render view in first-come-first-serve order
+        // Reserve a contiguous range of view ids. Returns false if there aren't enough free ids.
+        bool Reserve(Uint16 count, bgfx::ViewId& first);
+
+        // Free a range of view ids reserved by Reserve(), along with any views still using them.
+        void Release(bgfx::ViewId first);
+
+        // Create a render view using the first free id in the range that starts at first.
+        // Returns nullptr if every id in the range is in use.
         RenderView* Create(
+            bgfx::ViewId first,
             SDL_Rect viewport,
             RenderTarget* target,
             std::string name = "RenderView"
@@ -95,9 +105,12 @@ namespace Ossium
         // Get a render view by id
         RenderView* Get(bgfx::ViewId id);
         
-        // Array of all render view instances
+        // Render view instances by id, null where the id is free
         std::vector<RenderView*> views;
 
+        // The number of ids in each reserved range, by first id
+        std::map<bgfx::ViewId, Uint16> ranges;
+
     };
 
 }
@@ -0,0 +1,82 @@
+/** COPYRIGHT NOTICE
+ *
+ *  Ossium Engine
+ *  Copyright (c) 2018-2020 Tim Lane
+ *
+ *  This software is provided 'as-is', without any express or implied warranty. In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+ *
+ *  2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+ *
+ *  3. This notice may not be removed or altered from any source distribution.
+ *
+**/
+#include <cstdio>
+#include <filesystem>
+
+#include "scenesnapshot.h"
+#include "jsondata.h"
+#include "stringconvert.h"
+#include "logging.h"
+
+using namespace std;
+
+namespace Ossium
+{
+
+    string SceneSnapshot::ToString() const
+    {
+        JSON serialised;
+        for (auto& entity : entities)
+        {
+            serialised[Utilities::ToString(entity.first)] = *entity.second;
+        }
+        return serialised.ToString();
+    }
+
+    bool SceneSnapshot::Save(const string& path) const
+    {
+        string data = ToString();
+
+        // Write to a temporary file first so a failed save doesn't destroy the previous one
+        string temporary = path + ".tmp";
+        SDL_RWops* file = SDL_RWFromFile(temporary.c_str(), "wb");
+        if (file == NULL)
+        {
+            Log.Error("Failed to save scene to '{0}': {1}", path, SDL_GetError());
+            return false;
+        }
+        bool written = SDL_RWwrite(file, data.data(), sizeof(char), data.length()) == data.length();
+        written = SDL_RWclose(file) == 0 && written;
+        if (!written)
+        {
+            Log.Error("Failed to save scene to '{0}': {1}", path, SDL_GetError());
+            remove(temporary.c_str());
+            return false;
+        }
+
+        error_code error;
+        filesystem::rename(temporary, path, error);
+        if (error)
+        {
+            Log.Error("Failed to save scene to '{0}', could not replace the file: {1}", path, error.message());
+            remove(temporary.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    unsigned int SceneSnapshot::GetTotalEntities() const
+    {
+        return entities.size();
+    }
+
+    Uint64 SceneSnapshot::GetHash() const
+    {
+        return hash;
+    }
+
+}
@@ -0,0 +1,66 @@
+/** COPYRIGHT NOTICE
+ *
+ *  Ossium Engine
+ *  Copyright (c) 2018-2020 Tim Lane
+ *
+ *  This software is provided 'as-is', without any express or implied warranty. In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+ *
+ *  2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+ *
+ *  3. This notice may not be removed or altered from any source distribution.
+ *
+**/
+#ifndef SCENESNAPSHOT_H
+#define SCENESNAPSHOT_H
+
+#include <memory>
+#include <string>
+#include <vector>
+extern "C"
+{
+    #include <SDL.h>
+}
+
+#include "helpermacros.h"
+
+namespace Ossium
+{
+
+    /// An immutable copy of the serialised state of a scene, which can be saved from any thread.
+    /** Snapshots are created by Scene::Snapshot(). Entities that are unchanged between snapshots share their serialised data,
+     *  so keeping several snapshots around costs little more than keeping one. */
+    class OSSIUM_EDL SceneSnapshot
+    {
+    public:
+        /// Returns the scene data in the same format as Scene::ToString().
+        std::string ToString() const;
+
+        /// Writes the scene data to a file. The file is only replaced once the data has been fully written,
+        /// so an existing file is left intact if saving fails.
+        bool Save(const std::string& path) const;
+
+        /// Returns the number of entities in the snapshot.
+        unsigned int GetTotalEntities() const;
+
+        /// Returns a hash of the serialised state. Snapshots of a scene with the same hash have the same data,
+        /// so comparing hashes shows whether the scene has changed without comparing the data.
+        Uint64 GetHash() const;
+
+    private:
+        friend class Scene;
+
+        /// Serialised entities by id, in the order they are serialised by Scene::ToString().
+        std::vector<std::pair<int, std::shared_ptr<const std::string>>> entities;
+
+        /// Hash of the ids and hashes of the entities, in order.
+        Uint64 hash = 0;
+
+    };
+
+}
+
+#endif // SCENESNAPSHOT_H
@@ -55,6 +55,7 @@ namespace Ossium
                                       std::function<bool(void*, const char*, std::string)> lambdaFromString,
                                       std::function<std::string(void*, const char*)> lambdaToString,
                                       std::function<std::string(Serializer*, const char*, const char*, int, void*)> lambdaSerializeProperty,
+                                      std::function<Uint64(void*)> lambdaHash,
                                       const char* ultimate_name)
         {
 #ifdef OSSIUM_DEBUG
@@ -68,6 +69,7 @@ namespace Ossium
             member_from_string[count] = lambdaFromString;
             member_to_string[count] = lambdaToString;
             member_serializer[count] = lambdaSerializeProperty;
+            member_hash[count] = lambdaHash;
             schema_name = ultimate_name;
             count++;
             return count - 1;
@@ -183,8 +185,9 @@ namespace Ossium
             }
         }
 
-        /// Sets the values of all members in the local schema hierarchy using a JSON object representation of the schema
-        void SerialiseIn(JSON& data)
+        /// Sets the values of all members in the local schema hierarchy using a JSON object representation of the schema.
+        /// Partial data only sets the members it contains, so missing members aren't logged.
+        void SerialiseIn(JSON& data, bool partial = false)
         {
             for (unsigned int i = 0; i < count; i++)
             {
@@ -198,7 +201,7 @@ namespace Ossium
                         Log.Warning("Failed to serialise member '{0}' of type '{1}'.", member_names[i], member_types[i]);
                     }
                 }
-                else
+                else if (!partial)
                 {
                     // Could not find the data member.
                     Log.Verbose("Could not find member '{0}' of type '{1}' in provided JSON data during serialisation.", member_names[i], member_types[i]);
@@ -206,6 +209,16 @@ namespace Ossium
             }
         }
 
+        /// Appends a hash of the value of each member in the local schema hierarchy, in the same order as SerialiseOut().
+        /// Comparing hashes from different calls shows which members have changed without converting them to strings.
+        void HashMembers(std::vector<Uint64>& hashes)
+        {
+            for (unsigned int i = 0; i < count; i++)
+            {
+                hashes.push_back(member_hash[i](GetMember(i)));
+            }
+        }
+
         /// Returns the ultimate name of this schema
         static const char* GetSchemaName()
         {
@@ -224,6 +237,7 @@ namespace Ossium
         static std::function<bool(void*, const char*, std::string)> member_from_string[MaximumMembers];
         static std::function<std::string(void*, const char*)> member_to_string[MaximumMembers];
         static std::function<std::string(Serializer*, const char*, const char*, int, void*)> member_serializer[MaximumMembers];
+        static std::function<Uint64(void*)> member_hash[MaximumMembers];
         /// Array of associated user attributes for each schema member
         static int member_attributes[MaximumMembers];
         /// Array of names for each schema member
@@ -246,6 +260,9 @@ namespace Ossium
     template<class BaseType, unsigned int MaximumMembers, class BaseSerializer>
     std::function<std::string(BaseSerializer*, const char*, const char*, int, void*)> Schema<BaseType, MaximumMembers, BaseSerializer>::member_serializer[MaximumMembers];
 
+    template<class BaseType, unsigned int MaximumMembers, class BaseSerializer>
+    std::function<Uint64(void*)> Schema<BaseType, MaximumMembers, BaseSerializer>::member_hash[MaximumMembers];
+
     template<class BaseType, unsigned int MaximumMembers, class BaseSerializer>
     int Schema<BaseType, MaximumMembers, BaseSerializer>::member_attributes[MaximumMembers];
 
@@ -295,7 +312,11 @@ namespace Ossium
         {
         }
 
-        static void SerialiseIn(JSON& data)
+        static void SerialiseIn(JSON& data, bool partial = false)
+        {
+        }
+
+        static void HashMembers(std::vector<Uint64>& hashes)
         {
         }
 
@@ -323,12 +344,13 @@ namespace Ossium
             std::function<bool(void*, const char*, std::string)> lambdaFromString,
             std::function<std::string(void*, const char*)> lambdaToString,
             std::function<std::string(typename SchemaType::Serializer*, const char*, const char*, int, void*)> lambdaSerializeProperty,
+            std::function<Uint64(void*)> lambdaHash,
             const char* ultimate_name,
             size_t member_offset,
             int mem_attribute
         ) {
             ++m_count;
-            index = SchemaType::AddMember(strType::str, strName::str, member_offset, mem_attribute, lambdaFromString, lambdaToString, lambdaSerializeProperty, ultimate_name);
+            index = SchemaType::AddMember(strType::str, strName::str, member_offset, mem_attribute, lambdaFromString, lambdaToString, lambdaSerializeProperty, lambdaHash, ultimate_name);
         }
 
         inline static const char* type = strType::str;
@@ -489,6 +511,12 @@ namespace Ossium
         return serializer->SerializeProperty(type, name, attribute, *reinterpret_cast<TYPE*>(member));          \
     }
 
+    #define MEMBER_HASH(TYPE)                                                                                   \
+    [](void* member)                                                                                            \
+    {                                                                                                           \
+        return Utilities::HashValue(*reinterpret_cast<TYPE*>(member));                                          \
+    }
+
     /// This uses the wonderful Construct On First Use idiom to ensure that the order of the members is always base class, then derived class
     /// Also checks if the type is a pointer. If so, it gets the custom TO_STRING and FROM_STRING macros.
     /// TODO: MemberInfo should take another lambda for custom properties, that accepts a CustomSerializer instance (e.g. EditorSerializer) and returns a string.
@@ -498,11 +526,11 @@ namespace Ossium
             {                                                                                                                                                           \
                 static MemberInfo<BaseSchemaType, TYPE , SID(#TYPE ), SID(#NAME ) >* initialised_info = std::is_pointer<TYPE>::value ?                                  \
                     new MemberInfo<BaseSchemaType, TYPE , SID(#TYPE ), SID(#NAME ) >(schema_local_count,                                                                \
-                                    REFPTR_FROM_STRING( TYPE ), REFPTR_TO_STRING( TYPE ), CUSTOM_MEMBER_SERIALIZER( TYPE ),                                             \
+                                    REFPTR_FROM_STRING( TYPE ), REFPTR_TO_STRING( TYPE ), CUSTOM_MEMBER_SERIALIZER( TYPE ), MEMBER_HASH( TYPE ),                        \
                                     schema_local_typename, (size_t)((void*)&schema_layout_ref->NAME), ATTRIBUTE)                                                        \
                     :                                                                                                                                                   \
                     new MemberInfo<BaseSchemaType, TYPE , SID(#TYPE ), SID(#NAME ) >(schema_local_count,                                                                \
-                                    MEMBER_FROM_STRING( TYPE ), MEMBER_TO_STRING( TYPE ), CUSTOM_MEMBER_SERIALIZER( TYPE ),                                             \
+                                    MEMBER_FROM_STRING( TYPE ), MEMBER_TO_STRING( TYPE ), CUSTOM_MEMBER_SERIALIZER( TYPE ), MEMBER_HASH( TYPE ),                        \
                                     schema_local_typename, (size_t)((void*)&schema_layout_ref->NAME), ATTRIBUTE);                                                       \
                 return *initialised_info;                                                                                                                               \
             }                                                                                                                                                           \
@@ -547,16 +575,21 @@ namespace Ossium
                 }                                                                                       \
                 return BASETYPE::GetMember(index);                                                      \
             }                                                                                           \
-            virtual void SerialiseIn(JSON& data)                                                        \
+            virtual void SerialiseIn(JSON& data, bool partial = false)                                  \
             {                                                                                           \
-                SCHEMA_TYPE::SerialiseIn(data);                                                         \
-                BASETYPE::SerialiseIn(data);                                                            \
+                SCHEMA_TYPE::SerialiseIn(data, partial);                                                \
+                BASETYPE::SerialiseIn(data, partial);                                                   \
             }                                                                                           \
             virtual void SerialiseOut(JSON& data, EditorSerializer* serializer = nullptr)               \
             {                                                                                           \
                 BASETYPE::SerialiseOut(data, serializer);                                               \
                 SCHEMA_TYPE::SerialiseOut(data, serializer);                                            \
             }                                                                                           \
+            virtual void HashMembers(std::vector<Uint64>& hashes)                                       \
+            {                                                                                           \
+                BASETYPE::HashMembers(hashes);                                                          \
+                SCHEMA_TYPE::HashMembers(hashes);                                                       \
+            }                                                                                           \
             virtual std::string ToString()                                                              \
             {                                                                                           \
                 JSON data;                                                                              \
@@ -38,6 +38,11 @@ namespace Ossium
             {
             }
 
+            /// Called before each fixed timestep update, which may happen any number of times per frame.
+            virtual void FixedUpdate()
+            {
+            }
+
             /// Called after rendering.
             virtual void PostRender()
             {
@@ -106,6 +111,18 @@ namespace Ossium
             }
         }
 
+        /// Call this just before each fixed timestep update.
+        void FixedUpdate()
+        {
+            for (unsigned int i = 0, counti = TypeSystem::TypeRegistry<Internal::ServiceBase>::GetTotalTypes(); i < counti; i++)
+            {
+                if (services[i] != nullptr)
+                {
+                    services[i]->FixedUpdate();
+                }
+            }
+        }
+
         /// Call this at the end of a frame after rendering.
         void PostRender()
         {
@@ -0,0 +1,139 @@
+/** COPYRIGHT NOTICE
+ *
+ *  Ossium Engine
+ *  Copyright (c) 2018-2020 Tim Lane
+ *
+ *  This software is provided 'as-is', without any express or implied warranty. In no event will the authors be held liable for any damages arising from the use of this software.
+ *
+ *  Permission is granted to anyone to use this software for any purpose, including commercial applications, and to alter it and redistribute it freely, subject to the following restrictions:
+ *
+ *  1. The origin of this software must not be misrepresented; you must not claim that you wrote the original software. If you use this software in a product, an acknowledgment in the product documentation would be appreciated but is not required.
+ *
+ *  2. Altered source versions must be plainly marked as such, and must not be misrepresented as being the original software.
+ *
+ *  3. This notice may not be removed or altered from any source distribution.
+ *
+**/
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <vector>
+#include <atomic>
+
+namespace Ossium
+{
+
+    /// Bounded lock-free queue for passing values from exactly one producer thread to exactly one consumer thread.
+    /** Push() must only be called by the producer and Pop() only by the consumer. Neither method allocates memory. */
+    template<typename T>
+    class SPSCQueue
+    {
+    public:
+        SPSCQueue(unsigned int capacity = 0)
+        {
+            SetCapacity(capacity);
+        }
+
+        /// Sets the maximum number of values the queue can hold, rounded up to a power of two. This clears the queue.
+        /// Not thread safe; only call this while neither the producer nor the consumer is using the queue.
+        void SetCapacity(unsigned int capacity)
+        {
+            unsigned int size = 1;
+            while (size < capacity)
+            {
+                size <<= 1;
+            }
+            buffer.assign(capacity > 0 ? size : 0, T());
+            mask = size - 1;
+            head.store(0, std::memory_order_relaxed);
+            tail.store(0, std::memory_order_relaxed);
+        }
+
+        /// Returns the maximum number of values the queue can hold.
+        unsigned int GetCapacity()
+        {
+            return buffer.empty() ? 0 : buffer.size();
+        }
+
+        /// Adds a value to the back of the queue. Returns false if the queue is full.
+        bool Push(const T& value)
+        {
+            unsigned int back = tail.load(std::memory_order_relaxed);
+            if (back - head.load(std::memory_order_acquire) >= GetCapacity())
+            {
+                return false;
+            }
+            buffer[back & mask] = value;
+            tail.store(back + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// Removes the value at the front of the queue. Returns false if the queue is empty.
+        bool Pop(T& value)
+        {
+            unsigned int front = head.load(std::memory_order_relaxed);
+            if (front == tail.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+            value = buffer[front & mask];
+            head.store(front + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// Adds as many of the values as will fit to the back of the queue, returning the number added.
+        unsigned int PushRange(const T* values, unsigned int count)
+        {
+            unsigned int back = tail.load(std::memory_order_relaxed);
+            unsigned int space = GetCapacity() - (back - head.load(std::memory_order_acquire));
+            count = count < space ? count : space;
+            for (unsigned int i = 0; i < count; i++)
+            {
+                buffer[(back + i) & mask] = values[i];
+            }
+            tail.store(back + count, std::memory_order_release);
+            return count;
+        }
+
+        /// Removes up to count values from the front of the queue, returning the number removed.
+        /// If values is null, the removed values are discarded.
+        unsigned int PopRange(T* values, unsigned int count)
+        {
+            unsigned int front = head.load(std::memory_order_relaxed);
+            unsigned int available = tail.load(std::memory_order_acquire) - front;
+            count = count < available ? count : available;
+            if (values != nullptr)
+            {
+                for (unsigned int i = 0; i < count; i++)
+                {
+                    values[i] = buffer[(front + i) & mask];
+                }
+            }
+            head.store(front + count, std::memory_order_release);
+            return count;
+        }
+
+        /// Returns the number of values in the queue. Only exact when called from the producer or consumer with the other thread idle.
+        unsigned int Size()
+        {
+            return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+        }
+
+    private:
+        /// Ring buffer of values, sized to a power of two.
+        std::vector<T> buffer;
+
+        /// Bit mask for wrapping indices into the buffer.
+        unsigned int mask = 0;
+
+        /// Total number of values popped; only written by the consumer.
+        std::atomic<unsigned int> head = {0};
+
+        /// Total number of values pushed; only written by the producer.
+        std::atomic<unsigned int> tail = {0};
+
+    };
+
+}
+
+#endif // SPSCQUEUE_H
@@ -17,7 +17,9 @@
 #ifndef STRINGCONVERT_H
 #define STRINGCONVERT_H
 
+#include <charconv>
 #include <utility>
+#include <type_traits>
 
 extern "C"
 {
@@ -327,73 +329,312 @@ namespace Ossium
             return converted;
         }
 
-        /// Format a string with a list of arguments of various types
-        template<typename ...Args>
-        std::string Format(std::string text, Args&&... args)
+        /// A format string for Format(), split into literal text and {N} argument placeholders.
+        /** String literals are parsed by the constexpr constructor, so declaring a format string constexpr parses it at compile time,
+         *  and the optimiser can usually do the same for literals passed straight to Format(). Strings with more placeholders than
+         *  MaxSegments carry on being parsed as they are formatted. The FormatString only points to the text, so the text must outlive it. */
+        class FormatString
         {
-            /// Convert arguments to strings
-            std::vector<std::string> arguments = ToStrings(std::forward<Args>(args)...);
+        public:
+            /// A run of literal text, followed by an argument unless argument is negative.
+            struct Segment
+            {
+                unsigned int start = 0;
+                unsigned int length = 0;
+                int argument = -1;
+            };
+
+            static constexpr unsigned int MaxSegments = 8;
+
+            constexpr FormatString(const char* text) : text(text), length(Length(text))
+            {
+                Parse();
+            }
+
+            FormatString(const std::string& text) : text(text.c_str()), length((unsigned int)text.length())
+            {
+                Parse();
+            }
 
-            if (arguments.empty())
+            constexpr const char* GetText() const
             {
-                /// Early out if no arguments
                 return text;
             }
 
-            char previous = '\0';
-            bool formatting = false;
-            std::string formatted = "";
-            std::string parsing = "";
-            for (auto ch : text)
+            constexpr unsigned int GetLength() const
+            {
+                return length;
+            }
+
+            constexpr unsigned int GetSegmentCount() const
+            {
+                return count;
+            }
+
+            constexpr const Segment& GetSegment(unsigned int index) const
             {
-                if (!formatting)
+                return segments[index];
+            }
+
+            /// Returns the position in the text after the last parsed segment. If this is less than the length,
+            /// the rest of the text must be parsed with ParseSegment().
+            constexpr unsigned int GetParsedLength() const
+            {
+                return parsed;
+            }
+
+            /// Parses the segment at the position in the text, returning the position after it.
+            /// Literal text is copied up to an unescaped '{'. The digits up to the following '}' are the argument index;
+            /// anything else between the braces, or a '{' with no closing '}', produces no output.
+            constexpr unsigned int ParseSegment(unsigned int position, Segment& segment) const
+            {
+                segment.start = position;
+                segment.argument = -1;
+                while (position < length && (text[position] != '{' || (position > 0 && text[position - 1] == '\\')))
                 {
-                    if (ch == '{' && previous != '\\')
-                    {
-                        formatting = true;
-                    }
-                    else
-                    {
-                        formatted += ch;
-                    }
+                    position++;
                 }
-                else
+                segment.length = position - segment.start;
+                if (position < length)
                 {
-                    if (ch == '}')
+                    /// Skip the opening brace and read the argument index
+                    position++;
+                    int index = 0;
+                    bool valid = position < length && text[position] != '}';
+                    while (position < length && text[position] != '}')
                     {
-                        /// Get the argument index
-                        if (IsInt(parsing))
+                        if (text[position] >= '0' && text[position] <= '9' && index < 100000)
                         {
-                            int index = -1;
-                            FromString(index, parsing);
-                            if (index < 0 || (unsigned int)index >= arguments.size())
-                            {
-                                /// TODO: Log "invalid format argument index".
-                            }
-                            else
-                            {
-                                /// Append the argument
-                                formatted += arguments[(unsigned int)index];
-                            }
+                            index = index * 10 + (text[position] - '0');
                         }
                         else
                         {
-                            /// TODO: Log "invalid formatting argument".
+                            valid = false;
                         }
-                        formatting = false;
-                        parsing = "";
+                        position++;
+                    }
+                    if (position < length)
+                    {
+                        segment.argument = valid ? index : -1;
+                        position++;
+                    }
+                }
+                return position;
+            }
+
+        private:
+            static constexpr unsigned int Length(const char* text)
+            {
+                unsigned int length = 0;
+                while (text[length] != '\0')
+                {
+                    length++;
+                }
+                return length;
+            }
+
+            constexpr void Parse()
+            {
+                while (parsed < length && count < MaxSegments)
+                {
+                    parsed = ParseSegment(parsed, segments[count]);
+                    count++;
+                }
+            }
+
+            const char* text;
+            unsigned int length;
+            Segment segments[MaxSegments] = {};
+            unsigned int count = 0;
+            unsigned int parsed = 0;
+
+        };
+
+        namespace Internal
+        {
+
+            /// Appends an argument to a formatted string. Numbers are written with std::to_chars, strings are appended directly
+            /// and anything else is converted with ToString().
+            template<typename T>
+            void AppendFormatValue(std::string& output, T& value)
+            {
+                typedef typename std::decay<T>::type Type;
+                if constexpr (std::is_same<Type, bool>::value)
+                {
+                    output += value ? '1' : '0';
+                }
+                else if constexpr (std::is_same<Type, char>::value || std::is_same<Type, signed char>::value || std::is_same<Type, unsigned char>::value)
+                {
+                    /// Written as characters, as with stream insertion (so Uint8 and Sint8 values are too)
+                    output += (char)value;
+                }
+                else if constexpr (std::is_integral<Type>::value || std::is_floating_point<Type>::value)
+                {
+                    char buffer[64];
+                    std::to_chars_result result;
+                    if constexpr (std::is_floating_point<Type>::value)
+                    {
+                        /// Same output as stream insertion, i.e. %g with 6 significant figures
+                        result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::general, 6);
                     }
                     else
                     {
-                        parsing += ch;
+                        result = std::to_chars(buffer, buffer + sizeof(buffer), value);
                     }
+                    output.append(buffer, result.ptr - buffer);
+                }
+                else if constexpr (std::is_same<Type, const char*>::value || std::is_same<Type, char*>::value)
+                {
+                    output += value;
+                }
+                else if constexpr (std::is_base_of<std::string, Type>::value)
+                {
+                    output += value;
+                }
+                else
+                {
+                    output += ToString(value);
                 }
-                previous = ch;
             }
 
+            /// Base case, index out of range.
+            inline void AppendFormatArgument(std::string& output, unsigned int index)
+            {
+            }
+
+            /// Appends the argument at the index.
+            template<typename T, typename ...Args>
+            void AppendFormatArgument(std::string& output, unsigned int index, T&& value, Args&&... args)
+            {
+                if (index == 0)
+                {
+                    AppendFormatValue(output, value);
+                }
+                else
+                {
+                    AppendFormatArgument(output, index - 1, args...);
+                }
+            }
+
+            /// Appends a segment of a format string and its argument.
+            template<typename ...Args>
+            void AppendFormatSegment(std::string& output, const FormatString& format, const FormatString::Segment& segment, Args&&... args)
+            {
+                output.append(format.GetText() + segment.start, segment.length);
+                if (segment.argument >= 0)
+                {
+                    AppendFormatArgument(output, (unsigned int)segment.argument, args...);
+                }
+            }
+
+        }
+
+        /// Formats a string with a list of arguments of various types, appending the result to output.
+        /// Only allocates if output doesn't have the capacity for the result, or an argument isn't a number or a string,
+        /// so reusing the same output string avoids allocating altogether.
+        template<typename ...Args>
+        void FormatTo(std::string& output, const FormatString& format, Args&&... args)
+        {
+            if constexpr (sizeof...(Args) == 0)
+            {
+                /// No arguments, placeholders are left as they are
+                output.append(format.GetText(), format.GetLength());
+            }
+            else
+            {
+                for (unsigned int i = 0, counti = format.GetSegmentCount(); i < counti; i++)
+                {
+                    Internal::AppendFormatSegment(output, format, format.GetSegment(i), args...);
+                }
+                FormatString::Segment segment;
+                for (unsigned int position = format.GetParsedLength(); position < format.GetLength();)
+                {
+                    position = format.ParseSegment(position, segment);
+                    Internal::AppendFormatSegment(output, format, segment, args...);
+                }
+            }
+        }
+
+        /// Format a string with a list of arguments of various types
+        template<typename ...Args>
+        std::string Format(const FormatString& format, Args&&... args)
+        {
+            std::string formatted;
+            formatted.reserve(format.GetLength() + 16 * sizeof...(Args));
+            FormatTo(formatted, format, std::forward<Args>(args)...);
             return formatted;
         }
 
+        ///
+        /// Hashing functions, for detecting changes to values without comparing them as strings
+        ///
+
+        /// Hashes raw bytes with 64-bit FNV-1a. Pass the result of a previous call as the hash to combine hashes.
+        inline Uint64 HashBytes(const void* data, size_t length, Uint64 hash = 14695981039346656037ULL)
+        {
+            const Uint8* bytes = (const Uint8*)data;
+            for (size_t i = 0; i < length; i++)
+            {
+                hash = (hash ^ bytes[i]) * 1099511628211ULL;
+            }
+            return hash;
+        }
+
+        /// Is the type made of nothing but a float array, as vectors and matrices are?
+        template<typename T, typename = void>
+        struct IsFloatArray : std::false_type {};
+
+        template<typename T>
+        struct IsFloatArray<T, std::void_t<decltype(std::declval<T&>().data)>> : std::bool_constant<
+            std::is_array<decltype(T::data)>::value &&
+            std::is_same<typename std::remove_all_extents<decltype(T::data)>::type, float>::value &&
+            sizeof(T::data) == sizeof(T)
+        > {};
+
+        /// Hashes a float by value, so zeros of either sign hash the same.
+        inline Uint64 HashFloat(float value, Uint64 hash = 14695981039346656037ULL)
+        {
+            value = value == 0.0f ? 0.0f : value;
+            return HashBytes(&value, sizeof(float), hash);
+        }
+
+        /// Hashes a value. Strings hash their characters, scalars and types without padding hash their bytes,
+        /// and vectors and matrices hash each float. Anything else may have padding bytes with arbitrary values,
+        /// so it is converted with ToString() first, which makes hashing it no cheaper than converting it.
+        template<typename T>
+        Uint64 HashValue(T& value)
+        {
+            if constexpr (std::is_base_of<std::string, T>::value)
+            {
+                return HashBytes(value.data(), value.length());
+            }
+            else if constexpr (std::is_floating_point<T>::value)
+            {
+                // Zeros of either sign compare equal
+                T normalised = value == 0 ? 0 : value;
+                return HashBytes(&normalised, sizeof(T));
+            }
+            else if constexpr (std::is_scalar<T>::value || std::has_unique_object_representations<T>::value)
+            {
+                return HashBytes(&value, sizeof(T));
+            }
+            else if constexpr (IsFloatArray<T>::value)
+            {
+                Uint64 hash = 14695981039346656037ULL;
+                const float* elements = (const float*)&value.data;
+                for (unsigned int i = 0, counti = sizeof(T) / sizeof(float); i < counti; i++)
+                {
+                    hash = HashFloat(elements[i], hash);
+                }
+                return hash;
+            }
+            else
+            {
+                std::string converted = ToString(value);
+                return HashBytes(converted.data(), converted.length());
+            }
+        }
+
     }
 
 }
@@ -23,6 +23,21 @@ namespace Ossium
 
     REGISTER_COMPONENT(Transform);
 
+    vector<Transform*> Transform::interpolatedTransforms;
+
+    void Transform::OnDestroy()
+    {
+        SetInterpolated(false);
+        BaseComponent::OnDestroy();
+    }
+
+    void Transform::OnClone(BaseComponent* src)
+    {
+        // The copy isn't registered yet.
+        interpolated = false;
+        SetInterpolated(((Transform*)src)->interpolated);
+    }
+
     void Transform::SetRelativeToParent(bool setRelative)
     {
         if (relative != setRelative)
@@ -82,6 +97,77 @@ namespace Ossium
         dirty = true;
     }
 
+    void Transform::SetInterpolated(bool interpolate)
+    {
+        if (interpolate == interpolated)
+        {
+            return;
+        }
+        interpolated = interpolate;
+        if (interpolate)
+        {
+            previousPosition = position;
+            previousScale = scale;
+            interpolatedTransforms.push_back(this);
+        }
+        else
+        {
+            for (unsigned int i = 0, counti = interpolatedTransforms.size(); i < counti; i++)
+            {
+                if (interpolatedTransforms[i] == this)
+                {
+                    interpolatedTransforms[i] = interpolatedTransforms.back();
+                    interpolatedTransforms.pop_back();
+                    break;
+                }
+            }
+        }
+    }
+
+    bool Transform::IsInterpolated()
+    {
+        return interpolated;
+    }
+
+    void Transform::SaveInterpolationState()
+    {
+        for (Transform* t : interpolatedTransforms)
+        {
+            t->previousPosition = t->position;
+            t->previousScale = t->scale;
+        }
+    }
+
+    void Transform::BeginInterpolation(float alpha)
+    {
+        for (Transform* t : interpolatedTransforms)
+        {
+            t->currentPosition = t->position;
+            t->currentScale = t->scale;
+            // Transforms that didn't move in the last fixed update are already in the right place
+            t->moving = t->previousPosition != t->currentPosition || t->previousScale != t->currentScale;
+            if (t->moving)
+            {
+                t->position = t->previousPosition + ((Vector3)(t->currentPosition - t->previousPosition) * alpha);
+                t->scale = t->previousScale + ((Vector3)(t->currentScale - t->previousScale) * alpha);
+                t->dirty = true;
+            }
+        }
+    }
+
+    void Transform::EndInterpolation()
+    {
+        for (Transform* t : interpolatedTransforms)
+        {
+            if (t->moving)
+            {
+                t->position = t->currentPosition;
+                t->scale = t->currentScale;
+                t->dirty = true;
+            }
+        }
+    }
+
     Matrix<4, 4> Transform::GetMatrix()
     {
         Entity* parent = entity->GetParent();
@@ -52,6 +52,23 @@ namespace Ossium
         /// Has this transform or it's parent hierarchy been modified?
         bool dirty = true;
 
+        /// Is this transform interpolated between fixed updates when rendering?
+        bool interpolated = false;
+
+        /// Local position and scale saved before the last fixed update.
+        Vector3 previousPosition;
+        Vector3 previousScale;
+
+        /// Local position and scale while rendering an interpolated state.
+        Vector3 currentPosition;
+        Vector3 currentScale;
+
+        /// Did this transform move in the last fixed update? Only moving transforms are interpolated.
+        bool moving = false;
+
+        /// All interpolated transforms.
+        static std::vector<Transform*> interpolatedTransforms;
+
     public:
         DECLARE_COMPONENT(BaseComponent, Transform);
         CONSTRUCT_SCHEMA(BaseComponent, TransformSchema);
@@ -86,6 +103,27 @@ namespace Ossium
         // Return the matrix representing this transform in world space
         Matrix<4, 4> GetMatrix();
 
+        // Set whether the local position and scale are interpolated between fixed updates when rendering.
+        // Enable this for transforms moved in FixedUpdate() so they move smoothly at any frame rate.
+        void SetInterpolated(bool interpolate);
+
+        // Is this transform interpolated between fixed updates?
+        bool IsInterpolated();
+
+        // Saves the state of all interpolated transforms. Called before each fixed update.
+        static void SaveInterpolationState();
+
+        // Moves all interpolated transforms between the saved state (alpha = 0) and the current state (alpha = 1) for rendering.
+        // Must be followed by EndInterpolation() once rendering is done.
+        static void BeginInterpolation(float alpha);
+
+        // Restores all interpolated transforms to the current state.
+        static void EndInterpolation();
+
+    protected:
+        void OnDestroy();
+        void OnClone(BaseComponent* src);
+
     };
 
 }
@@ -122,7 +122,7 @@ namespace Ossium
 
             TypeFactory(const char* name, FactoryFunc factory, std::string baseNames, bool abstract_type = false)
             {
-                Log.Info("Type factory instantiated for type \"{0}\" [{1}].", name, TypeRegistry<CoreType>::typeIdent);
+                Logger::EngineLog().Info("Type factory instantiated for type \"{0}\" [{1}].", name, TypeRegistry<CoreType>::typeIdent);
                 gen_map()[TypeRegistry<CoreType>::typeIdent] = factory;
                 type_name_map()[name] = TypeRegistry<CoreType>::typeIdent;
                 type_id_map()[TypeRegistry<CoreType>::typeIdent] = name;
@@ -150,7 +150,7 @@ namespace Ossium
 
             TypeFactory(const char* name, FactoryFunc factory, bool abstract_type = false)
             {
-                Log.Info("Type factory instantiated for type \"{0}\" [{1}].", name, TypeRegistry<CoreType>::typeIdent);
+                Logger::EngineLog().Info("Type factory instantiated for type \"{0}\" [{1}].", name, TypeRegistry<CoreType>::typeIdent);
                 gen_map()[TypeRegistry<CoreType>::typeIdent] = factory;
                 type_name_map()[name] = TypeRegistry<CoreType>::typeIdent;
                 type_id_map()[TypeRegistry<CoreType>::typeIdent] = name;
@@ -12,6 +12,15 @@ namespace Ossium::Editor
     #define EDITOR_PATH_SEPARATOR "/"
 #endif // _WIN32
 
+    // How often loaded scenes are autosaved, in milliseconds.
+    #define EDITOR_AUTOSAVE_INTERVAL 60000
+
+    // How often the property inspector checks whether the members of the selected entity's components have changed, in milliseconds.
+    #define EDITOR_PROPERTY_POLL_INTERVAL 250
+
+    // Appended to the path of a scene to get the path of its autosave file.
+    #define EDITOR_AUTOSAVE_EXTENSION ".autosave"
+
 }
 
 #endif // EDITORCONSTANTS_H
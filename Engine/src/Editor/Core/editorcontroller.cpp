@@ -9,9 +9,10 @@ using namespace std;
 namespace Ossium::Editor
 {
 
-    EditorController::EditorController(ResourceController* resources)
+    EditorController::EditorController(ResourceController* resources, JobSystem* jobs)
     {
         this->resources = resources;
+        this->jobs = jobs;
         input = new InputController();
         sceneInput = new InputController();
         mainLayout = new EditorLayout(this, "Ossium Editor");
@@ -80,6 +81,11 @@ namespace Ossium::Editor
 
     void EditorController::SelectEntity(Entity* entity)
     {
+        if (entity != selectedEntity)
+        {
+            // Changes to a different entity are separate edits
+            journal.Seal();
+        }
         selectedEntity = entity;
     }
 
@@ -162,6 +168,12 @@ namespace Ossium::Editor
 
         ContextMenu::GetMainInstance(resources)->Update();
 
+        if (SDL_GetTicks() - lastAutosave >= EDITOR_AUTOSAVE_INTERVAL)
+        {
+            Autosave();
+            lastAutosave = SDL_GetTicks();
+        }
+
         // Now delay about 16 ms to get ~60 FPS
         if (timer.GetTicks() < 16)
         {
@@ -232,6 +244,8 @@ namespace Ossium::Editor
             delete loadedProject;
             loadedProject = nullptr;
         }
+        journal.Clear();
+        autosaved.clear();
     }
 
     ResourceController* EditorController::GetResources()
@@ -254,4 +268,60 @@ namespace Ossium::Editor
         return world;
     }
 
+    JobSystem* EditorController::GetJobSystem()
+    {
+        return jobs;
+    }
+
+    void EditorController::Autosave()
+    {
+        if (loadedProject == nullptr)
+        {
+            return;
+        }
+        for (auto& listedScene : loadedProject->openScenes)
+        {
+            if (listedScene.loaded)
+            {
+                Scene* scene = resources->Find<Scene>(listedScene.path);
+                // Skip scenes that are still being saved rather than waiting for them
+                if (scene != nullptr && !scene->IsSaving())
+                {
+                    // Skip scenes that haven't changed since they were last autosaved
+                    shared_ptr<const SceneSnapshot> snapshot = scene->Snapshot();
+                    auto itr = autosaved.find(listedScene.path);
+                    if (itr == autosaved.end() || itr->second != snapshot->GetHash())
+                    {
+                        autosaved[listedScene.path] = snapshot->GetHash();
+                        scene->SaveAsync(listedScene.path + EDITOR_AUTOSAVE_EXTENSION, snapshot);
+                    }
+                }
+            }
+        }
+    }
+
+    UndoJournal* EditorController::GetUndoJournal()
+    {
+        return &journal;
+    }
+
+    bool EditorController::Undo()
+    {
+        return ApplyJournal(true);
+    }
+
+    bool EditorController::Redo()
+    {
+        return ApplyJournal(false);
+    }
+
+    bool EditorController::ApplyJournal(bool undo)
+    {
+        Scene* scene = selectedEntity != nullptr ? selectedEntity->GetScene() : nullptr;
+        int id = selectedEntity != nullptr ? selectedEntity->GetID() : -1;
+        bool success = undo ? journal.Undo() : journal.Redo();
+        selectedEntity = scene != nullptr ? scene->GetEntity(id) : nullptr;
+        return success;
+    }
+
 }
@@ -5,6 +5,7 @@
 #include "editorstyle.h"
 #include "editorlayout.h"
 #include "editorconstants.h"
+#include "undojournal.h"
 
 namespace Ossium::Editor
 {
@@ -20,7 +21,8 @@ namespace Ossium::Editor
         CONSTRUCT_SCHEMA(SchemaRoot, EditorTheme);
 
         /// Constructor instantiates the main window and caches a reference to the resources.
-        EditorController(ResourceController* resources);
+        /// The job system is shared with the rest of the application rather than owned by the editor, and must outlive it.
+        EditorController(ResourceController* resources, JobSystem* jobs);
         virtual ~EditorController();
 
         /// Creates a new editor layout, and adds the specified editor window type to it.
@@ -112,6 +114,18 @@ namespace Ossium::Editor
         /// Returns a pointer to the physics world instance.
         Physics::PhysicsWorld* GetPhysicsWorld();
 
+        /// Returns the job system used for background work such as saving scenes.
+        JobSystem* GetJobSystem();
+
+        /// Returns the journal of edits made in the editor.
+        UndoJournal* GetUndoJournal();
+
+        /// Undoes the last edit, keeping the selected entity valid.
+        bool Undo();
+
+        /// Redoes the last undone edit, keeping the selected entity valid.
+        bool Redo();
+
     private:
         // Helper method for a template
         EditorLayout* CreateLayout();
@@ -144,6 +158,24 @@ namespace Ossium::Editor
         /// Physics world
         Physics::PhysicsWorld* world = nullptr;
 
+        /// Worker threads for background work, shared with the rest of the application.
+        JobSystem* jobs = nullptr;
+
+        /// Saves a snapshot of each loaded scene alongside the scene file, in the background.
+        void Autosave();
+
+        /// When the loaded scenes were last autosaved.
+        Uint32 lastAutosave = 0;
+
+        /// Snapshot hashes of the scenes when they were last autosaved, by scene path.
+        std::unordered_map<std::string, Uint64> autosaved;
+
+        /// Edits that can be undone and redone.
+        UndoJournal journal;
+
+        /// Reselects the selected entity by id after an edit is undone or redone, as the entity may have been destroyed or recreated.
+        bool ApplyJournal(bool undo);
+
     };
 
 }
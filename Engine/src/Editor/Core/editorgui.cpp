@@ -158,13 +158,18 @@ namespace Ossium::Editor
 
     void EditorGUI::Update(bool forceUpdate)
     {
-        if (update || alwaysUpdate || forceUpdate)
+        if (update || alwaysUpdate || forceUpdate || NeedsRefresh())
         {
             update = false;
             Refresh();
         }
     }
 
+    bool EditorGUI::NeedsRefresh()
+    {
+        return false;
+    }
+
     void EditorGUI::TriggerUpdate()
     {
         update = true;
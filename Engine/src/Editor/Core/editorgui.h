@@ -199,6 +199,9 @@ namespace Ossium::Editor
         /// Abstract method that should contain all GUI logic.
         virtual void OnGUI() = 0;
 
+        /// Called by Update() when no refresh has been triggered. Override to refresh when the data shown by the GUI changes.
+        virtual bool NeedsRefresh();
+
         /// Get the viewport scroll position.
         Vector2 GetScrollPos();
 
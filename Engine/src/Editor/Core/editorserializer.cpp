@@ -25,7 +25,10 @@ namespace Ossium
             gui->Tab(100);
             string data = attribute & ATTRIBUTE_FILEPATH ? gui->FilePathField(property) : gui->TextField(property);
             gui->EndHorizontal();
-            dirty |= data != property;
+            if (data != property)
+            {
+                SetModified(name, property);
+            }
             return data;
         }
 #endif // OSSIUM_EDITOR
@@ -42,7 +45,10 @@ namespace Ossium
             gui->Tab(100);
             bool data = gui->Toggle(property);
             gui->EndHorizontal();
-            dirty |= data != property;
+            if (data != property)
+            {
+                SetModified(name, property ? "1" : "0");
+            }
             return data ? "1" : "0";
         }
 #endif // OSSIUM_EDITOR
@@ -61,7 +67,10 @@ namespace Ossium
             gui->Tab(50);
             data.y = Utilities::ToFloat(gui->TextField(Utilities::ToString(property.y)));
             gui->EndHorizontal();
-            dirty |= data != property;
+            if (data != property)
+            {
+                SetModified(name, Utilities::ToString(property));
+            }
             return Utilities::ToString(data);
         }
 #endif // OSSIUM_EDITOR
@@ -71,6 +80,7 @@ namespace Ossium
     void EditorSerializer::ClearDirtyFlag()
     {
         dirty = false;
+        modified.clear();
     }
 
     // Returns true if any properties have been modified since the last ClearDirtyFlag() call.
@@ -79,4 +89,20 @@ namespace Ossium
         return dirty;
     }
 
+    const vector<EditorSerializer::ModifiedProperty>& EditorSerializer::GetModifiedProperties()
+    {
+        return modified;
+    }
+
+    void EditorSerializer::ClearPropertyCache()
+    {
+        cache.clear();
+    }
+
+    void EditorSerializer::SetModified(const char* name, string previous)
+    {
+        dirty = true;
+        modified.push_back({ name, previous });
+    }
+
 }
@@ -1,6 +1,9 @@
 #ifndef EDITORSERIALIZER_H
 #define EDITORSERIALIZER_H
 
+#include <unordered_map>
+#include <vector>
+
 #include "../../Core/stringconvert.h"
 #include "../../Core/schematype.h"
 #include "../../Core/jsondata.h"
@@ -49,10 +52,20 @@ namespace Ossium
 
     public:
         // Sinkhole. Last method to be considered, caters for all types.
-        template<typename ...Args>
-        std::string SerializeProperty(const char* type, const char* name, int attribute, Args&&... args)
+        // The property is only converted to a string when its value has changed since it was last serialized.
+        template<typename T>
+        typename std::enable_if<!std::is_base_of<SchemaType, T>::value || std::is_same<SchemaType, T>::value, std::string>::type
+        SerializeProperty(const char* type, const char* name, int attribute, T& property)
         {
-            std::string data = Utilities::ToString(std::forward<Args>(args)...);
+            Uint64 hash = Utilities::HashValue(property);
+            CachedProperty& cached = cache[(const void*)&property];
+            if (cached.type != type || cached.hash != hash || cached.text.empty())
+            {
+                cached.type = type;
+                cached.hash = hash;
+                cached.text = Utilities::ToString(property);
+            }
+            std::string data = cached.text;
             return SerializeProperty(type, name, attribute, data);
         }
 
@@ -87,12 +100,43 @@ namespace Ossium
         // Returns true if any properties have been modified since the last ClearDirtyFlag() call.
         bool IsDirty();
 
+        // A property that has been modified, along with its serialized value prior to modification.
+        struct ModifiedProperty
+        {
+            const char* name;
+            std::string previous;
+        };
+
+        // Returns the properties modified since the last ClearDirtyFlag() call.
+        const std::vector<ModifiedProperty>& GetModifiedProperties();
+
+        // Clears the cached string conversions of properties. These are only valid while the property addresses are,
+        // so this should be called when the objects being serialized are destroyed.
+        void ClearPropertyCache();
+
     private:
+        // Records a modified property.
+        void SetModified(const char* name, std::string previous);
+
         Ossium::Editor::EditorWindow* gui = nullptr;
 
         // Whether any property has been modified or not.
         bool dirty = false;
 
+        // The properties that have been modified.
+        std::vector<ModifiedProperty> modified;
+
+        // The last string conversion of a property.
+        struct CachedProperty
+        {
+            const char* type = nullptr;
+            Uint64 hash = 0;
+            std::string text;
+        };
+
+        // Cached string conversions, by property address.
+        std::unordered_map<const void*, CachedProperty> cache;
+
     };
 
 }
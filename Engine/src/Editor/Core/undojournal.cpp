@@ -0,0 +1,249 @@
+#include <algorithm>
+
+#include "undojournal.h"
+
+using namespace std;
+
+namespace Ossium::Editor
+{
+
+    UndoJournal::UndoJournal(size_t maxBytes)
+    {
+        this->maxBytes = maxBytes;
+    }
+
+    UndoJournal::~UndoJournal()
+    {
+        for (auto& itr : watched)
+        {
+            itr.first->onClear -= itr.second.clear;
+            itr.first->onDestroy -= itr.second.destroy;
+        }
+    }
+
+    void UndoJournal::RecordMember(BaseComponent* component, const char* member, const string& before, const string& after)
+    {
+        Entity* entity = component->GetEntity();
+        vector<BaseComponent*>& components = entity->GetComponents((ComponentType)component->GetType());
+        unsigned int index = 0;
+        for (unsigned int counti = components.size(); index < counti && components[index] != component; index++);
+
+        Uint32 now = SDL_GetTicks();
+        if (!sealed && !history.empty())
+        {
+            // Merge continuous changes to the same member
+            Edit& last = history.back();
+            if (last.type == EDIT_MEMBER && last.scene == entity->GetScene() && last.entity == entity->GetID() &&
+                last.componentType == (ComponentType)component->GetType() && last.componentIndex == index &&
+                last.member == member && now - last.time <= CoalesceTime)
+            {
+                bytes -= last.after.size();
+                last.after = after;
+                last.time = now;
+                bytes += last.after.size();
+                Trim();
+                return;
+            }
+        }
+
+        Edit edit;
+        edit.type = EDIT_MEMBER;
+        edit.scene = entity->GetScene();
+        edit.entity = entity->GetID();
+        edit.componentType = (ComponentType)component->GetType();
+        edit.componentIndex = index;
+        edit.member = member;
+        edit.before = before;
+        edit.after = after;
+        edit.time = now;
+        Record(edit);
+    }
+
+    void UndoJournal::RecordCreate(Entity* entity)
+    {
+        Edit edit;
+        edit.type = EDIT_CREATE;
+        edit.scene = entity->GetScene();
+        edit.entity = entity->GetID();
+        edit.after = edit.scene->ToString(entity);
+        Record(edit);
+    }
+
+    void UndoJournal::RecordDestroy(Entity* entity)
+    {
+        Edit edit;
+        edit.type = EDIT_DESTROY;
+        edit.scene = entity->GetScene();
+        edit.entity = entity->GetID();
+        edit.before = edit.scene->ToString(entity);
+        Record(edit);
+    }
+
+    void UndoJournal::Seal()
+    {
+        sealed = true;
+    }
+
+    bool UndoJournal::Undo()
+    {
+        if (history.empty())
+        {
+            return false;
+        }
+        sealed = true;
+        future.push_back(history.back());
+        history.pop_back();
+        return Apply(future.back(), true);
+    }
+
+    bool UndoJournal::Redo()
+    {
+        if (future.empty())
+        {
+            return false;
+        }
+        sealed = true;
+        history.push_back(future.back());
+        future.pop_back();
+        return Apply(history.back(), false);
+    }
+
+    bool UndoJournal::CanUndo()
+    {
+        return !history.empty();
+    }
+
+    bool UndoJournal::CanRedo()
+    {
+        return !future.empty();
+    }
+
+    void UndoJournal::Clear()
+    {
+        history.clear();
+        future.clear();
+        bytes = 0;
+        sealed = true;
+    }
+
+    void UndoJournal::SetMaxBytes(size_t bytes)
+    {
+        maxBytes = bytes;
+        Trim();
+    }
+
+    size_t UndoJournal::GetBytes()
+    {
+        return bytes;
+    }
+
+    void UndoJournal::Record(Edit& edit)
+    {
+        for (Edit& dropped : future)
+        {
+            bytes -= GetEditBytes(dropped);
+        }
+        future.clear();
+
+        Watch(edit.scene);
+        history.push_back(edit);
+        bytes += GetEditBytes(history.back());
+        sealed = false;
+        Trim();
+    }
+
+    bool UndoJournal::Apply(Edit& edit, bool undo)
+    {
+        Entity* entity = edit.scene->GetEntity(edit.entity);
+
+        switch (edit.type)
+        {
+        case EDIT_MEMBER:
+            if (entity != nullptr)
+            {
+                vector<BaseComponent*>& components = entity->GetComponents(edit.componentType);
+                if (edit.componentIndex < components.size())
+                {
+                    BaseComponent* component = components[edit.componentIndex];
+                    // Only the edited member is loaded
+                    JSON data;
+                    data[edit.member] = undo ? edit.before : edit.after;
+                    component->OnLoadStart();
+                    component->SerialiseIn(data, true);
+                    component->OnLoadFinish();
+                    component->OnEditorPropertyChanged();
+                    return true;
+                }
+            }
+            Log.Warning("Failed to {0} change to member '{1}', the component no longer exists.", undo ? "undo" : "redo", edit.member);
+            return false;
+        case EDIT_CREATE:
+        case EDIT_DESTROY:
+            if ((edit.type == EDIT_CREATE) == undo)
+            {
+                if (entity != nullptr)
+                {
+                    edit.scene->DestroyEntity(entity, true);
+                    return true;
+                }
+            }
+            else if (!edit.scene->LoadEntities(edit.type == EDIT_CREATE ? edit.after : edit.before).empty())
+            {
+                return true;
+            }
+            Log.Warning("Failed to {0} {1} of entity [{2}].", undo ? "undo" : "redo", edit.type == EDIT_CREATE ? "creation" : "destruction", edit.entity);
+            return false;
+        }
+        return false;
+    }
+
+    void UndoJournal::Trim()
+    {
+        // Prefer dropping the oldest edits over the edits that can be redone
+        while (bytes > maxBytes && !history.empty())
+        {
+            bytes -= GetEditBytes(history.front());
+            history.pop_front();
+        }
+        while (bytes > maxBytes && !future.empty())
+        {
+            bytes -= GetEditBytes(future.front());
+            future.pop_front();
+        }
+    }
+
+    void UndoJournal::Watch(Scene* scene)
+    {
+        if (watched.find(scene) == watched.end())
+        {
+            WatchHandles& handles = watched[scene];
+            handles.clear = scene->onClear += [&] (Scene* cleared) { Forget(cleared); };
+            handles.destroy = scene->onDestroy += [&] (Scene* destroyed) {
+                Forget(destroyed);
+                // The scene is being destroyed, so the callbacks don't need to be unregistered.
+                watched.erase(destroyed);
+            };
+        }
+    }
+
+    void UndoJournal::Forget(Scene* scene)
+    {
+        auto isForgotten = [&] (Edit& edit) {
+            if (edit.scene == scene)
+            {
+                bytes -= GetEditBytes(edit);
+                return true;
+            }
+            return false;
+        };
+        history.erase(remove_if(history.begin(), history.end(), isForgotten), history.end());
+        future.erase(remove_if(future.begin(), future.end(), isForgotten), future.end());
+        sealed = true;
+    }
+
+    size_t UndoJournal::GetEditBytes(Edit& edit)
+    {
+        return sizeof(Edit) + edit.before.size() + edit.after.size();
+    }
+
+}
@@ -0,0 +1,124 @@
+#ifndef UNDOJOURNAL_H
+#define UNDOJOURNAL_H
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+#include "../../Core/ecs.h"
+
+namespace Ossium::Editor
+{
+
+    // Records edits made in the editor so they can be undone and redone.
+    // Component edits are recorded per schema member, so only the members that changed are stored and reapplied.
+    // Entities are referred to by scene and id rather than by pointer, as undoing and redoing may destroy and recreate them.
+    class UndoJournal
+    {
+    public:
+        // The default limit on the memory used by recorded edits, in bytes.
+        static constexpr size_t DefaultMaxBytes = 8 * 1024 * 1024;
+
+        // Changes to the same member within this many milliseconds of each other are merged into a single edit,
+        // so that typing in a field or dragging a value is undone all at once.
+        static constexpr Uint32 CoalesceTime = 500;
+
+        UndoJournal(size_t maxBytes = DefaultMaxBytes);
+        ~UndoJournal();
+
+        // Records a change to a schema member of a component, given the serialized values before and after the change.
+        void RecordMember(BaseComponent* component, const char* member, const std::string& before, const std::string& after);
+
+        // Records the creation of an entity. Call this once the entity has been set up.
+        void RecordCreate(Entity* entity);
+
+        // Records the destruction of an entity and its children. Call this before the entity is destroyed.
+        void RecordDestroy(Entity* entity);
+
+        // Prevents the next change from being merged into the last edit.
+        void Seal();
+
+        // Reverts the last edit. Returns false if there is nothing to undo or the edit could not be reverted.
+        bool Undo();
+
+        // Reapplies the last undone edit. Returns false if there is nothing to redo or the edit could not be reapplied.
+        bool Redo();
+
+        bool CanUndo();
+        bool CanRedo();
+
+        // Removes all recorded edits.
+        void Clear();
+
+        // Sets the limit on the memory used by recorded edits. The oldest edits are dropped to stay within the limit.
+        void SetMaxBytes(size_t bytes);
+
+        // Returns the approximate memory used by recorded edits, in bytes.
+        size_t GetBytes();
+
+    private:
+        enum EditType
+        {
+            EDIT_MEMBER = 0,
+            EDIT_CREATE,
+            EDIT_DESTROY
+        };
+
+        struct Edit
+        {
+            EditType type;
+            Scene* scene;
+            int entity;
+
+            // The edited component, by type and index amongst the components of that type on the entity.
+            ComponentType componentType = 0;
+            unsigned int componentIndex = 0;
+            const char* member = nullptr;
+
+            // The serialized member values, or the serialized entity and its children when it is created or destroyed.
+            std::string before;
+            std::string after;
+
+            // When the edit was last changed.
+            Uint32 time = 0;
+        };
+
+        // Adds an edit to the journal, dropping any undone edits.
+        void Record(Edit& edit);
+
+        // Reverts or reapplies an edit.
+        bool Apply(Edit& edit, bool undo);
+
+        // Drops the oldest edits until the memory used is within the limit.
+        void Trim();
+
+        // Removes the edits to a scene when it is cleared, e.g. by loading, or destroyed,
+        // as the entity ids they refer to are no longer valid.
+        void Watch(Scene* scene);
+        void Forget(Scene* scene);
+
+        static size_t GetEditBytes(Edit& edit);
+
+        // Edits that can be undone, oldest first, and edits that can be redone, most recently undone last.
+        std::deque<Edit> history;
+        std::deque<Edit> future;
+
+        size_t bytes = 0;
+        size_t maxBytes;
+
+        // When true, the next change is not merged into the last edit.
+        bool sealed = true;
+
+        // Handles of the clear and destroy callbacks of scenes with recorded edits.
+        struct WatchHandles
+        {
+            int clear;
+            int destroy;
+        };
+        std::unordered_map<Scene*, WatchHandles> watched;
+
+    };
+
+}
+
+#endif // UNDOJOURNAL_H
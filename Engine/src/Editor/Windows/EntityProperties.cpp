@@ -51,6 +51,7 @@ namespace Ossium::Editor
             if (Button("Delete Entity", redStyle))
             {
                 GetEditorLayout()->GetEditorController()->SelectEntity(nullptr);
+                GetEditorLayout()->GetEditorController()->GetUndoJournal()->RecordDestroy(selected);
                 selected->Destroy(true);
                 selected = nullptr;
                 TriggerUpdate();
@@ -101,10 +102,21 @@ namespace Ossium::Editor
                     // Check if any properties changed during serialization.
                     if (IsDirty())
                     {
-                        // Reload the component.
+                        // Reload only the modified members of the component.
+                        JSON changes;
+                        for (auto& property : GetModifiedProperties())
+                        {
+                            changes[property.name] = data[property.name];
+                        }
                         modified.push_back(component);
                         component->OnLoadStart();
-                        component->SerialiseIn(data);
+                        component->SerialiseIn(changes, true);
+
+                        UndoJournal* journal = GetEditorLayout()->GetEditorController()->GetUndoJournal();
+                        for (auto& property : GetModifiedProperties())
+                        {
+                            journal->RecordMember(component, property.name, property.previous, changes[property.name]);
+                        }
                         ClearDirtyFlag();
                     }
 
@@ -156,6 +168,49 @@ namespace Ossium::Editor
             );
         }
 
+        // Remember what was shown so changes made elsewhere, e.g. by the components themselves, trigger a refresh.
+        if (selected != shown)
+        {
+            // Cached property strings are keyed by address, so they would be invalid if the components were destroyed.
+            ClearPropertyCache();
+            shown = selected;
+        }
+        HashComponents(selected, shownComponents, shownHashes);
+    }
+
+    bool EntityProperties::NeedsRefresh()
+    {
+        Entity* selected = GetEditorLayout()->GetEditorController()->GetSelectedEntity();
+        if (selected != shown)
+        {
+            return true;
+        }
+        // Hashing every member is too slow to do every frame, and changes made outside the inspector needn't show immediately
+        Uint32 now = SDL_GetTicks();
+        if (now - lastPoll < EDITOR_PROPERTY_POLL_INTERVAL)
+        {
+            return false;
+        }
+        lastPoll = now;
+        HashComponents(selected, currentComponents, currentHashes);
+        return currentComponents != shownComponents || currentHashes != shownHashes;
+    }
+
+    void EntityProperties::HashComponents(Entity* entity, vector<BaseComponent*>& components, vector<Uint64>& hashes)
+    {
+        components.clear();
+        hashes.clear();
+        if (entity != nullptr)
+        {
+            for (auto itr : entity->GetAllComponents())
+            {
+                for (BaseComponent* component : itr.second)
+                {
+                    components.push_back(component);
+                    component->HashMembers(hashes);
+                }
+            }
+        }
     }
 
     void EntityProperties::Property(JSON& data)
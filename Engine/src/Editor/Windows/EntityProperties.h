@@ -1,11 +1,19 @@
 #ifndef ENTITYPROPERTIES_H
 #define ENTITYPROPERTIES_H
 
+#include <vector>
+
 #include "../../Core/jsondata.h"
 
 #include "../Core/editorwindow.h"
 #include "../Core/editorserializer.h"
 
+namespace Ossium
+{
+    class Entity;
+    class BaseComponent;
+}
+
 namespace Ossium::Editor
 {
 
@@ -21,6 +29,27 @@ namespace Ossium::Editor
 
         void PropertyValue(Ossium::JString& data);
 
+        // Refreshes when the selected entity or the values of its component members change.
+        bool NeedsRefresh();
+
+    private:
+        // Hashes the members of each component on an entity.
+        void HashComponents(Entity* entity, std::vector<BaseComponent*>& components, std::vector<Uint64>& hashes);
+
+        // The entity shown by the last refresh.
+        Entity* shown = nullptr;
+
+        // Components and member hashes of the entity shown by the last refresh, for detecting changes.
+        std::vector<BaseComponent*> shownComponents;
+        std::vector<Uint64> shownHashes;
+
+        // When the members were last hashed to check for changes.
+        Uint32 lastPoll = 0;
+
+        // Reused when checking for changes.
+        std::vector<BaseComponent*> currentComponents;
+        std::vector<Uint64> currentHashes;
+
     };
 
 }
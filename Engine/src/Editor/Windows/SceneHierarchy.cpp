@@ -10,6 +10,32 @@ using namespace Ossium;
 namespace Ossium::Editor
 {
 
+    // Draws an arrow pointing right when closed, or down when open.
+    static void DrawArrow(Renderer* renderer, Vector2 position, float size, bool open)
+    {
+        renderer->SetDrawColor(Colors::Black);
+        Line arrowLine = Line(position, position + (open ? Vector2(size, 0) : Vector2(0, size)));
+
+        for (unsigned int i = 0, counti = (int)round(size / 2.0f); i < counti; i++)
+        {
+            arrowLine.Draw(*renderer);
+            arrowLine.a += Vector2::OneOne;
+            arrowLine.b += open ? Vector2(-1, 1) : Vector2::OneNegOne;
+        }
+    }
+
+    SceneHierarchy::~SceneHierarchy()
+    {
+        for (auto& itr : sceneRows)
+        {
+            itr.first->onEntityAdded -= itr.second.addedHandle;
+            itr.first->onEntityRemoved -= itr.second.removedHandle;
+            itr.first->onEntityReparented -= itr.second.reparentedHandle;
+            itr.first->onClear -= itr.second.clearHandle;
+            itr.first->onDestroy -= itr.second.destroyHandle;
+        }
+    }
+
     void SceneHierarchy::OnInit()
     {
         padding = 1;
@@ -37,10 +63,50 @@ namespace Ossium::Editor
                     ListScene(scene, true);
                     if (scene.opened)
                     {
-                        loaded->WalkEntities([&] (Entity* entity) {
-                            ListEntity(entity);
-                            return true;
-                        }, false);
+                        SceneRows& listed = GetRows(loaded);
+                        if (listed.rebuild)
+                        {
+                            listed.rows.clear();
+                            listed.depths.clear();
+                            for (Entity* root : loaded->GetRootEntities())
+                            {
+                                AppendRows(root, 0, listed.rows, listed.depths);
+                            }
+                            listed.indices.clear();
+                            listed.dirtyFrom = 0;
+                            listed.rebuild = false;
+                        }
+                        UpdateIndices(listed);
+
+                        // Only draw the rows in view, and leave space for the rest so scrolling still works.
+                        unsigned int total = listed.rows.size();
+                        unsigned int first = 0;
+                        unsigned int last = total;
+                        if (rowHeight > 0)
+                        {
+                            first = (unsigned int)std::max(0.0f, (GetScrollPos().y - GetLayoutPosition().y) / rowHeight);
+                            first = std::min(first, total);
+                            last = std::min(total, first + (unsigned int)(renderer->GetHeight() / rowHeight) + 2);
+                            Space(first * rowHeight);
+                        }
+                        for (unsigned int i = first; i < last && i < listed.rows.size(); i++)
+                        {
+                            float rowTop = GetLayoutPosition().y;
+                            ListEntity(listed.rows[i]);
+                            if (rowHeight <= 0)
+                            {
+                                // Now the row height is known, stop once the view is filled
+                                rowHeight = GetLayoutPosition().y - rowTop;
+                                if (rowHeight > 0)
+                                {
+                                    last = std::min(total, i + 1 + (unsigned int)(renderer->GetHeight() / rowHeight) + 2);
+                                }
+                            }
+                        }
+                        if (rowHeight > 0)
+                        {
+                            Space((total - last) * rowHeight);
+                        }
                     }
                 }
             }
@@ -62,16 +128,7 @@ namespace Ossium::Editor
             selectedScene != nullptr && item.name == selectedScene->GetName() ? EditorStyle::HierarchySceneSelected : EditorStyle::HierarchyScene,
             Vector2(8 + arrowSize, 8 + arrowSize),
             [&] (bool on) {
-                renderer->SetDrawColor(Colors::Black);
-                // Draw an arrow
-                Line arrowLine = Line(arrowPos, arrowPos + (on && loaded ? Vector2(arrowSize, 0) : Vector2(0, arrowSize)));
-
-                for (unsigned int i = 0, counti = (int)round(arrowSize / 2.0f); i < counti; i++)
-                {
-                    arrowLine.Draw(*renderer);
-                    arrowLine.a += Vector2::OneOne;
-                    arrowLine.b += on && loaded ? Vector2(-1, 1) : Vector2::OneNegOne;
-                }
+                DrawArrow(renderer, arrowPos, arrowSize, on && loaded);
             }
         );
         if (loaded)
@@ -147,12 +204,33 @@ namespace Ossium::Editor
 
         StyleClickable style = editor->GetSelectedEntity() == entity ? EditorStyle::HierarchyEntitySelected : EditorStyle::HierarchyEntity;
 
-        std::string text = "";
-        for (int i = entity->GetDepth(); i >= 0; i--)
+        // Indent by depth, with an arrow to show or hide the children of entities that have any
+        float arrowSize = 7.0f;
+        Space(4 + entity->GetDepth() * 12);
+        if (entity->GetChildCount() > 0)
+        {
+            Vector2 arrowPos = GetLayoutPosition() + Vector2(3, 4);
+            bool isExpanded = expanded.find(entity) != expanded.end();
+            bool expand = Toggle(
+                isExpanded,
+                style,
+                Vector2(6 + arrowSize, 6 + arrowSize),
+                [&] (bool on) {
+                    DrawArrow(renderer, arrowPos, arrowSize, on);
+                }
+            );
+            if (expand != isExpanded)
+            {
+                SetExpanded(entity, expand);
+                TriggerUpdate();
+            }
+        }
+        else
         {
-            text += "  ";
+            Space(6 + arrowSize);
         }
-        text += entity->name;
+
+        std::string text = entity->name;
 
         TextLayout tlayout;
         Vector2 layoutPos = GetLayoutPosition();
@@ -180,10 +258,13 @@ namespace Ossium::Editor
                 cmenu->ClearOptions();
 
                 cmenu->Add("Clone Entity", [&, entity] () {
-                    GetEditorLayout()->GetEditorController()->SelectEntity(entity->Clone());
+                    Entity* clone = entity->Clone();
+                    GetEditorLayout()->GetEditorController()->GetUndoJournal()->RecordCreate(clone);
+                    GetEditorLayout()->GetEditorController()->SelectEntity(clone);
                 });
 
                 cmenu->Add("Delete Entity", [&, entity] () {
+                    GetEditorLayout()->GetEditorController()->GetUndoJournal()->RecordDestroy(entity);
                     entity->Destroy(true);
                     GetEditorLayout()->GetEditorController()->SelectEntity(nullptr);
                 });
@@ -196,4 +277,205 @@ namespace Ossium::Editor
         EndHorizontal();
     }
 
+    SceneHierarchy::SceneRows& SceneHierarchy::GetRows(Scene* scene)
+    {
+        auto itr = sceneRows.find(scene);
+        if (itr != sceneRows.end())
+        {
+            return itr->second;
+        }
+
+        SceneRows& listed = sceneRows[scene];
+        listed.addedHandle = scene->onEntityAdded += [&] (Entity* entity) { OnEntityAdded(entity); };
+        listed.removedHandle = scene->onEntityRemoved += [&] (Entity* entity) { OnEntityRemoved(entity); };
+        listed.reparentedHandle = scene->onEntityReparented += [&] (Entity* entity) { OnEntityReparented(entity); };
+        listed.clearHandle = scene->onClear += [&] (Scene* cleared) {
+            // Rebuild once afterwards rather than erasing the rows of each entity as it is destroyed
+            auto itr = sceneRows.find(cleared);
+            if (itr != sceneRows.end())
+            {
+                itr->second.rebuild = true;
+                itr->second.rows.clear();
+                itr->second.depths.clear();
+                itr->second.indices.clear();
+                TriggerUpdate();
+            }
+        };
+        listed.destroyHandle = scene->onDestroy += [&] (Scene* destroyed) {
+            // The scene's callbacks are destroyed with it
+            sceneRows.erase(destroyed);
+            TriggerUpdate();
+        };
+        return listed;
+    }
+
+    void SceneHierarchy::AppendRows(Entity* entity, unsigned int depth, std::vector<Entity*>& rows, std::vector<unsigned int>& depths)
+    {
+        rows.push_back(entity);
+        depths.push_back(depth);
+        if (expanded.find(entity) != expanded.end())
+        {
+            for (unsigned int i = 0, counti = entity->GetChildCount(); i < counti; i++)
+            {
+                AppendRows(entity->GetChild(i), depth + 1, rows, depths);
+            }
+        }
+    }
+
+    void SceneHierarchy::InsertRows(SceneRows& listed, unsigned int index, Entity* entity, unsigned int depth)
+    {
+        std::vector<Entity*> rows;
+        std::vector<unsigned int> depths;
+        AppendRows(entity, depth, rows, depths);
+        listed.rows.insert(listed.rows.begin() + index, rows.begin(), rows.end());
+        listed.depths.insert(listed.depths.begin() + index, depths.begin(), depths.end());
+        SetIndicesDirty(listed, index);
+    }
+
+    void SceneHierarchy::EraseRows(SceneRows& listed, unsigned int index)
+    {
+        unsigned int end = FindSubtreeEnd(listed, index);
+        for (unsigned int i = index; i < end; i++)
+        {
+            listed.indices.erase(listed.rows[i]->GetID());
+        }
+        listed.rows.erase(listed.rows.begin() + index, listed.rows.begin() + end);
+        listed.depths.erase(listed.depths.begin() + index, listed.depths.begin() + end);
+        SetIndicesDirty(listed, index);
+    }
+
+    void SceneHierarchy::SetIndicesDirty(SceneRows& listed, unsigned int first)
+    {
+        listed.dirtyFrom = std::min(listed.dirtyFrom, first);
+    }
+
+    void SceneHierarchy::UpdateIndices(SceneRows& listed)
+    {
+        for (unsigned int i = listed.dirtyFrom, counti = listed.rows.size(); i < counti; i++)
+        {
+            listed.indices[listed.rows[i]->GetID()] = i;
+        }
+        listed.dirtyFrom = listed.rows.size();
+    }
+
+    unsigned int SceneHierarchy::FindRow(SceneRows& listed, Entity* entity)
+    {
+        // Rows only move when rows are inserted or erased before them, so indices before the dirty rows are still right
+        auto itr = listed.indices.find(entity->GetID());
+        if (itr != listed.indices.end() && (itr->second < listed.dirtyFrom || (itr->second < listed.rows.size() && listed.rows[itr->second] == entity)))
+        {
+            return itr->second;
+        }
+        if (listed.dirtyFrom < listed.rows.size())
+        {
+            UpdateIndices(listed);
+            itr = listed.indices.find(entity->GetID());
+        }
+        return itr != listed.indices.end() ? itr->second : listed.rows.size();
+    }
+
+    unsigned int SceneHierarchy::FindSubtreeEnd(SceneRows& listed, unsigned int index)
+    {
+        // The subtree ends at the next row that is no deeper than the entity was when it was listed
+        unsigned int end = index + 1;
+        for (unsigned int counti = listed.rows.size(); end < counti && listed.depths[end] > listed.depths[index]; end++)
+        {
+        }
+        return end;
+    }
+
+    void SceneHierarchy::OnEntityAdded(Entity* entity)
+    {
+        auto itr = sceneRows.find(entity->GetScene());
+        if (itr == sceneRows.end() || itr->second.rebuild)
+        {
+            return;
+        }
+        SceneRows& listed = itr->second;
+        Entity* parent = entity->GetParent();
+        if (parent == nullptr)
+        {
+            // New root entities are always last
+            InsertRows(listed, listed.rows.size(), entity, 0);
+        }
+        else if (expanded.find(parent) != expanded.end())
+        {
+            // The entity is the last child of its parent, so it goes after the rows of the parent's other children
+            unsigned int index = FindRow(listed, parent);
+            if (index < listed.rows.size())
+            {
+                InsertRows(listed, FindSubtreeEnd(listed, index), entity, listed.depths[index] + 1);
+            }
+        }
+        TriggerUpdate();
+    }
+
+    void SceneHierarchy::OnEntityRemoved(Entity* entity)
+    {
+        auto itr = sceneRows.find(entity->GetScene());
+        if (itr != sceneRows.end() && !itr->second.rebuild)
+        {
+            SceneRows& listed = itr->second;
+            unsigned int index = FindRow(listed, entity);
+            if (index < listed.rows.size())
+            {
+                EraseRows(listed, index);
+            }
+            TriggerUpdate();
+        }
+
+        // Forget the expanded state, as another entity may be created at the same address
+        if (!expanded.empty())
+        {
+            entity->GetScene()->WalkEntities([&] (Entity* removed) {
+                expanded.erase(removed);
+                return true;
+            }, false, entity);
+        }
+    }
+
+    void SceneHierarchy::OnEntityReparented(Entity* entity)
+    {
+        auto itr = sceneRows.find(entity->GetScene());
+        if (itr == sceneRows.end() || itr->second.rebuild)
+        {
+            return;
+        }
+        SceneRows& listed = itr->second;
+        // Remove the rows from their old position and add them under the new parent
+        unsigned int index = FindRow(listed, entity);
+        if (index < listed.rows.size())
+        {
+            EraseRows(listed, index);
+        }
+        OnEntityAdded(entity);
+    }
+
+    void SceneHierarchy::SetExpanded(Entity* entity, bool expand)
+    {
+        if (expand)
+        {
+            expanded.insert(entity);
+        }
+        else
+        {
+            expanded.erase(entity);
+        }
+
+        auto itr = sceneRows.find(entity->GetScene());
+        if (itr == sceneRows.end() || itr->second.rebuild)
+        {
+            return;
+        }
+        SceneRows& listed = itr->second;
+        unsigned int index = FindRow(listed, entity);
+        if (index < listed.rows.size())
+        {
+            // Replace the rows of the entity and its children
+            unsigned int depth = listed.depths[index];
+            EraseRows(listed, index);
+            InsertRows(listed, index, entity, depth);
+        }
+    }
+
 }
@@ -1,6 +1,10 @@
 #ifndef SCENEHIERARCHY_H
 #define SCENEHIERARCHY_H
 
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 #include "../Core/editorwindow.h"
 #include "../Core/project.h"
 
@@ -17,6 +21,8 @@ namespace Ossium::Editor
     class SceneHierarchy : public EditorWindow
     {
     public:
+        ~SceneHierarchy();
+
         void OnInit();
 
         void OnGUI();
@@ -28,6 +34,76 @@ namespace Ossium::Editor
         bool rightPressed = false;
         bool rightWasPressed = false;
 
+    private:
+        // The entities listed for a scene, in the order they are shown.
+        // Only the children of expanded entities are listed, and only the rows within the visible area are drawn.
+        struct SceneRows
+        {
+            std::vector<Entity*> rows;
+
+            // The depth of each row in the hierarchy when it was listed, so the rows of a subtree can be found
+            // even after its entities have been moved.
+            std::vector<unsigned int> depths;
+
+            // The index of each listed entity's row, by entity id.
+            std::unordered_map<int, unsigned int> indices;
+
+            // The indices of rows before this one are up to date. The rest are updated once per frame,
+            // rather than each time rows are inserted or erased.
+            unsigned int dirtyFrom = 0;
+
+            // When true, the rows are out of date and must be rebuilt before they are used.
+            bool rebuild = true;
+
+            // Handles of the scene callbacks that keep the rows up to date.
+            int addedHandle = 0;
+            int removedHandle = 0;
+            int reparentedHandle = 0;
+            int clearHandle = 0;
+            int destroyHandle = 0;
+        };
+
+        // Returns the rows of a scene, creating them and listening for changes to the scene if necessary.
+        SceneRows& GetRows(Scene* scene);
+
+        // Lists an entity and, if it is expanded, its children.
+        void AppendRows(Entity* entity, unsigned int depth, std::vector<Entity*>& rows, std::vector<unsigned int>& depths);
+
+        // Lists an entity and its expanded children at a row index.
+        void InsertRows(SceneRows& listed, unsigned int index, Entity* entity, unsigned int depth);
+
+        // Removes the row at an index along with the rows of its listed children.
+        void EraseRows(SceneRows& listed, unsigned int index);
+
+        // Marks the row indices of the entities listed at or after an index as out of date.
+        void SetIndicesDirty(SceneRows& listed, unsigned int first);
+
+        // Updates the out of date row indices.
+        void UpdateIndices(SceneRows& listed);
+
+        // Returns the index of an entity's row, or the number of rows if it isn't listed.
+        unsigned int FindRow(SceneRows& listed, Entity* entity);
+
+        // Returns the index after the last row of an entity's listed children and their children.
+        unsigned int FindSubtreeEnd(SceneRows& listed, unsigned int index);
+
+        // Scene callbacks.
+        void OnEntityAdded(Entity* entity);
+        void OnEntityRemoved(Entity* entity);
+        void OnEntityReparented(Entity* entity);
+
+        // Sets whether an entity shows its children.
+        void SetExpanded(Entity* entity, bool expand);
+
+        // Rows by scene.
+        std::unordered_map<Scene*, SceneRows> sceneRows;
+
+        // Entities whose children are listed.
+        std::unordered_set<Entity*> expanded;
+
+        // Height of a single entity row, measured when the first row is drawn.
+        float rowHeight = 0;
+
     };
 
 }
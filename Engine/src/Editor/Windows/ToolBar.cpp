@@ -142,7 +142,7 @@ namespace Ossium::Editor
                                 Scene* scene = resources->Find<Scene>(listedScene.path);
                                 if (scene != nullptr)
                                 {
-                                    scene->Save(listedScene.path);
+                                    scene->SaveAsync(listedScene.path);
                                 }
                             }
                         }
@@ -182,9 +182,21 @@ namespace Ossium::Editor
         // Edit
         //
 
-        // TODO: edit menus
-        //editor->AddCustomMenu("Edit/Undo", [] () {});
-        //editor->AddCustomMenu("Edit/Redo", [] () {});
+        editor->AddCustomMenu("Edit/Undo",
+            [&] () {
+                GetEditorLayout()->GetEditorController()->Undo();
+                TriggerUpdate();
+            },
+            [&] () { return GetEditorLayout()->GetEditorController()->GetUndoJournal()->CanUndo(); }
+        );
+
+        editor->AddCustomMenu("Edit/Redo",
+            [&] () {
+                GetEditorLayout()->GetEditorController()->Redo();
+                TriggerUpdate();
+            },
+            [&] () { return GetEditorLayout()->GetEditorController()->GetUndoJournal()->CanRedo(); }
+        );
 
 
         //
@@ -241,7 +253,7 @@ namespace Ossium::Editor
                     if (selectedEntity != nullptr)
                     {
                         // Nest under this entity
-                        selectedEntity->CreateChild();
+                        e->GetUndoJournal()->RecordCreate(selectedEntity->CreateChild());
                     }
                     else
                     {
@@ -249,7 +261,7 @@ namespace Ossium::Editor
                         if (selectedScene != nullptr)
                         {
                             // Add to end of the scene
-                            selectedScene->CreateEntity();
+                            e->GetUndoJournal()->RecordCreate(selectedScene->CreateEntity());
                         }
                         else
                         {
@@ -263,7 +275,7 @@ namespace Ossium::Editor
                                     Scene* insertScene = resources->Find<Scene>(scene.path);
                                     if (insertScene != nullptr)
                                     {
-                                        insertScene->CreateEntity();
+                                        e->GetUndoJournal()->RecordCreate(insertScene->CreateEntity());
                                     }
                                     else
                                     {
@@ -190,7 +190,10 @@ int main(int argc, char* argv[])
     }
 #else
     ResourceController resources;
-    EditorController* editor = new EditorController(&resources);
+    // One set of worker threads for everything, including scenes being saved by the editor
+    JobSystem jobs;
+    jobs.Init();
+    EditorController* editor = new EditorController(&resources, &jobs);
 
     while (editor->Update())
     {
@@ -201,6 +204,8 @@ int main(int argc, char* argv[])
 
     delete editor;
     editor = nullptr;
+    // Finishes any scenes that are still being saved
+    jobs.Quit();
 #endif
 
     TerminateOssium();
@@ -0,0 +1,10 @@
+$input normal, uv
+
+#include <bgfx_shader.sh>
+
+void main()
+{
+    // A fixed light so the shape of a mesh without a material can be seen
+    float light = 0.3 + 0.7 * max(dot(normalize(normal), normalize(vec3(-0.5, 0.5, 1.0))), 0.0);
+    gl_FragColor = vec4(light, light, light, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,11 @@
+$input a_position, a_normal, a_texcoord0
+$output normal, uv
+
+#include <bgfx_shader.sh>
+
+void main()
+{
+    gl_Position = mul(u_modelViewProj, vec4(a_position, 1.0));
+    normal = normalize(mul(u_model[0], vec4(a_normal, 0.0)).xyz);
+    uv = a_texcoord0;
+}
\ No newline at end of file
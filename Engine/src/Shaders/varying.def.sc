@@ -1,6 +1,8 @@
 vec2 uv             : TEXCOORD0 = vec2(0.0, 0.0);
 vec4 color          : COLOR0 = vec4(1.0, 1.0, 1.0, 1.0);
+vec3 normal         : NORMAL = vec3(0.0, 0.0, 1.0);
 
-vec2 a_position     : POSITION;
+vec3 a_position     : POSITION;
+vec3 a_normal       : NORMAL;
 vec2 a_texcoord0    : TEXCOORD0;
 vec4 a_color0       : COLOR0;
\ No newline at end of file
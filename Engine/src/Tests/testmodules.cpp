@@ -35,6 +35,29 @@ namespace Ossium
         int UnitTest::total_passed_test_asserts = 0;
         bool UnitTest::assert_result = true;
 
+        NoopBgfxScope::NoopBgfxScope()
+        {
+            // Calling this first makes bgfx render on this thread
+            bgfx::renderFrame();
+            bgfx::Init init;
+            init.type = bgfx::RendererType::Noop;
+            initialised = bgfx::init(init);
+        }
+
+        NoopBgfxScope::~NoopBgfxScope()
+        {
+            if (initialised)
+            {
+                bgfx::frame();
+                bgfx::shutdown();
+            }
+        }
+
+        bool NoopBgfxScope::IsInitialised()
+        {
+            return initialised;
+        }
+
     }
 #endif
 }
@@ -19,9 +19,12 @@
 
 #include <string>
 #include <unordered_map>
+#include <list>
 #include <iostream>
+#include <filesystem>
 
 #include "../Core/circularbuffer.h"
+#include "../Core/lrucache.h"
 #include "../Core/tree.h"
 #include "../Core/csvdata.h"
 #include "../Core/jsondata.h"
@@ -31,7 +34,21 @@
 #include "../Core/schemamodel.h"
 #include "../Core/randutils.h"
 #include "../Core/ecs.h"
+#include "../Core/audioengine.h"
+#include "../Core/audiodecoder.h"
+#include "../Core/jobsystem.h"
+#include "../Core/mesh.h"
+#include "../Core/material.h"
+#include "../Core/transform.h"
+#include "../Core/renderer.h"
+#include "../Core/rendergraph.h"
+#include "../Core/debugdraw.h"
+#include "../Editor/Core/undojournal.h"
 #include "../Components/text.h"
+#include "../Components/texture.h"
+#include "../Components/cachedcanvas.h"
+#include "../Components/camera.h"
+#include "../Components/model.h"
 
 using namespace std;
 
@@ -71,6 +88,24 @@ namespace Ossium
 
         };
 
+        /// Initialises bgfx with the no-op renderer until the end of the scope, which creates real handles without a window or GPU.
+        /// Declare it before anything that uses bgfx, so it shuts down last, and check IsInitialised() before using bgfx.
+        class OSSIUM_EDL NoopBgfxScope
+        {
+        public:
+            NoopBgfxScope();
+            ~NoopBgfxScope();
+
+            /// Did bgfx initialise successfully?
+            bool IsInitialised();
+
+        private:
+            NOCOPY(NoopBgfxScope);
+
+            bool initialised = false;
+
+        };
+
         /// Use this macro to run a unit test
         #define TEST_RUN(MODULE)                                                                                            \
                 Logger::EngineLog().Info("\n\nRunning unit test '" #MODULE "':");                                                            \
@@ -160,6 +195,12 @@ namespace Ossium
                 TEST_ASSERT(SplitLeft("1:2", ':') == "1");
                 TEST_ASSERT(SplitLeft("1111:2", ':') == "1111");
                 TEST_ASSERT(SplitLeft("-3:55", ':') == "-3");
+                TEST_ASSERT(Format("{0} is {1}{1}", "x", 2) == "x is 22");
+                TEST_ASSERT(Format("{0} {1} {2}", 0.1f, true, -7) == "0.1 1 -7");
+                TEST_ASSERT(Format("{0}/{1}", 4u, (Uint64)5) == "4/5");
+                TEST_ASSERT(Format("{0}{1}", (Uint8)'o', (Sint8)'k') == "ok");
+                TEST_ASSERT(Format("{} {a} \\{0} {9}", 3) == "  \\{0} ");
+                TEST_ASSERT(Format("{0} {1} {2} {3} {4} {5} {6} {7} {8} {9}", 0, 1, 2, 3, 4, 5, 6, 7, 8, 9) == "0 1 2 3 4 5 6 7 8 9");
 
                 Logger::EngineLog().Info("Type conversion tests.");
 
@@ -223,6 +264,547 @@ namespace Ossium
 
         };
 
+        /// The original list based LRU cache, kept as a baseline for benchmarking LRUCache.
+        template<typename T>
+        class ListLRUCache
+        {
+        public:
+            void PopLRU()
+            {
+                if (!cache.empty())
+                {
+                    accessLookup.erase(cache.back());
+                    cache.pop_back();
+                }
+            }
+
+            void Access(const T& data)
+            {
+                auto itr = accessLookup.find(data);
+                if (itr != accessLookup.end())
+                {
+                    cache.erase(itr->second);
+                }
+                cache.push_front(data);
+                accessLookup[data] = cache.begin();
+            }
+
+            unsigned int Size()
+            {
+                return accessLookup.size();
+            }
+
+        private:
+            std::list<T> cache;
+            std::unordered_map<T, typename std::list<T>::iterator> accessLookup;
+
+        };
+
+        class OSSIUM_EDL LRUCacheTests : public UnitTest
+        {
+        public:
+            void RunTest()
+            {
+                LRUCache<int> cache(3);
+                cache.Access(1);
+                cache.Access(2);
+                cache.Access(3);
+                TEST_ASSERT(cache.Size() == 3);
+                TEST_ASSERT(cache.GetLRU() == 1);
+
+                cache.Access(1);
+                TEST_ASSERT(cache.GetLRU() == 2);
+
+                // Full, so accessing a new value evicts the least recently used value.
+                cache.Access(4);
+                TEST_ASSERT(cache.Size() == 3);
+                TEST_ASSERT(!cache.Contains(2));
+                TEST_ASSERT(cache.GetLRU() == 3);
+
+                cache.Erase(3);
+                TEST_ASSERT(cache.GetLRU() == 1);
+                cache.PopLRU();
+                TEST_ASSERT(cache.GetLRU() == 4);
+                TEST_ASSERT(cache.Size() == 1);
+
+                cache.Clear();
+                TEST_ASSERT(cache.Size() == 0);
+                cache.Access(5);
+                TEST_ASSERT(cache.GetLRU() == 5);
+
+                Logger::EngineLog().Info("LRUCache benchmark.");
+
+                // Mimics the font glyph cache; mostly hits on a working set with occasional misses that evict.
+                const unsigned int capacity = 1536;
+                const unsigned int accesses = 2000000;
+                Rand rng(12345);
+                std::vector<int> keys;
+                keys.reserve(accesses);
+                for (unsigned int i = 0; i < accesses; i++)
+                {
+                    keys.push_back(rng.Int(0, i % 16 == 0 ? 0x1FFFF : capacity));
+                }
+
+                LRUCache<int> flat(capacity);
+                Uint64 start = SDL_GetPerformanceCounter();
+                for (int key : keys)
+                {
+                    flat.Access(key);
+                }
+                double flatTime = (double)(SDL_GetPerformanceCounter() - start) / (double)SDL_GetPerformanceFrequency();
+
+                ListLRUCache<int> listed;
+                start = SDL_GetPerformanceCounter();
+                for (int key : keys)
+                {
+                    if (listed.Size() >= capacity)
+                    {
+                        listed.PopLRU();
+                    }
+                    listed.Access(key);
+                }
+                double listTime = (double)(SDL_GetPerformanceCounter() - start) / (double)SDL_GetPerformanceFrequency();
+
+                Logger::EngineLog().Info("{0} accesses: LRUCache took {1}s, list based cache took {2}s.", accesses, flatTime, listTime);
+                TEST_ASSERT(flat.Size() == listed.Size());
+            }
+
+        };
+
+        class OSSIUM_EDL AudioEngineTests : public UnitTest
+        {
+        public:
+            void RunTest()
+            {
+                // Mixes offline, so no audio device is required.
+                Audio::Internals::AudioEngine engine;
+                engine.Setup(4, 48000);
+
+                std::vector<float> clip(2 * 1024, 0.5f);
+                std::vector<float> output(2 * 1024);
+
+                Logger::EngineLog().Info("Voices and buses.");
+                int bus = engine.CreateBus();
+                int voice = engine.PlayVoice(nullptr, &clip[0], 1024, bus, 1.0f, 1.0f);
+                TEST_ASSERT(voice >= 0);
+                TEST_ASSERT(engine.GetActiveVoices() == 1);
+                engine.Render(&output[0], 1024);
+                TEST_ASSERT(output[0] == 0.5f && output[2047] == 0.5f);
+
+                // Finished voices are released on Update().
+                engine.Render(&output[0], 1024);
+                TEST_ASSERT(output[0] == 0.0f);
+                engine.Update();
+                TEST_ASSERT(engine.GetActiveVoices() == 0);
+
+                Logger::EngineLog().Info("Half speed resampling.");
+                for (unsigned int i = 0; i < 1024; i++)
+                {
+                    clip[i * 2] = (float)i;
+                }
+                engine.PlayVoice(nullptr, &clip[0], 1024, -1, 1.0f, 1.0f, 0, 0.5f);
+                engine.Render(&output[0], 1024);
+                TEST_ASSERT(output[2] == 0.5f && output[2 * 101] == 50.5f);
+                engine.StopAllUsing(&clip[0]);
+                TEST_ASSERT(engine.GetActiveVoices() == 0);
+
+                Logger::EngineLog().Info("Voice virtualisation.");
+                voice = engine.PlayVoice(nullptr, &clip[0], 1024, -1, 1.0f, 1.0f, -1);
+                engine.SetVoiceVirtual(voice, true);
+                TEST_ASSERT(engine.IsVoiceVirtual(voice) && engine.GetRealVoices() == 0);
+                // Fades out over one block, then silent while the cursor keeps advancing.
+                engine.Render(&output[0], 512);
+                engine.Render(&output[0], 256);
+                TEST_ASSERT(output[0] == 0.0f && output[511] == 0.0f);
+                // Fades back in from where the cursor got to.
+                engine.SetVoiceVirtual(voice, false);
+                engine.Render(&output[0], 4);
+                TEST_ASSERT(output[0] == 0.0f && output[6] == 771.0f * 0.75f);
+                engine.StopAllUsing(&clip[0]);
+
+                // Voices beyond the mix budget are not mixed.
+                engine.SetMixBudget(1);
+                engine.PlayVoice(nullptr, &clip[0], 1024, -1, 1.0f, 1.0f);
+                engine.PlayVoice(nullptr, &clip[0], 1024, -1, 1.0f, 1.0f);
+                engine.Render(&output[0], 512);
+                engine.Render(&output[0], 4);
+                TEST_ASSERT(output[6] == 515.0f);
+                engine.StopAllUsing(&clip[0]);
+
+                // The budget goes to the highest priority voices rather than the lowest voice indices.
+                engine.PlayVoice(nullptr, &clip[0], 1024, -1, 1.0f, 1.0f);
+                voice = engine.PlayVoice(nullptr, &clip[0], 1024, -1, 0.5f, 0.5f);
+                engine.SetVoicePriority(voice, 2.0f);
+                engine.Render(&output[0], 512);
+                engine.Render(&output[0], 4);
+                TEST_ASSERT(output[6] == 515.0f * 0.5f);
+                engine.StopAllUsing(&clip[0]);
+                engine.SetMixBudget(4);
+
+                Logger::EngineLog().Info("Bus inserts.");
+                std::vector<float> loud(2 * 1024, 1.0f);
+                int master = engine.CreateBus();
+                engine.SetBusOutput(bus, master);
+                engine.SetBusInsert(master, 0, AudioInsert::LowPass(100.0f));
+                engine.SetBusInsert(master, 1, AudioInsert::Compressor(0.25f, 4.0f));
+                engine.PlayVoice(nullptr, &loud[0], 1024, bus, 1.0f, 1.0f, -1);
+                for (unsigned int i = 0; i < 32; i++)
+                {
+                    engine.Render(&output[0], 1024);
+                }
+                // Settles at the threshold plus a quarter of the excess.
+                TEST_ASSERT(fabs(output[0] - 0.4375f) < 0.001f);
+
+                engine.Clear();
+            }
+
+        };
+
+        class OSSIUM_EDL AudioDecoderTests : public UnitTest
+        {
+        public:
+            void RunTest()
+            {
+                std::vector<float> samples;
+
+                Logger::EngineLog().Info("WAV decoding.");
+                // 16 bit stereo PCM at 44.1 kHz, left is i * 1000 and right is -i * 1000
+                Uint8 wavData[44 + 16 * 4];
+                memcpy(wavData, "RIFF", 4);
+                WriteLE(wavData + 4, sizeof(wavData) - 8, 4);
+                memcpy(wavData + 8, "WAVEfmt ", 8);
+                WriteLE(wavData + 16, 16, 4);
+                WriteLE(wavData + 20, 1, 2);
+                WriteLE(wavData + 22, 2, 2);
+                WriteLE(wavData + 24, 44100, 4);
+                WriteLE(wavData + 28, 44100 * 4, 4);
+                WriteLE(wavData + 32, 4, 2);
+                WriteLE(wavData + 34, 16, 2);
+                memcpy(wavData + 36, "data", 4);
+                WriteLE(wavData + 40, 16 * 4, 4);
+                for (unsigned int i = 0; i < 16; i++)
+                {
+                    WriteLE(wavData + 44 + i * 4, i * 1000, 2);
+                    WriteLE(wavData + 46 + i * 4, (Uint32)(-(int)i * 1000), 2);
+                }
+                TEST_ASSERT(Decode("decodertest.wav", wavData, sizeof(wavData), 44100, samples));
+                TEST_ASSERT(samples.size() == 16 * 2 && IsRamp(samples));
+
+                Logger::EngineLog().Info("FLAC decoding.");
+                // The same ramp as the WAV file continued to 32 samples, in two frames of verbatim subframes
+                static const Uint8 flacData[] = {
+                    0x66, 0x4C, 0x61, 0x43, 0x80, 0x00, 0x00, 0x22, 0x00, 0x10, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00,
+                    0x00, 0x00, 0x0A, 0xC4, 0x42, 0xF0, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xF8, 0x60, 0x18, 0x00, 0x0F,
+                    0x34, 0x02, 0x00, 0x00, 0x03, 0xE8, 0x07, 0xD0, 0x0B, 0xB8, 0x0F, 0xA0, 0x13, 0x88, 0x17, 0x70,
+                    0x1B, 0x58, 0x1F, 0x40, 0x23, 0x28, 0x27, 0x10, 0x2A, 0xF8, 0x2E, 0xE0, 0x32, 0xC8, 0x36, 0xB0,
+                    0x3A, 0x98, 0x02, 0x00, 0x00, 0xFC, 0x18, 0xF8, 0x30, 0xF4, 0x48, 0xF0, 0x60, 0xEC, 0x78, 0xE8,
+                    0x90, 0xE4, 0xA8, 0xE0, 0xC0, 0xDC, 0xD8, 0xD8, 0xF0, 0xD5, 0x08, 0xD1, 0x20, 0xCD, 0x38, 0xC9,
+                    0x50, 0xC5, 0x68, 0x90, 0xC2, 0xFF, 0xF8, 0x60, 0x18, 0x01, 0x0F, 0x21, 0x02, 0x3E, 0x80, 0x42,
+                    0x68, 0x46, 0x50, 0x4A, 0x38, 0x4E, 0x20, 0x52, 0x08, 0x55, 0xF0, 0x59, 0xD8, 0x5D, 0xC0, 0x61,
+                    0xA8, 0x65, 0x90, 0x69, 0x78, 0x6D, 0x60, 0x71, 0x48, 0x75, 0x30, 0x79, 0x18, 0x02, 0xC1, 0x80,
+                    0xBD, 0x98, 0xB9, 0xB0, 0xB5, 0xC8, 0xB1, 0xE0, 0xAD, 0xF8, 0xAA, 0x10, 0xA6, 0x28, 0xA2, 0x40,
+                    0x9E, 0x58, 0x9A, 0x70, 0x96, 0x88, 0x92, 0xA0, 0x8E, 0xB8, 0x8A, 0xD0, 0x86, 0xE8, 0x8C, 0xE4,
+                };
+                TEST_ASSERT(Decode("decodertest.flac", flacData, sizeof(flacData), 44100, samples));
+                TEST_ASSERT(samples.size() == 32 * 2 && IsRamp(samples));
+
+                Logger::EngineLog().Info("Ogg Vorbis decoding.");
+                // Stereo at 22.05 kHz with one codebook, floor, residue, mapping and mode. Every packet
+                // marks both floors as unused, so all the decoded samples are exactly zero.
+                static const Uint8 oggData[] = {
+                    0x4F, 0x67, 0x67, 0x53, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x53, 0x4F,
+                    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x51, 0xE2, 0xA7, 0xB7, 0x01, 0x1E, 0x01, 0x76, 0x6F, 0x72,
+                    0x62, 0x69, 0x73, 0x00, 0x00, 0x00, 0x00, 0x02, 0x22, 0x56, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x88, 0x01, 0x4F, 0x67, 0x67, 0x53, 0x00, 0x00,
+                    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x53, 0x4F, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+                    0x51, 0xAB, 0x4C, 0x3E, 0x02, 0x16, 0x34, 0x03, 0x76, 0x6F, 0x72, 0x62, 0x69, 0x73, 0x06, 0x00,
+                    0x00, 0x00, 0x4F, 0x73, 0x73, 0x69, 0x75, 0x6D, 0x00, 0x00, 0x00, 0x00, 0x01, 0x05, 0x76, 0x6F,
+                    0x72, 0x62, 0x69, 0x73, 0x00, 0x42, 0x43, 0x56, 0x01, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00,
+                    0x00, 0x00, 0x10, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                    0x01, 0x4F, 0x67, 0x67, 0x53, 0x00, 0x04, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x53,
+                    0x4F, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x90, 0xF2, 0x59, 0xE0, 0x09, 0x01, 0x01, 0x01, 0x01,
+                    0x01, 0x01, 0x01, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                };
+                TEST_ASSERT(Decode("decodertest.ogg", oggData, sizeof(oggData), 22050, samples));
+                bool silent = !samples.empty() && samples.size() <= 1024 * 2;
+                for (unsigned int i = 0, counti = samples.size(); i < counti; i++)
+                {
+                    silent &= samples[i] == 0.0f;
+                }
+                TEST_ASSERT(silent);
+
+                // Unsupported file types are rejected by extension
+                TEST_ASSERT(Audio::Internals::AudioDecoder::Create("decodertest.mp3") == nullptr);
+            }
+
+        private:
+            void WriteLE(Uint8* dest, Uint32 value, unsigned int bytes)
+            {
+                for (unsigned int i = 0; i < bytes; i++)
+                {
+                    dest[i] = (Uint8)(value >> (i * 8));
+                }
+            }
+
+            /// Writes the data to a file and decodes all of it, checking the decoder reports a stereo stream at the sample rate.
+            bool Decode(const string& path, const Uint8* data, size_t size, int sampleRate, std::vector<float>& samples)
+            {
+                samples.clear();
+                SDL_RWops* file = SDL_RWFromFile(path.c_str(), "wb");
+                if (file == NULL)
+                {
+                    return false;
+                }
+                bool written = SDL_RWwrite(file, data, 1, size) == size;
+                SDL_RWclose(file);
+
+                Audio::Internals::AudioDecoder* decoder = written ? Audio::Internals::AudioDecoder::Create(path) : nullptr;
+                bool valid = decoder != nullptr && decoder->GetSampleRate() == sampleRate && decoder->GetChannels() == 2;
+                if (valid)
+                {
+                    float block[64 * 2];
+                    for (Uint32 frames = decoder->Decode(block, 64); frames > 0; frames = decoder->Decode(block, 64))
+                    {
+                        samples.insert(samples.end(), block, block + frames * 2);
+                    }
+                    // Rewinding decodes the same samples again
+                    valid = decoder->Rewind() && decoder->Decode(block, 1) == 1 && block[0] == samples[0] && block[1] == samples[1];
+                }
+                delete decoder;
+                remove(path.c_str());
+                return valid;
+            }
+
+            /// Checks decoded samples are the ramp of i * 1000 on the left and -i * 1000 on the right.
+            bool IsRamp(const std::vector<float>& samples)
+            {
+                bool ramp = true;
+                for (unsigned int i = 0, counti = samples.size() / 2; i < counti; i++)
+                {
+                    float expected = (float)(i * 1000) / 32768.0f;
+                    ramp &= fabs(samples[i * 2] - expected) < 0.0001f && fabs(samples[i * 2 + 1] + expected) < 0.0001f;
+                }
+                return ramp;
+            }
+
+        };
+
+        class OSSIUM_EDL JobSystemTests : public UnitTest
+        {
+        public:
+            void RunTest()
+            {
+                JobSystem jobs;
+                jobs.Init(3);
+
+                Logger::EngineLog().Info("Parallel for.");
+                std::vector<int> values(10000, 0);
+                jobs.ParallelFor(values.size(), 64, [&] (unsigned int begin, unsigned int end) {
+                    for (unsigned int i = begin; i < end; i++)
+                    {
+                        values[i] += i;
+                    }
+                });
+                bool correct = true;
+                for (unsigned int i = 0, counti = values.size(); i < counti; i++)
+                {
+                    correct &= values[i] == (int)i;
+                }
+                TEST_ASSERT(correct);
+
+                Logger::EngineLog().Info("Dependencies and nested waits.");
+                JobCounter first;
+                JobCounter second;
+                std::atomic<int> total = {0};
+                std::atomic<bool> ordered = {true};
+                for (unsigned int i = 0; i < 100; i++)
+                {
+                    jobs.Run([&] () {
+                        JobCounter nested;
+                        for (unsigned int j = 0; j < 10; j++)
+                        {
+                            jobs.Run([&] () { total++; }, &nested);
+                        }
+                        jobs.Wait(nested);
+                    }, &first);
+                }
+                jobs.Run([&] () { ordered = total.load() == 1000; }, &second, &first);
+                jobs.Wait(second);
+                TEST_ASSERT(first.IsDone() && total.load() == 1000 && ordered);
+
+                Logger::EngineLog().Info("Dependency chains.");
+                // Each job only starts once the previous one has finished, wherever it runs.
+                JobCounter chain[8];
+                std::atomic<int> step = {0};
+                std::atomic<bool> inOrder = {true};
+                for (int i = 0; i < 8; i++)
+                {
+                    jobs.Run([&, i] () { inOrder = inOrder && step.fetch_add(1) == i; }, &chain[i], i > 0 ? &chain[i - 1] : nullptr);
+                }
+                jobs.Wait(chain[7]);
+                TEST_ASSERT(step.load() == 8 && inOrder);
+
+                jobs.Quit();
+
+                Logger::EngineLog().Info("Separate job systems on one thread.");
+                // With no worker threads, jobs only run on the thread that waits for them, which must still be
+                // recognised as a worker of each job system.
+                JobSystem a;
+                JobSystem b;
+                a.Init(0);
+                b.Init(0);
+                JobCounter counterA;
+                JobCounter counterB;
+                int ranA = 0;
+                int ranB = 0;
+                a.Run([&] () { ranA++; }, &counterA);
+                b.Run([&] () { ranB++; }, &counterB);
+                a.Wait(counterA);
+                b.Quit();
+                a.Run([&] () { ranA++; }, &counterA);
+                a.Wait(counterA);
+                TEST_ASSERT(ranA == 2 && ranB == 1);
+                a.Quit();
+            }
+
+        };
+
+        class OSSIUM_EDL MeshTests : public UnitTest
+        {
+        public:
+            void RunTest()
+            {
+                const std::string path = "meshtest.obj";
+                const std::string cachePath = Mesh::GetCachePath(path);
+                std::filesystem::remove(cachePath);
+
+                Logger::EngineLog().Info("OBJ parsing.");
+                // A quad with a single u texture coordinate and a comment after the face
+                const std::string quad =
+                    "# quad\n"
+                    "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+                    "vt 0.5\nvt 1 1\n"
+                    "vn 0 0 1\n"
+                    "f 1/1/1 2/2/1 3/2/1 4/1/1 # fan\n";
+                WriteFile(path, quad);
+                Mesh mesh;
+                TEST_ASSERT(mesh.Load(path));
+                TEST_ASSERT(mesh.vertices.size() == 4 && mesh.indices.size() == 6);
+                TEST_ASSERT(mesh.vertices[0].uv[0] == 0.5f && mesh.vertices[0].uv[1] == 0.0f && mesh.vertices[2].normal[2] == 1.0f);
+                TEST_ASSERT(mesh.vertices[3].position[1] == 1.0f);
+                TEST_ASSERT(mesh.indices[3] == 0 && mesh.indices[4] == 2 && mesh.indices[5] == 3);
+
+                // Relative indices count back from the last vertex, and elements already used are shared
+                WriteFile("meshtest_relative.obj", "v 0 0 0\nv 1 0 0\nv 1 1 0\nf -3 -2 -1\nf 1 2 3\n");
+                Mesh relative;
+                TEST_ASSERT(relative.Load("meshtest_relative.obj"));
+                TEST_ASSERT(relative.vertices.size() == 3 && relative.indices.size() == 6 && relative.indices[5] == 2);
+
+                // Indices out of range are errors
+                WriteFile("meshtest_invalid.obj", "v 0 0 0\nv 1 0 0\nf 1 2 3\n");
+                Mesh invalid;
+                TEST_ASSERT(!invalid.Load("meshtest_invalid.obj") && invalid.vertices.empty());
+
+                Logger::EngineLog().Info("Mesh cache validation.");
+                TEST_ASSERT(std::filesystem::exists(cachePath));
+                // An edit that keeps the size and modification time can't be detected, so the cache is still used
+                std::string moved = quad;
+                moved.replace(moved.find("v 0 1 0"), 7, "v 0 2 0");
+                std::filesystem::file_time_type time = std::filesystem::last_write_time(path);
+                WriteFile(path, moved);
+                std::filesystem::last_write_time(path, time);
+                Mesh cached;
+                TEST_ASSERT(cached.Load(path) && cached.vertices[3].position[1] == 1.0f);
+                // A different modification time invalidates the cache
+                std::filesystem::last_write_time(path, time + std::chrono::seconds(10));
+                Mesh touched;
+                TEST_ASSERT(touched.Load(path) && touched.vertices[3].position[1] == 2.0f);
+                // So does a different size, even with the same modification time
+                time = std::filesystem::last_write_time(path);
+                moved.replace(moved.find("v 0 2 0"), 7, "v 0 3.0 0");
+                WriteFile(path, moved);
+                std::filesystem::last_write_time(path, time);
+                Mesh resized;
+                TEST_ASSERT(resized.Load(path) && resized.vertices[3].position[1] == 3.0f);
+
+                Logger::EngineLog().Info("MTL parsing.");
+                WriteFile("meshtest.mtl",
+                    "newmtl Brick Wall\n"
+                    "Ka 0.5 # grey\n"
+                    "Kd 1 0.5 0.25\n"
+                    "Ns 10\n"
+                    "Tr 0.25\n"
+                    "map_Kd textures/brick wall.png \n"
+                    "newmtl Other\n"
+                    "Kd 0 0 0\n"
+                );
+                Material material;
+                TEST_ASSERT(material.Load("meshtest.mtl"));
+                TEST_ASSERT(material.name == "Brick Wall" && material.diffuseMap == "textures/brick wall.png");
+                TEST_ASSERT(material.ambient.x == 0.5f && material.ambient.z == 0.5f && material.diffuse.y == 0.5f && material.diffuse.z == 0.25f);
+                TEST_ASSERT(material.shininess == 10.0f && material.dissolve == 0.75f);
+
+                Logger::EngineLog().Info("Mesh GPU buffers.");
+                NoopBgfxScope noop;
+                if (noop.IsInitialised())
+                {
+                    Mesh gpu;
+                    TEST_ASSERT(gpu.Load(path) && !gpu.HasBuffers() && gpu.GetBufferedIndexCount() == 0);
+                    TEST_ASSERT(gpu.Init(nullptr) && gpu.HasBuffers() && gpu.GetBufferedIndexCount() == 6);
+                    // The bounds enclose the quad, which was last stretched to 3 units high
+                    Vector3 centre;
+                    float radius = 0;
+                    TEST_ASSERT(gpu.GetRenderBounds(centre, radius));
+                    TEST_ASSERT(centre.x == 0.5f && centre.y == 1.5f && centre.z == 0.0f && abs(radius - sqrt(2.5f)) < 0.0001f);
+                    // Static buffers can't be updated
+                    TEST_ASSERT(!gpu.UpdateBuffers());
+                    gpu.FreeBuffers();
+                    TEST_ASSERT(!gpu.HasBuffers() && gpu.GetBufferedIndexCount() == 0 && !gpu.GetRenderBounds(centre, radius));
+
+                    // Dynamic buffers draw whatever was last updated
+                    gpu.SetDynamic(true);
+                    TEST_ASSERT(gpu.Init(nullptr) && gpu.HasBuffers() && gpu.GetBufferedIndexCount() == 6);
+                    gpu.indices.resize(3);
+                    TEST_ASSERT(gpu.UpdateBuffers() && gpu.GetBufferedIndexCount() == 3);
+                    bgfx::frame();
+                    gpu.indices = {0, 1, 2, 0, 2, 3, 0, 1, 3};
+                    TEST_ASSERT(gpu.UpdateBuffers() && gpu.GetBufferedIndexCount() == 9);
+                    // The bounds follow the updated vertices
+                    gpu.vertices[2].position[0] = 3.0f;
+                    TEST_ASSERT(gpu.UpdateBuffers() && gpu.GetRenderBounds(centre, radius) && centre.x == 1.5f);
+                    gpu.FreeBuffers();
+                    TEST_ASSERT(!gpu.HasBuffers() && !gpu.UpdateBuffers());
+
+                    // Meshes without faces don't get static buffers
+                    Mesh empty;
+                    TEST_ASSERT(!empty.Init(nullptr) && !empty.HasBuffers());
+                }
+                else
+                {
+                    Logger::EngineLog().Warning("Failed to initialise bgfx, skipping mesh GPU buffer tests.");
+                }
+
+                for (const char* file : {"meshtest.obj", "meshtest_relative.obj", "meshtest_invalid.obj", "meshtest.omesh", "meshtest_relative.omesh", "meshtest.mtl"})
+                {
+                    std::filesystem::remove(file);
+                }
+            }
+
+        private:
+            void WriteFile(const std::string& path, const std::string& contents)
+            {
+                SDL_RWops* file = SDL_RWFromFile(path.c_str(), "wb");
+                if (file != NULL)
+                {
+                    SDL_RWwrite(file, contents.data(), 1, contents.size());
+                    SDL_RWclose(file);
+                }
+            }
+
+        };
+
         class OSSIUM_EDL TreeTests : public UnitTest
         {
         public:
@@ -551,6 +1133,27 @@ namespace Ossium
                 JSON output;
                 SerialiseOut(output);
                 output.Export("assets/test_serialise_out.json");
+
+                /// Only the hashes of modified members change
+                vector<Uint64> hashes;
+                HashMembers(hashes);
+                TEST_ASSERT(hashes.size() == GetMemberCount());
+                degree += "!";
+                vector<Uint64> modified;
+                HashMembers(modified);
+                for (unsigned int i = 0; i < GetMemberCount(); i++)
+                {
+                    TEST_ASSERT((hashes[i] != modified[i]) == (string(GetMemberName(i)) == "degree"));
+                }
+
+                /// Values are hashed by value rather than by their bytes
+                float zero = 0.0f;
+                float negativeZero = -0.0f;
+                TEST_ASSERT(Utilities::HashValue(zero) == Utilities::HashValue(negativeZero));
+                Vector2 a = Vector2(1.0f, 0.0f);
+                Vector2 b = Vector2(1.0f, -0.0f);
+                Vector2 c = Vector2(1.0f, 2.0f);
+                TEST_ASSERT(Utilities::HashValue(a) == Utilities::HashValue(b) && Utilities::HashValue(a) != Utilities::HashValue(c));
             }
 
         };
@@ -575,6 +1178,83 @@ namespace Ossium
             }
         };
 
+        class OSSIUM_EDL CullingTests : public UnitTest
+        {
+        public:
+            void RunTest()
+            {
+                Rect viewport = Rect(0, 0, 100, 100);
+                TEST_ASSERT(Rect(90, 90, 20, 20).Intersects(viewport));
+                TEST_ASSERT(Rect(-10, 50, 5, 5).Intersects(viewport) == false);
+                TEST_ASSERT(Rect(150, 50, 5, 5).Intersects(viewport) == false);
+                TEST_ASSERT(Rect(50, 120, 5, 5).Intersects(viewport) == false);
+
+                // Camera at the origin looking along the z axis with a 90 degree field of view
+                Frustum frustum = Frustum(Matrix<4, 4>::Perspective(Constants::pi / 2.0f, 1.0f, 1.0f, 100.0f));
+                TEST_ASSERT(frustum.Intersects(Vector3(0, 0, 5), 0.1f));
+                TEST_ASSERT(frustum.Intersects(Vector3(7, 0, 5), 3.0f));
+                TEST_ASSERT(frustum.Intersects(Vector3(0, 0, -5), 1.0f) == false);
+                TEST_ASSERT(frustum.Intersects(Vector3(0, 0, 200), 1.0f) == false);
+                TEST_ASSERT(frustum.Intersects(Vector3(50, 0, 5), 1.0f) == false);
+                TEST_ASSERT(frustum.Intersects(Vector3(-1, -1, 4), Vector3(1, 1, 6)));
+                TEST_ASSERT(frustum.Intersects(Vector3(10, -1, 4), Vector3(12, 1, 6)) == false);
+
+                NoopBgfxScope noop;
+                if (!noop.IsInitialised())
+                {
+                    Logger::EngineLog().Warning("Failed to initialise bgfx, skipping camera culling tests.");
+                    return;
+                }
+                RenderViewPool pool;
+                RenderTexture target;
+                target.Create(64, 64);
+                Renderer renderer(&target, &pool);
+                ResourceController resources;
+                ServicesProvider services(&renderer, &resources);
+                Scene scene(&services);
+
+                // One triangle in front of the camera and one far off to the side
+                for (auto file : {make_pair("culltest_visible.obj", "v 0 0 5\nv 1 0 5\nv 0 1 5\nf 1 2 3\n"), make_pair("culltest_hidden.obj", "v 100 0 5\nv 101 0 5\nv 100 1 5\nf 1 2 3\n")})
+                {
+                    SDL_RWops* rw = SDL_RWFromFile(file.first, "wb");
+                    if (rw != NULL)
+                    {
+                        SDL_RWwrite(rw, file.second, 1, strlen(file.second));
+                        SDL_RWclose(rw);
+                    }
+                }
+                TEST_ASSERT(resources.LoadAndInit<Mesh>("culltest_visible.obj", &resources) != nullptr);
+                TEST_ASSERT(resources.LoadAndInit<Mesh>("culltest_hidden.obj", &resources) != nullptr);
+
+                Camera* camera = scene.CreateEntity()->AddComponent<Camera>();
+                Model* visible = scene.CreateEntity()->AddComponent<Model>();
+                visible->meshes.push_back("culltest_visible.obj");
+                Model* hidden = scene.CreateEntity()->AddComponent<Model>();
+                hidden->meshes.push_back("culltest_hidden.obj");
+
+                Logger::EngineLog().Info("Models are bounded by the spheres of their meshes.");
+                Vector3 centre;
+                float radius = 0;
+                TEST_ASSERT(hidden->GetRenderBounds(centre, radius) && centre.x == 100.5f && centre.z == 5.0f && radius > 0);
+                hidden->meshes.push_back("culltest_visible.obj");
+                TEST_ASSERT(hidden->GetRenderBounds(centre, radius) && abs(centre.x - 50.5f) < 0.001f && radius > 50.0f);
+                hidden->meshes.pop_back();
+
+                Logger::EngineLog().Info("Cameras skip models outside of their view.");
+                camera->Render();
+                TEST_ASSERT(camera->GetCulledCount() == 1);
+                hidden->meshes.clear();
+                camera->Render();
+                TEST_ASSERT(camera->GetCulledCount() == 0);
+
+                resources.FreeAll();
+                for (const char* file : {"culltest_visible.obj", "culltest_hidden.obj", "culltest_visible.omesh", "culltest_hidden.omesh"})
+                {
+                    std::filesystem::remove(file);
+                }
+            }
+        };
+
         class OSSIUM_EDL EntitySerialisationTests : public UnitTest
         {
         public:
@@ -600,11 +1280,611 @@ namespace Ossium
 
                     JSON output(ecs.ToString());
                     output.Export("assets/test_ecs_serialise_out.json");
+
+                    // Snapshots must match ToString(), including after an entity changes
+                    TEST_ASSERT(ecs.Snapshot()->ToString() == ecs.ToString());
+                    Uint64 hash = ecs.Snapshot()->GetHash();
+                    TEST_ASSERT(ecs.Snapshot()->GetHash() == hash);
+                    ecs.CreateEntity()->name = "Snapshot";
+                    TEST_ASSERT(ecs.Snapshot()->ToString() == ecs.ToString());
+                    // The hash only changes when the scene does
+                    TEST_ASSERT(ecs.Snapshot()->GetHash() != hash);
+
+                    // Streaming the same file in again adds a copy of every entity under new ids
+                    unsigned int total = ecs.GetTotalEntities();
+                    Uint32 chunk = ecs.StreamIn("assets/test_ecs_serialise_in.json");
+                    while (!ecs.IsStreamedIn(chunk))
+                    {
+                        ecs.UpdateStreaming();
+                    }
+                    TEST_ASSERT(ecs.GetTotalEntities() == total + data.size());
+                    ecs.StreamOut(chunk);
+                    for (unsigned int i = 0; i < data.size() && ecs.GetTotalEntities() > total; i++)
+                    {
+                        ecs.UpdateStreaming();
+                    }
+                    TEST_ASSERT(ecs.GetTotalEntities() == total);
+                }
+
+                // Entities that are still streaming in are kept out of updates and rendering
+                Scene source;
+                for (unsigned int i = 0; i < 256; i++)
+                {
+                    source.CreateEntity()->AddComponent<Transform>();
+                }
+                TEST_ASSERT(source.Save("test_ecs_stream.json"));
+                Scene streaming;
+                streaming.SetStreamingBudget(0.01f);
+                Uint32 streamed = streaming.StreamIn("test_ecs_stream.json");
+                while (!streaming.IsStreamedIn(streamed))
+                {
+                    streaming.UpdateStreaming();
+                    bool finished = streaming.IsStreamedIn(streamed);
+                    streaming.WalkEntities([&] (Entity* entity) {
+                        TEST_ASSERT(entity->IsActive() == finished);
+                        for (Transform* transform : entity->GetComponents<Transform>())
+                        {
+                            TEST_ASSERT(transform->IsActiveAndEnabled() == finished);
+                        }
+                        return true;
+                    });
+                }
+                TEST_ASSERT(streaming.GetTotalEntities() == 256);
+                std::filesystem::remove("test_ecs_stream.json");
+
+                // Reparenting only notifies listeners when the parent changes
+                Entity* parent = ecs.CreateEntity();
+                Entity* child = ecs.CreateEntity();
+                unsigned int reparented = 0;
+                int handle = ecs.onEntityReparented += [&] (Entity* entity) { reparented++; };
+                child->SetParent(parent);
+                child->SetParent(parent);
+                TEST_ASSERT(reparented == 1 && child->GetParent() == parent);
+                child->SetParent(nullptr);
+                child->SetParent(nullptr);
+                TEST_ASSERT(reparented == 2 && child->GetParent() == nullptr);
+                ecs.onEntityReparented -= handle;
+            }
+        };
+
+        class OSSIUM_EDL UndoJournalTests : public UnitTest
+        {
+        public:
+            void RunTest()
+            {
+                Scene scene;
+                Editor::UndoJournal journal;
+                Entity* entity = scene.CreateEntity();
+                Transform* transform = entity->AddComponent<Transform>();
+                const char* relative = nullptr;
+                bool* isRelative = nullptr;
+                for (unsigned int i = 0, counti = transform->GetMemberCount(); i < counti; i++)
+                {
+                    if (string(transform->GetMemberName(i)) == "relative")
+                    {
+                        relative = transform->GetMemberName(i);
+                        isRelative = (bool*)transform->GetMember(i);
+                    }
                 }
+                TEST_ASSERT(relative != nullptr);
+                const string on = Utilities::ToString(true);
+                const string off = Utilities::ToString(false);
+
+                Logger::EngineLog().Info("Undo and redo member changes.");
+                transform->SetRelativeToParent(false);
+                journal.RecordMember(transform, relative, on, off);
+                TEST_ASSERT(journal.CanUndo() && !journal.CanRedo());
+                TEST_ASSERT(journal.Undo() && *isRelative && journal.CanRedo());
+                TEST_ASSERT(journal.Redo() && !*isRelative && !journal.CanRedo());
+
+                Logger::EngineLog().Info("Coalesce continuous changes.");
+                // Undoing and redoing seals the last edit, so these two changes are merged into a new edit
+                journal.RecordMember(transform, relative, off, on);
+                journal.RecordMember(transform, relative, on, off);
+                TEST_ASSERT(journal.Undo() && !*isRelative && journal.CanUndo());
+                TEST_ASSERT(journal.Undo() && *isRelative && !journal.CanUndo());
+                // Recording drops the edits that were undone
+                journal.RecordMember(transform, relative, on, off);
+                TEST_ASSERT(!journal.CanRedo());
+                // Sealed edits aren't merged
+                journal.Seal();
+                journal.RecordMember(transform, relative, off, on);
+                TEST_ASSERT(journal.Undo() && journal.CanUndo() && journal.Undo() && !journal.CanUndo());
+
+                Logger::EngineLog().Info("Undo and redo entity creation.");
+                Entity* created = scene.CreateEntity();
+                int id = created->GetID();
+                journal.RecordCreate(created);
+                TEST_ASSERT(journal.Undo() && scene.GetEntity(id) == nullptr);
+                TEST_ASSERT(journal.Redo() && scene.GetEntity(id) != nullptr);
+
+                Logger::EngineLog().Info("Loading a scene clears its edits.");
+                scene.FromString(scene.ToString());
+                TEST_ASSERT(!journal.CanUndo() && !journal.CanRedo() && journal.GetBytes() == 0);
+            }
 
+        };
+
+
+        class OSSIUM_EDL CachedCanvasTests : public UnitTest
+        {
+        public:
+            void RunTest()
+            {
+                Logger::EngineLog().Info("Blend states.");
+                TEST_ASSERT(GetBlendState(SDL_BLENDMODE_BLEND) == OSSIUM_BLEND_STANDARD);
+                TEST_ASSERT(GetBlendState(GetPremultipliedBlendMode()) == OSSIUM_BLEND_PREMULTIPLIED);
+                TEST_ASSERT(GetBlendState(SDL_BLENDMODE_NONE) == 0);
+
+                NoopBgfxScope noop;
+                if (!noop.IsInitialised())
+                {
+                    Logger::EngineLog().Warning("Failed to initialise bgfx, skipping cached canvas tests.");
+                    return;
+                }
+                RenderViewPool pool;
+                RenderTexture target;
+                target.Create(200, 100);
+                Renderer renderer(&target, &pool);
+                ServicesProvider services(&renderer);
+                Scene scene(&services);
+
+                Entity* root = scene.CreateEntity();
+                root->AddComponent<Transform>();
+                CachedCanvas* cached = root->AddComponent<CachedCanvas>();
+                Entity* child = scene.CreateEntity(root);
+                child->AddComponent<Transform>()->SetWorldPosition(Vector3(50, 40, 0));
+                Texture* texture = child->AddComponent<Texture>();
+                texture->width = 20;
+                texture->height = 10;
+
+                Logger::EngineLog().Info("Render the subtree into a texture that covers it.");
+                Rect bounds;
+                TEST_ASSERT(cached->IsRenderEnabled() && !cached->IsCached());
+                TEST_ASSERT(cached->GetDrawBounds(bounds) && bounds.x == 40 && bounds.y == 35 && bounds.w == 20 && bounds.h == 10);
+                TEST_ASSERT(cached->GetTexture()->GetWidth() == 20 && cached->GetTexture()->GetHeight() == 10);
+                renderer.RenderPresent();
+                TEST_ASSERT(cached->IsCached() && !cached->IsRenderEnabled());
+
+                Logger::EngineLog().Info("Member changes re-render the texture.");
+                renderer.RenderPresent();
+                texture->width = 30;
+                TEST_ASSERT(cached->IsRenderEnabled() && cached->GetDrawBounds(bounds) && bounds.x == 35 && bounds.w == 30);
+                TEST_ASSERT(cached->GetTexture()->GetWidth() == 30);
+                // Shrinking reuses the larger texture
+                renderer.RenderPresent();
+                texture->width = 24;
+                TEST_ASSERT(cached->IsRenderEnabled() && cached->GetDrawBounds(bounds) && bounds.w == 24);
+                TEST_ASSERT(cached->GetTexture()->GetWidth() == 30);
+                renderer.RenderPresent();
+                TEST_ASSERT(cached->IsCached());
+
+                Logger::EngineLog().Info("Moving the root and SetDirty() re-render the texture.");
+                renderer.RenderPresent();
+                root->GetComponent<Transform>()->SetWorldPosition(Vector3(10, 0, 0));
+                TEST_ASSERT(cached->IsRenderEnabled());
+                renderer.RenderPresent();
+                cached->SetDirty();
+                TEST_ASSERT(cached->IsRenderEnabled());
+
+                Logger::EngineLog().Info("Structural changes re-render the texture.");
+                renderer.RenderPresent();
+                Entity* other = scene.CreateEntity();
+                TEST_ASSERT(cached->IsCached());
+                renderer.RenderPresent();
+                other->SetParent(child);
+                TEST_ASSERT(cached->IsRenderEnabled());
+                renderer.RenderPresent();
+                other->SetParent(nullptr);
+                TEST_ASSERT(cached->IsRenderEnabled());
+                renderer.RenderPresent();
+                Entity* removed = scene.CreateEntity(root);
+                TEST_ASSERT(cached->IsRenderEnabled());
+                renderer.RenderPresent();
+                scene.DestroyEntity(removed, true);
+                TEST_ASSERT(cached->IsRenderEnabled());
+
+                Logger::EngineLog().Info("Large subtrees are checked over several frames.");
+                Texture* last = nullptr;
+                for (unsigned int i = 0; i < CachedCanvas::HashBudget * 3; i++)
+                {
+                    Entity* entity = scene.CreateEntity(root);
+                    entity->AddComponent<Transform>();
+                    last = entity->AddComponent<Texture>();
+                }
+                renderer.RenderPresent();
+                renderer.RenderPresent();
+                TEST_ASSERT(cached->IsCached());
+                last->height = 5;
+                unsigned int frames = 0;
+                for (; frames < 8 && !cached->IsRenderEnabled(); frames++)
+                {
+                    renderer.RenderPresent();
+                }
+                TEST_ASSERT(frames < 4);
             }
+
         };
 
+        class OSSIUM_EDL RenderGraphTests : public UnitTest
+        {
+        public:
+            void RunTest()
+            {
+                NoopBgfxScope noop;
+                if (!noop.IsInitialised())
+                {
+                    Logger::EngineLog().Warning("Failed to initialise bgfx, skipping render graph tests.");
+                    return;
+                }
+                RenderViewPool pool;
+                RenderTexture target;
+                target.Create(64, 64);
+                RenderTexture shared;
+                shared.Create(64, 64);
+                Renderer renderer(&target, &pool, 4);
+                Renderer other(&target, &pool, 4);
+
+                Logger::EngineLog().Info("Renderers reserve contiguous view ranges.");
+                TEST_ASSERT(renderer.GetFirstView() == 0 && renderer.GetViewCount() == 4);
+                TEST_ASSERT(other.GetFirstView() == 4 && other.GetViewCount() == 4);
+                TestPass a("a", executed), b("b", executed), c("c", executed), d("d", executed), e("e", executed);
+                renderer.AddInput(&a);
+                other.AddInput(&b);
+                renderer.AddInput(&c);
+                TEST_ASSERT(a.GetID() == 0 && c.GetID() == 1 && b.GetID() == 4);
+                // Freed ids are reused without moving the views of other inputs
+                renderer.RemoveInput(&a);
+                renderer.AddInput(&d);
+                TEST_ASSERT(d.GetID() == 0 && c.GetID() == 1 && b.GetID() == 4);
+                // Inputs beyond the range aren't added
+                renderer.AddInput(&a);
+                renderer.AddInput(&e);
+                TestPass extra("extra", executed);
+                renderer.AddInput(&extra);
+                TEST_ASSERT(extra.GetRenderer() == nullptr);
+                for (TestPass* pass : {&a, &c, &d, &e})
+                {
+                    renderer.RemoveInput(pass);
+                }
+                other.RemoveInput(&b);
+
+                Logger::EngineLog().Info("Readers are rendered after writers.");
+                // Added in reverse: a composites a blurred copy of the scene rendered by c
+                a.declare = [&] (RenderPassTargets& targets) { targets.Read("blur"); };
+                b.declare = [&] (RenderPassTargets& targets) { targets.Read(&shared); targets.Write("blur", 32, 32); };
+                c.declare = [&] (RenderPassTargets& targets) { targets.Write(&shared); };
+                // Nothing reads the output of d, so it's culled
+                d.declare = [&] (RenderPassTargets& targets) { targets.Write("unused", 32, 32); };
+                for (TestPass* pass : {&a, &b, &c, &d})
+                {
+                    renderer.AddInput(pass);
+                }
+                Render(renderer);
+                TEST_ASSERT(executed == "cba");
+                TEST_ASSERT(renderer.GetRenderGraph()->GetSkippedCount() == 1);
+                TEST_ASSERT(renderer.GetRenderGraph()->GetTransientBufferCount() == 1);
+                // Disabled inputs are skipped as well as anything that only they read
+                a.enabled = false;
+                Render(renderer);
+                TEST_ASSERT(executed == "c" && renderer.GetRenderGraph()->GetTransientBufferCount() == 0);
+                a.enabled = true;
+
+                Logger::EngineLog().Info("Cycles fall back to the order inputs were added.");
+                c.declare = [&] (RenderPassTargets& targets) { targets.Read("blur"); targets.Write(&shared); };
+                Render(renderer);
+                TEST_ASSERT(executed == "abc");
+                c.declare = [&] (RenderPassTargets& targets) { targets.Write(&shared); };
+                Render(renderer);
+                TEST_ASSERT(executed == "cba");
+
+                for (TestPass* pass : {&a, &b, &c, &d})
+                {
+                    renderer.RemoveInput(pass);
+                }
+
+                Logger::EngineLog().Info("Transient targets of the same size share frame buffers when not in use at the same time.");
+                a.declare = [&] (RenderPassTargets& targets) { targets.Write("first", 32, 32); };
+                b.declare = [&] (RenderPassTargets& targets) { targets.Read("first"); };
+                c.declare = [&] (RenderPassTargets& targets) { targets.Write("second", 32, 32); };
+                d.declare = [&] (RenderPassTargets& targets) { targets.Read("second"); };
+                for (TestPass* pass : {&a, &b, &c, &d})
+                {
+                    renderer.AddInput(pass);
+                }
+                Render(renderer);
+                TEST_ASSERT(executed == "abcd" && renderer.GetRenderGraph()->GetTransientBufferCount() == 1);
+                // Reading both at once needs separate buffers
+                d.declare = [&] (RenderPassTargets& targets) { targets.Read("first"); targets.Read("second"); };
+                Render(renderer);
+                TEST_ASSERT(executed == "abcd" && renderer.GetRenderGraph()->GetTransientBufferCount() == 2);
+
+                for (TestPass* pass : {&a, &b, &c, &d})
+                {
+                    renderer.RemoveInput(pass);
+                }
+            }
+
+        private:
+            // Records the order it's rendered in and declares whatever targets a test requires
+            class TestPass : public RenderInput
+            {
+            public:
+                TestPass(std::string name, std::string& executed) : name(name), executed(executed)
+                {
+                }
+
+                std::string GetRenderDebugName()
+                {
+                    return name;
+                }
+
+                bool IsRenderEnabled()
+                {
+                    return enabled;
+                }
+
+                std::function<void(RenderPassTargets&)> declare;
+                bool enabled = true;
+
+            protected:
+                void DeclareTargets(RenderPassTargets& targets)
+                {
+                    if (declare)
+                    {
+                        declare(targets);
+                    }
+                }
+
+            private:
+                void Render()
+                {
+                    executed += name;
+                }
+
+                std::string name;
+                std::string& executed;
+
+            };
+
+            void Render(Renderer& renderer)
+            {
+                executed.clear();
+                renderer.RenderPresent();
+            }
+
+            std::string executed;
+
+        };
+
+        class OSSIUM_EDL RenderCommandListTests : public UnitTest
+        {
+        public:
+            void RunTest()
+            {
+                NoopBgfxScope noop;
+                if (!noop.IsInitialised())
+                {
+                    Logger::EngineLog().Warning("Failed to initialise bgfx, skipping render command list tests.");
+                    return;
+                }
+                RenderViewPool pool;
+                RenderTexture target;
+                target.Create(64, 64);
+                Renderer renderer(&target, &pool);
+                bgfx::ProgramHandle program = renderer.GetProgram("default.vert", "default.frag");
+                bgfx::ProgramHandle other = renderer.GetProgram("image.vert", "image.frag");
+                if (bgfx::isValid(program) && bgfx::isValid(other))
+                {
+                    RunCommandTests(program, other);
+                }
+                else
+                {
+                    Logger::EngineLog().Warning("Failed to load the default shaders, skipping render command list tests.");
+                }
+            }
+
+        private:
+            void RunCommandTests(bgfx::ProgramHandle program, bgfx::ProgramHandle other)
+            {
+                RenderCommandList list;
+                std::vector<Vertex2D> vertices(UINT16_MAX + 2, {0, 0, 0xFFFFFFFF});
+                DrawCall call;
+                call.layout = &Vertex2D::Layout();
+                call.vertices = vertices.data();
+                call.vertexCount = 3;
+                call.program = program;
+
+                Logger::EngineLog().Info("Draw calls with equal keys keep the order they were recorded in.");
+                for (unsigned int i = 0; i < 6; i++)
+                {
+                    // Alternating colours can't be merged, so nothing changes order
+                    call.rgba = i % 2 == 0 ? 0xFF0000FF : 0x00FF00FF;
+                    list.Record(0, bgfx::ViewMode::Default, call);
+                }
+                list.Submit();
+                TEST_ASSERT(list.GetSubmitOrder() == std::vector<Uint32>({0, 1, 2, 3, 4, 5}));
+                TEST_ASSERT(list.GetCommandCount() == 6 && list.GetSubmitCount() == 6);
+                call.rgba = 0;
+
+                Logger::EngineLog().Info("Draw calls are sorted by view, layer, then depth or program.");
+                call.layer = 1;
+                list.Record(0, bgfx::ViewMode::Default, call);
+                call.layer = 0;
+                call.program = other;
+                list.Record(0, bgfx::ViewMode::Default, call);
+                call.program = program;
+                list.Record(0, bgfx::ViewMode::Default, call);
+                list.Record(0, bgfx::ViewMode::Default, call);
+                list.Submit();
+                // The two calls with the same program are merged
+                const std::vector<Uint32>& order = list.GetSubmitOrder();
+                TEST_ASSERT(order[3] == 0 && list.GetSubmitCount() == 3);
+                TEST_ASSERT(program.idx < other.idx ? order[0] == 2 && order[1] == 3 : order[0] == 1);
+
+                float depths[3] = {0.9f, 0.1f, 0.5f};
+                for (float depth : depths)
+                {
+                    call.depth = depth;
+                    list.Record(1, bgfx::ViewMode::DepthAscending, call);
+                }
+                list.Submit();
+                TEST_ASSERT(list.GetSubmitOrder() == std::vector<Uint32>({1, 2, 0}));
+                // bgfx sorts the view by the depth it is given too, so draw calls at different depths aren't merged
+                const std::vector<Uint32>& submitted = list.GetSubmitDepths();
+                TEST_ASSERT(list.GetSubmitCount() == 3 && submitted.size() == 3);
+                TEST_ASSERT(submitted[0] < submitted[1] && submitted[1] < submitted[2]);
+                TEST_ASSERT(submitted[2] == RenderCommandList::GetSortDepth(bgfx::ViewMode::DepthAscending, 0, 0.9f));
+                for (float depth : depths)
+                {
+                    call.depth = depth;
+                    list.Record(1, bgfx::ViewMode::DepthDescending, call);
+                }
+                list.Submit();
+                TEST_ASSERT(list.GetSubmitOrder() == std::vector<Uint32>({0, 2, 1}));
+                TEST_ASSERT(submitted[0] > submitted[1] && submitted[1] > submitted[2]);
+                call.depth = 0;
+
+                // Layers come before depth in either direction
+                Uint32 nearer = RenderCommandList::GetSortDepth(bgfx::ViewMode::DepthAscending, 1, 0.1f);
+                Uint32 further = RenderCommandList::GetSortDepth(bgfx::ViewMode::DepthAscending, 0, 0.9f);
+                TEST_ASSERT(nearer > further);
+                nearer = RenderCommandList::GetSortDepth(bgfx::ViewMode::DepthDescending, 1, 0.1f);
+                further = RenderCommandList::GetSortDepth(bgfx::ViewMode::DepthDescending, 0, 0.9f);
+                TEST_ASSERT(nearer < further);
+                call.depth = 0.5f;
+                list.Record(1, bgfx::ViewMode::DepthAscending, call);
+                list.Record(1, bgfx::ViewMode::DepthAscending, call);
+                list.Submit();
+                TEST_ASSERT(list.GetSubmitCount() == 1 && submitted[0] == RenderCommandList::GetSortDepth(bgfx::ViewMode::DepthAscending, 0, 0.5f));
+                call.depth = 0;
+
+                // Sequential views ignore layers, and views are submitted in order of id
+                for (Uint8 layer : {3, 1, 2})
+                {
+                    call.layer = layer;
+                    list.Record(2, bgfx::ViewMode::Sequential, call);
+                }
+                call.layer = 0;
+                list.Record(1, bgfx::ViewMode::Sequential, call);
+                list.Submit();
+                TEST_ASSERT(list.GetSubmitOrder() == std::vector<Uint32>({3, 0, 1, 2}));
+
+                Logger::EngineLog().Info("Draw calls are merged up to the limit of 16 bit indices.");
+                for (unsigned int i = 0; i < 10; i++)
+                {
+                    list.Record(0, bgfx::ViewMode::Default, call);
+                }
+                list.Submit();
+                TEST_ASSERT(list.GetCommandCount() == 10 && list.GetSubmitCount() == 1);
+                call.vertexCount = 30000;
+                for (unsigned int i = 0; i < 3; i++)
+                {
+                    list.Record(0, bgfx::ViewMode::Default, call);
+                }
+                list.Submit();
+                TEST_ASSERT(list.GetCommandCount() == 3 && list.GetSubmitCount() == 2);
+                // Too many vertices for a single draw call
+                call.vertexCount = vertices.size();
+                list.Record(0, bgfx::ViewMode::Default, call);
+                list.Submit();
+                TEST_ASSERT(list.GetCommandCount() == 0 && list.GetSubmitCount() == 0);
+                call.vertexCount = 3;
+
+                // Different states aren't merged
+                list.Record(0, bgfx::ViewMode::Default, call);
+                call.state = BGFX_STATE_WRITE_RGB;
+                list.Record(0, bgfx::ViewMode::Default, call);
+                list.Submit();
+                TEST_ASSERT(list.GetCommandCount() == 2 && list.GetSubmitCount() == 2);
+            }
+
+        };
+
+        class OSSIUM_EDL DebugDrawTests : public UnitTest
+        {
+        public:
+            void RunTest()
+            {
+                NoopBgfxScope noop;
+                if (!noop.IsInitialised())
+                {
+                    Logger::EngineLog().Warning("Failed to initialise bgfx, skipping debug draw tests.");
+                    return;
+                }
+                RenderViewPool pool;
+                RenderTexture target;
+                target.Create(64, 64);
+                Renderer renderer(&target, &pool);
+                DebugDraw debug(&renderer);
+                EmptyPass pass;
+                renderer.AddInput(&pass);
+                if (bgfx::isValid(renderer.GetProgram("default.vert", "default.frag")))
+                {
+                    Logger::EngineLog().Info("Thousands of shapes are drawn with one submission.");
+                    for (unsigned int i = 0; i < 10000; i++)
+                    {
+                        debug.AddLine(&pass, Vector2(0, i % 64), Vector2(63, i % 64), Colors::Red);
+                    }
+                    renderer.RenderPresent();
+                    TEST_ASSERT(debug.GetLineCount() == 10000);
+                    TEST_ASSERT(renderer.GetCommandList()->GetCommandCount() == 1 && renderer.GetCommandList()->GetSubmitCount() == 1);
+                    // Shapes only last for the frame they are added in
+                    renderer.RenderPresent();
+                    TEST_ASSERT(debug.GetLineCount() == 0 && renderer.GetCommandList()->GetSubmitCount() == 0);
+                }
+                else
+                {
+                    Logger::EngineLog().Warning("Failed to load the default shaders, skipping debug draw submission tests.");
+                }
+
+                Logger::EngineLog().Info("Shapes added for removed inputs are dropped.");
+                debug.AddRect(&pass, Rect(8, 8, 16, 16), Colors::Green, true);
+                debug.AddCircle(&pass, Vector2(32, 32), 8, Colors::Blue);
+                renderer.RemoveInput(&pass);
+                renderer.RenderPresent();
+                TEST_ASSERT(debug.GetLineCount() == 0 && debug.GetTriangleCount() == 0);
+                TEST_ASSERT(renderer.GetCommandList()->GetCommandCount() == 0);
+
+                Logger::EngineLog().Info("Shapes added to inputs that aren't in screen space are dropped.");
+                EmptyPass sorted(bgfx::ViewMode::DepthAscending);
+                renderer.AddInput(&sorted);
+                debug.AddLine(&sorted, Vector2(0, 0), Vector2(63, 63), Colors::Red);
+                renderer.RenderPresent();
+                TEST_ASSERT(debug.GetLineCount() == 0 && renderer.GetCommandList()->GetCommandCount() == 0);
+                renderer.RemoveInput(&sorted);
+            }
+
+        private:
+            // An input that draws nothing itself
+            class EmptyPass : public RenderInput
+            {
+            public:
+                EmptyPass(bgfx::ViewMode::Enum mode = bgfx::ViewMode::Sequential) : mode(mode)
+                {
+                }
+
+                std::string GetRenderDebugName()
+                {
+                    return "EmptyPass";
+                }
+
+            protected:
+                bgfx::ViewMode::Enum GetViewMode()
+                {
+                    return mode;
+                }
+
+            private:
+                void Render()
+                {
+                }
+
+                bgfx::ViewMode::Enum mode;
+
+            };
+
+        };
     }
 #endif
 }